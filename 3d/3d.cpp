@@ -9,6 +9,8 @@
 
 using namespace FTS;
 
+PerfCounter FTS::g_drawCalls("gl.drawCalls");
+
 #ifdef DEBUG
 /// Check the OpenGL state for errors.
 /** This looks if there was an OpenGL error, if yes, prints it out.
@@ -70,8 +72,13 @@ bool FTS::glHasExtension(const char* extname)
     verifGL("glHasExtension start");
 
     if(exts.empty()) {
+        // Without a context, like when running headless, there are none.
+        const GLubyte* pszVersion = glGetString(GL_VERSION);
+        if(!pszVersion)
+            return false;
+
         // Load all extensions:
-        if(glGetString(GL_VERSION)[0] >= '3') {
+        if(pszVersion[0] >= '3') {
             GLint nExts = 0;
             glGetIntegerv(GL_NUM_EXTENSIONS, &nExts);
             for(GLint i = 0 ; i < nExts ; ++i) {
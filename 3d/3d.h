@@ -3,6 +3,7 @@
 
 #include "main.h"
 #include "opengl_wrapper.h"
+#include "logging/PerfCounters.h"
 
 namespace FTS {
     class String;
@@ -24,6 +25,9 @@ int verifGL(const FTS::String& in_sMessage);
 namespace FTS {
     void* glGetProcAddress(const char* fname);
     bool glHasExtension(const char* extname);
+
+    /// Every glDrawElements and every glBegin/glEnd block counts as a draw call.
+    extern PerfCounter g_drawCalls;
 }; // namespace FTS
 
 #endif                          /* D_3D_H */
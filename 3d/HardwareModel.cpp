@@ -16,9 +16,11 @@
 #include "graphic/graphic.h"
 #include "graphic/Color.h"
 #include "logging/logger.h"
+#include "logging/Profiler.h"
 #include "main/runlevels.h"
 
 #include "dLib/dString/dString.h"
+#include "dLib/dString/dName.h"
 #include "dLib/dArchive/dArchive.h"
 
 #include "bouge/bouge.hpp"
@@ -49,8 +51,8 @@ struct MaterialUserData : public bouge::UserData {
     /// The shader to be used by this material.
     Program* prog;
 
-    std::map<String, Vector> uniforms_f;
-    std::map<String, Graphic*> uniforms_tex;
+    std::map<Name, Vector> uniforms_f;
+    std::map<Name, Graphic*> uniforms_tex;
 
     /// A VAO storing the shader, shader's vertex attrib setup and vbo setup
     /// on the graphics card.
@@ -138,7 +140,7 @@ struct MaterialUserData : public bouge::UserData {
                 case GL_FLOAT_VEC2:
                 case GL_FLOAT_VEC3:
                 case GL_FLOAT_VEC4:
-                    uniforms_f[prop.name()] = Vector(&prop.valueAsFvec()[0]);
+                    uniforms_f[Name(prop.name())] = Vector(&prop.valueAsFvec()[0]);
                     break;
                 case GL_SAMPLER_2D:
                     Graphic* pGraphic = nullptr;
@@ -150,7 +152,7 @@ struct MaterialUserData : public bouge::UserData {
                         // If not, try to load it from Arkana-FTS.
                         pGraphic = GraphicManager::getSingleton().getOrLoadGraphic(prop.value());
                     }
-                    uniforms_tex[prop.name()] = pGraphic;
+                    uniforms_tex[Name(prop.name())] = pGraphic;
                     break;
                 //TODO: more types, for example matrices, ints, ...
                 }
@@ -475,17 +477,25 @@ bool FTS::HardwareModel::isStatic() const
 
 void FTS::HardwareModel::render(const AffineMatrix& in_modelMatrix, const Color& in_playerCol, bouge::ModelInstancePtrC in_modelInst)
 {
+    FTS_PROFILE_SCOPE("HardwareModel::render");
     // Preliminary gets to shorten the code.
     Camera& cam = RunlevelManager::getSingleton().getCurrRunlevel()->getActiveCamera();
 
     // This actually is a very big optimization, belive it or not, I profiled it!
-    static const std::string uModelViewProjectionMatrix = "uModelViewProjectionMatrix";
-    static const std::string uModelViewMatrix = "uModelViewMatrix";
-    static const std::string uViewMatrix = "uViewMatrix";
-    static const std::string uProjectionMatrix = "uProjectionMatrix";
-    static const std::string uInvModelViewProjectionMatrix = "uInvModelViewProjectionMatrix";
-    static const std::string uInvModelViewMatrix = "uInvModelViewMatrix";
-    static const std::string uNormalMatrix = "qNormalMatrix";
+    // Names make finding the uniforms in the program a mere hash lookup.
+    static const Name uModelViewProjectionMatrix("uModelViewProjectionMatrix");
+    static const Name uModelViewMatrix("uModelViewMatrix");
+    static const Name uViewMatrix("uViewMatrix");
+    static const Name uProjectionMatrix("uProjectionMatrix");
+    static const Name uInvModelViewProjectionMatrix("uInvModelViewProjectionMatrix");
+    static const Name uInvModelViewMatrix("uInvModelViewMatrix");
+    static const Name uNormalMatrix("qNormalMatrix");
+    static const Name uBonesPalette("uBonesPalette");
+    static const Name uBonesPaletteInvTrans("uBonesPaletteInvTrans");
+    static const Name uPlayerColor("uPlayerColor");
+    static const Name uLightDirection("uLightDirection");
+    static const Name uLightDiffuse("uLightDiffuse");
+    static const Name uGlobalAmbient("uGlobalAmbient");
 
     // Pre-calculate a few matrices:
     AffineMatrix v = cam.getViewMatrix();
@@ -522,18 +532,18 @@ void FTS::HardwareModel::render(const AffineMatrix& in_modelMatrix, const Color&
         if(!m_isStatic) {
             for(std::size_t i = 0 ; i < submesh.boneCount() ; ++i) {
                 bouge::BoneInstancePtrC bone = in_modelInst->skeleton()->bone(submesh.boneName(i));
-                prog->setUniformArrayElement("uBonesPalette", i, bone->transformMatrix());
-                prog->setUniformArrayElementInverse("uBonesPaletteInvTrans", i, bone->transformMatrix(), true);
+                prog->setUniformArrayElement(uBonesPalette, i, bone->transformMatrix());
+                prog->setUniformArrayElementInverse(uBonesPaletteInvTrans, i, bone->transformMatrix(), true);
             }
         }
 
         // Set various other uniforms
-        prog->setUniform("uPlayerColor", in_playerCol);
+        prog->setUniform(uPlayerColor, in_playerCol);
 
         // TODO: implement the sun/moon right here.
-        prog->setUniform("uLightDirection", Vector(1.0f, -1.0f, 1.0f));
-        prog->setUniform("uLightDiffuse", Vector(1.0f, 1.0f, 1.0f));
-        prog->setUniform("uGlobalAmbient", Vector(1.0f, 1.0f, 1.0f));
+        prog->setUniform(uLightDirection, Vector(1.0f, -1.0f, 1.0f));
+        prog->setUniform(uLightDiffuse, Vector(1.0f, 1.0f, 1.0f));
+        prog->setUniform(uGlobalAmbient, Vector(1.0f, 1.0f, 1.0f));
 
         // Set all the material-registered uniforms.
         for(auto uniform = pUD->uniforms_f.begin() ; uniform != pUD->uniforms_f.end() ; ++uniform) {
@@ -548,6 +558,7 @@ void FTS::HardwareModel::render(const AffineMatrix& in_modelMatrix, const Color&
             texUnit++;
         }
 
+        g_drawCalls.add();
         glDrawElements(pUD->drawMode, (GLsizei)(submesh.faceCount() * m_pHardwareModel->indicesPerFace()), BOUGE_FACE_INDEX_TYPE_GL, (const GLvoid*)(submesh.startIndex()*sizeof(BOUGE_FACE_INDEX_TYPE)));
 
         pUD->vao.unbind();
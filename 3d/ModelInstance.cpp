@@ -24,42 +24,33 @@
 // TODO: when creating a model using this core model:
     // Start the idle animation if there is any?
 
-std::map<FTS::String, std::set<unsigned int> > FTS::ModelInstance::m_mUsedNames;
+namespace {
+    FTS::PerfCounter g_instances("models.instances", FTS::PerfCounter::Gauge);
+}
 
 FTS::ModelInstance::ModelInstance(std::shared_ptr<FTS::HardwareModel> in_pHwModel)
     : m_pModel(new bouge::ModelInstance(in_pHwModel->m_pCoreModel))
     , m_pHwModel(in_pHwModel)
+    , m_hUpdate(UpdateableManager::InvalidHandle)
 {
     // And we need to select the default skin...
     this->selectSkin("Default");
+    g_instances.add();
 
     // If I have at least one animation, register me as an updateable.
     // Without animation, we don't need to get updated!
     if(m_pHwModel->anims().size() > 0) {
-        // Find an unique name for it:
-        // NOTE: If this gets a bottleneck, we might create an addUnnamed
-        //       method to the UpdateableManager...
-        std::set<unsigned int>& numbers = m_mUsedNames[m_pHwModel->getName()];
-        for(unsigned int i = 0 ; i < std::numeric_limits<unsigned int>::max() ; ++i) {
-            if(numbers.find(i) == numbers.end()) {
-                // Yup, this number is still free!
-                UpdateableManager::getSingleton().add(m_pHwModel->getName() + String::nr(i), this);
-                numbers.insert(i);
-                m_uiInstanceNumber = i;
-                break;
-            }
-        }
+        m_hUpdate = UpdateableManager::getSingleton().add(this);
     }
 }
 
 FTS::ModelInstance::~ModelInstance()
 {
+    g_instances.sub();
+
     // If I have at least one animation, I've been registered as an updateable.
-    // Unregister me now!
-    if(m_pHwModel->anims().size() > 0) {
-        UpdateableManager::getSingleton().rem(m_pHwModel->getName() + String::nr(m_uiInstanceNumber));
-        m_mUsedNames[m_pHwModel->getName()].erase(m_uiInstanceNumber);
-    }
+    // Unregister me now! Without, the handle is invalid and this does nothing.
+    UpdateableManager::getSingleton().rem(m_hUpdate);
 }
 
 void FTS::ModelInstance::render(const FTS::Vector& in_pos, const Color& in_playerColor)
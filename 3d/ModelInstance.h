@@ -78,6 +78,9 @@ protected:
     ModelInstance(std::shared_ptr<FTS::HardwareModel> in_pHwModel);
 
     virtual bool update(const Clock&);
+    /// Animating only touches this instance, the core model is only read.
+    virtual bool isUpdateThreadSafe() const {return true;};
+    virtual Phase getUpdatePhase() const {return Animation;};
 
 private:
     /// The bouge model instance.
@@ -86,11 +89,8 @@ private:
     /// The HardwareModel that I am an instance of.
     std::shared_ptr<FTS::HardwareModel> m_pHwModel;
 
-    /// All the numbers that are already used as "names" for instances of a certain hw model.
-    static std::map<String, std::set<unsigned int> > m_mUsedNames;
-
-    /// And this is the number of this instance, relative to the hw model.
-    unsigned int m_uiInstanceNumber;
+    /// Where I am registered as an updateable, if I have any animation.
+    UpdateableManager::Handle m_hUpdate;
 };
 
 }; // namespace FTS
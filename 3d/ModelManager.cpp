@@ -19,11 +19,12 @@
 
 FTS::ModelManager::ModelManager()
     : ErrorModelName("Error")
+    , m_errorModelName(ErrorModelName)
 {
     FTSMSGDBG("Creating hw model manager", 2);
 
     // Create the error model that will (hopefully) never fail.
-    m_mHardwareModels[ErrorModelName] = std::shared_ptr<HardwareModel>(new HardwareModel(ErrorModelName));
+    m_mHardwareModels[m_errorModelName] = std::shared_ptr<HardwareModel>(new HardwareModel(ErrorModelName));
 
     FTSMSGDBG("Created hw model manager", 2);
 }
@@ -40,36 +41,44 @@ FTS::ModelManager::~ModelManager()
 
 FTS::ModelInstance* FTS::ModelManager::createInstance(const FTS::String& in_sName)
 {
-    return new ModelInstance(this->getOrLoad(in_sName));
+    return new ModelInstance(this->getOrLoad(Name(in_sName)));
+}
+
+FTS::ModelInstance* FTS::ModelManager::createInstance(const FTS::Name& in_name)
+{
+    return new ModelInstance(this->getOrLoad(in_name));
 }
 
 void FTS::ModelManager::addModel(const FTS::String& in_sName)
 {
-    this->getOrLoad(in_sName);
+    this->getOrLoad(Name(in_sName));
 }
 
-std::shared_ptr<FTS::HardwareModel> FTS::ModelManager::getOrLoad(const FTS::String& in_sName)
+std::shared_ptr<FTS::HardwareModel> FTS::ModelManager::getOrLoad(const FTS::Name& in_name)
 {
-    auto i = m_mHardwareModels.find(in_sName);
+    auto i = m_mHardwareModels.find(in_name);
     if(i != m_mHardwareModels.end())
         return i->second;
 
     // Not loaded yet, then load it!
+    const String& sName = in_name.str();
     try {
         // Check if the name is either just a "name" (of a model in or models dir) ...
-        Path toOpen = Path::datadir(D_MODELS_DIRNAME) + Path(in_sName + ".ftsmdl");
-        if(!FileUtils::exists(toOpen)) {
+        Path toOpen = Path::datadir(D_MODELS_DIRNAME) + Path(sName + ".ftsmdl");
+        // The model may as well be in one of the archives to look in, so ask
+        // the file class, which looks into them before asking the disk.
+        if(!File::available(toOpen, File::Read)) {
             // Next, try to open it without the .ftsmdl extension (in the case it is a directory)
-            toOpen = Path::datadir(D_MODELS_DIRNAME) + Path(in_sName);
+            toOpen = Path::datadir(D_MODELS_DIRNAME) + Path(sName);
             if(!FileUtils::exists(toOpen)) {
                 // Last chance is that we got a full pathname already:
-                toOpen = in_sName;
+                toOpen = sName;
             }
         }
 
         // Load the model out of the archive.
         Archive::Ptr pArch  = Archive::Ptr(Archive::loadArchive(toOpen));
-        m_mHardwareModels[in_sName] = std::shared_ptr<HardwareModel>(new HardwareModel(in_sName, *pArch));
+        m_mHardwareModels[in_name] = std::shared_ptr<HardwareModel>(new HardwareModel(sName, *pArch));
 
         // And here the archive gets closed again, automagic :)
     } catch(const FTS::LoggableException& e) {
@@ -77,21 +86,21 @@ std::shared_ptr<FTS::HardwareModel> FTS::ModelManager::getOrLoad(const FTS::Stri
 
         // If it hasn't been loaded successfully, we still add it to the map as being
         // the error texture. To avoid hundreds of reload trials.
-        m_mHardwareModels[in_sName] = this->getErrorModel();
+        m_mHardwareModels[in_name] = this->getErrorModel();
     } catch(const std::exception& e) {
-        FTS18N("CorruptData", MsgType::Error, in_sName, e.what());
+        FTS18N("CorruptData", MsgType::Error, sName, e.what());
 
         // same here.
-        m_mHardwareModels[in_sName] = this->getErrorModel();
+        m_mHardwareModels[in_name] = this->getErrorModel();
     }
 
-    return m_mHardwareModels[in_sName];
+    return m_mHardwareModels[in_name];
 }
 
 void FTS::ModelManager::removeModel(const String& in_sName)
 {
     if(in_sName != ErrorModelName)
-        m_mHardwareModels.erase(in_sName);
+        m_mHardwareModels.erase(Name(in_sName));
 }
 
 void FTS::ModelManager::removeAllModels()
@@ -99,7 +108,7 @@ void FTS::ModelManager::removeAllModels()
     if(m_mHardwareModels.size() > 1) {
         String sWarning = "The following hardware models haven't been unloaded:\n";
         for(auto model = m_mHardwareModels.begin() ; model != m_mHardwareModels.end() ; ++model) {
-            sWarning += "    -> " + model->first + " (" + String::nr(model->second.use_count()) + " references)\n";
+            sWarning += "    -> " + model->first.str() + " (" + String::nr(model->second.use_count()) + " references)\n";
         }
         FTSMSGDBG(sWarning, 2);
     }
@@ -109,5 +118,5 @@ void FTS::ModelManager::removeAllModels()
 
 std::shared_ptr<FTS::HardwareModel> FTS::ModelManager::getErrorModel()
 {
-    return m_mHardwareModels[ErrorModelName];
+    return m_mHardwareModels[m_errorModelName];
 }
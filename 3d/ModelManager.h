@@ -9,8 +9,9 @@
 #define D_MODEL_MANAGER_H
 
 #include "dLib/dString/dString.h"
+#include "dLib/dString/dName.h"
 
-#include <map>
+#include <unordered_map>
 #include <memory>
 
 namespace FTS {
@@ -23,6 +24,8 @@ public:
     virtual ~ModelManager();
 
     ModelInstance* createInstance(const String& in_sModelName);
+    /// The same, but faster for creating many instances of the same model.
+    ModelInstance* createInstance(const Name& in_modelName);
 
     /// Adds a model. It actually loads the whole model into hardware
     /// such that it is ready to make some instances with nearly no delay.
@@ -52,12 +55,14 @@ private:
     ///
     /// \return The corresponding hardware model. If it failed to load, the
     ///         error hardware model.
-    std::shared_ptr<HardwareModel> getOrLoad(const String& in_sHwModelName);
+    std::shared_ptr<HardwareModel> getOrLoad(const Name& in_hwModelName);
 
     /// \return The hardware model used when there is an error loading one.
     std::shared_ptr<HardwareModel> getErrorModel();
 
-    std::map<String, std::shared_ptr<HardwareModel> > m_mHardwareModels;
+    std::unordered_map<Name, std::shared_ptr<HardwareModel> > m_mHardwareModels;
+    /// \a ErrorModelName as a key into \a m_mHardwareModels.
+    const Name m_errorModelName;
 };
 
 } // namespace FTS
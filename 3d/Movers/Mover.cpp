@@ -14,17 +14,15 @@ FTS::Mover::Mover(const std::weak_ptr<MapObject>& in_pWhom, float in_fDuration,
 {
     // If a name was given, use this for the updateable.
     if(!m_sName.empty())
-        UpdateableManager::getSingleton().add(m_sName, this);
+        m_hUpdate = UpdateableManager::getSingleton().add(m_sName, this);
     else
-        UpdateableManager::getSingleton().add(this);
+        m_hUpdate = UpdateableManager::getSingleton().add(this);
 }
 
 FTS::Mover::~Mover()
 {
-    if(!m_sName.empty())
-        UpdateableManager::getSingleton().rem(m_sName);
-    else
-        UpdateableManager::getSingleton().rem(this);
+    // If another mover took over my name, this leaves it alone.
+    UpdateableManager::getSingleton().rem(m_hUpdate);
 }
 
 bool FTS::Mover::update(const Clock& in_clock)
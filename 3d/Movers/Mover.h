@@ -43,6 +43,7 @@ private:
     float m_fOldSpeed;
     String m_sName;
     bool m_bSelfdestroy;
+    UpdateableManager::Handle m_hUpdate;
 };
 
 class MoverStopper : public CommandBase {
@@ -12,8 +12,7 @@
 #include "ui/ui.h"
 #include "3d/light.h"
 
-#include "dLib/dConf/ArkanaDefaultSettings.h"
-#include "dLib/dConf/configuration.h"
+#include "dLib/dConf/ConfigurationStore.h"
 #include "dLib/dString/dString.h"
 
 #include <iterator>
@@ -36,11 +35,13 @@ public:
 
 using namespace FTS;
 
+bool FTS::Renderer::m_bHeadless = false;
+
 FTS::Renderer::Renderer()
 {
 
-    Configuration conf ("conf.xml", ArkanaDefaultSettings());
-    this->changeResolution(Resolution(conf.get<int>("HRes"), conf.get<int>("VRes"), conf.get<bool>("Fullscreen")));
+    Configuration::Ptr pConf = ConfigurationStore::getSingleton().getMainConf();
+    this->changeResolution(Resolution(pConf->get<int>("HRes"), pConf->get<int>("VRes"), pConf->get<bool>("Fullscreen")));
 
     // Initialize the Camera object after the SDL window is initialized.
     m_default2DCam.reset();
@@ -80,11 +81,19 @@ void FTS::Renderer::createSDLWindow(const Resolution& in_res)
     //    throw HardwareLimitException("Screen resolution " + in_res.toString(true), 0, 0);
     //}
 
+    // Without a display, the window only receives the (non-existing) input
+    // and there is no OpenGL context at all.
+    if(m_bHeadless)
+        iVideoFlags &= ~SDL_WINDOW_OPENGL;
+
     // get a SDL surface
     m_pScreen = SDL_CreateWindow(FTS_WINDOW_TITLE, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, in_res.w, in_res.h, iVideoFlags);
     if(!m_pScreen) {
         throw HardwareLimitException("Screen resolution " + in_res.toString(true), 0, 0);
     }
+    if(m_bHeadless)
+        return;
+
     m_Context = SDL_GL_CreateContext(m_pScreen);
     String sVersion = glGetString(GL_VERSION);
     std::vector<String> versions;
@@ -194,7 +203,8 @@ void FTS::Renderer::init()
 void FTS::Renderer::deinit()
 {
     LightSystem::deinit();
-    SDL_GL_DeleteContext(m_Context);
+    if(m_Context)
+        SDL_GL_DeleteContext(m_Context);
 }
 
 /// This function enters into the 2D drawing mode.
@@ -321,12 +331,12 @@ bool FTS::Renderer::changeResolution(const Resolution& res)
             throw 3;
 
         // We were successful! Store the options.
-        Configuration conf ("conf.xml", ArkanaDefaultSettings());
+        Configuration::Ptr pConf = ConfigurationStore::getSingleton().getMainConf();
 
-        conf.set("Fullscreen", res.fs);
-        conf.set("HRes", res.w);
-        conf.set("VRes", res.h);
-        conf.save();
+        pConf->set("Fullscreen", res.fs);
+        pConf->set("HRes", res.w);
+        pConf->set("VRes", res.h);
+        pConf->save();
 
         return true;
     } catch(const TooOldOpenGLException&) {
@@ -31,6 +31,9 @@ class Renderer : public Singleton<Renderer> {
     /// SDL: The screen surface.
     SDL_Window *m_pScreen = nullptr;
     void * m_Context = nullptr;
+
+    /// Whether there is neither a display nor an OpenGL context.
+    static bool m_bHeadless;
     // Graphics mode creation methods.
     void createSDLWindow(const Resolution& in_res);
     static uint32_t calcSDLVideoFlags(bool in_bFullscreen);
@@ -50,6 +53,12 @@ public:
     inline Camera& getDefault2DCamera() {return m_default2DCam;};
     inline Camera& getDefault3DCamera() {return m_default3DCam;};
     inline SDL_Window* getWindow() { return m_pScreen; }
+
+    /// Without a display, the game runs just like with one, only nothing gets
+    /// drawn: OpenGL calls do nothing, see opengl_wrapper.cpp. This must be
+    /// chosen before SDL and the renderer are initialized.
+    static void setHeadless(bool in_bHeadless) { m_bHeadless = in_bHeadless; }
+    static bool isHeadless() { return m_bHeadless; }
 };
 
 } // namespace FTS
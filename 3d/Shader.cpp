@@ -25,6 +25,11 @@ extern const char* sErrorFrag;
 
 #define D_SHADERS_DIRNAME "Shaders"
 
+namespace {
+    PerfCounter g_uniformUploads("gl.uniformUploads");
+    PerfCounter g_programBinds("gl.programBinds");
+}
+
 namespace FTS {
 /// Abstract base-class that is used to independently either use native OpenGL
 /// #include feature if available (GL_ARB_shading_language_include) or use a
@@ -347,7 +352,7 @@ public:
     CompiledShader(const String& in_sShaderName, const String& in_sSourceCode, GLuint in_type, ShaderIncludeManager* in_pIncMgr, const ShaderCompileFlags& in_flags)
     {
         verifGL("CompiledShader::CompiledShader start " + in_sShaderName);
-        FTSMSGDBG("CompiledShader::CompiledShader: Preparing to compile " + in_sShaderName, 2);
+        FTSMSGDBG("CompiledShader::CompiledShader: Preparing to compile {1}", 2, in_sShaderName);
         m_id = glCreateShader(in_type);
         String sErr = in_pIncMgr->compileShader(m_id, in_sShaderName, in_sSourceCode, in_flags);
 
@@ -363,7 +368,7 @@ public:
         m_sLog = &pszLog[0];
 
         if(!m_sLog.empty()) {
-            FTSMSGDBG("Shader::CompiledShader: info-log of " + in_sShaderName + ":\n" + m_sLog, 2);
+            FTSMSGDBG("Shader::CompiledShader: info-log of {1}:\n{2}", 2, in_sShaderName, m_sLog);
         }
 
         // If there was an error, we throw it as an exception.
@@ -373,7 +378,7 @@ public:
             throw CorruptDataException(in_sShaderName, m_sLog);
         }
 
-        FTSMSGDBG("CompiledShader::CompiledShader: done with " + in_sShaderName + "; id = " + String::nr(m_id), 2);
+        FTSMSGDBG("CompiledShader::CompiledShader: done with {1}; id = {2}", 2, in_sShaderName, m_id);
         verifGL("CompiledShader::CompiledShader end " + in_sShaderName);
     };
 
@@ -381,7 +386,7 @@ public:
     {
         if(m_id != 0) {
             verifGL("CompiledShader::~CompiledShader start");
-            FTSMSGDBG("CompiledShader::CompiledShader: deleting " + String::nr(m_id), 2);
+            FTSMSGDBG("CompiledShader::CompiledShader: deleting {1}", 2, m_id);
             glDeleteShader(m_id);
             verifGL("CompiledShader::~CompiledShader end");
         }
@@ -398,7 +403,7 @@ private:
 FTS::Program::Program(const CompiledShader& in_vert, const CompiledShader& in_frag, const String& in_sShaderName)
 {
     verifGL("Program::Program: start of " + in_sShaderName);
-    FTSMSGDBG("Program::Program: Preparing to link " + in_sShaderName + " using: " + String::nr(in_vert.id()) + ", " + String::nr(in_frag.id()), 2);
+    FTSMSGDBG("Program::Program: Preparing to link {1} using: {2}, {3}", 2, in_sShaderName, in_vert.id(), in_frag.id());
 
     m_id = glCreateProgram();
     glAttachShader(this->id(), in_vert.id());
@@ -412,7 +417,7 @@ FTS::Program::Program(const CompiledShader& in_vert, const CompiledShader& in_fr
 FTS::Program::Program(const CompiledShader& in_vert, const CompiledShader& in_frag, const CompiledShader& in_geom, const String& in_sShaderName)
 {
     verifGL("Program::Program: start of " + in_sShaderName);
-    FTSMSGDBG("Program::Program: Preparing to link " + in_sShaderName + " using: " + String::nr(in_vert.id()) + ", " + String::nr(in_frag.id()) + ", " + String::nr(in_geom.id()), 2);
+    FTSMSGDBG("Program::Program: Preparing to link {1} using: {2}, {3}, {4}", 2, in_sShaderName, in_vert.id(), in_frag.id(), in_geom.id());
 
     m_id = glCreateProgram();
     glAttachShader(this->id(), in_vert.id());
@@ -436,7 +441,7 @@ void FTS::Program::init(const String& in_sShaderName)
     m_sLog = &pszLog[0];
 
     if(!m_sLog.empty()) {
-        FTSMSGDBG("Program::init: info-log of " + in_sShaderName + ":\n" + m_sLog, 2);
+        FTSMSGDBG("Program::init: info-log of {1}:\n{2}", 2, in_sShaderName, m_sLog);
     }
 
     // If there was an error, we throw it as an exception.
@@ -450,7 +455,7 @@ void FTS::Program::init(const String& in_sShaderName)
     glBindFragDataLocation(this->id(), 0, "Color");
 
     verifGL("Program::init: link of " + in_sShaderName);
-    FTSMSGDBG("Program::init: done with " + in_sShaderName + "; got id = " + String::nr(this->id()), 2);
+    FTSMSGDBG("Program::init: done with {1}; got id = {2}", 2, in_sShaderName, this->id());
 
     // If all that worked, we query all attributes and all uniforms that are
     // available in the program and store their informations.
@@ -470,7 +475,7 @@ void FTS::Program::init(const String& in_sShaderName)
         a.id = glGetAttribLocation(this->id(), a.name.c_str());
 
         m_attribs[a.name] = a;
-        FTSMSGDBG("Program::init: found attrib " + a.name + " id = " + String::nr(a.id), 3);
+        FTSMSGDBG("Program::init: found attrib {1} id = {2}", 3, a.name, a.id);
     }
 
     // Then the uniforms:
@@ -499,8 +504,8 @@ void FTS::Program::init(const String& in_sShaderName)
             }
         }
 
-        m_uniforms[u.name] = u;
-        FTSMSGDBG("Program::init: found uniform " + u.name + " id = " + String::nr(u.id), 3);
+        m_uniforms[Name(u.name)] = u;
+        FTSMSGDBG("Program::init: found uniform {1} id = {2}", 3, u.name, u.id);
     }
 
     verifGL("Program::init: end of " + in_sShaderName);
@@ -603,45 +608,46 @@ bool FTS::Program::setVertexAttribute(const String& in_sAttribName, const Vertex
     return true;
 }
 
-const FTS::Program::Uniform& FTS::Program::uniform(const String& in_sUniformName) const
+const FTS::Program::Uniform& FTS::Program::uniform(const Name& in_uniformName) const
 {
-    auto uniform = m_uniforms.find(in_sUniformName);
+    auto uniform = m_uniforms.find(in_uniformName);
     if(uniform == m_uniforms.end())
-        throw NotExistException("Uniform " + in_sUniformName, "Program no " + String::nr(m_id));
+        throw NotExistException("Uniform " + in_uniformName.str(), "Program no " + String::nr(m_id));
 
     return uniform->second;
 }
 
-bool FTS::Program::hasUniform(const String& in_sUniformName) const
+bool FTS::Program::hasUniform(const Name& in_uniformName) const
 {
-    auto i = m_uniforms.find(in_sUniformName);
+    auto i = m_uniforms.find(in_uniformName);
     return i != m_uniforms.end();
 }
 
-bool FTS::Program::setUniform(const String& in_sUniformName, float in_v)
+bool FTS::Program::setUniform(const Name& in_uniformName, float in_v)
 {
-    auto i = m_uniforms.find(in_sUniformName);
+    auto i = m_uniforms.find(in_uniformName);
     if(i == m_uniforms.end())
         return false;
 
-    verifGL("Program::setUniform("+in_sUniformName+") start");
+    verifGL("Program::setUniform("+in_uniformName.str()+") start");
     if(i->second.type == GL_FLOAT) {
         glUniform1f(i->second.id, in_v);
-        verifGL("Program::setUniform("+in_sUniformName+") end");
+        g_uniformUploads.add();
+        verifGL("Program::setUniform("+in_uniformName.str()+") end");
         return true;
     } else {
-        verifGL("Program::setUniform("+in_sUniformName+") badend");
+        verifGL("Program::setUniform("+in_uniformName.str()+") badend");
         return false;
     }
 }
 
-bool FTS::Program::setUniform(const String& in_sUniformName, const Vector& in_v)
+bool FTS::Program::setUniform(const Name& in_uniformName, const Vector& in_v)
 {
-    auto i = m_uniforms.find(in_sUniformName);
+    auto i = m_uniforms.find(in_uniformName);
     if(i == m_uniforms.end())
         return false;
 
-    verifGL("Program::setUniform("+in_sUniformName+") start");
+    verifGL("Program::setUniform("+in_uniformName.str()+") start");
     switch(i->second.type) {
     case GL_FLOAT:
         glUniform1f(i->second.id, in_v.x());
@@ -656,21 +662,22 @@ bool FTS::Program::setUniform(const String& in_sUniformName, const Vector& in_v)
         glUniform4fv(i->second.id, 1, in_v.array4f());
         break;
     default:
-        verifGL("Program::setUniform("+in_sUniformName+") badend");
+        verifGL("Program::setUniform("+in_uniformName.str()+") badend");
         return false;
     };
 
-    verifGL("Program::setUniform("+in_sUniformName+") end");
+    g_uniformUploads.add();
+    verifGL("Program::setUniform("+in_uniformName.str()+") end");
     return true;
 }
 
-bool FTS::Program::setUniform(const String& in_sUniformName, const Color& in_c)
+bool FTS::Program::setUniform(const Name& in_uniformName, const Color& in_c)
 {
-    auto i = m_uniforms.find(in_sUniformName);
+    auto i = m_uniforms.find(in_uniformName);
     if(i == m_uniforms.end())
         return false;
 
-    verifGL("Program::setUniform("+in_sUniformName+") start");
+    verifGL("Program::setUniform("+in_uniformName.str()+") start");
     switch(i->second.type) {
     case GL_FLOAT_VEC2:
         glUniform2fv(i->second.id, 1, in_c.array3f());
@@ -682,21 +689,22 @@ bool FTS::Program::setUniform(const String& in_sUniformName, const Color& in_c)
         glUniform4fv(i->second.id, 1, in_c.array4f());
         break;
     default:
-        verifGL("Program::setUniform("+in_sUniformName+") badend");
+        verifGL("Program::setUniform("+in_uniformName.str()+") badend");
         return false;
     };
 
-    verifGL("Program::setUniform("+in_sUniformName+") end");
+    g_uniformUploads.add();
+    verifGL("Program::setUniform("+in_uniformName.str()+") end");
     return true;
 }
 
-bool FTS::Program::setUniform(const String& in_sUniformName, const Quaternion& in_q)
+bool FTS::Program::setUniform(const Name& in_uniformName, const Quaternion& in_q)
 {
-    auto i = m_uniforms.find(in_sUniformName);
+    auto i = m_uniforms.find(in_uniformName);
     if(i == m_uniforms.end())
         return false;
 
-    verifGL("Program::setUniform("+in_sUniformName+") start");
+    verifGL("Program::setUniform("+in_uniformName.str()+") start");
     switch(i->second.type) {
     case GL_FLOAT_VEC2:
         glUniform2fv(i->second.id, 1, in_q.array4f());
@@ -708,118 +716,124 @@ bool FTS::Program::setUniform(const String& in_sUniformName, const Quaternion& i
         glUniform4fv(i->second.id, 1, in_q.array4f());
         break;
     default:
-        verifGL("Program::setUniform("+in_sUniformName+") badend");
+        verifGL("Program::setUniform("+in_uniformName.str()+") badend");
         return false;
     };
 
-    verifGL("Program::setUniform("+in_sUniformName+") end");
+    g_uniformUploads.add();
+    verifGL("Program::setUniform("+in_uniformName.str()+") end");
     return true;
 }
 
-bool FTS::Program::setUniform(const String& in_sUniformName, const General4x4Matrix& in_mat, bool in_transpose)
+bool FTS::Program::setUniform(const Name& in_uniformName, const General4x4Matrix& in_mat, bool in_transpose)
 {
-    auto i = m_uniforms.find(in_sUniformName);
+    auto i = m_uniforms.find(in_uniformName);
     if(i == m_uniforms.end())
         return false;
 
-    verifGL("Program::setUniform("+in_sUniformName+") start");
+    verifGL("Program::setUniform("+in_uniformName.str()+") start");
     if(i->second.type != GL_FLOAT_MAT4) {
-        verifGL("Program::setUniform("+in_sUniformName+") badend");
+        verifGL("Program::setUniform("+in_uniformName.str()+") badend");
         return false;
     }
 
     glUniformMatrix4fv(i->second.id, 1, in_transpose ? GL_TRUE : GL_FALSE, in_mat.array16f());
-    verifGL("Program::setUniform("+in_sUniformName+") end");
+    g_uniformUploads.add();
+    verifGL("Program::setUniform("+in_uniformName.str()+") end");
     return true;
 }
 
-bool FTS::Program::setUniform(const String& in_sUniformName, const AffineMatrix& in_mat, bool in_transpose)
+bool FTS::Program::setUniform(const Name& in_uniformName, const AffineMatrix& in_mat, bool in_transpose)
 {
-    auto i = m_uniforms.find(in_sUniformName);
+    auto i = m_uniforms.find(in_uniformName);
     if(i == m_uniforms.end())
         return false;
 
-    verifGL("Program::setUniform("+in_sUniformName+") start");
+    verifGL("Program::setUniform("+in_uniformName.str()+") start");
     if(i->second.type == GL_FLOAT_MAT3) {
         glUniformMatrix3fv(i->second.id, 1, in_transpose ? GL_TRUE : GL_FALSE, in_mat.array9f());
     } else if(i->second.type == GL_FLOAT_MAT4) {
         glUniformMatrix4fv(i->second.id, 1, in_transpose ? GL_TRUE : GL_FALSE, in_mat.array16f());
     } else {
-        verifGL("Program::setUniform("+in_sUniformName+") badend");
+        verifGL("Program::setUniform("+in_uniformName.str()+") badend");
         return false;
     }
 
-    verifGL("Program::setUniform("+in_sUniformName+") end");
+    g_uniformUploads.add();
+    verifGL("Program::setUniform("+in_uniformName.str()+") end");
     return true;
 }
 
-bool FTS::Program::setUniformInverse(const String& in_sUniformName, const AffineMatrix& in_mat, bool in_transpose)
+bool FTS::Program::setUniformInverse(const Name& in_uniformName, const AffineMatrix& in_mat, bool in_transpose)
 {
-    auto i = m_uniforms.find(in_sUniformName);
+    auto i = m_uniforms.find(in_uniformName);
     if(i == m_uniforms.end())
         return false;
 
-    verifGL("Program::setUniformInv("+in_sUniformName+") start");
+    verifGL("Program::setUniformInv("+in_uniformName.str()+") start");
     if(i->second.type == GL_FLOAT_MAT3) {
         glUniformMatrix3fv(i->second.id, 1, in_transpose ? GL_TRUE : GL_FALSE, in_mat.array9fInverse());
     } else if(i->second.type == GL_FLOAT_MAT4) {
         glUniformMatrix4fv(i->second.id, 1, in_transpose ? GL_TRUE : GL_FALSE, in_mat.array16fInverse());
     } else {
-        verifGL("Program::setUniformInv("+in_sUniformName+") badend");
+        verifGL("Program::setUniformInv("+in_uniformName.str()+") badend");
         return false;
     }
 
-    verifGL("Program::setUniformInv("+in_sUniformName+") end");
+    g_uniformUploads.add();
+    verifGL("Program::setUniformInv("+in_uniformName.str()+") end");
     return true;
 }
 
-bool FTS::Program::setUniformInverse(const String& in_sUniformName, const General4x4Matrix& in_mat, bool in_transpose)
+bool FTS::Program::setUniformInverse(const Name& in_uniformName, const General4x4Matrix& in_mat, bool in_transpose)
 {
-    auto i = m_uniforms.find(in_sUniformName);
+    auto i = m_uniforms.find(in_uniformName);
     if(i == m_uniforms.end())
         return false;
 
-    verifGL("Program::setUniformInv("+in_sUniformName+") start");
+    verifGL("Program::setUniformInv("+in_uniformName.str()+") start");
     if(i->second.type != GL_FLOAT_MAT4) {
-        verifGL("Program::setUniformInv("+in_sUniformName+") badend");
+        verifGL("Program::setUniformInv("+in_uniformName.str()+") badend");
         return false;
     }
 
     glUniformMatrix4fv(i->second.id, 1, in_transpose ? GL_TRUE : GL_FALSE, in_mat.array16fInverse());
-    verifGL("Program::setUniformInv("+in_sUniformName+") end");
+    g_uniformUploads.add();
+    verifGL("Program::setUniformInv("+in_uniformName.str()+") end");
     return true;
 }
 
-bool FTS::Program::setUniformSampler(const String& in_sUniformName, uint8_t in_iTexUnit)
+bool FTS::Program::setUniformSampler(const Name& in_uniformName, uint8_t in_iTexUnit)
 {
-    String sUniformName = in_sUniformName + String::chr(convertTextNr(in_iTexUnit));
-    auto i = m_uniforms.find(sUniformName);
+    Name uniformName(in_uniformName.str() + String::chr(convertTextNr(in_iTexUnit)));
+    auto i = m_uniforms.find(uniformName);
     if(i == m_uniforms.end())
         return false;
 
-    verifGL("Program::setUniformSampler("+in_sUniformName+") start");
+    verifGL("Program::setUniformSampler("+in_uniformName.str()+") start");
     if(i->second.type != GL_SAMPLER_2D){
-        verifGL("Program::setUniformSampler("+in_sUniformName+", "+String::nr(in_iTexUnit)+") badend");
+        verifGL("Program::setUniformSampler("+in_uniformName.str()+", "+String::nr(in_iTexUnit)+") badend");
         return false;
     }
 
     glUniform1i(i->second.id, (GLint)in_iTexUnit);
-    verifGL("Program::setUniformSampler("+in_sUniformName+", "+String::nr(in_iTexUnit)+") end");
+    g_uniformUploads.add();
+    verifGL("Program::setUniformSampler("+in_uniformName.str()+", "+String::nr(in_iTexUnit)+") end");
     return true;
 }
 
-bool FTS::Program::setUniformArrayElement(const String& in_sUniformName, size_t in_iArrayIdx, const Vector& in_v)
+bool FTS::Program::setUniformArrayElement(const Name& in_uniformName, size_t in_iArrayIdx, const Vector& in_v)
 {
-    auto i = m_uniforms.find(in_sUniformName);
+    auto i = m_uniforms.find(in_uniformName);
     if(i == m_uniforms.end())
         return false;
 
     if((GLint)in_iArrayIdx >= i->second.size) {
-        FTSMSG("Program::setUniformArrayElement("+in_sUniformName+", "+String::nr(in_iArrayIdx)+"): index out of bounds (max is "+String::nr(i->second.size)+")\n", MsgType::WarningNoMB);
+        FTSMSG("Program::setUniformArrayElement("+in_uniformName.str()+", "+String::nr(in_iArrayIdx)+"): index out of bounds (max is "+String::nr(i->second.size)+")\n", MsgType::WarningNoMB);
         return false;
     }
 
-    verifGL("Program::setUniformArrayElement("+in_sUniformName+", "+String::nr(in_iArrayIdx)+") start");
+    verifGL("Program::setUniformArrayElement("+in_uniformName.str()+", "+String::nr(in_iArrayIdx)+") start");
     switch(i->second.type) {
     case GL_FLOAT_VEC2:
         glUniform2fv(i->second.arrayIds[in_iArrayIdx], 1, in_v.array3f());
@@ -831,61 +845,64 @@ bool FTS::Program::setUniformArrayElement(const String& in_sUniformName, size_t
         glUniform4fv(i->second.arrayIds[in_iArrayIdx], 1, in_v.array4f());
         break;
     default:
-        verifGL("Program::setUniformArrayElement("+in_sUniformName+", "+String::nr(in_iArrayIdx)+") badend");
+        verifGL("Program::setUniformArrayElement("+in_uniformName.str()+", "+String::nr(in_iArrayIdx)+") badend");
         return false;
     };
 
-    verifGL("Program::setUniformArrayElement("+in_sUniformName+", "+String::nr(in_iArrayIdx)+") end");
+    g_uniformUploads.add();
+    verifGL("Program::setUniformArrayElement("+in_uniformName.str()+", "+String::nr(in_iArrayIdx)+") end");
     return true;
 }
 
-bool FTS::Program::setUniformArrayElement(const String& in_sUniformName, size_t in_iArrayIdx, const AffineMatrix& in_mat, bool in_transpose)
+bool FTS::Program::setUniformArrayElement(const Name& in_uniformName, size_t in_iArrayIdx, const AffineMatrix& in_mat, bool in_transpose)
 {
-    auto i = m_uniforms.find(in_sUniformName);
+    auto i = m_uniforms.find(in_uniformName);
     if(i == m_uniforms.end())
         return false;
 
     if( (GLint)in_iArrayIdx >= i->second.size) {
-        FTSMSG("Program::setUniformArrayElement("+in_sUniformName+", "+String::nr(in_iArrayIdx)+"): index out of bounds (max is "+String::nr(i->second.size)+")\n", MsgType::WarningNoMB);
+        FTSMSG("Program::setUniformArrayElement("+in_uniformName.str()+", "+String::nr(in_iArrayIdx)+"): index out of bounds (max is "+String::nr(i->second.size)+")\n", MsgType::WarningNoMB);
         return false;
     }
 
-    verifGL("Program::setUniformArrayElement("+in_sUniformName+", "+String::nr(in_iArrayIdx)+") start");
+    verifGL("Program::setUniformArrayElement("+in_uniformName.str()+", "+String::nr(in_iArrayIdx)+") start");
     if(i->second.type == GL_FLOAT_MAT3) {
         glUniformMatrix3fv(i->second.arrayIds[in_iArrayIdx], 1, in_transpose ? GL_TRUE : GL_FALSE, in_mat.array9f());
     } else if(i->second.type == GL_FLOAT_MAT4) {
         glUniformMatrix4fv(i->second.arrayIds[in_iArrayIdx], 1, in_transpose ? GL_TRUE : GL_FALSE, in_mat.array16f());
     } else {
-        verifGL("Program::setUniformArrayElement("+in_sUniformName+", "+String::nr(in_iArrayIdx)+") badend");
+        verifGL("Program::setUniformArrayElement("+in_uniformName.str()+", "+String::nr(in_iArrayIdx)+") badend");
         return false;
     }
 
-    verifGL("Program::setUniformArrayElement("+in_sUniformName+", "+String::nr(in_iArrayIdx)+") end");
+    g_uniformUploads.add();
+    verifGL("Program::setUniformArrayElement("+in_uniformName.str()+", "+String::nr(in_iArrayIdx)+") end");
     return true;
 }
 
-bool FTS::Program::setUniformArrayElementInverse(const String& in_sUniformName, size_t in_iArrayIdx, const AffineMatrix& in_mat, bool in_transpose)
+bool FTS::Program::setUniformArrayElementInverse(const Name& in_uniformName, size_t in_iArrayIdx, const AffineMatrix& in_mat, bool in_transpose)
 {
-    auto i = m_uniforms.find(in_sUniformName);
+    auto i = m_uniforms.find(in_uniformName);
     if(i == m_uniforms.end())
         return false;
 
     if((GLint)in_iArrayIdx >= i->second.size) {
-        FTSMSG("Program::setUniformArrayElement("+in_sUniformName+", "+String::nr(in_iArrayIdx)+"): index out of bounds (max is "+String::nr(i->second.size)+")\n", MsgType::WarningNoMB);
+        FTSMSG("Program::setUniformArrayElement("+in_uniformName.str()+", "+String::nr(in_iArrayIdx)+"): index out of bounds (max is "+String::nr(i->second.size)+")\n", MsgType::WarningNoMB);
         return false;
     }
 
-    verifGL("Program::setUniformArrayElement("+in_sUniformName+", "+String::nr(in_iArrayIdx)+") start");
+    verifGL("Program::setUniformArrayElement("+in_uniformName.str()+", "+String::nr(in_iArrayIdx)+") start");
     if(i->second.type == GL_FLOAT_MAT3) {
         glUniformMatrix3fv(i->second.arrayIds[in_iArrayIdx], 1, in_transpose ? GL_TRUE : GL_FALSE, in_mat.array9fInverse());
     } else if(i->second.type == GL_FLOAT_MAT4) {
         glUniformMatrix4fv(i->second.arrayIds[in_iArrayIdx], 1, in_transpose ? GL_TRUE : GL_FALSE, in_mat.array16fInverse());
     } else {
-        verifGL("Program::setUniformArrayElement("+in_sUniformName+", "+String::nr(in_iArrayIdx)+") badend");
+        verifGL("Program::setUniformArrayElement("+in_uniformName.str()+", "+String::nr(in_iArrayIdx)+") badend");
         return false;
     }
 
-    verifGL("Program::setUniformArrayElement("+in_sUniformName+", "+String::nr(in_iArrayIdx)+") end");
+    g_uniformUploads.add();
+    verifGL("Program::setUniformArrayElement("+in_uniformName.str()+", "+String::nr(in_iArrayIdx)+") end");
     return true;
 }
 
@@ -900,6 +917,7 @@ void FTS::Program::bind()
     verifGL("Program::bind("+String::nr(this->id())+") start");
     glUseProgram(this->id());
     m_uiCurrentlyBoundShaderId = this->id();
+    g_programBinds.add();
     verifGL("Program::bind("+String::nr(this->id())+") end");
 }
 
@@ -3,12 +3,14 @@
 
 #include "utilities/Singleton.h"
 #include "dLib/dString/dString.h"
+#include "dLib/dString/dName.h"
 
 #include "3d/opengl_wrapper.h"
 #include "3d/Math.h"
 #include "3d/VertexArrayObject.h"
 
 #include <map>
+#include <unordered_map>
 #include <list>
 
 namespace FTS {
@@ -55,20 +57,37 @@ public:
     bool setVertexAttribute(const String& in_sAttribName, const VertexBufferObject& in_buffer);
     bool setVertexAttribute(const String& in_sAttribName, const VertexBufferObject& in_buffer, GLint in_nComponents, std::size_t in_offset);
 
-    const Uniform& uniform(const String& in_sUniformName) const;
-    bool hasUniform(const String& in_sUniformName) const;
-    bool setUniform(const String& in_sUniformName, float in_v);
-    bool setUniform(const String& in_sUniformName, const Vector& in_v);
-    bool setUniform(const String& in_sUniformName, const Color& in_c);
-    bool setUniform(const String& in_sUniformName, const Quaternion& in_q);
-    bool setUniform(const String& in_sUniformName, const General4x4Matrix& in_mat, bool in_transpose = false);
-    bool setUniform(const String& in_sUniformName, const AffineMatrix& in_mat, bool in_transpose = false);
-    bool setUniformInverse(const String& in_sUniformName, const General4x4Matrix& in_mat, bool in_transpose = false);
-    bool setUniformInverse(const String& in_sUniformName, const AffineMatrix& in_mat, bool in_transpose = false);
-    bool setUniformSampler(const String& in_sUniformName, uint8_t in_iTexUnit);
-    bool setUniformArrayElement(const String& in_sUniformName, size_t in_iArrayIdx, const Vector& in_v);
-    bool setUniformArrayElement(const String& in_sUniformName, size_t in_iArrayIdx, const AffineMatrix& in_mat, bool in_transpose = false);
-    bool setUniformArrayElementInverse(const String& in_sUniformName, size_t in_iArrayIdx, const AffineMatrix& in_mat, bool in_transpose = false);
+    const Uniform& uniform(const Name& in_uniformName) const;
+    bool hasUniform(const Name& in_uniformName) const;
+    bool setUniform(const Name& in_uniformName, float in_v);
+    bool setUniform(const Name& in_uniformName, const Vector& in_v);
+    bool setUniform(const Name& in_uniformName, const Color& in_c);
+    bool setUniform(const Name& in_uniformName, const Quaternion& in_q);
+    bool setUniform(const Name& in_uniformName, const General4x4Matrix& in_mat, bool in_transpose = false);
+    bool setUniform(const Name& in_uniformName, const AffineMatrix& in_mat, bool in_transpose = false);
+    bool setUniformInverse(const Name& in_uniformName, const General4x4Matrix& in_mat, bool in_transpose = false);
+    bool setUniformInverse(const Name& in_uniformName, const AffineMatrix& in_mat, bool in_transpose = false);
+    bool setUniformSampler(const Name& in_uniformName, uint8_t in_iTexUnit);
+    bool setUniformArrayElement(const Name& in_uniformName, size_t in_iArrayIdx, const Vector& in_v);
+    bool setUniformArrayElement(const Name& in_uniformName, size_t in_iArrayIdx, const AffineMatrix& in_mat, bool in_transpose = false);
+    bool setUniformArrayElementInverse(const Name& in_uniformName, size_t in_iArrayIdx, const AffineMatrix& in_mat, bool in_transpose = false);
+
+    // The same, by string. Every call interns the string, so code that sets
+    // uniforms every frame should rather keep the names around.
+    inline const Uniform& uniform(const String& in_sUniformName) const {return this->uniform(Name(in_sUniformName));};
+    inline bool hasUniform(const String& in_sUniformName) const {return this->hasUniform(Name(in_sUniformName));};
+    inline bool setUniform(const String& in_sUniformName, float in_v) {return this->setUniform(Name(in_sUniformName), in_v);};
+    inline bool setUniform(const String& in_sUniformName, const Vector& in_v) {return this->setUniform(Name(in_sUniformName), in_v);};
+    inline bool setUniform(const String& in_sUniformName, const Color& in_c) {return this->setUniform(Name(in_sUniformName), in_c);};
+    inline bool setUniform(const String& in_sUniformName, const Quaternion& in_q) {return this->setUniform(Name(in_sUniformName), in_q);};
+    inline bool setUniform(const String& in_sUniformName, const General4x4Matrix& in_mat, bool in_transpose = false) {return this->setUniform(Name(in_sUniformName), in_mat, in_transpose);};
+    inline bool setUniform(const String& in_sUniformName, const AffineMatrix& in_mat, bool in_transpose = false) {return this->setUniform(Name(in_sUniformName), in_mat, in_transpose);};
+    inline bool setUniformInverse(const String& in_sUniformName, const General4x4Matrix& in_mat, bool in_transpose = false) {return this->setUniformInverse(Name(in_sUniformName), in_mat, in_transpose);};
+    inline bool setUniformInverse(const String& in_sUniformName, const AffineMatrix& in_mat, bool in_transpose = false) {return this->setUniformInverse(Name(in_sUniformName), in_mat, in_transpose);};
+    inline bool setUniformSampler(const String& in_sUniformName, uint8_t in_iTexUnit) {return this->setUniformSampler(Name(in_sUniformName), in_iTexUnit);};
+    inline bool setUniformArrayElement(const String& in_sUniformName, size_t in_iArrayIdx, const Vector& in_v) {return this->setUniformArrayElement(Name(in_sUniformName), in_iArrayIdx, in_v);};
+    inline bool setUniformArrayElement(const String& in_sUniformName, size_t in_iArrayIdx, const AffineMatrix& in_mat, bool in_transpose = false) {return this->setUniformArrayElement(Name(in_sUniformName), in_iArrayIdx, in_mat, in_transpose);};
+    inline bool setUniformArrayElementInverse(const String& in_sUniformName, size_t in_iArrayIdx, const AffineMatrix& in_mat, bool in_transpose = false) {return this->setUniformArrayElementInverse(Name(in_sUniformName), in_iArrayIdx, in_mat, in_transpose);};
 
     void bind();
     static void unbind();
@@ -82,7 +101,7 @@ private:
     String m_sLog; ///< Might contain infos/warnings/errors about the shader.
 
     std::map<String, Attribute> m_attribs;
-    std::map<String, Uniform> m_uniforms;
+    std::unordered_map<Name, Uniform> m_uniforms;
 
     // For optimization: do not re-bind the same shader:
     static GLuint m_uiCurrentlyBoundShaderId;
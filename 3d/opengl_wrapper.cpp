@@ -1,10 +1,41 @@
 #include "3d/3d.h"
 
+#include "3d/Renderer.h"
 #include "dLib/dString/dString.h"
 #include "main/Exception.h"
 
+#include <atomic>
+
+// Without a display, there is no OpenGL context and no driver to ask for these
+// functions. They do nothing then, and where they have to answer, they answer
+// like a driver that can do everything would. The core functions, which are
+// linked to directly, already do nothing while there is no current context.
+namespace {
+    GLuint headlessName()
+    {
+        static std::atomic<GLuint> next(1);
+        return next++;
+    }
+
+    void headlessNames(GLsizei n, GLuint* out_names)
+    {
+        for(GLsizei i = 0 ; i < n ; ++i) {
+            out_names[i] = headlessName();
+        }
+    }
+
+    void headlessString(GLsizei bufSize, GLsizei* out_length, GLchar* out_str)
+    {
+        if(out_length)
+            *out_length = 0;
+        if(out_str && bufSize > 0)
+            out_str[0] = 0;
+    }
+}
+
 GLAPI void APIENTRY glActiveTexture (GLenum texture)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLACTIVETEXTUREPROC proc = (PFNGLACTIVETEXTUREPROC)FTS::glGetProcAddress("glActiveTexture");
     if(!proc) { throw FTS::NotExistException("OpenGL Multitexturing extension", "Your way too old OpenGL drivers!"); }
 
@@ -13,6 +44,7 @@ GLAPI void APIENTRY glActiveTexture (GLenum texture)
 
 GLAPI void APIENTRY glMultiTexCoord2f (GLenum target, GLfloat s, GLfloat t)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLMULTITEXCOORD2FPROC proc = (PFNGLMULTITEXCOORD2FPROC)FTS::glGetProcAddress("glMultiTexCoord2f");
     if(!proc) { throw FTS::NotExistException("OpenGL Multitexturing extension", "Your way too old OpenGL drivers!"); }
 
@@ -21,6 +53,7 @@ GLAPI void APIENTRY glMultiTexCoord2f (GLenum target, GLfloat s, GLfloat t)
 
 GLAPI void APIENTRY glCompileShader (GLuint shader)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLCOMPILESHADERPROC proc = (PFNGLCOMPILESHADERPROC)FTS::glGetProcAddress("glCompileShader");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -29,6 +62,7 @@ GLAPI void APIENTRY glCompileShader (GLuint shader)
 
 GLAPI void APIENTRY glShaderSource (GLuint shader, GLsizei count, const GLchar* *string, const GLint *length)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLSHADERSOURCEPROC proc = (PFNGLSHADERSOURCEPROC)FTS::glGetProcAddress("glShaderSource");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -37,6 +71,7 @@ GLAPI void APIENTRY glShaderSource (GLuint shader, GLsizei count, const GLchar*
 
 GLAPI void APIENTRY glGetShaderInfoLog (GLuint shader, GLsizei bufSize, GLsizei *length, GLchar *infoLog)
 {
+    if(FTS::Renderer::isHeadless()) { headlessString(bufSize, length, infoLog); return; }
     static PFNGLGETSHADERINFOLOGPROC proc = (PFNGLGETSHADERINFOLOGPROC)FTS::glGetProcAddress("glGetShaderInfoLog");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -45,6 +80,7 @@ GLAPI void APIENTRY glGetShaderInfoLog (GLuint shader, GLsizei bufSize, GLsizei
 
 GLAPI void APIENTRY glGetShaderiv (GLuint shader, GLenum pname, GLint *params)
 {
+    if(FTS::Renderer::isHeadless()) { *params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0; return; }
     static PFNGLGETSHADERIVPROC proc = (PFNGLGETSHADERIVPROC)FTS::glGetProcAddress("glGetShaderiv");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -53,6 +89,7 @@ GLAPI void APIENTRY glGetShaderiv (GLuint shader, GLenum pname, GLint *params)
 
 GLAPI GLuint APIENTRY glCreateShader (GLenum type)
 {
+    if(FTS::Renderer::isHeadless()) { return headlessName(); }
     static PFNGLCREATESHADERPROC proc = (PFNGLCREATESHADERPROC)FTS::glGetProcAddress("glCreateShader");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -61,6 +98,7 @@ GLAPI GLuint APIENTRY glCreateShader (GLenum type)
 
 GLAPI void APIENTRY glDeleteShader (GLuint shader)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLDELETESHADERPROC proc = (PFNGLDELETESHADERPROC)FTS::glGetProcAddress("glDeleteShader");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -69,6 +107,7 @@ GLAPI void APIENTRY glDeleteShader (GLuint shader)
 
 GLAPI void APIENTRY glGetShaderSource(GLuint shader, GLsizei bufSize, GLsizei *length, GLchar *source)
 {
+    if(FTS::Renderer::isHeadless()) { headlessString(bufSize, length, source); return; }
     static PFNGLGETSHADERSOURCEPROC proc = (PFNGLGETSHADERSOURCEPROC)FTS::glGetProcAddress("glGetShaderSource");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -77,6 +116,7 @@ GLAPI void APIENTRY glGetShaderSource(GLuint shader, GLsizei bufSize, GLsizei *l
 
 GLAPI GLuint APIENTRY glCreateProgram()
 {
+    if(FTS::Renderer::isHeadless()) { return headlessName(); }
     static PFNGLCREATEPROGRAMPROC proc = (PFNGLCREATEPROGRAMPROC)FTS::glGetProcAddress("glCreateProgram");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -85,6 +125,7 @@ GLAPI GLuint APIENTRY glCreateProgram()
 
 GLAPI void APIENTRY glDeleteProgram (GLuint program)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLDELETEPROGRAMPROC proc = (PFNGLDELETEPROGRAMPROC)FTS::glGetProcAddress("glDeleteProgram");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -93,6 +134,7 @@ GLAPI void APIENTRY glDeleteProgram (GLuint program)
 
 GLAPI void APIENTRY glAttachShader(GLuint program, GLuint shader)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLATTACHSHADERPROC proc = (PFNGLATTACHSHADERPROC)FTS::glGetProcAddress("glAttachShader");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -101,6 +143,7 @@ GLAPI void APIENTRY glAttachShader(GLuint program, GLuint shader)
 
 GLAPI void APIENTRY glLinkProgram(GLuint program)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLLINKPROGRAMPROC proc = (PFNGLLINKPROGRAMPROC)FTS::glGetProcAddress("glLinkProgram");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -109,6 +152,7 @@ GLAPI void APIENTRY glLinkProgram(GLuint program)
 
 GLAPI void APIENTRY glUseProgram(GLuint program)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
 	static PFNGLUSEPROGRAMPROC proc = (PFNGLUSEPROGRAMPROC)FTS::glGetProcAddress("glUseProgram");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -117,6 +161,7 @@ GLAPI void APIENTRY glUseProgram(GLuint program)
 
 GLAPI void APIENTRY glGetProgramInfoLog (GLuint shader, GLsizei bufSize, GLsizei *length, GLchar *infoLog)
 {
+    if(FTS::Renderer::isHeadless()) { headlessString(bufSize, length, infoLog); return; }
     static PFNGLGETPROGRAMINFOLOGPROC proc = (PFNGLGETPROGRAMINFOLOGPROC)FTS::glGetProcAddress("glGetProgramInfoLog");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -125,6 +170,7 @@ GLAPI void APIENTRY glGetProgramInfoLog (GLuint shader, GLsizei bufSize, GLsizei
 
 GLAPI void APIENTRY glGetProgramiv (GLuint shader, GLenum pname, GLint *params)
 {
+    if(FTS::Renderer::isHeadless()) { *params = pname == GL_LINK_STATUS ? GL_TRUE : 0; return; }
     static PFNGLGETPROGRAMIVPROC proc = (PFNGLGETPROGRAMIVPROC)FTS::glGetProcAddress("glGetProgramiv");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -133,6 +179,7 @@ GLAPI void APIENTRY glGetProgramiv (GLuint shader, GLenum pname, GLint *params)
 
 GLAPI void APIENTRY glGetActiveAttrib(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
 {
+    if(FTS::Renderer::isHeadless()) { *size = 0; *type = GL_FLOAT; headlessString(bufSize, length, name); return; }
     static PFNGLGETACTIVEATTRIBPROC proc = (PFNGLGETACTIVEATTRIBPROC)FTS::glGetProcAddress("glGetActiveAttrib");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -141,6 +188,7 @@ GLAPI void APIENTRY glGetActiveAttrib(GLuint program, GLuint index, GLsizei bufS
 
 GLAPI void APIENTRY glGetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
 {
+    if(FTS::Renderer::isHeadless()) { *size = 0; *type = GL_FLOAT; headlessString(bufSize, length, name); return; }
     static PFNGLGETACTIVEUNIFORMPROC proc = (PFNGLGETACTIVEUNIFORMPROC)FTS::glGetProcAddress("glGetActiveUniform");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -149,6 +197,7 @@ GLAPI void APIENTRY glGetActiveUniform(GLuint program, GLuint index, GLsizei buf
 
 GLAPI GLint APIENTRY glGetAttribLocation (GLuint program, const GLchar *name)
 {
+    if(FTS::Renderer::isHeadless()) { return -1; }
     static PFNGLGETATTRIBLOCATIONPROC proc = (PFNGLGETATTRIBLOCATIONPROC)FTS::glGetProcAddress("glGetAttribLocation");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -157,6 +206,7 @@ GLAPI GLint APIENTRY glGetAttribLocation (GLuint program, const GLchar *name)
 
 GLAPI GLint APIENTRY glGetUniformLocation (GLuint program, const GLchar *name)
 {
+    if(FTS::Renderer::isHeadless()) { return -1; }
     static PFNGLGETUNIFORMLOCATIONPROC proc = (PFNGLGETUNIFORMLOCATIONPROC)FTS::glGetProcAddress("glGetUniformLocation");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -165,6 +215,7 @@ GLAPI GLint APIENTRY glGetUniformLocation (GLuint program, const GLchar *name)
 
 GLAPI const GLubyte * APIENTRY glGetStringi (GLenum name, GLuint index)
 {
+    if(FTS::Renderer::isHeadless()) { return reinterpret_cast<const GLubyte*>(""); }
     static PFNGLGETSTRINGIPROC proc = (PFNGLGETSTRINGIPROC)FTS::glGetProcAddress("glGetStringi");
     if(!proc) { throw FTS::NotExistException("OpenGL 3 functions", "Your way too old OpenGL drivers!"); }
 
@@ -173,6 +224,7 @@ GLAPI const GLubyte * APIENTRY glGetStringi (GLenum name, GLuint index)
 
 GLAPI void APIENTRY glBindFragDataLocation(GLuint program, GLuint color, const GLchar* name)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLBINDFRAGDATALOCATIONPROC proc = (PFNGLBINDFRAGDATALOCATIONPROC)FTS::glGetProcAddress("glBindFragDataLocation");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -181,6 +233,7 @@ GLAPI void APIENTRY glBindFragDataLocation(GLuint program, GLuint color, const G
 
 GLAPI void APIENTRY glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLVERTEXATTRIBPOINTERPROC proc = (PFNGLVERTEXATTRIBPOINTERPROC)FTS::glGetProcAddress("glVertexAttribPointer");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -189,6 +242,7 @@ GLAPI void APIENTRY glVertexAttribPointer(GLuint index, GLint size, GLenum type,
 
 GLAPI void APIENTRY glBindBuffer(GLenum target, GLuint buffer)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLBINDBUFFERPROC proc = (PFNGLBINDBUFFERPROC)FTS::glGetProcAddress("glBindBuffer");
     if(!proc) { throw FTS::NotExistException("OpenGL Vertex Array Objects", "Your way too old OpenGL drivers!"); }
 
@@ -197,6 +251,7 @@ GLAPI void APIENTRY glBindBuffer(GLenum target, GLuint buffer)
 
 GLAPI void APIENTRY glEnableVertexAttribArray(GLuint index)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLENABLEVERTEXATTRIBARRAYPROC proc = (PFNGLENABLEVERTEXATTRIBARRAYPROC)FTS::glGetProcAddress("glEnableVertexAttribArray");
     if(!proc) { throw FTS::NotExistException("OpenGL Vertex Array Objects", "Your way too old OpenGL drivers!"); }
 
@@ -205,6 +260,7 @@ GLAPI void APIENTRY glEnableVertexAttribArray(GLuint index)
 
 GLAPI void APIENTRY glDisableVertexAttribArray(GLuint index)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLDISABLEVERTEXATTRIBARRAYPROC proc = (PFNGLDISABLEVERTEXATTRIBARRAYPROC)FTS::glGetProcAddress("glDisableVertexAttribArray");
     if(!proc) { throw FTS::NotExistException("OpenGL Vertex Array Objects", "Your way too old OpenGL drivers!"); }
 
@@ -213,6 +269,7 @@ GLAPI void APIENTRY glDisableVertexAttribArray(GLuint index)
 
 GLAPI void APIENTRY glUniform1i(GLint location, GLint v0)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLUNIFORM1IPROC proc = (PFNGLUNIFORM1IPROC)FTS::glGetProcAddress("glUniform1i");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -221,6 +278,7 @@ GLAPI void APIENTRY glUniform1i(GLint location, GLint v0)
 
 GLAPI void APIENTRY glUniform4fv(GLint location, GLsizei count, const GLfloat* value)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLUNIFORM4FVPROC proc = (PFNGLUNIFORM4FVPROC)FTS::glGetProcAddress("glUniform4fv");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -229,6 +287,7 @@ GLAPI void APIENTRY glUniform4fv(GLint location, GLsizei count, const GLfloat* v
 
 GLAPI void APIENTRY glUniform3fv(GLint location, GLsizei count, const GLfloat* value)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLUNIFORM3FVPROC proc = (PFNGLUNIFORM3FVPROC)FTS::glGetProcAddress("glUniform3fv");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -237,6 +296,7 @@ GLAPI void APIENTRY glUniform3fv(GLint location, GLsizei count, const GLfloat* v
 
 GLAPI void APIENTRY glUniform2fv(GLint location, GLsizei count, const GLfloat* value)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLUNIFORM2FVPROC proc = (PFNGLUNIFORM2FVPROC)FTS::glGetProcAddress("glUniform2fv");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -245,6 +305,7 @@ GLAPI void APIENTRY glUniform2fv(GLint location, GLsizei count, const GLfloat* v
 
 GLAPI void APIENTRY glUniform1f(GLint location, GLfloat v0)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLUNIFORM1FPROC proc = (PFNGLUNIFORM1FPROC)FTS::glGetProcAddress("glUniform1f");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -253,6 +314,7 @@ GLAPI void APIENTRY glUniform1f(GLint location, GLfloat v0)
 
 GLAPI void APIENTRY glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLUNIFORMMATRIX4FVPROC proc = (PFNGLUNIFORMMATRIX4FVPROC)FTS::glGetProcAddress("glUniformMatrix4fv");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -261,6 +323,7 @@ GLAPI void APIENTRY glUniformMatrix4fv(GLint location, GLsizei count, GLboolean
 
 GLAPI void APIENTRY glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLUNIFORMMATRIX3FVPROC proc = (PFNGLUNIFORMMATRIX3FVPROC)FTS::glGetProcAddress("glUniformMatrix3fv");
     if(!proc) { throw FTS::NotExistException("Modern OpenGL Shaders", "Your way too old OpenGL drivers!"); }
 
@@ -275,6 +338,7 @@ GLAPI void APIENTRY glBindBuffer(GLenum target, GLuint buffer)
 */
 GLAPI void APIENTRY glDeleteBuffers(GLsizei n, const GLuint *buffers)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLDELETEBUFFERSPROC proc = (PFNGLDELETEBUFFERSPROC)FTS::glGetProcAddress("glDeleteBuffers");
     if(!proc) { throw FTS::NotExistException("OpenGL Vertex Array Objects", "Your way too old OpenGL drivers!"); }
 
@@ -283,6 +347,7 @@ GLAPI void APIENTRY glDeleteBuffers(GLsizei n, const GLuint *buffers)
 
 GLAPI void APIENTRY glGenBuffers(GLsizei n, GLuint *buffers)
 {
+    if(FTS::Renderer::isHeadless()) { headlessNames(n, buffers); return; }
     static PFNGLGENBUFFERSPROC proc = (PFNGLGENBUFFERSPROC)FTS::glGetProcAddress("glGenBuffers");
     if(!proc) { throw FTS::NotExistException("OpenGL Vertex Array Objects", "Your way too old OpenGL drivers!"); }
 
@@ -291,6 +356,7 @@ GLAPI void APIENTRY glGenBuffers(GLsizei n, GLuint *buffers)
 
 GLAPI void APIENTRY glBufferData (GLenum target, GLsizeiptr size, const GLvoid *data, GLenum usage)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLBUFFERDATAPROC proc = (PFNGLBUFFERDATAPROC)FTS::glGetProcAddress("glBufferData");
     if(!proc) { throw FTS::NotExistException("OpenGL Vertex Array Objects", "Your way too old OpenGL drivers!"); }
 
@@ -299,6 +365,7 @@ GLAPI void APIENTRY glBufferData (GLenum target, GLsizeiptr size, const GLvoid *
 
 GLAPI void APIENTRY glBindVertexArray(GLuint arr)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLBINDVERTEXARRAYPROC proc = (PFNGLBINDVERTEXARRAYPROC)FTS::glGetProcAddress("glBindVertexArray");
     if(!proc) { throw FTS::NotExistException("OpenGL Vertex Array Objects", "Your way too old OpenGL drivers!"); }
 
@@ -307,6 +374,7 @@ GLAPI void APIENTRY glBindVertexArray(GLuint arr)
 
 GLAPI void APIENTRY glDeleteVertexArrays(GLsizei n, const GLuint *arrays)
 {
+    if(FTS::Renderer::isHeadless()) { return; }
     static PFNGLDELETEVERTEXARRAYSPROC proc = (PFNGLDELETEVERTEXARRAYSPROC)FTS::glGetProcAddress("glDeleteVertexArrays");
     if(!proc) { throw FTS::NotExistException("OpenGL Vertex Array Objects", "Your way too old OpenGL drivers!"); }
 
@@ -315,6 +383,7 @@ GLAPI void APIENTRY glDeleteVertexArrays(GLsizei n, const GLuint *arrays)
 
 GLAPI void APIENTRY glGenVertexArrays(GLsizei n, GLuint *arrays)
 {
+    if(FTS::Renderer::isHeadless()) { headlessNames(n, arrays); return; }
     static PFNGLGENVERTEXARRAYSPROC proc = (PFNGLGENVERTEXARRAYSPROC)FTS::glGetProcAddress("glGenVertexArrays");
     if(!proc) { throw FTS::NotExistException("OpenGL Vertex Array Objects", "Your way too old OpenGL drivers!"); }
 
@@ -1,12 +1,11 @@
 #if !defined(LOGGER_H)
 #define LOGGER_H
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <ostream>
-#include <iostream>
-#include <vector>
-#include <utility>
-#include <mutex>
+#include <type_traits>
 
 #include "TextFormatting.h"
 
@@ -42,68 +41,133 @@ enum class MsgType
     Raw
 };
 
+/// Wrap a number into this to have FTSMSG and FTSMSGDBG write it in hexadecimal.
+struct Hex
+{
+    template<typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    explicit Hex( T in_value, int in_iWidth = 0, char in_cFill = '0' )
+        : value( static_cast<std::uint64_t>( static_cast<typename std::make_unsigned<T>::type>( in_value ) ) )
+        , width( in_iWidth )
+        , fill( in_cFill )
+    {}
+
+    std::uint64_t value;
+    int width;
+    char fill;
+};
+
+/// The messages are written by a thread of their own, into the stream given
+/// to \a LogFile or std::cout. Logging only formats the message into a buffer
+/// of the calling thread and hands it over without taking any lock.
 class Logger
 {
 public:
     Logger() = delete;
-    static void DbgLevel( int lvl ) { dbg_level = lvl; }
-    static int DbgLevel() { return dbg_level; }
-    static void LogFile(std::ostream * out) { outstream = out; }
-    static std::ostream& out() { return outstream == nullptr ? std::cout : *outstream; }
-    static void Lock();
-    static void Unlock();
+    static void DbgLevel( int lvl ) { dbg_level.store( lvl, std::memory_order_relaxed ); }
+    static int DbgLevel() { return dbg_level.load( std::memory_order_relaxed ); }
+    static void LogFile( std::ostream * out );
+    static void Flush();
+
+    /// \return The buffer of the calling thread to format a message into, empty.
+    static std::string& Buffer();
+    static void Write( const std::string& in_Msg, bool in_bFlush );
 private:
-    static int dbg_level;
-    static std::ostream* outstream;
+    static std::atomic<int> dbg_level;
 };
 
+namespace LoggerImpl {
+
+template<typename T>
+struct IsLoggable : std::integral_constant<bool,
+    std::is_arithmetic<T>::value ||
+    std::is_same<T, std::string>::value ||
+    std::is_same<T, const char*>::value ||
+    std::is_same<T, char*>::value ||
+    std::is_same<T, Hex>::value>
+{};
+
+template<bool...> struct BoolPack;
+template<bool... Bs>
+using AllTrue = std::is_same<BoolPack<Bs..., true>, BoolPack<true, Bs...>>;
+
+void append( std::string& out, const std::string& in_s );
+void append( std::string& out, const char* in_s );
+void append( std::string& out, char in_c );
+void append( std::string& out, bool in_b );
+void append( std::string& out, long long in_i );
+void append( std::string& out, unsigned long long in_i );
+void append( std::string& out, double in_d );
+void append( std::string& out, const Hex& in_hex );
+
+template<typename T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, int>::type = 0>
+inline void append( std::string& out, T in_i ) { append( out, static_cast<long long>( in_i ) ); }
+template<typename T, typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value, int>::type = 0>
+inline void append( std::string& out, T in_i ) { append( out, static_cast<unsigned long long>( in_i ) ); }
+inline void append( std::string& out, float in_f ) { append( out, static_cast<double>( in_f ) ); }
+
+using AppendFn = void (*)( std::string&, const void* );
+
+template<typename T>
+void appendArg( std::string& out, const void* in_pArg )
+{
+    append( out, *static_cast<const T*>( in_pArg ) );
+}
+
+void format( std::string& out, const char* in_pszMsg, std::size_t in_nArgs, const void* const* in_pArgs, const AppendFn* in_pAppend );
+
+/// Puts the message together in the buffer of this thread and hands it over.
 template<typename... Ts>
-void FTSMSGDBG( std::string in_Msg, int in_iDbgLv, Ts&&... params )
+void log( const char* in_pszMsg, bool in_bFlush, const Ts&... params )
 {
-    std::vector<std::string> args{ std::forward<Ts>(params)... };
-    int i = 1;
-    for( auto p : args ) {
-        std::string fmt = "{" + toString( i++ ) + "}";
-        auto pos = in_Msg.find( fmt );
-        if( pos != std::string::npos ) {
-            in_Msg.replace( pos, fmt.size(), p );
-        }
-    }
-    FTSMSGDBG( in_Msg, in_iDbgLv );
+    // The first ones only make sure the arrays aren't empty.
+    const void* args[] = { nullptr, &params... };
+    const AppendFn appends[] = { nullptr, &appendArg<Ts>... };
+
+    std::string& msg = Logger::Buffer();
+    format( msg, in_pszMsg, sizeof...( Ts ), args + 1, appends + 1 );
+    Logger::Write( msg, in_bFlush );
 }
 
-template<>
-inline void FTSMSGDBG( std::string in_Msg, int in_iDbgLv )
+} // namespace LoggerImpl
+
+/// Logs a debug message if \a in_iDbgLv is not above the debug level. The
+/// placeholders {1}, {2}, ... get replaced by the parameters, which may be
+/// strings, numbers or \a Hex. Nothing is formatted if the message isn't shown.
+template<typename... Ts>
+void FTSMSGDBG( const char* in_pszMsg, int in_iDbgLv, const Ts&... params )
 {
-    if( in_iDbgLv <= Logger::DbgLevel() ) {
-        Logger::Lock();
-        Logger::out() << in_Msg << std::endl;
-        Logger::Unlock();
-    }
+    static_assert( LoggerImpl::AllTrue<LoggerImpl::IsLoggable<typename std::decay<Ts>::type>::value...>::value,
+                   "FTSMSGDBG: only strings, numbers and FTS::Hex can be logged" );
+
+    // No need to put the message together if it isn't shown anyway.
+    if( in_iDbgLv > Logger::DbgLevel() )
+        return;
+
+    LoggerImpl::log( in_pszMsg, false, params... );
 }
 
 template<typename... Ts>
-void FTSMSG( std::string in_Msg, FTS::MsgType in_Gravity, Ts&&... params )
+void FTSMSGDBG( const std::string& in_Msg, int in_iDbgLv, const Ts&... params )
 {
-    std::vector<std::string> args { std::forward<Ts>(params)... };
-    int i = 1;
-    for( auto p : args ) {
-        std::string fmt = "{" + toString( i++ ) + "}";
-        auto pos = in_Msg.find( fmt );
-        if( pos != std::string::npos ) {
-            in_Msg.replace( pos, fmt.size(), p );
-        }
-    }
-    FTSMSG( in_Msg, in_Gravity );
+    FTSMSGDBG( in_Msg.c_str(), in_iDbgLv, params... );
 }
 
-template<>
-inline void FTSMSG( std::string in_Msg, FTS::MsgType in_Gravity )
+/// Logs a message, errors are written out before this returns. See FTSMSGDBG
+/// for the parameters.
+template<typename... Ts>
+void FTSMSG( const char* in_pszMsg, FTS::MsgType in_Gravity, const Ts&... params )
+{
+    static_assert( LoggerImpl::AllTrue<LoggerImpl::IsLoggable<typename std::decay<Ts>::type>::value...>::value,
+                   "FTSMSG: only strings, numbers and FTS::Hex can be logged" );
+
+    LoggerImpl::log( in_pszMsg, in_Gravity == MsgType::Error || in_Gravity == MsgType::Horror, params... );
+}
+
+template<typename... Ts>
+void FTSMSG( const std::string& in_Msg, FTS::MsgType in_Gravity, const Ts&... params )
 {
-    Logger::Lock();
-    Logger::out() << in_Msg << std::endl;
-    Logger::Unlock();
+    FTSMSG( in_Msg.c_str(), in_Gravity, params... );
 }
 
 } // namespace FTS;
-#endif
\ No newline at end of file
+#endif
@@ -36,6 +36,14 @@ enum class FTSC_ERR {
 // Holds for each request the recv and send counts.
 using PacketStats = std::unordered_map<master_request_t, std::pair<std::uint64_t, std::uint64_t>>;
 
+// What went through all connections since the start, headers included.
+struct TrafficStats {
+    std::uint64_t packetsSent;
+    std::uint64_t packetsReceived;
+    std::uint64_t bytesSent;
+    std::uint64_t bytesReceived;
+};
+
 namespace FTS {
 
 FTSC_ERR getHTTPFile(std::vector<std::uint8_t>& out_data, const std::string &in_sServer, const std::string &in_sPath, std::uint64_t in_ulMaxWaitMillisec );
@@ -72,6 +80,7 @@ public:
 
     virtual void setMaxWaitMillisec( std::uint64_t in_ulMaxWaitMillisec ) { m_maxWaitMillisec = in_ulMaxWaitMillisec; }
     PacketStats getPacketStats() { return m_statPackets; }
+    static TrafficStats getTotalTraffic();
 protected:
     std::list<Packet *>m_lpPacketQueue; ///< A queue of packets that have been received but not consumed. Most recent are at the back.
     std::uint64_t m_maxWaitMillisec;         ///< Time out in millisec for all socket calls.
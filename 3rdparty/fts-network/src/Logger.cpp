@@ -1,20 +1,505 @@
-
-#include <string>
-#include <ostream>
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
-#include <utility>
 
 #include "Logger.h"
 
 namespace FTS {
 namespace LoggerImpl {
-std::recursive_mutex mtx;
+
+/// The messages of one thread, as the text that is to be written. Only that
+/// thread writes into it and only the writer reads out of it, so neither of
+/// them needs a lock. Whoever reads out of a ring holds the stream mutex.
+struct Ring
+{
+    static const std::size_t Size = 16 * 1024;
+    char data[Size];
+
+    /// How many bytes have been written into the ring, only its thread changes it.
+    std::atomic<std::size_t> head{ 0 };
+    /// How many bytes have been read out of the ring, only the reader changes it.
+    std::atomic<std::size_t> tail{ 0 };
+    /// A message that doesn't fit into the ring, see Sink::push.
+    std::atomic<const std::string*> pHuge{ nullptr };
+    /// Set when the thread exits, the ring is forgotten once it is empty.
+    std::atomic<bool> bClosed{ false };
+};
+
+/// Writes the messages on a thread of its own, so that the threads that log
+/// never wait for the stream nor for each other.
+///
+/// Every thread that logs gets a ring of its own the first time, which it
+/// copies its messages into. After that, logging allocates nothing and a
+/// server whose connections all log doesn't make them contend. The messages
+/// of one thread are written in the order they have been logged. If its ring
+/// is full, the thread waits for the writer to make room.
+///
+/// The writer is stopped at exit, after having written everything. Messages
+/// logged after that are written right away by the thread that logs them.
+class Sink
+{
+public:
+    Sink();
+
+    void push( const std::string& in_Msg );
+    void flush();
+    void setStream( std::ostream* out );
+    void stop();
+    void close( Ring& out_ring );
+
+private:
+    /// Guards the rings, only the writer and new threads take it.
+    std::mutex m_ringsMutex;
+    std::vector<std::unique_ptr<Ring>> m_rings;
+
+    /// Set by the writer when it is about to sleep, so that the producers
+    /// only need to take the mutex to wake it up.
+    std::atomic<bool> m_bSleeping;
+    /// Set once the writer is gone, see stop().
+    std::atomic<bool> m_bStopped;
+    bool m_bStop = false;
+    /// Flushes that have been asked for and that are done.
+    std::size_t m_flushRequest = 0;
+    std::size_t m_flushed = 0;
+
+    /// Guards the writer's sleep, the flushes and stopping.
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    /// Notified after every round of the writer.
+    std::condition_variable m_written;
+
+    /// Guards the stream and reading out of the rings.
+    std::mutex m_streamMutex;
+    std::ostream* m_out = nullptr;
+
+    std::thread m_thread;
+
+    Ring* ring();
+    void write( Ring& out_ring, const std::string& in_Msg );
+    void writeNow( Ring* in_pRing, const std::string* in_pMsg );
+    template<typename Pred> bool waitForWriter( Pred in_done );
+    bool read( Ring& in_ring, std::ostream& out );
+    bool readAll();
+    bool pending();
+    void wake();
+    void work();
+};
+
+Sink& sink();
+
+namespace {
+    /// The ring of the calling thread, nullptr before the first message and
+    /// once the thread is exiting.
+    thread_local Ring* t_pRing = nullptr;
+    thread_local bool t_bExiting = false;
+
+    /// Closes the ring of a thread when it exits.
+    struct RingCloser
+    {
+        ~RingCloser()
+        {
+            t_bExiting = true;
+            if( t_pRing != nullptr )
+                sink().close( *t_pRing );
+            t_pRing = nullptr;
+        }
+    };
+}
+
+Sink::Sink()
+    : m_bSleeping( false )
+    , m_bStopped( false )
+{
+    m_thread = std::thread( &Sink::work, this );
+}
+
+/// \return The ring of the calling thread, made the first time, or nullptr
+///         if the thread is exiting already.
+Ring* Sink::ring()
+{
+    if( t_pRing == nullptr && !t_bExiting ) {
+        thread_local RingCloser closer;
+        std::unique_ptr<Ring> pRing( new Ring );
+        t_pRing = pRing.get();
+
+        std::lock_guard<std::mutex> lock( m_ringsMutex );
+        m_rings.push_back( std::move( pRing ) );
+    }
+    return t_pRing;
+}
+
+void Sink::push( const std::string& in_Msg )
+{
+    // Once the writer is gone or the thread is exiting, nobody else writes it.
+    Ring* pRing = m_bStopped.load( std::memory_order_acquire ) ? nullptr : this->ring();
+    if( pRing == nullptr ) {
+        this->writeNow( t_pRing, &in_Msg );
+        return;
+    }
+
+    // With the line break, the message may not fit into the ring even when
+    // it is empty. Then the writer takes it as it is, once all before it has
+    // been written, and we wait until it did.
+    if( in_Msg.size() >= Ring::Size ) {
+        Ring& r = *pRing;
+        bool bHandedOver = false;
+        if( this->waitForWriter( [&r]() { return r.tail.load( std::memory_order_acquire ) == r.head.load( std::memory_order_relaxed ); } ) ) {
+            r.pHuge.store( &in_Msg, std::memory_order_release );
+            bHandedOver = true;
+            if( this->waitForWriter( [&r]() { return r.pHuge.load( std::memory_order_acquire ) == nullptr; } ) )
+                return;
+        }
+        this->writeNow( pRing, bHandedOver ? nullptr : &in_Msg );
+        return;
+    }
+
+    this->write( *pRing, in_Msg );
+}
+
+/// Copies the message and its line break into the ring of the calling thread.
+void Sink::write( Ring& out_ring, const std::string& in_Msg )
+{
+    std::size_t len = in_Msg.size() + 1;
+    std::size_t head = out_ring.head.load( std::memory_order_relaxed );
+    if( head + len - out_ring.tail.load( std::memory_order_acquire ) > Ring::Size ) {
+        Ring& r = out_ring;
+        if( !this->waitForWriter( [&r, head, len]() { return head + len - r.tail.load( std::memory_order_acquire ) <= Ring::Size; } ) ) {
+            this->writeNow( &out_ring, &in_Msg );
+            return;
+        }
+    }
+
+    // The message may wrap around the end of the ring.
+    std::size_t pos = head % Ring::Size;
+    std::size_t first = std::min( in_Msg.size(), Ring::Size - pos );
+    std::memcpy( out_ring.data + pos, in_Msg.data(), first );
+    std::memcpy( out_ring.data, in_Msg.data() + first, in_Msg.size() - first );
+    out_ring.data[( head + in_Msg.size() ) % Ring::Size] = '\n';
+    out_ring.head.store( head + len, std::memory_order_release );
+
+    this->wake();
+}
+
+/// Writes what is in \a in_pRing and the message \a in_pMsg right away, for
+/// when there is no writer to do it anymore. Either may be nullptr.
+void Sink::writeNow( Ring* in_pRing, const std::string* in_pMsg )
+{
+    std::lock_guard<std::mutex> lock( m_streamMutex );
+    std::ostream& out = m_out == nullptr ? std::cout : *m_out;
+    if( in_pRing != nullptr )
+        this->read( *in_pRing, out );
+    if( in_pMsg != nullptr )
+        out << *in_pMsg << '\n';
+    out.flush();
+}
+
+/// Waits until the writer made \a in_done true.
+/// \return false if the writer stopped before.
+template<typename Pred>
+bool Sink::waitForWriter( Pred in_done )
+{
+    this->wake();
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_written.wait( lock, [this, &in_done]() { return in_done() || m_bStopped.load(); } );
+    return in_done();
+}
+
+/// Waits until every message that has been logged before is written out.
+void Sink::flush()
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    if( m_bStopped.load() )
+        return;
+
+    std::size_t target = ++m_flushRequest;
+    m_wakeUp.notify_one();
+    m_written.wait( lock, [this, target]() { return m_flushed >= target || m_bStopped.load(); } );
+}
+
+/// Writes everything that is waiting into the old stream, the next messages
+/// into \a out.
+void Sink::setStream( std::ostream* out )
+{
+    this->flush();
+
+    std::lock_guard<std::mutex> lock( m_streamMutex );
+    m_out = out;
+}
+
+/// Writes everything that is waiting and lets the writer thread end. Called
+/// at exit.
+void Sink::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_bStop = true;
+        m_wakeUp.notify_one();
+    }
+    if( m_thread.joinable() )
+        m_thread.join();
+
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_bStopped.store( true );
+        m_written.notify_all();
+    }
+
+    // Whatever came in while the writer was finishing.
+    this->readAll();
+}
+
+/// Waits until everything in the ring of an exiting thread is written, then
+/// lets the writer forget it. Like that, what the thread logs afterwards and
+/// writes right away comes after it.
+void Sink::close( Ring& out_ring )
+{
+    Ring& r = out_ring;
+    if( !this->waitForWriter( [&r]() {
+            return r.tail.load( std::memory_order_acquire ) == r.head.load( std::memory_order_relaxed )
+                && r.pHuge.load( std::memory_order_acquire ) == nullptr;
+        } ) ) {
+        this->writeNow( &out_ring, nullptr );
+    }
+    out_ring.bClosed.store( true, std::memory_order_release );
 }
 
-int Logger::dbg_level = 0;
-std::ostream* Logger::outstream = nullptr;
-void Logger::Lock() { LoggerImpl::mtx.lock(); }
-void Logger::Unlock() { LoggerImpl::mtx.unlock(); }
+/// Writes what is in the ring into \a out, only call it with the stream mutex.
+/// \return Whether there was something.
+bool Sink::read( Ring& in_ring, std::ostream& out )
+{
+    bool bRead = false;
+    std::size_t tail = in_ring.tail.load( std::memory_order_relaxed );
+    std::size_t head = in_ring.head.load( std::memory_order_acquire );
+    if( head != tail ) {
+        std::size_t pos = tail % Ring::Size;
+        std::size_t first = std::min( head - tail, Ring::Size - pos );
+        out.write( in_ring.data + pos, static_cast<std::streamsize>( first ) );
+        out.write( in_ring.data, static_cast<std::streamsize>( head - tail - first ) );
+        in_ring.tail.store( head, std::memory_order_release );
+        bRead = true;
+    }
 
-}
\ No newline at end of file
+    // It only comes while the ring is empty and nothing else comes until it's written.
+    const std::string* pHuge = in_ring.pHuge.load( std::memory_order_acquire );
+    if( pHuge != nullptr ) {
+        out << *pHuge << '\n';
+        in_ring.pHuge.store( nullptr, std::memory_order_release );
+        bRead = true;
+    }
+    return bRead;
+}
+
+/// Writes what is in all rings and forgets the rings of the threads that exited.
+/// \return Whether there was something.
+bool Sink::readAll()
+{
+    std::lock_guard<std::mutex> ringsLock( m_ringsMutex );
+    std::lock_guard<std::mutex> streamLock( m_streamMutex );
+    std::ostream& out = m_out == nullptr ? std::cout : *m_out;
+
+    bool bRead = false;
+    for( auto i = m_rings.begin(); i != m_rings.end(); ) {
+        // Once closed, nothing more comes in.
+        bool bClosed = ( *i )->bClosed.load( std::memory_order_acquire );
+        bRead = this->read( **i, out ) || bRead;
+        if( bClosed )
+            i = m_rings.erase( i );
+        else
+            ++i;
+    }
+    if( bRead )
+        out.flush();
+    return bRead;
+}
+
+/// \return Whether any ring has something to be written.
+bool Sink::pending()
+{
+    std::lock_guard<std::mutex> lock( m_ringsMutex );
+    for( const std::unique_ptr<Ring>& pRing : m_rings ) {
+        if( pRing->head.load( std::memory_order_acquire ) != pRing->tail.load( std::memory_order_relaxed )
+            || pRing->pHuge.load( std::memory_order_acquire ) != nullptr )
+            return true;
+    }
+    return false;
+}
+
+/// Wakes the writer thread up if it is sleeping. Only then the mutex is needed.
+void Sink::wake()
+{
+    // Pairs with the fence in work(): either the writer sees the new message
+    // or we see it going to sleep.
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if( m_bSleeping.load( std::memory_order_relaxed ) && m_bSleeping.exchange( false ) ) {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_wakeUp.notify_one();
+    }
+}
+
+void Sink::work()
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    for( ;; ) {
+        // Everything logged before the flushes that have been asked for by now
+        // is in the rings.
+        std::size_t flushRequest = m_flushRequest;
+        bool bStop = m_bStop;
+        lock.unlock();
+        this->readAll();
+        lock.lock();
+
+        m_flushed = flushRequest;
+        m_written.notify_all();
+        if( bStop )
+            break;
+
+        m_bSleeping.store( true );
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        if( this->pending() ) {
+            m_bSleeping.store( false );
+            continue;
+        }
+        m_wakeUp.wait( lock, [this]() {
+            return !m_bSleeping.load() || m_flushRequest > m_flushed || m_bStop;
+        } );
+        m_bSleeping.store( false );
+    }
+}
+
+/// The sink is never destroyed, messages may still be logged while the
+/// program exits. The writer thread is stopped at exit, once it wrote
+/// everything that is waiting.
+Sink& sink()
+{
+    static Sink* pSink = []() {
+        Sink* p = new Sink;
+        std::atexit( []() { sink().stop(); } );
+        return p;
+    }();
+    return *pSink;
+}
+
+void append( std::string& out, const std::string& in_s )
+{
+    out.append( in_s );
+}
+
+void append( std::string& out, const char* in_s )
+{
+    out.append( in_s == nullptr ? "(null)" : in_s );
+}
+
+void append( std::string& out, char in_c )
+{
+    out.push_back( in_c );
+}
+
+void append( std::string& out, bool in_b )
+{
+    out.push_back( in_b ? '1' : '0' );
+}
+
+void append( std::string& out, long long in_i )
+{
+    char buf[32];
+    int len = std::snprintf( buf, sizeof( buf ), "%lld", in_i );
+    out.append( buf, static_cast<std::size_t>( len ) );
+}
+
+void append( std::string& out, unsigned long long in_i )
+{
+    char buf[32];
+    int len = std::snprintf( buf, sizeof( buf ), "%llu", in_i );
+    out.append( buf, static_cast<std::size_t>( len ) );
+}
+
+void append( std::string& out, double in_d )
+{
+    char buf[64];
+    int len = std::snprintf( buf, sizeof( buf ), "%g", in_d );
+    out.append( buf, static_cast<std::size_t>( std::min( len, static_cast<int>( sizeof( buf ) ) - 1 ) ) );
+}
+
+void append( std::string& out, const Hex& in_hex )
+{
+    char buf[32];
+    int len = std::snprintf( buf, sizeof( buf ), "%llx", static_cast<unsigned long long>( in_hex.value ) );
+    for( int i = len; i < in_hex.width; ++i ) {
+        out.push_back( in_hex.fill );
+    }
+    out.append( buf, static_cast<std::size_t>( len ) );
+}
+
+/// Copies the message into \a out, with every placeholder {1}, {2}, ... that
+/// has a parameter replaced by it. The others stay as they are.
+void format( std::string& out, const char* in_pszMsg, std::size_t in_nArgs, const void* const* in_pArgs, const AppendFn* in_pAppend )
+{
+    const char* p = in_pszMsg;
+    while( *p != '\0' ) {
+        const char* pOpen = std::strchr( p, '{' );
+        if( pOpen == nullptr ) {
+            out.append( p );
+            break;
+        }
+        out.append( p, static_cast<std::size_t>( pOpen - p ) );
+
+        std::size_t idx = 0;
+        const char* pEnd = pOpen + 1;
+        while( *pEnd >= '0' && *pEnd <= '9' ) {
+            idx = idx * 10 + static_cast<std::size_t>( *pEnd - '0' );
+            ++pEnd;
+        }
+
+        if( *pEnd == '}' && pEnd > pOpen + 1 && idx >= 1 && idx <= in_nArgs ) {
+            in_pAppend[idx - 1]( out, in_pArgs[idx - 1] );
+            p = pEnd + 1;
+        } else {
+            out.push_back( '{' );
+            p = pOpen + 1;
+        }
+    }
+}
+
+} // namespace LoggerImpl
+
+std::atomic<int> Logger::dbg_level( 0 );
+
+/// Sets the stream to write into, nullptr for std::cout. Everything logged
+/// before still goes into the previous one.
+void Logger::LogFile( std::ostream * out )
+{
+    LoggerImpl::sink().setStream( out );
+}
+
+/// Waits until everything that has been logged before is written out.
+void Logger::Flush()
+{
+    LoggerImpl::sink().flush();
+}
+
+std::string& Logger::Buffer()
+{
+    thread_local std::string buffer;
+    buffer.clear();
+    return buffer;
+}
+
+/// Hands a message over to the writer thread, if \a in_bFlush also waits until
+/// it has been written.
+void Logger::Write( const std::string& in_Msg, bool in_bFlush )
+{
+    LoggerImpl::sink().push( in_Msg );
+    if( in_bFlush )
+        LoggerImpl::sink().flush();
+}
+
+}
@@ -163,7 +163,7 @@ void FTS::TraditionalConnection::disconnect()
     }
     // We need to check empty the queue ourselves.
     if(!m_lpPacketQueue.empty()) {
-        FTSMSGDBG( "There are still {1} packets in the queue left.", 5, toString( m_lpPacketQueue.size() ) );
+        FTSMSGDBG( "There are still {1} packets in the queue left.", 5, m_lpPacketQueue.size() );
         for( auto p : m_lpPacketQueue ) {
             delete p;
         }
@@ -544,7 +544,7 @@ Packet *FTS::TraditionalConnection::getPacket(bool in_bUseQueue, uint64_t timeOu
 
     // All is good, check the package ID.
     if(p->isValid()) {
-        FTSMSGDBG("Recv packet with ID 0x{1}, payload len: {2}", 5, toString(p->getType(), -1, ' ', std::ios::hex), toString(p->getPayloadLen()));
+        FTSMSGDBG("Recv packet with ID 0x{1}, payload len: {2}", 5, Hex(p->getType()), p->getPayloadLen());
         addRecvPacketStat(p);
         return p;
     }
@@ -622,7 +622,7 @@ Packet *FTS::TraditionalConnection::waitForThenGetPacketWithReq(master_request_t
         // Check if this is the packet we want.
         if( p->getType() == in_req) {
             FTSMSGDBG("Accepted packet with ID 0x{1}, payload len: {2}", 5,
-                      toString(p->getType(), -1, ' ', std::ios::hex), toString(p->getPayloadLen()));
+                      Hex(p->getType()), p->getPayloadLen());
             return p;
         }
 
@@ -698,7 +698,7 @@ FTSC_ERR FTS::TraditionalConnection::send( Packet * in_pPacket )
     if( in_pPacket == nullptr )
         return FTSC_ERR::INVALID_INPUT;
 
-    FTSMSGDBG("Sending packet with ID 0x{1}, payload len: {2}", 5, toString(in_pPacket->getType(), -1, ' ', std::ios::hex), toString(in_pPacket->getPayloadLen()));
+    FTSMSGDBG("Sending packet with ID 0x{1}, payload len: {2}", 5, Hex(in_pPacket->getType()), in_pPacket->getPayloadLen());
     addSendPacketStat(in_pPacket);
 
     return this->send( in_pPacket->m_pData, in_pPacket->getTotalLen() );
@@ -7,6 +7,7 @@
  **/
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cerrno>
 #include <cassert>
@@ -23,6 +24,14 @@
 
 using namespace FTS;
 
+namespace {
+    // Updated by all connections, whichever thread they are used on.
+    std::atomic<std::uint64_t> g_packetsSent(0);
+    std::atomic<std::uint64_t> g_packetsReceived(0);
+    std::atomic<std::uint64_t> g_bytesSent(0);
+    std::atomic<std::uint64_t> g_bytesReceived(0);
+}
+
 Connection * FTS::Connection::create( eConnectionType type, const std::string &in_sName, std::uint16_t in_usPort, std::uint64_t in_ulTimeoutInMillisec )
 {
     switch( type ) {
@@ -75,7 +84,7 @@ Packet *FTS::Connection::getFirstPacketFromQueue( master_request_t in_req )
     }
 
     if( p != nullptr && Logger::DbgLevel() == 5) {
-        FTSMSGDBG("Recv packet from queue with ID 0x{1}, payload len: {2}", 4, toString(p->getType(), -1, ' ', std::ios::hex), toString(p->getPayloadLen()));
+        FTSMSGDBG("Recv packet from queue with ID 0x{1}, payload len: {2}", 4, Hex(p->getType()), p->getPayloadLen());
         std::string s = "Queue is now: (len:"+toString(m_lpPacketQueue.size())+")";
         for(auto pPack : m_lpPacketQueue) {
             s += "(0x" + toString(pPack->getType(), -1, ' ', std::ios::hex) + "," + toString(pPack->getPayloadLen()) + ")";
@@ -105,7 +114,7 @@ void FTS::Connection::queuePacket( Packet *in_pPacket )
     while( m_lpPacketQueue.size() > FTSC_MAX_QUEUE_LEN ) {
         Packet *pPack = m_lpPacketQueue.front();
         FTSMSGDBG( "Queue full, dropping packet with ID 0x{1}, payload len: {2}", 5,
-                   toString( pPack->getType(), -1, ' ', std::ios::hex ), toString( pPack->getPayloadLen() ) );
+                   Hex( pPack->getType() ), pPack->getPayloadLen() );
         m_lpPacketQueue.pop_front();
         delete pPack;
     }
@@ -113,7 +122,7 @@ void FTS::Connection::queuePacket( Packet *in_pPacket )
     if( Logger::DbgLevel() == 5 ) {
 
         FTSMSGDBG( "Queued packet with ID 0x{1}, payload len: {2}", 5,
-                   toString( in_pPacket->getType(), -1, ' ', std::ios::hex ), toString( in_pPacket->getPayloadLen() ) );
+                   Hex( in_pPacket->getType() ), in_pPacket->getPayloadLen() );
         std::string s = "Queue is now: (len:" + toString( m_lpPacketQueue.size() ) + ")";
         for( auto pPack : m_lpPacketQueue ) {
             s += "(0x" + toString( pPack->getType(), -1, ' ', std::ios::hex ) + "," + toString( pPack->getPayloadLen() ) + ")";
@@ -126,10 +135,24 @@ void FTS::Connection::queuePacket( Packet *in_pPacket )
 void FTS::Connection::addSendPacketStat( Packet * p )
 {
     ++m_statPackets[p->getType()].second;
+    g_packetsSent.fetch_add( 1, std::memory_order_relaxed );
+    g_bytesSent.fetch_add( p->getTotalLen(), std::memory_order_relaxed );
 }
 
 void FTS::Connection::addRecvPacketStat( Packet * p )
 {
     ++m_statPackets[p->getType()].first;
+    g_packetsReceived.fetch_add( 1, std::memory_order_relaxed );
+    g_bytesReceived.fetch_add( p->getTotalLen(), std::memory_order_relaxed );
+}
+
+TrafficStats FTS::Connection::getTotalTraffic()
+{
+    TrafficStats stats;
+    stats.packetsSent = g_packetsSent.load( std::memory_order_relaxed );
+    stats.packetsReceived = g_packetsReceived.load( std::memory_order_relaxed );
+    stats.bytesSent = g_bytesSent.load( std::memory_order_relaxed );
+    stats.bytesReceived = g_bytesReceived.load( std::memory_order_relaxed );
+    return stats;
 }
 
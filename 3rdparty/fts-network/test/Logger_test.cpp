@@ -1,6 +1,8 @@
 #include "catch.hpp"
 #include "../include/Logger.h"
 #include <sstream>
+#include <thread>
+#include <vector>
 
 using namespace FTS;
 
@@ -10,6 +12,7 @@ TEST_CASE("Message Simple String", "[FTSMSG]")
     Logger::LogFile(&logout);
     Logger::DbgLevel(5);
     FTSMSG("Testlog", MsgType::Message);
+    Logger::Flush();
     REQUIRE(logout.str() == "Testlog\n");
 }
 
@@ -19,6 +22,7 @@ TEST_CASE("Message one integer parameter", "[FTSMSG]")
     Logger::LogFile(&logout);
     Logger::DbgLevel(5);
     FTSMSG("Testlog {1}", MsgType::Message, toString(123));
+    Logger::Flush();
     REQUIRE(logout.str() == "Testlog 123\n");
 }
 
@@ -28,6 +32,7 @@ TEST_CASE("Message three parameter", "[FTSMSG]")
     Logger::LogFile(&logout);
     Logger::DbgLevel(5);
     FTSMSG("Testlog {1} {3} {2}", MsgType::Message, toString(123), toString(123,0,' ',std::ios::hex), "=");
+    Logger::Flush();
     REQUIRE(logout.str() == "Testlog 123 = 7b\n");
 }
 
@@ -37,6 +42,7 @@ TEST_CASE("Warning three parameter", "[FTSMSG]")
     Logger::LogFile(&logout);
     Logger::DbgLevel(5);
     FTSMSG("Testlog {1} {3} {2}", MsgType::Warning, toString(123), toString(123, 0, ' ', std::ios::hex), "=");
+    Logger::Flush();
     REQUIRE(logout.str() == "Testlog 123 = 7b\n");
 }
 
@@ -46,6 +52,7 @@ TEST_CASE("Error message", "[FTSMSG]")
     Logger::LogFile(&logout);
     Logger::DbgLevel(5);
     FTSMSG("Testlog {1}", MsgType::Error, toString(1));
+    Logger::Flush();
     REQUIRE(logout.str() == "Testlog 1\n");
 }
 
@@ -56,6 +63,7 @@ TEST_CASE("Messing missing first parameter placeholder", "[FTSMSG]")
     Logger::LogFile(&logout);
     Logger::DbgLevel(5);
     FTSMSG("Testlog {3} {2}", MsgType::Warning, toString(123), toString(123, 0, ' ', std::ios::hex), "=");
+    Logger::Flush();
     REQUIRE(logout.str() == "Testlog = 7b\n");
 }
 
@@ -65,6 +73,7 @@ TEST_CASE("Debug message same level", "[FTSMSGDBG]")
     Logger::LogFile(&logout);
     Logger::DbgLevel(1);
     FTSMSGDBG("Testlog {1} {3} {2}", 1, toString(123), toString(123, 0, ' ', std::ios::hex), "=");
+    Logger::Flush();
     REQUIRE(logout.str() == "Testlog 123 = 7b\n");
 }
 
@@ -74,6 +83,7 @@ TEST_CASE("Debug message higher level", "[FTSMSGDBG]")
     Logger::LogFile(&logout);
     Logger::DbgLevel(1);
     FTSMSGDBG("Testlog {1} {3} {2}", 2, toString(123), toString(123, 0, ' ', std::ios::hex), "=");
+    Logger::Flush();
     REQUIRE(logout.str().empty());
 }
 
@@ -83,5 +93,97 @@ TEST_CASE("Debug message lower level", "[FTSMSGDBG]")
     Logger::LogFile(&logout);
     Logger::DbgLevel(2);
     FTSMSGDBG("Testlog {1} {3} {2}", 1, toString(123), toString(123, 0, ' ', std::ios::hex), "=");
+    Logger::Flush();
     REQUIRE(logout.str() == "Testlog 123 = 7b\n");
 }
+
+TEST_CASE("Message with numbers", "[FTSMSG]")
+{
+    std::stringstream logout;
+    Logger::LogFile(&logout);
+    Logger::DbgLevel(5);
+    FTSMSG("Testlog {1} {2} 0x{3} {4} {5}", MsgType::Message, 123, std::uint8_t(7), Hex(std::uint8_t(0xab), 4), -5, 'c');
+    Logger::Flush();
+    REQUIRE(logout.str() == "Testlog 123 7 0x00ab -5 c\n");
+}
+
+TEST_CASE("Message placeholders without parameter", "[FTSMSG]")
+{
+    std::stringstream logout;
+    Logger::LogFile(&logout);
+    Logger::DbgLevel(5);
+    FTSMSG("Testlog {1} {2} {} {1}", MsgType::Message, "a");
+    Logger::Flush();
+    REQUIRE(logout.str() == "Testlog a {2} {} a\n");
+}
+
+TEST_CASE("Messages from many threads", "[FTSMSGDBG]")
+{
+    std::stringstream logout;
+    Logger::LogFile(&logout);
+    Logger::DbgLevel(5);
+
+    const int nThreads = 4;
+    const int nMessages = 1000;
+    std::vector<std::thread> threads;
+    for(int t = 0; t < nThreads; ++t) {
+        threads.emplace_back([t]() {
+            for(int i = 0; i < nMessages; ++i) {
+                FTSMSGDBG("Thread {1} message {2}", 5, t, i);
+            }
+        });
+    }
+    for(auto& t : threads) {
+        t.join();
+    }
+    Logger::Flush();
+
+    // All lines are there and each thread's ones are in order.
+    std::vector<int> next(nThreads, 0);
+    std::string line;
+    int nLines = 0;
+    while(std::getline(logout, line)) {
+        int t = 0, i = 0;
+        REQUIRE(std::sscanf(line.c_str(), "Thread %d message %d", &t, &i) == 2);
+        REQUIRE(i == next[t]);
+        ++next[t];
+        ++nLines;
+    }
+    REQUIRE(nLines == nThreads * nMessages);
+}
+
+TEST_CASE("Message bigger than the buffer", "[FTSMSG]")
+{
+    std::stringstream logout;
+    Logger::LogFile(&logout);
+    Logger::DbgLevel(5);
+
+    std::string huge(100000, 'x');
+    FTSMSG("before", MsgType::Message);
+    FTSMSG("{1}", MsgType::Message, huge);
+    FTSMSG("after", MsgType::Message);
+    Logger::Flush();
+    REQUIRE(logout.str() == "before\n" + huge + "\nafter\n");
+}
+
+TEST_CASE("Messages of threads that exited", "[FTSMSG]")
+{
+    std::stringstream logout;
+    Logger::LogFile(&logout);
+    Logger::DbgLevel(5);
+
+    // Every thread gets a buffer of its own, the messages must not get lost
+    // with the threads.
+    for(int t = 0; t < 20; ++t) {
+        std::thread([t]() {
+            FTSMSG("Thread {1}", MsgType::Message, t);
+        }).join();
+    }
+    Logger::Flush();
+
+    std::string expected;
+    for(int t = 0; t < 20; ++t) {
+        expected += "Thread " + std::to_string(t) + "\n";
+    }
+    REQUIRE(logout.str() == expected);
+}
@@ -1,13 +1,48 @@
 #include "dArchive.h"
 #include <experimental/filesystem>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
 #include "dLib/dCompressor/dCompressor.h"
 #include "logging/logger.h"
+#include "logging/FlightRecorder.h"
+#include "main/JobSystem.h"
 
 namespace fs = std::experimental::filesystem;
 
 using namespace FTS;
 
 ChunkFactory Archive::m_factory;
+const uint8_t Archive::FormatV1;
+const uint8_t Archive::FormatV2;
+const uint8_t Archive::CurrentFormat;
+std::size_t Archive::m_nWorkerThreads = 0;
+
+/// Ignore leading "./" or ".\" in chunk names.
+static void stripCurrentDir(String& out_sName)
+{
+    while(out_sName.left(2) == "./" || out_sName.left(2) == ".\\") {
+        out_sName = String(out_sName, 2);
+    }
+}
+
+/** Computes the hash of a chunk name like it is stored in the table of contents
+ *  of an archive. This is the 32 bit FNV-1a hash of the UTF-8 bytes of the name.
+ *
+ * \param in_sName The name of the chunk to hash.
+ *
+ * \return The hash of the name.
+ */
+uint32_t ChunkIndexEntry::hashName(const String& in_sName)
+{
+    uint32_t uiHash = 2166136261u;
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(in_sName.c_str());
+    for(size_t i = 0 ; i < in_sName.byteCount() ; ++i) {
+        uiHash ^= p[i];
+        uiHash *= 16777619u;
+    }
+    return uiHash;
+}
 
 /** From a given chunktype ID, it creates a chunk object that is of the type
  *  indicated by the ID. For unknown IDs, it creates an UnknownChunk object.
@@ -49,12 +84,24 @@ int Chunk::read(File &out_f)
     out_f.read(m_uiPayloadLength);
     out_f.read(m_sName);
 
-    FTSMSGDBG("Reading "+this->getTypeName()+" '"+m_sName+"' with size "
-              +String::nr(m_uiPayloadLength), 3);
+    FTSMSGDBG("Reading {1} '{2}' with size {3}", 3, this->getTypeName(), m_sName, m_uiPayloadLength);
 
     return out_f.eof() ? -1 : ERR_OK;
 }
 
+/// Takes the chunk's header out of an entry of an archive's table of contents.
+/// \param in_entry The entry that describes this chunk.
+/// \return ERR_OK on success, an error code < 0 on failure.
+int Chunk::readIndexed(const ChunkIndexEntry& in_entry)
+{
+    m_uiPayloadLength = in_entry.uiSize;
+    m_sName = in_entry.sName;
+
+    FTSMSGDBG("Indexing {1} '{2}' with size {3}", 3, this->getTypeName(), m_sName, m_uiPayloadLength);
+
+    return ERR_OK;
+}
+
 /// Reads in the chunk's header.
 /// \param out_f The file to read the header from. The file pointer will be moved.
 /// \param in_sChunkPrefix A prefix to give the chunk name.
@@ -64,8 +111,7 @@ String Chunk::prefix(const String &in_sChunkPrefix)
     if(!in_sChunkPrefix)
         return this->getName();
 
-    String sDbgMsg = "Prefixing "+this->getName()+" with '"+in_sChunkPrefix+"'";
-    FTSMSGDBG(sDbgMsg, 3);
+    FTSMSGDBG("Prefixing {1} with '{2}'", 3, this->getName(), in_sChunkPrefix);
 
     m_sName = in_sChunkPrefix + this->getName();
     return this->getName();
@@ -127,14 +173,14 @@ int UnknownChunk::write(File &out_f)
 
 /// Default constructor.
 FileChunk::FileChunk()
-    : m_pRawContent(NULL)
+    : m_pRawContent() // Null pointer
     , m_pFileCache() // Null pointer
 {
 }
 
 /// Identical to calling new FileChunk()->give(in_pFile).
 FileChunk::FileChunk(File::Ptr in_pFile, const String& in_sChunkName)
-    : m_pRawContent(NULL)
+    : m_pRawContent() // Null pointer
     , m_pFileCache() // Null pointer
 {
     this->give(std::move(in_pFile), in_sChunkName);
@@ -143,7 +189,6 @@ FileChunk::FileChunk(File::Ptr in_pFile, const String& in_sChunkName)
 /// Default destructor.
 FileChunk::~FileChunk()
 {
-    SAFE_DELETE(m_pRawContent);
 }
 
 /** Reads a file chunk out of a file object. The bytes right in front of the
@@ -160,17 +205,16 @@ int FileChunk::read(File &out_f)
     if(Chunk::read(out_f) != ERR_OK)
         return -1;
 
-    // Ignore leading "./" or ".\" in filenames
-    while(m_sName.left(2) == "./" || m_sName.left(2) == ".\\") {
-        m_sName = String(m_sName, 2);
-    }
+    stripCurrentDir(m_sName);
 
     // Read the file's data into a new data container.
-    m_pRawContent = new RawDataContainer(this->getPayloadLength());
-    if(out_f.readNoEndian(*m_pRawContent) < this->getPayloadLength()) {
-        SAFE_DELETE(m_pRawContent);
+    RawDataContainer *pContent = new RawDataContainer(this->getPayloadLength());
+    if(out_f.readNoEndian(*pContent) < this->getPayloadLength()) {
+        SAFE_DELETE(pContent);
+        m_pRawContent.reset();
         return -2;
     }
+    m_pRawContent.reset(pContent);
 
     // The file object will be created when it is first needed.
     // This avoids unnecessary creations of unneeded objects.
@@ -179,6 +223,154 @@ int FileChunk::read(File &out_f)
     return ERR_OK;
 }
 
+/** Reads a file chunk out of the table of contents of an archive whose
+ *  payload already resides in memory. The payload is copied and checked
+ *  against the checksum stored in the table of contents.
+ *
+ * \param in_entry The entry of the table of contents describing the chunk.
+ * \param in_payload The payload of the chunk. May be longer than the chunk.
+ *
+ * \return ERR_OK on success, an error code < 0 on failure.
+ */
+int FileChunk::readIndexedPayload(const ChunkIndexEntry& in_entry, const ConstRawDataContainer& in_payload)
+{
+    if(Chunk::readIndexed(in_entry) != ERR_OK)
+        return -1;
+
+    stripCurrentDir(m_sName);
+
+    if(in_payload.getSize() < this->getPayloadLength())
+        return -2;
+
+    ConstRawDataContainer payload(in_payload.getData(), static_cast<size_t>(this->getPayloadLength()));
+    if(payload.fletcher32() != in_entry.uiFletcher32)
+        return -3;
+
+    m_pRawContent.reset(new RawDataContainer(payload));
+    m_sLazySource = Path();
+    m_pFileCache.reset();
+
+    return ERR_OK;
+}
+
+/** Reads a file chunk out of the table of contents of an archive lying on the
+ *  disk, without reading its payload. The payload is read from the archive
+ *  file the first time it is needed and checked against the checksum stored in
+ *  the table of contents at that time.
+ *
+ * \param in_entry The entry of the table of contents describing the chunk.
+ * \param in_sArchiveFile The archive file to read the payload from later on.
+ *
+ * \return ERR_OK on success, an error code < 0 on failure.
+ */
+int FileChunk::readLazy(const ChunkIndexEntry& in_entry, const Path& in_sArchiveFile)
+{
+    if(Chunk::readIndexed(in_entry) != ERR_OK)
+        return -1;
+
+    stripCurrentDir(m_sName);
+
+    m_pRawContent.reset();
+    m_pFileCache.reset();
+    m_sLazySource = in_sArchiveFile;
+    m_uiLazyOffset = in_entry.uiOffset;
+    m_uiLazyFletcher32 = in_entry.uiFletcher32;
+
+    return ERR_OK;
+}
+
+/** Reads the payload of a lazy chunk from the archive file, if that didn't
+ *  happen yet.
+ *
+ * \exception FileNotExistException The archive file can't be opened anymore.
+ * \exception SyscallException The payload could not be read.
+ * \exception CorruptDataException The payload doesn't match its checksum.
+ */
+void FileChunk::loadLazy() const
+{
+    std::lock_guard<std::mutex> lock(m_lazyMutex);
+    this->loadLazyLocked();
+}
+
+/** Does the work of \a loadLazy, \a m_lazyMutex has to be locked already.
+ *
+ * \exception FileNotExistException The archive file can't be opened anymore.
+ * \exception SyscallException The payload could not be read.
+ * \exception CorruptDataException The payload doesn't match its checksum.
+ */
+void FileChunk::loadLazyLocked() const
+{
+    if(!this->isLazy())
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::FILE *pFile = fopen(m_sLazySource.c_str(), "rb");
+    if(pFile == NULL)
+        throw FileNotExistException(m_sLazySource);
+
+    RawDataContainer *pContent = new RawDataContainer(static_cast<size_t>(this->getPayloadLength()));
+    bool bRead = File::seek(pFile, m_uiLazyOffset);
+
+    // Read it piece by piece and checksum every piece right after reading it.
+    static const size_t PieceSize = 256 * 1024;
+    Fletcher32 fletcher;
+    for(size_t uiDone = 0 ; bRead && uiDone < pContent->getSize() ; ) {
+        size_t uiPiece = std::min<size_t>(pContent->getSize() - uiDone, PieceSize);
+        bRead = fread(pContent->getData() + uiDone, uiPiece, 1, pFile) == 1;
+        if(!bRead)
+            break;
+        fletcher.update(pContent->getData() + uiDone, uiPiece);
+        uiDone += uiPiece;
+    }
+    SAFE_FCLOSE(pFile);
+
+    if(!bRead) {
+        SAFE_DELETE(pContent);
+        throw SyscallException("FileChunk::load::fread(" + m_sLazySource + ")");
+    }
+
+    if(fletcher.finalize() != m_uiLazyFletcher32) {
+        SAFE_DELETE(pContent);
+        throw CorruptDataException(m_sLazySource, "Invalid Fletcher32 checksum of chunk " + this->getName(), MsgType::Error);
+    }
+
+    FTSMSGDBG("Loaded {1} '{2}' from {3}", 3, this->getTypeName(), this->getName(), m_sLazySource);
+    FlightRecorder::record(FlightEvent::ChunkLoaded, static_cast<int64_t>(pContent->getSize()),
+                           std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+
+    m_pRawContent.reset(pContent);
+    m_sLazySource = Path();
+}
+
+/** Gets the raw content of the chunk, reading it from the archive file first
+ *  if that didn't happen yet. Only this chunk is locked meanwhile, so other
+ *  chunks can be read at the same time.
+ *
+ * \return The raw content, shared with all files opened from this chunk.
+ */
+std::shared_ptr<const RawDataContainer> FileChunk::getRawContent()
+{
+    this->loadLazy();
+
+    std::lock_guard<std::mutex> lock(m_lazyMutex);
+    return m_pRawContent;
+}
+
+/** Reads the payload from the archive file in case it isn't in memory yet.
+ *
+ * \exception FileNotExistException The archive file can't be opened anymore.
+ * \exception SyscallException The payload could not be read.
+ * \exception CorruptDataException The payload doesn't match its checksum.
+ *
+ * \return ERR_OK.
+ */
+int FileChunk::load()
+{
+    this->loadLazy();
+    return ERR_OK;
+}
+
 /** This gives a file object to this chunk, That means that the old file object
  *  hold by this chunk object gets deleted and control is taken over the given
  *  one.\n
@@ -194,7 +386,8 @@ int FileChunk::read(File &out_f)
  */
 int FileChunk::give(File::Ptr in_pFile, const String& in_sChunkName)
 {
-    SAFE_DELETE(m_pRawContent);
+    m_pRawContent.reset();
+    m_sLazySource = Path();
 
     m_pFileCache.reset();
     m_pFileCache = std::move(in_pFile);
@@ -207,7 +400,7 @@ int FileChunk::give(File::Ptr in_pFile, const String& in_sChunkName)
         // Compress it like it was originally.
         StreamedDataContainer sdc;
         m_pFileCache->saveToBuf(sdc, m_pFileCache->getOriginalCompressor());
-        m_pRawContent = sdc.unbindDC();
+        m_pRawContent.reset(sdc.unbindDC());
         m_uiPayloadLength = m_pRawContent->getSize();
     } else {
         m_sName = String::EMPTY;
@@ -234,6 +427,7 @@ int FileChunk::execute(const String &in_sNewChunkname)
 {
     Path sFileName = in_sNewChunkname.empty() ? this->getName() : in_sNewChunkname;
     try {
+        this->loadLazy();
         File::Ptr f = File::overwrite(sFileName, File::Insert);
         f->writeNoEndian(*m_pRawContent); // RawContent may already be comressed.
         f->save(NoCompressor()); // That's why no compression is explicitly wanted here.
@@ -262,6 +456,9 @@ int FileChunk::write(File &out_f)
         /// \TODO.
     //}
 
+    // Make sure we got something to write.
+    this->loadLazy();
+
     // Write the chunk header
     if(Chunk::write(out_f) != ERR_OK)
         return -1;
@@ -313,10 +510,15 @@ FTS::File &FileChunk::getFile()
 /// called. The subsequent calls do make virutally no overhead.
 ConstRawDataContainer FileChunk::getContents() const
 {
+    // Several threads may get here first, only one of them makes the file.
+    std::lock_guard<std::mutex> lock(m_lazyMutex);
+
     // First time used, load the file object.
     if(!m_pFileCache.get()) {
-        if(m_pRawContent != NULL) {
-            m_pFileCache = File::fromRawData(*m_pRawContent, this->getName(), File::Insert, File::OverwriteFile);
+        this->loadLazyLocked();
+        if(m_pRawContent.get() != NULL) {
+            // The file shares my data until it gets modified.
+            m_pFileCache.reset(new File(this->getName(), File::Insert, File::OverwriteFile, new SharedDataContainer(m_pRawContent)));
         } else {
             // Huh? Just create an empty file.
             FTS18N("InvParam", MsgType::Horror, "FileChunk::getFile, but no file loaded");
@@ -348,9 +550,9 @@ Archive::Archive(File& out_file, const String &in_sChunkPrefix)
     m_sFileName = out_file.getName();
 
     // Read out the header.
+    uint64_t uiStart = out_file.getCursorPos();
     String sID = out_file.readstr();
     int8_t version = out_file.readi8();
-    uint32_t uiFletcher32 = out_file.readui32();
 
     // Check for validity.
     if(out_file.eof() || sID != "FTSARC") {
@@ -358,7 +560,36 @@ Archive::Archive(File& out_file, const String &in_sChunkPrefix)
     }
 
     // Log something.
-    FTSMSGDBG("Loading archive (format version "+String::nr(version)+") from file "+out_file.getName(), 2);
+    FTSMSGDBG("Loading archive (format version {1}) from file {2}", 2, version, out_file.getName());
+
+    m_uiFormatVersion = static_cast<uint8_t>(version);
+    switch(m_uiFormatVersion) {
+    case FormatV1:
+        this->readV1(out_file, in_sChunkPrefix);
+        break;
+    case FormatV2:
+        this->readV2(out_file, uiStart, in_sChunkPrefix);
+        break;
+    default:
+        throw(CorruptDataException(out_file.getName(), "Unknown archive format version " + String::nr(version), MsgType::Error));
+    }
+
+    // Another log.
+    FTSMSGDBG("Done loading the archive with {1} chunks.", 2, this->getChunkCount());
+    FlightRecorder::record(FlightEvent::ArchiveLoaded, static_cast<int64_t>(this->getChunkCount()), m_uiFormatVersion);
+}
+
+/** Reads the chunks of a version 1 archive, that is all chunks one after the
+ *  other, protected by a checksum over all of them.
+ *
+ * \param out_file The file to read the archive from. The cursor has to be right
+ *                 behind the format version and will be at the end of the file
+ *                 after this call.
+ * \param in_sChunkPrefix A prefix to give all chunk's names.
+ */
+void Archive::readV1(File& out_file, const String &in_sChunkPrefix)
+{
+    uint32_t uiFletcher32 = out_file.readui32();
 
     // We calculate the checksum and see if it is the one that was expected.
     ConstRawDataContainer cdc(out_file.getDataContainer().getData() + out_file.getCursorPos(), out_file.getSize() - out_file.getCursorPos());
@@ -366,7 +597,7 @@ Archive::Archive(File& out_file, const String &in_sChunkPrefix)
     if(uiFletcher32 != uiFletcher32Calc) {
         throw(CorruptDataException(out_file.getName(), "Invalid Fletcher32 checksum: calculated " + String::nr(uiFletcher32Calc) + "but expected" + String::nr(uiFletcher32), MsgType::Error));
     }
-    FTSMSGDBG("Checksum "+String::nr(uiFletcher32)+" is valid", 3);
+    FTSMSGDBG("Checksum {1} is valid", 3, uiFletcher32);
 
     // Read out all chunks until the end of the file.
     uint8_t uiChunkType = 0;
@@ -379,11 +610,203 @@ Archive::Archive(File& out_file, const String &in_sChunkPrefix)
         // Read it and add it to our chunk map.
         pChunk->read(out_file);
         pChunk->prefix(in_sChunkPrefix);
-        m_mChunks[pChunk->getName()] = pChunk;
+        this->insertChunk(pChunk);
     } while(!out_file.eof());
+}
 
-    // Another log.
-    FTSMSGDBG("Done loading the archive with "+String::nr(this->getChunkCount())+" chunks.", 2);
+/** Reads the chunks of a version 2 archive by using its table of contents.
+ *  Only the table of contents is covered by the checksum in the header, every
+ *  chunk's payload is checked against its own checksum.
+ *
+ * \param out_file The file to read the archive from. The cursor has to be right
+ *                 behind the format version and will be at the end of the file
+ *                 after this call.
+ * \param in_uiStart Where the archive begins in the file.
+ * \param in_sChunkPrefix A prefix to give all chunk's names.
+ */
+void Archive::readV2(File& out_file, uint64_t in_uiStart, const String &in_sChunkPrefix)
+{
+    uint32_t uiFletcher32 = out_file.readui32();
+    uint64_t uiIndexOffset = out_file.readui64();
+
+    // Compared by subtraction, the offsets may be anything in a broken file.
+    if(out_file.eof() || uiIndexOffset >= out_file.getSize() - in_uiStart) {
+        throw(CorruptDataException(out_file.getName(), "Invalid table of contents position " + String::nr(uiIndexOffset), MsgType::Error));
+    }
+    uint64_t uiIndexPos = in_uiStart + uiIndexOffset;
+
+    // Only the table of contents is checked here.
+    const uint8_t *pData = out_file.getDataContainer().getData();
+    ConstRawDataContainer index(pData + uiIndexPos, static_cast<size_t>(out_file.getSize() - uiIndexPos));
+    uint32_t uiFletcher32Calc = index.fletcher32();
+    if(uiFletcher32 != uiFletcher32Calc) {
+        throw(CorruptDataException(out_file.getName(), "Invalid Fletcher32 checksum: calculated " + String::nr(uiFletcher32Calc) + "but expected" + String::nr(uiFletcher32), MsgType::Error));
+    }
+    FTSMSGDBG("Checksum {1} is valid", 3, uiFletcher32);
+
+    std::vector<ChunkIndexEntry> entries;
+    StreamedConstDataContainer indexStream(&index);
+    if(!Archive::readIndex(indexStream, entries)) {
+        throw(CorruptDataException(out_file.getName(), "Invalid table of contents", MsgType::Error));
+    }
+
+    for(const ChunkIndexEntry& entry : entries) {
+        Chunk *pChunk = m_factory.createChunk(entry.uiChunkType);
+        FileChunk *pFileChunk = dynamic_cast<FileChunk *>(pChunk);
+
+        int iRet = ERR_OK;
+        if(pFileChunk == NULL) {
+            iRet = pChunk->readIndexed(entry);
+        } else if(entry.uiOffset > uiIndexOffset || entry.uiSize > uiIndexOffset - entry.uiOffset) {
+            iRet = -1;
+        } else {
+            ConstRawDataContainer payload(pData + in_uiStart + entry.uiOffset, static_cast<size_t>(entry.uiSize));
+            iRet = pFileChunk->readIndexedPayload(entry, payload);
+        }
+
+        if(iRet != ERR_OK) {
+            SAFE_DELETE(pChunk);
+            throw(CorruptDataException(out_file.getName(), "Invalid chunk " + entry.sName, MsgType::Error));
+        }
+
+        pChunk->prefix(in_sChunkPrefix);
+        this->insertChunk(pChunk);
+    }
+
+    out_file.setCursorPos(out_file.getSize());
+}
+
+/** Reads the table of contents of a version 2 archive.
+ *
+ * \param in_index The stream holding the table of contents.
+ * \param out_entries The entries of the table of contents are appended to this.
+ *
+ * \return true if the table of contents is intact, false if not.
+ */
+bool Archive::readIndex(ReadableStream& in_index, std::vector<ChunkIndexEntry>& out_entries)
+{
+    uint64_t uiCount = in_index.read<uint64_t>();
+
+    for(uint64_t i = 0 ; i < uiCount ; ++i) {
+        if(in_index.eod())
+            return false;
+
+        ChunkIndexEntry entry;
+        in_index.read(entry.uiNameHash);
+        in_index.read(entry.uiChunkType);
+        in_index.read(entry.uiOffset);
+        in_index.read(entry.uiSize);
+        in_index.read(entry.sCompressor);
+        in_index.read(entry.uiFletcher32);
+        in_index.read(entry.sName);
+
+        if(entry.uiNameHash != ChunkIndexEntry::hashName(entry.sName))
+            return false;
+
+        out_entries.push_back(entry);
+    }
+
+    return true;
+}
+
+/** Reads the table of contents of a version 2 archive lying uncompressed on
+ *  the disk, without reading any chunk's payload yet.
+ *
+ * \param in_sFileName The name of the archive file.
+ * \param in_sChunkPrefix A prefix to give all chunk's names.
+ *
+ * \exception CorruptDataException In case the table of contents is corrupt.
+ *
+ * \return The archive or NULL if the file is no such archive, in which case
+ *         it has to be loaded the usual way.
+ */
+Archive *Archive::loadIndexedArchive(const Path &in_sFileName, const String &in_sChunkPrefix)
+{
+    // Only files on the local disk can be read partially.
+    if(in_sFileName == "-" || in_sFileName.protocol() != "file")
+        return NULL;
+#ifndef D_FILE_NO_ARCHMAP
+    if(File::isInArchive(in_sFileName))
+        return NULL;
+#endif
+
+    std::FILE *pFile = fopen(in_sFileName.c_str(), "rb");
+    if(pFile == NULL)
+        return NULL;
+
+    // The header: "FTSARC", version, checksum and position of the index.
+    // If the file is compressed as a whole, this doesn't match.
+    uint8_t header[7 + 1 + 4 + 8] = {0};
+    if(fread(header, sizeof(header), 1, pFile) != 1
+       || memcmp(header, "FTSARC", 7) != 0
+       || header[7] != FormatV2) {
+        SAFE_FCLOSE(pFile);
+        return NULL;
+    }
+
+    ConstRawDataContainer headerRest(header + 8, sizeof(header) - 8);
+    StreamedConstDataContainer headerStream(&headerRest);
+    uint32_t uiFletcher32 = headerStream.read<uint32_t>();
+    uint64_t uiIndexPos = headerStream.read<uint64_t>();
+
+    uint64_t uiFileSize = File::getSize(pFile);
+    if(uiIndexPos < sizeof(header) || uiIndexPos >= uiFileSize) {
+        SAFE_FCLOSE(pFile);
+        throw(CorruptDataException(in_sFileName, "Invalid table of contents position " + String::nr(uiIndexPos), MsgType::Error));
+    }
+
+    // Read nothing but the table of contents.
+    RawDataContainer index(static_cast<size_t>(uiFileSize - uiIndexPos));
+    bool bRead = File::seek(pFile, uiIndexPos)
+              && fread(index.getData(), index.getSize(), 1, pFile) == 1;
+    SAFE_FCLOSE(pFile);
+    if(!bRead) {
+        throw SyscallException("Archive::loadArchive::fread(" + in_sFileName + ")");
+    }
+
+    uint32_t uiFletcher32Calc = index.fletcher32();
+    if(uiFletcher32 != uiFletcher32Calc) {
+        throw(CorruptDataException(in_sFileName, "Invalid Fletcher32 checksum: calculated " + String::nr(uiFletcher32Calc) + "but expected" + String::nr(uiFletcher32), MsgType::Error));
+    }
+
+    std::vector<ChunkIndexEntry> entries;
+    StreamedConstDataContainer indexStream(&index);
+    if(!Archive::readIndex(indexStream, entries)) {
+        throw(CorruptDataException(in_sFileName, "Invalid table of contents", MsgType::Error));
+    }
+
+    FTSMSGDBG("Loading archive index (format version 2) from file {1}", 2, in_sFileName);
+
+    Archive *pArch = new Archive(in_sFileName, static_cast<Compressor *>(NULL));
+    pArch->m_uiFormatVersion = FormatV2;
+    for(const ChunkIndexEntry& entry : entries) {
+        Chunk *pChunk = m_factory.createChunk(entry.uiChunkType);
+        FileChunk *pFileChunk = dynamic_cast<FileChunk *>(pChunk);
+
+        // A payload reaching into the table of contents is only found out
+        // when it gets loaded otherwise, better fail right now.
+        int iRet = ERR_OK;
+        if(pFileChunk == NULL) {
+            iRet = pChunk->readIndexed(entry);
+        } else if(entry.uiOffset + entry.uiSize > uiIndexPos || entry.uiOffset + entry.uiSize < entry.uiOffset) {
+            iRet = -1;
+        } else {
+            iRet = pFileChunk->readLazy(entry, in_sFileName);
+        }
+
+        if(iRet != ERR_OK) {
+            SAFE_DELETE(pChunk);
+            SAFE_DELETE(pArch);
+            throw(CorruptDataException(in_sFileName, "Invalid chunk " + entry.sName, MsgType::Error));
+        }
+
+        pChunk->prefix(in_sChunkPrefix);
+        pArch->insertChunk(pChunk);
+    }
+
+    FTSMSGDBG("Done indexing the archive with {1} chunks.", 2, pArch->getChunkCount());
+    FlightRecorder::record(FlightEvent::ArchiveLoaded, static_cast<int64_t>(pArch->getChunkCount()), FormatV2);
+    return pArch;
 }
 
 /** Constructs the archive object, reading every file out of the directory.\n
@@ -400,31 +823,77 @@ Archive::Archive(const Path& in_Path, const String &in_sChunkPrefix)
     m_sFileName = in_Path;
 
     // Log something.
-    FTSMSGDBG("Loading archive from directory "+in_Path, 2);
+    FTSMSGDBG("Loading archive from directory {1}", 2, in_Path);
 
     // We recursively enter each subdirectory and we read out every file as
     // a chunk if we encounter one.
-    this->makeChunksFromDir(in_Path, "", in_sChunkPrefix);
+    this->makeChunksFromDir(in_Path, in_sChunkPrefix);
 
     // Another log.
-    FTSMSGDBG("Done loading the archive with "+String::nr(this->getChunkCount())+" chunks.", 2);
+    FTSMSGDBG("Done loading the archive with {1} chunks.", 2, this->getChunkCount());
 }
 
-void FTS::Archive::makeChunksFromDir(const Path& in_Path, const Path& in_sSubdir, const String &in_sChunkPrefix)
+/** Collects all files that are in a directory and all of its subdirectories.
+ *
+ * \param in_Path The directory to look into.
+ * \param in_sSubdir The path of that directory relative to the archive's root.
+ * \param out_files Every file found is appended to this, as pair of its path
+ *                  and the name of the chunk it will become.
+ */
+static void listFilesInDir(const Path& in_Path, const Path& in_sSubdir, std::vector< std::pair<Path, Path> >& out_files)
 {
     for(auto& p : fs::directory_iterator(in_Path.c_str())) {
         if(fs::is_directory(p.path())) {
             // If it is a directory, recurse into it.
-            this->makeChunksFromDir(Path(p.path().string()), in_sSubdir + Path(p.path().filename().string()), in_sChunkPrefix);
+            listFilesInDir(Path(p.path().string()), in_sSubdir + Path(p.path().filename().string()), out_files);
         }  else {
-            // It is most probably a file, create a chunk for it.
-            Chunk* pChunk = new FileChunk(File::open(Path(p.path().string()), File::Insert), in_sSubdir + Path(p.path().filename().string()));
-            pChunk->prefix(in_sChunkPrefix);
-            m_mChunks[pChunk->getName()] = pChunk;
+            // It is most probably a file.
+            out_files.push_back(std::make_pair(Path(p.path().string()), in_sSubdir + Path(p.path().filename().string())));
         }
     }
 }
 
+/** Creates a chunk for every file in a directory and its subdirectories.\n
+ *  Reading and compressing the files is done as jobs of the \a JobSystem, in
+ *  up to \a m_nWorkerThreads ranges, but the resulting archive does not
+ *  depend on how the work is split.
+ *
+ * \param in_Path The directory to read the chunks from.
+ * \param in_sChunkPrefix A prefix to give all chunk's names.
+ *
+ * \exception ArkanaException Any exception that may be thrown by the \a File
+ *                            methods, for the first file that fails. No chunk
+ *                            is added to the archive in that case.
+ */
+void FTS::Archive::makeChunksFromDir(const Path& in_Path, const String &in_sChunkPrefix)
+{
+    std::vector< std::pair<Path, Path> > files;
+    listFilesInDir(in_Path, "", files);
+
+    // The factory must exist before the threads use it.
+    CompressorFactory::getSingleton();
+
+    // Each job only ever touches its own slots.
+    std::vector<Chunk*> chunks(files.size(), nullptr);
+    try {
+        parallelForRanges(files.size(), rangeGrain(files.size(), m_nWorkerThreads), [&](std::size_t in_iBegin, std::size_t in_iEnd) {
+            for(std::size_t i = in_iBegin ; i < in_iEnd ; ++i) {
+                chunks[i] = new FileChunk(File::open(files[i].first, File::Insert), files[i].second);
+            }
+        });
+    } catch(...) {
+        for(Chunk* pChunk : chunks) {
+            SAFE_DELETE(pChunk);
+        }
+        throw;
+    }
+
+    for(Chunk* pChunk : chunks) {
+        pChunk->prefix(in_sChunkPrefix);
+        this->insertChunk(pChunk);
+    }
+}
+
 /** Constructs an archive object, reading every chunk out of the given file.\n
  *
  * \param in_sFileName The name of the file to be opened and read from. This name
@@ -445,6 +914,11 @@ Archive *Archive::loadArchive(const Path &in_sFileName, const String &in_sChunkP
     if(FTS::FileUtils::dirExists(in_sFileName)) {
         return new Archive(in_sFileName, in_sChunkPrefix);
     } else {
+        // Indexed archives on the disk only need their index to be read now.
+        Archive *pArch = Archive::loadIndexedArchive(in_sFileName, in_sChunkPrefix);
+        if(pArch != NULL)
+            return pArch;
+
         File::Ptr f = File::open(in_sFileName, File::Read);
         return new Archive(*f, in_sChunkPrefix);
     }
@@ -505,10 +979,14 @@ bool Archive::isValidArchive(File& out_file)
 
     // Read out the header.
     String sID = out_file.readstr();
-    // skip version
-    out_file.readi8();
+    int8_t version = out_file.readi8();
     uint32_t uiFletcher32 = out_file.readui32();
 
+    // Version 2 archives only have a checksum over their table of contents.
+    if(version == FormatV2) {
+        out_file.setCursorPos(uiOrigCursorPos + out_file.readui64());
+    }
+
     // Check for validity.
     if(out_file.eof() || sID != "FTSARC") {
         return false;
@@ -526,6 +1004,19 @@ bool Archive::isValidArchive(File& out_file)
     return true;
 }
 
+/** Reads the payload of every chunk that has not been read yet. This is
+ *  needed before the archive file is overwritten, as chunks of indexed archives
+ *  read their payload from it only when they are first used.
+ *
+ * \exception ArkanaException Anything the chunks may throw while reading.
+ */
+void Archive::load() const
+{
+    for(ChunkMap::const_iterator i = m_mChunks.begin() ; i != m_mChunks.end() ; ++i) {
+        i->second->load();
+    }
+}
+
 /// Unloads all the content of the archive, resulting in the archive being empty.
 void Archive::unload()
 {
@@ -539,6 +1030,7 @@ void Archive::unload()
         SAFE_DELETE(i->second);
     }
     m_mChunks.clear();
+    m_mChunksByHash.clear();
 
     m_pOrigComp.reset(new NoCompressor);
 }
@@ -552,13 +1044,27 @@ Archive::~Archive()
 /** This saves the whole archive into a file object. No whole-archive compression
  *  gets done, but if for example one file-chunk was compressed on-disk, it gets
  *  compressed again in the archive, this happens in this method, thus the
- *  method may be slow if there are some big compressed chunks in it.
+ *  method may be slow if there are some big compressed chunks in it.\n
+ *  The archive is written in the format returned by \a getFormatVersion.
  *
  * \param out_file The file to write the archive to.
  *
  * \return a reference to this, allowing chaining.
  */
 const Archive& Archive::save(File &out_file) const
+{
+    if(m_uiFormatVersion == FormatV1) {
+        this->saveV1(out_file);
+    } else {
+        this->saveV2(out_file);
+    }
+
+    return *this;
+}
+
+/// Writes the archive in the version 1 format.
+/// \param out_file The file to write the archive to.
+void Archive::saveV1(File &out_file) const
 {
     // We write the header with a dummy fletcher sum and keep the position of
     // that dummy fletcher sum in our mind.
@@ -567,20 +1073,19 @@ const Archive& Archive::save(File &out_file) const
     uint64_t uiCursorPosFletcher = out_file.getCursorPos();
     out_file.write(static_cast<uint32_t>(12345)); // Dummy fletcher sum.
 
-    // Now we keep in mind where the payload (over which the sum is done) began.
-    uint64_t uiCursorPosBefore = out_file.getCursorPos();
-
-    // And now write the payload (all the chunks).
+    // And now write the payload (all the chunks). The fletcher sum is done
+    // over each chunk right after it has been written, while it is still in
+    // the cache, instead of going over all of them again at the end.
+    Fletcher32 fletcher;
     for(ChunkMap::const_iterator i = this->begin() ; i != this->end() ; ++i) {
+        uint64_t uiCursorPosBefore = out_file.getCursorPos();
         out_file.write(m_factory.getChunkID(i->second));
         i->second->write(out_file);
+        fletcher.update(out_file.getDataContainer().getData() + uiCursorPosBefore, static_cast<size_t>(out_file.getCursorPos() - uiCursorPosBefore));
     }
 
-    // Now go back at the front of the payload and calculate the fletcher sum.
-    // But keep the end of our payload in mind.
     uint64_t uiCursorPosEnd = out_file.getCursorPos();
-    out_file.setCursorPos(uiCursorPosBefore);
-    uint32_t uiFletcher32 = out_file.fletcher32FromCursor();
+    uint32_t uiFletcher32 = fletcher.finalize();
 
     // Go overwrite the dummy fletcher with the correct one.
     out_file.setCursorPos(uiCursorPosFletcher);
@@ -588,8 +1093,75 @@ const Archive& Archive::save(File &out_file) const
 
     // Go back at the end .. that's all, folks!
     out_file.setCursorPos(uiCursorPosEnd);
+}
 
-    return *this;
+/// Writes the archive in the version 2 format.
+/// \param out_file The file to write the archive to.
+void Archive::saveV2(File &out_file) const
+{
+    // We write the header with a dummy fletcher sum and index position and keep
+    // their position in our mind.
+    uint64_t uiCursorPosStart = out_file.getCursorPos();
+    out_file.write("FTSARC");
+    out_file.write(static_cast<uint8_t>(FormatV2));
+    uint64_t uiCursorPosFletcher = out_file.getCursorPos();
+    out_file.write(static_cast<uint32_t>(12345)); // Dummy fletcher sum.
+    out_file.write(static_cast<uint64_t>(0)); // Dummy index position.
+
+    // The chunks are written just like in version 1, but we take note of
+    // where each chunk's payload is.
+    std::vector<ChunkIndexEntry> entries;
+    for(ChunkMap::const_iterator i = this->begin() ; i != this->end() ; ++i) {
+        ChunkIndexEntry entry;
+        entry.uiChunkType = m_factory.getChunkID(i->second);
+        out_file.write(entry.uiChunkType);
+        i->second->write(out_file);
+
+        entry.sName = i->second->getName();
+        entry.uiNameHash = ChunkIndexEntry::hashName(entry.sName);
+        entry.uiSize = i->second->getPayloadLength();
+        entry.uiOffset = out_file.getCursorPos() - entry.uiSize - uiCursorPosStart;
+        entries.push_back(entry);
+    }
+
+    // Once all is written, the data doesn't move anymore and the payloads'
+    // checksums and compressors can be found out in parallel.
+    const uint8_t *pData = out_file.getDataContainer().getData() + uiCursorPosStart;
+    const CompressorFactory& factory = CompressorFactory::getSingleton();
+    parallelForRanges(entries.size(), rangeGrain(entries.size(), m_nWorkerThreads), [&](std::size_t in_iBegin, std::size_t in_iEnd) {
+        for(std::size_t i = in_iBegin ; i < in_iEnd ; ++i) {
+            ConstRawDataContainer payload(pData + entries[i].uiOffset, static_cast<size_t>(entries[i].uiSize));
+            entries[i].uiFletcher32 = payload.fletcher32();
+            entries[i].sCompressor = factory.determine(&payload)->getName();
+        }
+    });
+
+    // Now comes the table of contents.
+    uint64_t uiCursorPosIndex = out_file.getCursorPos();
+    out_file.write(static_cast<uint64_t>(entries.size()));
+    for(const ChunkIndexEntry& entry : entries) {
+        out_file.write(entry.uiNameHash);
+        out_file.write(entry.uiChunkType);
+        out_file.write(entry.uiOffset);
+        out_file.write(entry.uiSize);
+        out_file.write(entry.sCompressor);
+        out_file.write(entry.uiFletcher32);
+        out_file.write(entry.sName);
+    }
+
+    // The fletcher sum only protects the table of contents, the payloads
+    // are protected by their own sums.
+    uint64_t uiCursorPosEnd = out_file.getCursorPos();
+    out_file.setCursorPos(uiCursorPosIndex);
+    uint32_t uiFletcher32 = out_file.fletcher32FromCursor();
+
+    // Go overwrite the dummy values with the correct ones.
+    out_file.setCursorPos(uiCursorPosFletcher);
+    out_file.getWriter()->overwrite(uiFletcher32);
+    out_file.getWriter()->overwrite(uiCursorPosIndex - uiCursorPosStart);
+
+    // Go back at the end .. that's all, folks!
+    out_file.setCursorPos(uiCursorPosEnd);
 }
 
 /** This saves the whole archive on the disk. The file is being compressed using
@@ -607,6 +1179,9 @@ const Archive& Archive::save(File &out_file) const
  */
 const Archive& Archive::save() const
 {
+    // Lazy chunks still need to read from the file we are about to overwrite.
+    this->load();
+
     File::Ptr pFile = File::overwrite(this->getName(), File::Insert);
     this->save(*pFile);
     pFile->save(this->getOriginalCompressor());
@@ -668,6 +1243,62 @@ bool Archive::hasChunk(const String& in_sName) const
     return m_mChunks.find(in_sName) != m_mChunks.end();
 }
 
+/** This returns a chunk of the archive, without comparing any strings.
+ *
+ * \param in_name The name of the chunk you want to get from the archive.
+ *
+ * \return The chunk that has the given name. If there is no chunk with that
+ *         name, NULL is returned.
+ */
+const Chunk *Archive::getChunk(const Name &in_name) const
+{
+    return this->findChunk(in_name);
+}
+
+/** This returns a chunk of the archive, without comparing any strings.
+ *
+ * \param in_name The name of the chunk you want to get from the archive.
+ *
+ * \return The chunk that has the given name. If there is no chunk with that
+ *         name, NULL is returned.
+ */
+Chunk *Archive::getChunk(const Name &in_name)
+{
+    return this->findChunk(in_name);
+}
+
+bool Archive::hasChunk(const Name& in_name) const
+{
+    return this->findChunk(in_name) != NULL;
+}
+
+/// Puts a chunk into both the map and the index by name, replacing a chunk
+/// with the same name (without deleting it).
+/// \param in_pChunk The chunk to put into the archive.
+void Archive::insertChunk(Chunk *in_pChunk)
+{
+    auto inserted = m_mChunks.insert(std::make_pair(in_pChunk->getName(), in_pChunk));
+    if(inserted.second) {
+        m_mChunksByHash.insert(std::make_pair(cstring_hash()(inserted.first->first), inserted.first));
+    } else {
+        inserted.first->second = in_pChunk;
+    }
+}
+
+/// Looks a chunk up by the precomputed hash of a name, only comparing the
+/// names of chunks with the same hash.
+/// \param in_name The name of the chunk to look for.
+/// \return The chunk with that name, NULL if there is none.
+Chunk *Archive::findChunk(const Name& in_name) const
+{
+    auto range = m_mChunksByHash.equal_range(in_name.hash());
+    for(auto i = range.first ; i != range.second ; ++i) {
+        if(i->second->first == in_name.str())
+            return i->second->second;
+    }
+    return NULL;
+}
+
 /// \return the total number of file chunks stored in the archive.
 uint64_t Archive::getFileCount() const
 {
@@ -727,6 +1358,22 @@ Chunk *Archive::take(const String &in_sChunkName)
 
     // Take it out of the map and then return it.
     Chunk *pChunk = i->second;
+#ifndef D_FILE_NO_ARCHMAP
+    // The files in it can't be opened through me anymore, and whoever is
+    // still loading it has to be done before the caller may delete it.
+    {
+        std::unique_lock<std::mutex> lock(File::m_vfsMutex);
+        File::m_vfs.removeChunk(this, in_sChunkName);
+        File::waitForVFSLoads(lock);
+    }
+#endif
+    auto range = m_mChunksByHash.equal_range(cstring_hash()(in_sChunkName));
+    for(auto j = range.first ; j != range.second ; ++j) {
+        if(j->second == i) {
+            m_mChunksByHash.erase(j);
+            break;
+        }
+    }
     m_mChunks.erase(i);
     return pChunk;
 }
@@ -766,7 +1413,14 @@ int Archive::give(Chunk *in_pChunk, bool in_bReplace)
         }
     }
 
-    m_mChunks[in_pChunk->getName()] = in_pChunk;
+    this->insertChunk(in_pChunk);
+#ifndef D_FILE_NO_ARCHMAP
+    // If I'm one of the archives to look in, the new file can be opened now.
+    if(FileChunk *pFileChunk = dynamic_cast<FileChunk *>(in_pChunk)) {
+        std::lock_guard<std::mutex> lock(File::m_vfsMutex);
+        File::m_vfs.addChunk(this, pFileChunk);
+    }
+#endif
     return ERR_OK;
 }
 
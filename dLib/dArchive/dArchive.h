@@ -4,15 +4,42 @@
 #include "main.h"
 
 #include <map>
+#include <unordered_map>
 #include <list>
+#include <vector>
+#include <memory>
+#include <mutex>
 
 #include "dLib/dString/dString.h"
+#include "dLib/dString/dName.h"
 #include "dLib/dFile/dFile.h"
 #include "dLib/dFile/dBrowse.h"
 
 namespace FTS {
     class StreamedDataContainer;
 
+/// One entry of the table of contents that is stored at the end of an FTSARC
+/// version 2 archive. It describes where to find a chunk's payload, so the
+/// payload only needs to be read when it is really used.
+struct ChunkIndexEntry {
+    /// The hash of the chunk's name, see \a ChunkIndexEntry::hashName.
+    uint32_t uiNameHash = 0;
+    /// The chunktype ID, as given by the \a ChunkFactory.
+    uint8_t uiChunkType = 0;
+    /// Position of the payload, relative to the beginning of the archive.
+    uint64_t uiOffset = 0;
+    /// The length of the payload, in bytes.
+    uint64_t uiSize = 0;
+    /// The name of the compressor the payload is compressed with.
+    String sCompressor;
+    /// The fletcher32 checksum of the payload alone.
+    uint32_t uiFletcher32 = 0;
+    /// The (unprefixed) name of the chunk.
+    String sName;
+
+    static uint32_t hashName(const String& in_sName);
+};
+
 /// This is the base class for any chunk. It is used to read a chunk's header
 /// that is the same for all chunks.
 class Chunk {
@@ -39,9 +66,15 @@ public:
     virtual String getTypeName() const = 0;
 
     virtual int read(File &out_f);
+    virtual int readIndexed(const ChunkIndexEntry& in_entry);
     virtual int execute(const String &in_sNewChunkname = String::EMPTY) = 0;
     virtual int write(File &out_f);
 
+    /// Makes sure the chunk's payload is in memory. Chunks of indexed archives
+    /// only read their payload the first time it is needed.
+    /// \return ERR_OK on success, an error code < 0 on failure.
+    virtual int load() {return ERR_OK;};
+
     String getName() const;
     String prefix(const String &in_sChunkPrefix);
     uint64_t getPayloadLength() const;
@@ -67,12 +100,27 @@ public:
 /// contains a whole file (compressed or uncompressed). The whole path of the
 /// file is stored in the chunk name.
 class FileChunk : public Chunk {
-    /// The raw chunk content.
-    RawDataContainer *m_pRawContent;
+    /// The raw chunk content. NULL as long as a lazy chunk is not loaded.
+    /// Files opened from the chunk share it, it is never modified but replaced.
+    mutable std::shared_ptr<const RawDataContainer> m_pRawContent;
 
     /// The content of the file.
     mutable File::Ptr m_pFileCache;
 
+    /// The archive file on disk to read the payload from when it is first
+    /// needed. Empty if the payload is already in memory.
+    mutable Path m_sLazySource;
+    /// Where the payload lies within \a m_sLazySource.
+    uint64_t m_uiLazyOffset = 0;
+    /// The checksum the payload has to match once it is read.
+    uint32_t m_uiLazyFletcher32 = 0;
+    /// Files of registered archives may be opened from several threads, they
+    /// must not read the payload or make \a m_pFileCache at the same time.
+    mutable std::mutex m_lazyMutex;
+
+    void loadLazy() const;
+    void loadLazyLocked() const;
+
 public:
     FileChunk();
     FileChunk(File::Ptr in_pFile, const String& in_sChunkName = String::EMPTY);
@@ -81,16 +129,22 @@ public:
     virtual String getTypeName() const {return "FileChunk";};
 
     virtual int read(File &out_f);
+    virtual int readIndexedPayload(const ChunkIndexEntry& in_entry, const ConstRawDataContainer& in_payload);
+    virtual int readLazy(const ChunkIndexEntry& in_entry, const Path& in_sArchiveFile);
     virtual int give(File::Ptr in_pFile, const String& in_sChunkName = String::EMPTY);
     virtual int execute(const String &in_sNewChunkname = String::EMPTY);
     virtual int write(File &out_f);
+    virtual int load();
+
+    /// \return Whether the payload still has to be read from the archive file.
+    inline bool isLazy() const {return !m_sLazySource.empty();};
 
     operator FTS::File&();
     FTS::File &getFile();
     ConstRawDataContainer getContents() const;
 
 protected:
-    virtual RawDataContainer *getRawContent() {return m_pRawContent;};
+    virtual std::shared_ptr<const RawDataContainer> getRawContent();
     friend class File;
 };
 
@@ -126,9 +180,23 @@ public:
     typedef std::map<String, Chunk*> ChunkMap;
     typedef std::unique_ptr<Archive> Ptr;
 
+    /// The original format: a single checksum over all chunks, which are read
+    /// one after the other.
+    static const uint8_t FormatV1 = 1;
+    /// Like \a FormatV1, but with a table of contents at the end of the file
+    /// and a checksum per chunk. Chunks are only read when needed.
+    static const uint8_t FormatV2 = 2;
+    /// The format new archives are written in.
+    static const uint8_t CurrentFormat = FormatV2;
+
 private:
-    /// All chunks are stored in this map.
+    /// All chunks are stored in this map. It is sorted by name so that the
+    /// archive is always written the same way.
     ChunkMap m_mChunks;
+    /// The same chunks as in \a m_mChunks, by the hash of their name, for
+    /// looking them up by \a Name. The chunk names themselves aren't interned,
+    /// as there is no end to the chunks of all the archives ever opened.
+    std::unordered_multimap<std::size_t, ChunkMap::iterator> m_mChunksByHash;
 
     /// Factory to create the chunks.
     static ChunkFactory m_factory;
@@ -139,11 +207,27 @@ private:
     /// The original file I was loaded from.
     Path m_sFileName;
 
+    /// The format version the archive will be saved in.
+    uint8_t m_uiFormatVersion = CurrentFormat;
+
+    /// In how many jobs to split loading directories and saving at most, 0 lets
+    /// the job system decide.
+    static std::size_t m_nWorkerThreads;
+
     Archive(File& out_file, const String& in_sFileChunkPrefix = String::EMPTY);
     Archive(const Path& in_sFileName, Compressor* in_pComp = nullptr);
     Archive(const Path& in_Path, const String& in_sChunkPrefix);
 
-    void makeChunksFromDir(const Path& in_Path, const Path& in_sSubdir, const String& in_sChunkPrefix);
+    void makeChunksFromDir(const Path& in_Path, const String& in_sChunkPrefix);
+    void insertChunk(Chunk *in_pChunk);
+    Chunk *findChunk(const Name& in_name) const;
+    void readV1(File& out_file, const String& in_sChunkPrefix);
+    void readV2(File& out_file, uint64_t in_uiStart, const String& in_sChunkPrefix);
+    void saveV1(File& out_file) const;
+    void saveV2(File& out_file) const;
+
+    static Archive* loadIndexedArchive(const Path& in_sFileName, const String& in_sChunkPrefix);
+    static bool readIndex(ReadableStream& in_index, std::vector<ChunkIndexEntry>& out_entries);
 
 public:
     static Archive* createEmptyArchive(const Path& in_sFileName, Compressor* in_pComp = nullptr);
@@ -152,12 +236,26 @@ public:
     static bool isValidArchive(const String& in_sFileName);
     static bool isValidArchive(File& out_file);
 
+    /// \param in_nThreads How many threads to use at most while reading a
+    ///                    directory into an archive or saving an archive, as
+    ///                    the work is split into that many jobs at most. 0
+    ///                    lets the \a JobSystem decide. The result is the same
+    ///                    for any number of threads.
+    static inline void setWorkerThreads(std::size_t in_nThreads) {m_nWorkerThreads = in_nThreads;};
+    /// \return How many threads to use at most, 0 lets the job system decide.
+    static inline std::size_t getWorkerThreads() {return m_nWorkerThreads;};
+
     virtual ~Archive();
 
     const Archive& save(File& out_file) const;
     const Archive& save() const;
     inline Compressor& getOriginalCompressor() const {return *m_pOrigComp;};
     inline Path getName() const {return m_sFileName;};
+    /// \return The format version the archive has been loaded in and will be saved in.
+    inline uint8_t getFormatVersion() const {return m_uiFormatVersion;};
+    /// \param in_uiVersion The format version to use during the next \a save.
+    inline void setFormatVersion(uint8_t in_uiVersion) {m_uiFormatVersion = in_uiVersion;};
+    void load() const;
     void unload();
     int execute();
 
@@ -169,6 +267,9 @@ public:
     const Chunk* getChunk(const String& in_sName) const;
     Chunk* getChunk(const String& in_sName);
     bool hasChunk(const String& in_sName) const;
+    const Chunk* getChunk(const Name& in_name) const;
+    Chunk* getChunk(const Name& in_name);
+    bool hasChunk(const Name& in_name) const;
 
     uint64_t getFileCount() const;
     std::list<String> getFileList() const;
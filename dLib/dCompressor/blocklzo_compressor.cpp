@@ -0,0 +1,413 @@
+/**
+ * \file blocklzo_compressor.cpp
+ * \brief This file contains the implementation of the block-parallel LZO
+ *        compressor.
+ **/
+
+#include "blocklzo_compressor.h"
+#include "logging/logger.h"
+#include "logging/Chronometer.h"
+#include "main/JobSystem.h"
+#include "utilities/StreamedDataContainer.h"
+#include "utilities/DataContainer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+using namespace FTS;
+
+/// Set in the compressed size of a block that is stored without compression.
+#define D_BLOCKLZO_STORED 0x80000000u
+
+/// The maximum size LZO may need to compress a block of the given size.
+#define D_BLOCKLZO_WORST_CASE(size) ((size) + (size) / 16 + 64 + 3)
+
+bool BlockLZOCompressor::m_bMiniLZOInited = false;
+
+/** Creates a block compressor.
+ *
+ * \param in_uiBlockSize The size of the uncompressed blocks. Smaller blocks
+ *                       give more parallelism and cheaper random access,
+ *                       bigger blocks a better compression.
+ * \param in_nThreads In how many jobs to split the blocks at most, so that
+ *                    at most that many threads work on them. 0 lets the
+ *                    job system decide.
+ */
+BlockLZOCompressor::BlockLZOCompressor(std::uint32_t in_uiBlockSize, unsigned int in_nThreads)
+    : m_uiBlockSize(std::min<std::uint32_t>(std::max<std::uint32_t>(in_uiBlockSize, 1), D_BLOCKLZO_STORED / 2))
+    , m_nThreads(in_nThreads)
+{
+    // Only initialise the miniLZO once.
+    if(!m_bMiniLZOInited) {
+        if(lzo_init() != LZO_E_OK) {
+            throw SyscallException("lzo_init", MsgType::Horror);
+        } else {
+            m_bMiniLZOInited = true;
+        }
+    }
+}
+
+/// Default destructor.
+BlockLZOCompressor::~BlockLZOCompressor()
+{
+}
+
+/// \return The string that should be at the beginning of every data that is
+///         compressed using this compressor.
+String BlockLZOCompressor::getHeaderID() const
+{
+    return "FTSBLZ";
+}
+
+/// \return The name of this compressor.
+String BlockLZOCompressor::getName() const
+{
+    return "BlockLZO";
+}
+
+/// \return A quick description and credits of this compressor.
+String BlockLZOCompressor::getDescription() const
+{
+    return "MiniLZO on independent blocks, (de)compressed in parallel. MiniLZO is written by Markus Franz Xaver Johannes Oberhumer";
+}
+
+/// This method checks if a DataContainer contains data that may be compressed
+/// using this compressor.
+/// \param in_pData A pointer to the DataContainer that has to be checked.
+/// \return true if the data may be compressed using this compressor, false else.
+bool BlockLZOCompressor::isMyType(const DataContainer * const in_pData) const
+{
+    if(in_pData == NULL || in_pData->getData() == NULL) {
+        return false;
+    }
+
+    StreamedConstDataContainer scdc(in_pData);
+    String sDataBegin = scdc.readstr();
+    return this->getHeaderID() == sDataBegin && !scdc.eod();
+}
+
+/** Runs some work for every block, as jobs of the \a JobSystem. The blocks
+ *  are split into at most \a m_nThreads ranges of consecutive blocks. Without
+ *  a job system, all blocks are done on the calling thread.
+ *
+ * \param in_nBlocks The number of blocks to work on.
+ * \param in_uiScratchSize The size of some scratch memory every range gets,
+ *                         to give to the work. May be 0.
+ * \param in_work What to do with a block. Gets the index of the block and the
+ *                scratch memory of the range it is in.
+ */
+void BlockLZOCompressor::forEachBlock(std::size_t in_nBlocks, std::size_t in_uiScratchSize, const std::function<void(std::size_t, void *)>& in_work) const
+{
+    parallelForRanges(in_nBlocks, rangeGrain(in_nBlocks, m_nThreads), [&](std::size_t in_iBegin, std::size_t in_iEnd) {
+        // LZO doesn't need its working memory to be cleared, so every range
+        // just gets its own.
+        std::unique_ptr<lzo_align_t[]> pScratch;
+        if(in_uiScratchSize > 0)
+            pScratch.reset(new lzo_align_t[(in_uiScratchSize + sizeof(lzo_align_t) - 1) / sizeof(lzo_align_t)]);
+
+        for(std::size_t i = in_iBegin ; i < in_iEnd ; ++i) {
+            in_work(i, pScratch.get());
+        }
+    });
+}
+
+/** Reads and checks the header and the block index of compressed data.
+ *
+ * \param out_frame Receives the header and the block index.
+ * \param in_pData The compressed data.
+ *
+ * \exception CorruptDecompressionDataException if the header or the index is
+ *            broken or the data is too short for the blocks it should contain.
+ */
+void BlockLZOCompressor::readFrame(Frame& out_frame, const DataContainer * const in_pData) const
+{
+    // Check the header ID.
+    StreamedConstDataContainer scdc(in_pData);
+    if(in_pData == NULL || scdc.readstr() != this->getHeaderID()) {
+        m_sLastProblem = "Invalid header";
+        throw CorruptDecompressionDataException(this, MsgType::Error);
+    }
+
+    // The rest of the header has a fixed size.
+    if(scdc.getSizeTillEnd() < sizeof(uint8_t) + sizeof(uint64_t) + 2 * sizeof(uint32_t)) {
+        m_sLastProblem = "Unexpected end of data";
+        throw CorruptDecompressionDataException(this, MsgType::Error);
+    }
+
+    // Check the version.
+    if(scdc.read<uint8_t>() != 1) {
+        m_sLastProblem = "Unknown version";
+        throw CorruptDecompressionDataException(this, MsgType::Error);
+    }
+
+    out_frame.uiSize = scdc.read<uint64_t>();
+    out_frame.uiBlockSize = scdc.read<uint32_t>();
+    uint32_t nBlocks = scdc.read<uint32_t>();
+
+    // The number of blocks follows from the sizes, so it is a good check. The
+    // size isn't rounded up to whole blocks for that, a broken one overflows.
+    const uint64_t uiBlockSize = out_frame.uiBlockSize;
+    if(uiBlockSize == 0 || uiBlockSize >= D_BLOCKLZO_STORED
+    || (nBlocks == 0 && out_frame.uiSize != 0)
+    || (nBlocks != 0 && (out_frame.uiSize > nBlocks * uiBlockSize || out_frame.uiSize <= (nBlocks - 1) * uiBlockSize))
+    || static_cast<uint64_t>(nBlocks) * sizeof(uint32_t) > scdc.getSizeTillEnd()) {
+        m_sLastProblem = "Broken header";
+        throw CorruptDecompressionDataException(this, MsgType::Error);
+    }
+
+    out_frame.blocks.resize(nBlocks);
+    uint64_t uiOffset = 0;
+    for(uint32_t i = 0 ; i < nBlocks ; ++i) {
+        uint32_t uiEntry = scdc.read<uint32_t>();
+
+        Block& block = out_frame.blocks[i];
+        block.uiOffset = uiOffset;
+        block.bStored = (uiEntry & D_BLOCKLZO_STORED) != 0;
+        block.uiCompressedSize = uiEntry & ~D_BLOCKLZO_STORED;
+        block.uiSize = static_cast<uint32_t>(std::min<uint64_t>(out_frame.uiBlockSize, out_frame.uiSize - static_cast<uint64_t>(i) * out_frame.uiBlockSize));
+        uiOffset += block.uiCompressedSize;
+
+        if(block.bStored && block.uiCompressedSize != block.uiSize) {
+            m_sLastProblem = "Broken block index";
+            throw CorruptDecompressionDataException(this, MsgType::Error);
+        }
+    }
+
+    if(uiOffset > scdc.getSizeTillEnd()) {
+        m_sLastProblem = "Unexpected end of data";
+        throw CorruptDecompressionDataException(this, MsgType::Error);
+    }
+
+    out_frame.pBlockData = in_pData->getData() + scdc.getCursorPos();
+}
+
+/** Decompresses some consecutive blocks in parallel.
+ *
+ * \param out_pDest Where to write the decompressed blocks to. Must have
+ *                  enough room for all of them.
+ * \param in_frame The frame the blocks are in.
+ * \param in_iFirst The index of the first block to decompress.
+ * \param in_iLast The index of the last block to decompress.
+ *
+ * \return true if all went well, false if any of the blocks is broken.
+ */
+bool BlockLZOCompressor::decompressBlocks(std::uint8_t *out_pDest, const Frame& in_frame, std::size_t in_iFirst, std::size_t in_iLast) const
+{
+    if(in_iLast < in_iFirst)
+        return true;
+
+    std::atomic<bool> bBroken(false);
+    this->forEachBlock(in_iLast - in_iFirst + 1, 0, [&](std::size_t i, void *) {
+        const Block& block = in_frame.blocks[in_iFirst + i];
+        const uint8_t *pIn = in_frame.pBlockData + block.uiOffset;
+        uint8_t *pOut = out_pDest + i * static_cast<std::size_t>(in_frame.uiBlockSize);
+
+        if(block.bStored) {
+            std::memcpy(pOut, pIn, block.uiSize);
+            return;
+        }
+
+        lzo_uint uiOutSize = block.uiSize;
+        int r = lzo1x_decompress_safe(pIn, block.uiCompressedSize, pOut, &uiOutSize, NULL);
+        if(r != LZO_E_OK || uiOutSize != block.uiSize)
+            bBroken = true;
+    });
+
+    return !bBroken;
+}
+
+/// This method should automagically decompress all the data it gets.
+/// \param out_where A streamed data container where you want to put the
+///                 decompressed data into.
+/// \param in_pData The data that has to be decompressed.
+/// \exception CorruptDecompressionDataException for anything that went wrong.
+/// \note If an error occurs, \a out_where should be left intact.
+void BlockLZOCompressor::decompress(StreamedDataContainer& out_where, const DataContainer * const in_pData) const
+{
+    Frame frame;
+    this->readFrame(frame, in_pData);
+
+    // Debug output.
+    const float fInSzMB = static_cast<float>(in_pData->getSize())/(1024.0f*1024.0f);
+    const float fOutSzMB = static_cast<float>(frame.uiSize)/(1024.0f*1024.0f);
+    String sLog = "decompression of "+String::nr(in_pData->getSize())+" Bytes "
+                   "("+String::nr(fInSzMB, 2)+" MB) in "+String::nr(frame.blocks.size())+" blocks into "
+                   +String::nr(frame.uiSize)+" Bytes ("+String::nr(fOutSzMB, 2)+" MB)";
+    LoggingChronometer compChron(sLog, 3);
+
+    if(frame.uiSize == 0)
+        return;
+
+    // Allocate enough data for the uncompressed thing.
+    out_where.grow(frame.uiSize);
+
+    if(!this->decompressBlocks(out_where.getBufferInFrontOfCursor(), frame, 0, frame.blocks.size() - 1)) {
+        m_sLastProblem = "Broken data";
+        out_where.shrink(frame.uiSize); // Back into the original state!
+        throw CorruptDecompressionDataException(this, MsgType::Error);
+    }
+
+    // Move the cursor behind the uncompressed data.
+    out_where.moveCursor(frame.uiSize);
+
+    // Debug output.
+    compChron.measure();
+}
+
+/** Decompresses only a part of the data. Only the blocks that contain that
+ *  part are decompressed.
+ *
+ * \param out_where A streamed data container where you want to put the
+ *                  decompressed part into.
+ * \param in_pData The data that has to be decompressed.
+ * \param in_uiOffset Where the wanted part begins in the uncompressed data.
+ * \param in_uiSize How many bytes the wanted part has.
+ *
+ * \exception CorruptDecompressionDataException if the data is broken or the
+ *            wanted part lies (partly) outside of the uncompressed data.
+ * \note If an error occurs, \a out_where is left intact.
+ */
+void BlockLZOCompressor::decompressRange(StreamedDataContainer& out_where, const DataContainer * const in_pData, std::uint64_t in_uiOffset, std::uint64_t in_uiSize) const
+{
+    Frame frame;
+    this->readFrame(frame, in_pData);
+
+    if(in_uiOffset > frame.uiSize || in_uiSize > frame.uiSize - in_uiOffset) {
+        m_sLastProblem = "Range "+String::nr(in_uiOffset)+"+"+String::nr(in_uiSize)+" lies outside of the "+String::nr(frame.uiSize)+" Bytes of data";
+        throw CorruptDecompressionDataException(this, MsgType::Error);
+    }
+
+    if(in_uiSize == 0)
+        return;
+
+    std::size_t iFirst = static_cast<std::size_t>(in_uiOffset / frame.uiBlockSize);
+    std::size_t iLast = static_cast<std::size_t>((in_uiOffset + in_uiSize - 1) / frame.uiBlockSize);
+
+    // The part rarely starts and ends exactly on block boundaries, so inflate
+    // the blocks somewhere else first.
+    std::vector<uint8_t> blocks(static_cast<std::size_t>(iLast - iFirst + 1) * frame.uiBlockSize);
+    if(!this->decompressBlocks(&blocks[0], frame, iFirst, iLast)) {
+        m_sLastProblem = "Broken data";
+        throw CorruptDecompressionDataException(this, MsgType::Error);
+    }
+
+    const uint64_t uiSkip = in_uiOffset - static_cast<uint64_t>(iFirst) * frame.uiBlockSize;
+    out_where.insertNoEndian(&blocks[static_cast<std::size_t>(uiSkip)], static_cast<std::size_t>(in_uiSize));
+}
+
+/** Reads the size that some data compressed by this compressor has once
+ *  decompressed, without decompressing anything.
+ *
+ * \param in_pData The compressed data.
+ *
+ * \return The size of the data when decompressed.
+ *
+ * \exception CorruptDecompressionDataException if the header is broken.
+ */
+std::uint64_t BlockLZOCompressor::getDecompressedSize(const DataContainer * const in_pData) const
+{
+    Frame frame;
+    this->readFrame(frame, in_pData);
+    return frame.uiSize;
+}
+
+/// This method should automagically compress all the data it gets.
+/// \note This method stores some additional data (the header and the block
+///       index) in front of the compressed result, see the class description.
+/// \note If an error occurs, \a out_where should be left intact.
+/// \param out_where A streamed data container where the decompressed data
+///                  will be written behind the cursor. The cursor will be
+///                  placed right behind the compressed data.
+/// \param in_pData The data that has to be compressed.
+/// \note No exception will be thrown. It just never fails :)
+bool BlockLZOCompressor::compress(StreamedDataContainer& out_where, const DataContainer * const in_pData) const
+{
+    const uint64_t uiSize = in_pData->getSize();
+    const std::size_t nBlocks = static_cast<std::size_t>((uiSize + m_uiBlockSize - 1) / m_uiBlockSize);
+    // Small data doesn't need room for a whole block.
+    const std::size_t uiWorstCaseBlock = D_BLOCKLZO_WORST_CASE(static_cast<std::size_t>(std::min<uint64_t>(m_uiBlockSize, uiSize)));
+
+    // Debug output.
+    const float fInSzMB = static_cast<float>(uiSize)/(1024.0f*1024.0f);
+    String sLog = "compression of "+String::nr(uiSize)+" Bytes "
+                   "("+String::nr(fInSzMB, 2)+" MB) in "+String::nr(nBlocks)+" blocks";
+    LoggingChronometer compChron(sLog, 3);
+
+    // We write the ID into the first bytes and the version.
+    out_where.insert(this->getHeaderID());
+    out_where.insert(static_cast<uint8_t>(1));
+
+    // ... we write the real uncompressed data size into the next 8 bytes.
+    out_where.insert(uiSize);
+    out_where.insert(m_uiBlockSize);
+    out_where.insert(static_cast<uint32_t>(nBlocks));
+
+    // The block index is only known once all blocks are compressed. Reserve
+    // its room for now.
+    const uint64_t uiIndexPos = out_where.getCursorPos();
+    for(std::size_t i = 0 ; i < nBlocks ; ++i) {
+        out_where.insert(static_cast<uint32_t>(0));
+    }
+
+    if(nBlocks == 0) {
+        compChron.measure();
+        return false;
+    }
+
+    // Every block gets compressed into its own worst-case sized slot, so that
+    // all blocks can be compressed at the same time.
+    const uint64_t uiWorstCaseSize = static_cast<uint64_t>(nBlocks) * uiWorstCaseBlock;
+    out_where.grow(uiWorstCaseSize);
+    uint8_t *pOut = out_where.getBufferInFrontOfCursor();
+
+    std::vector<uint32_t> vEntries(nBlocks);
+    this->forEachBlock(nBlocks, LZO1X_1_MEM_COMPRESS, [&](std::size_t i, void *in_pWorkingMemory) {
+        const uint8_t *pIn = in_pData->getData() + i * static_cast<std::size_t>(m_uiBlockSize);
+        const lzo_uint uiBlockSize = static_cast<lzo_uint>(std::min<uint64_t>(m_uiBlockSize, uiSize - i * static_cast<uint64_t>(m_uiBlockSize)));
+        uint8_t *pSlot = pOut + i * uiWorstCaseBlock;
+
+        // The function CAN'T fail.
+        lzo_uint uiCompressedSize = static_cast<lzo_uint>(uiWorstCaseBlock);
+        lzo1x_1_compress(pIn, uiBlockSize, pSlot, &uiCompressedSize, in_pWorkingMemory);
+
+        // Incompressible blocks are stored as they are, it's faster to read.
+        if(uiCompressedSize >= uiBlockSize) {
+            std::memcpy(pSlot, pIn, uiBlockSize);
+            vEntries[i] = static_cast<uint32_t>(uiBlockSize) | D_BLOCKLZO_STORED;
+        } else {
+            vEntries[i] = static_cast<uint32_t>(uiCompressedSize);
+        }
+    });
+
+    // Now close the gaps between the blocks.
+    uint64_t uiCompressedSize = 0;
+    for(std::size_t i = 0 ; i < nBlocks ; ++i) {
+        const uint32_t uiBlockCompSize = vEntries[i] & ~D_BLOCKLZO_STORED;
+        std::memmove(pOut + uiCompressedSize, pOut + i * uiWorstCaseBlock, uiBlockCompSize);
+        uiCompressedSize += uiBlockCompSize;
+    }
+
+    // Fill in the block index and cut off the unused room.
+    const uint64_t uiDataPos = out_where.getCursorPos();
+    out_where.setCursorPos(uiIndexPos);
+    for(std::size_t i = 0 ; i < nBlocks ; ++i) {
+        out_where.overwrite(vEntries[i]);
+    }
+    out_where.setCursorPos(uiDataPos);
+    out_where.shrink(uiWorstCaseSize - uiCompressedSize);
+
+    // Move the cursor behind the compressed data.
+    out_where.moveCursor(uiCompressedSize);
+
+    // Debug output.
+    const float fOutSzMB = static_cast<float>(uiCompressedSize)/(1024.0f*1024.0f);
+    String sAddInfo = "into "+String::nr(uiCompressedSize)+" Bytes ("+String::nr(fOutSzMB, 2)+" MB)";
+    if(uiCompressedSize >= uiSize) {
+        sAddInfo = "INCOMPRESSIBLE DATA!" + sAddInfo;
+    }
+    compChron.measure(sAddInfo);
+
+    return uiCompressedSize < uiSize;
+}
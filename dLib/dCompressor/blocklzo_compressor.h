@@ -0,0 +1,101 @@
+/**
+ * \file blocklzo_compressor.h
+ * \brief This file contains the definition of the block-parallel LZO compressor.
+ **/
+
+#ifndef D_BLOCKLZO_COMPRESSOR_H
+#define D_BLOCKLZO_COMPRESSOR_H
+
+#include "dLib/dCompressor/dCompressor.h"
+#include "dLib/dCompressor/minilzo/minilzo.h"
+
+#include <vector>
+#include <functional>
+
+/// The size of the uncompressed blocks if nothing else is specified.
+#define D_BLOCKLZO_BLOCK_SIZE (256*1024)
+
+namespace FTS {
+
+/// This compressor uses the same LZO algorithm as the \a MiniLZOCompressor,
+/// but it cuts the data into blocks of a fixed size that are compressed
+/// independently of each other. This has two advantages:\n
+///  - All blocks are (de)compressed in parallel, as jobs of the \a JobSystem.
+///    Big archives and savegames are thus (de)compressed a lot faster.
+///  - A range of the data can be decompressed without decompressing all of
+///    it, see \a decompressRange.
+///
+/// The compressed data looks like this:
+///  - The header ID "FTSBLZ", the version (uint8) and the size of the data
+///    when uncompressed (uint64).
+///  - The size of the uncompressed blocks (uint32) and the number of blocks
+///    (uint32). All blocks have that size, except for the last one.
+///  - The block index: for every block, the size of its compressed data
+///    (uint32). If the highest bit is set, the block could not be compressed
+///    and is stored as-is.
+///  - The compressed data of every block, one after the other.
+class BlockLZOCompressor : public Compressor {
+    /// The size of the uncompressed blocks that are written by \a compress.
+    std::uint32_t m_uiBlockSize;
+
+    /// In how many jobs to split the blocks at most, 0 lets the job system decide.
+    unsigned int m_nThreads;
+
+    /// This is used to initialise the miniLZO library when the first object is
+    /// constructed.
+    static bool m_bMiniLZOInited;
+
+    /// A description of the last probem that occured.
+    mutable String m_sLastProblem;
+
+    /// Where to find one block in the compressed data.
+    struct Block {
+        /// Where the compressed block starts, relative to the compressed data.
+        std::uint64_t uiOffset;
+        /// The size of the compressed block.
+        std::uint32_t uiCompressedSize;
+        /// The size of the block once decompressed.
+        std::uint32_t uiSize;
+        /// Whether the block is stored as-is, without compression.
+        bool bStored;
+    };
+
+    /// Everything that is stored in front of the compressed blocks.
+    struct Frame {
+        std::uint64_t uiSize;
+        std::uint32_t uiBlockSize;
+        std::vector<Block> blocks;
+        /// Where the compressed data of the first block begins.
+        const std::uint8_t *pBlockData;
+    };
+
+    void readFrame(Frame& out_frame, const DataContainer * const in_pData) const;
+    bool decompressBlocks(std::uint8_t *out_pDest, const Frame& in_frame, std::size_t in_iFirst, std::size_t in_iLast) const;
+    void forEachBlock(std::size_t in_nBlocks, std::size_t in_uiScratchSize, const std::function<void(std::size_t, void *)>& in_work) const;
+
+protected:
+    virtual String getHeaderID() const;
+
+public:
+    BlockLZOCompressor(std::uint32_t in_uiBlockSize = D_BLOCKLZO_BLOCK_SIZE, unsigned int in_nThreads = 0);
+    virtual ~BlockLZOCompressor();
+
+    virtual String getName() const;
+    virtual String getDescription() const;
+    virtual String getLastProblem() const {return m_sLastProblem;};
+
+    virtual bool isMyType(const DataContainer * const in_pData) const;
+    virtual Compressor::Ptr copy() const {return Compressor::Ptr(new BlockLZOCompressor(m_uiBlockSize, m_nThreads));};
+
+    virtual void decompress(StreamedDataContainer& out_where, const DataContainer * const in_pData) const;
+    virtual bool compress(StreamedDataContainer& out_where, const DataContainer * const in_pData) const;
+
+    std::uint64_t getDecompressedSize(const DataContainer * const in_pData) const;
+    void decompressRange(StreamedDataContainer& out_where, const DataContainer * const in_pData, std::uint64_t in_uiOffset, std::uint64_t in_uiSize) const;
+
+    /// \return The size of the uncompressed blocks that are written by \a compress.
+    inline std::uint32_t getBlockSize() const {return m_uiBlockSize;};
+};
+};
+
+#endif // D_BLOCKLZO_COMPRESSOR_H
@@ -2,6 +2,7 @@
 
 #ifndef D_NOMINILZO
 #  include "dLib/dCompressor/minilzo_compressor.h"
+#  include "dLib/dCompressor/blocklzo_compressor.h"
 #endif
 
 #include "logging/logger.h"
@@ -56,8 +57,11 @@ CompressorFactory::CompressorFactory()
     m_pDefault = NULL;
 
 #ifndef D_NOMINILZO
+    // Older versions can't read block compressed data, so that stays opt-in
+    // through create("BlockLZO") until they are gone.
     m_pDefault = new MiniLZOCompressor;
     m_lpCompressors.push_back(m_pDefault);
+    m_lpCompressors.push_back(new BlockLZOCompressor);
 #endif
 
     // This one has to be the last in the list because it recognizes every data
@@ -12,6 +12,12 @@ ArkanaDefaultSettings::ArkanaDefaultSettings()
     add("MouseScrollSpeed", 75);
     add("KbdScrollSpeed", 50);
     add("DebugLevel", 1);
+    add("LogFlushInterval", 500);
+    add("PerfCountersCsv", "");
+    add("PerfCountersInterval", 1000);
+    add("SimulationHz", 0);
+    add("SimulationMaxSteps", 5);
+    add("SimulationThread", false);
     add("ModelDetails", 2);
     add("TextureFilter", 2);
     add("MenuBGMove", 0);
@@ -0,0 +1,85 @@
+#include "ConfigurationStore.h"
+
+#include "dLib/dConf/ArkanaDefaultSettings.h"
+
+using namespace FTS;
+
+ConfigurationStore::ConfigurationStore()
+{
+}
+
+ConfigurationStore::~ConfigurationStore()
+{
+}
+
+/** Gets the shared configuration of a file, reading it if this didn't happen yet.
+ *
+ * \param in_fileName The name of the configuration file, as given to the
+ *                    \a Configuration constructor.
+ * \param in_defaults The options and their default values. They are only used
+ *                    the first time the file is asked for.
+ * \param in_useUserPath Whether the file is in the user's configuration directory.
+ *
+ * \return The configuration of the file.
+ */
+Configuration::Ptr ConfigurationStore::get(const String& in_fileName, const DefaultOptions& in_defaults, bool in_useUserPath)
+{
+    Path sFile = Configuration::resolveFileName(in_fileName, in_useUserPath);
+    Configuration::Ptr pConf = this->find(sFile);
+    return pConf ? pConf : this->add(sFile, Configuration::Ptr(new Configuration(in_fileName, in_defaults, in_useUserPath)));
+}
+
+/// \return The shared configuration of the game, which is conf.xml.
+Configuration::Ptr ConfigurationStore::getMainConf()
+{
+    return this->get<ArkanaDefaultSettings>("conf.xml");
+}
+
+/** Tells the store that a configuration has been saved. If it is not the
+ *  shared one of its file, the shared one takes over the saved values.
+ *
+ * \param in_conf The configuration that has been saved.
+ */
+void ConfigurationStore::saved(const Configuration& in_conf)
+{
+    Configuration::Ptr pConf = this->find(in_conf.getFileName());
+    if(pConf != nullptr && pConf.get() != &in_conf) {
+        pConf->setValues(in_conf);
+    }
+}
+
+/** Removes the shared configuration of a file, so that it is read again the
+ *  next time it is asked for. Whoever still holds the old one keeps it, but
+ *  doesn't see any changes made to the new one.
+ *
+ * \param in_fileName The name of the configuration file.
+ * \param in_useUserPath Whether the file is in the user's configuration directory.
+ */
+void ConfigurationStore::forget(const String& in_fileName, bool in_useUserPath)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_confs.erase(Configuration::resolveFileName(in_fileName, in_useUserPath));
+}
+
+/// \return The shared configuration of the file, nullptr if it isn't loaded.
+Configuration::Ptr ConfigurationStore::find(const Path& in_sFile)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto i = m_confs.find(in_sFile);
+    return i == m_confs.end() ? nullptr : i->second;
+}
+
+/** Makes a freshly loaded configuration the shared one of its file. If some
+ *  other thread was faster, that one is kept instead.
+ *
+ * \param in_sFile The full path of the file.
+ * \param in_pConf The freshly loaded configuration.
+ *
+ * \return The shared configuration of the file.
+ */
+Configuration::Ptr ConfigurationStore::add(const Path& in_sFile, Configuration::Ptr in_pConf)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto i = m_confs.insert(std::make_pair(in_sFile, std::move(in_pConf)));
+    return i.first->second;
+}
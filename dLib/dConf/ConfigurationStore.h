@@ -0,0 +1,57 @@
+#ifndef D_CONFIGURATIONSTORE_H
+#define D_CONFIGURATIONSTORE_H
+
+#include "dLib/dConf/configuration.h"
+#include "utilities/Singleton.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace FTS {
+
+/// Keeps one shared \a Configuration per configuration file, so that every
+/// file is only read and parsed once, the first time it is needed. After that,
+/// getting an option is just a lookup of an already parsed value.\n
+/// Changes made to a shared configuration are seen by everyone right away and
+/// reported to its subscribers. They only go to the disk when it is saved.
+/// When some other \a Configuration of the same file is saved, the shared one
+/// takes over its values.\n
+/// The configurations are handed out as shared pointers, so they stay alive
+/// for whoever holds one, even after the store forgot about them.
+class ConfigurationStore : public LazySingleton<ConfigurationStore> {
+public:
+    ConfigurationStore();
+    virtual ~ConfigurationStore();
+
+    Configuration::Ptr get(const String& in_fileName, const DefaultOptions& in_defaults, bool in_useUserPath = true);
+
+    /// Like the other \a get, but the defaults are only created if the file
+    /// is not loaded yet.
+    /// \tparam TDefaults The \a DefaultOptions of the file.
+    template<class TDefaults>
+    Configuration::Ptr get(const String& in_fileName, bool in_useUserPath = true)
+    {
+        Path sFile = Configuration::resolveFileName(in_fileName, in_useUserPath);
+        Configuration::Ptr pConf = this->find(sFile);
+        return pConf ? pConf : this->add(sFile, Configuration::Ptr(new Configuration(in_fileName, TDefaults(), in_useUserPath)));
+    }
+
+    Configuration::Ptr getMainConf();
+
+    void saved(const Configuration& in_conf);
+    void forget(const String& in_fileName, bool in_useUserPath = true);
+
+private:
+    Configuration::Ptr find(const Path& in_sFile);
+    Configuration::Ptr add(const Path& in_sFile, Configuration::Ptr in_pConf);
+
+    /// Guards the map. The configurations in it lock themselves.
+    std::mutex m_mutex;
+    /// The shared configurations, by the full path of their file.
+    std::map<Path, Configuration::Ptr> m_confs;
+};
+
+}
+
+#endif // D_CONFIGURATIONSTORE_H
@@ -10,43 +10,75 @@
 #include "stdio.h"
 #include "stdlib.h"
 #include "configuration.h"
+#include "ConfigurationStore.h"
+
+#include <vector>
 
 namespace FTS
 {
 
+/// Parses a value once into everything it can be read as.
+Configuration::Value::Value ( const String& in_sValue )
+    : sValue ( in_sValue )
+{
+    // Same rules as reading it from a stream: it has to be all number.
+    char c = 0;
+    std::istringstream i ( in_sValue.str() );
+    long long iValue = 0;
+    bIsInt = ( i >> iValue ) && !i.get ( c );
+    this->iValue = iValue;
+
+    std::istringstream f ( in_sValue.str() );
+    bIsFloat = ( f >> dValue ) && !f.get ( c );
+
+    bIsBool = in_sValue == "True" || in_sValue == "False";
+    bValue = in_sValue == "True";
+}
+
 Configuration::Configuration ( const Options& in_options )
 {
-    m_opts = in_options;
+    for ( auto i = in_options.begin() ; i != in_options.end() ; ++i )
+        m_opts[i->first] = Value ( i->second );
     m_defaults = in_options;
 }
 
 Configuration::Configuration ( const FTS::DefaultOptions& in_defaults )
+    : Configuration ( in_defaults.getDefaults() )
 {
-    m_opts = in_defaults.getDefaults();
-    m_defaults = m_opts;
 }
 
 Configuration::Configuration ( File& in_file, const FTS::DefaultOptions& in_defaults )
+    : Configuration ( in_defaults.getDefaults() )
 {
-    m_opts = in_defaults.getDefaults() ;
-    m_defaults = m_opts;
     CEGUITinyXML::TiXmlDocument docConf;
     docConf.Parse((char*)in_file.getDataContainer().getData());
     parse ( docConf );
 }
 
-Configuration::Configuration ( const String& in_fileName, const DefaultOptions& in_defaults , bool in_useUserPath /*= true*/ )
+/** Finds out where a configuration file lives.
+ *
+ * \param in_fileName The name of the configuration file.
+ * \param in_useUserPath Whether it is in the user's configuration directory or
+ *                       relative to the user's directory.
+ *
+ * \return The full path to the file.
+ */
+Path Configuration::resolveFileName ( const String& in_fileName, bool in_useUserPath /*= true*/ )
 {
     if ( in_useUserPath )
     {
-        m_confFileName = Path::getUserConfPath() + Path ( in_fileName );
+        return Path::getUserConfPath() + Path ( in_fileName );
     }
     else
     {
-        m_confFileName = Path::userdir(in_fileName);
+        return Path::userdir(in_fileName);
     }
-    m_opts = in_defaults.getDefaults() ;
-    m_defaults = m_opts;
+}
+
+Configuration::Configuration ( const String& in_fileName, const DefaultOptions& in_defaults , bool in_useUserPath /*= true*/ )
+    : Configuration ( in_defaults.getDefaults() )
+{
+    m_confFileName = resolveFileName ( in_fileName, in_useUserPath );
     CEGUITinyXML::TiXmlDocument docConf ( m_confFileName.c_str() );
     if ( docConf.LoadFile() )
     {
@@ -76,14 +108,51 @@ void Configuration::parse ( CEGUITinyXML::TiXmlDocument& doc )
         const char * value = elem->Attribute ( "value" );
         if ( value != NULL )
         {
-            i->second = value;
+            i->second = Value ( value );
         }
     }
 }
 
+/// \return The value of the option \a in_optName. The caller has to hold
+///         \a m_mutex for as long as it uses the value.
+/// \exception CorruptDataException if there is no such option.
+const Configuration::Value& Configuration::value ( const String& in_optName ) const
+{
+    auto i = m_opts.find ( in_optName );
+    if ( i == m_opts.end() )
+        throw CorruptDataException(in_optName, "Unknown option name in Configuration::get<>()", MsgType::Horror);
+    return i->second;
+}
+
+/** Sets the value of an option, creating the option if it doesn't exist yet.
+ *  If this changes the value, everybody who subscribed to it gets notified.
+ *
+ * \param in_optName The name of the option to set.
+ * \param value The new value of the option.
+ */
 void Configuration::set ( String in_optName, String value )
 {
-    m_opts[in_optName] = value;
+    // A listener may get or set options or unsubscribe while being notified,
+    // so first collect them and notify them without holding the lock.
+    std::vector<Listener> listeners;
+    {
+        std::lock_guard<std::mutex> lock ( m_mutex );
+        auto i = m_opts.find ( in_optName );
+        if ( i != m_opts.end() && i->second.sValue == value )
+            return;
+
+        m_opts[in_optName] = Value ( value );
+
+        for ( auto l = m_listeners.begin() ; l != m_listeners.end() ; ++l )
+        {
+            if ( l->second.first.empty() || l->second.first == in_optName )
+                listeners.push_back ( l->second.second );
+        }
+    }
+    for ( auto l = listeners.begin() ; l != listeners.end() ; ++l )
+    {
+        (*l) ( in_optName );
+    }
 }
 
 void Configuration::set ( String in_optName, const char * value )
@@ -93,17 +162,60 @@ void Configuration::set ( String in_optName, const char * value )
 
 void Configuration::set ( String in_optName, int value )
 {
-    m_opts[in_optName] = String::nr ( value );
+    set ( in_optName, String::nr ( value ) );
 }
 
 void Configuration::set ( String in_optName, bool value )
 {
-    m_opts[in_optName] = String::b ( value );
+    set ( in_optName, String::b ( value ) );
 }
 
 void Configuration::set ( String in_optName, float value )
 {
-    m_opts[in_optName] = String::nr ( value );
+    set ( in_optName, String::nr ( value ) );
+}
+
+/** Calls a function every time the value of an option changes.
+ *
+ * \param in_optName The option to watch. If it is empty, every option is
+ *                   watched.
+ * \param in_listener The function to call with the name of the option, right
+ *                    after its value changed.
+ *
+ * \return An id to give to \a unsubscribe.
+ */
+std::size_t Configuration::subscribe ( const String& in_optName, Listener in_listener )
+{
+    std::lock_guard<std::mutex> lock ( m_mutex );
+    std::size_t id = m_nextListenerId++;
+    m_listeners[id] = std::make_pair ( in_optName, std::move ( in_listener ) );
+    return id;
+}
+
+/// Stops calling a function that has been given to \a subscribe.
+/// \param in_id What \a subscribe returned.
+void Configuration::unsubscribe ( std::size_t in_id )
+{
+    std::lock_guard<std::mutex> lock ( m_mutex );
+    m_listeners.erase ( in_id );
+}
+
+/// Takes over all values of another configuration, notifying about changes.
+/// \param in_other The configuration to take the values from.
+void Configuration::setValues ( const Configuration& in_other )
+{
+    std::map<String, Value> opts = in_other.values();
+    for ( auto i = opts.begin() ; i != opts.end() ; ++i )
+    {
+        this->set ( i->first, i->second.sValue );
+    }
+}
+
+/// \return A copy of all options, taken at once.
+std::map<String, Configuration::Value> Configuration::values() const
+{
+    std::lock_guard<std::mutex> lock ( m_mutex );
+    return m_opts;
 }
 
 void Configuration::save()
@@ -112,16 +224,21 @@ void Configuration::save()
     {
         return;
     }
+
+    // Whoever uses the shared configuration of this file needs to see this.
+    ConfigurationStore::getSingleton().saved ( *this );
+
     CEGUITinyXML::TiXmlDocument doc ( m_confFileName.c_str() );
     CEGUITinyXML::TiXmlHandle h ( &doc );
     CEGUITinyXML::TiXmlDeclaration * declaration = new CEGUITinyXML::TiXmlDeclaration ( "1.0", "UTF-8","" );
     doc.LinkEndChild ( declaration );
     CEGUITinyXML::TiXmlElement * root = new CEGUITinyXML::TiXmlElement ( m_confFileName.basename().withoutExt().c_str() );
 
-    for ( auto i = m_opts.begin() ; i != m_opts.end() ; ++i )
+    std::map<String, Value> opts = this->values();
+    for ( auto i = opts.begin() ; i != opts.end() ; ++i )
     {
         CEGUITinyXML::TiXmlElement * element = new CEGUITinyXML::TiXmlElement ( i->first.c_str() );
-        element->SetAttribute ( "value", i->second.c_str() );
+        element->SetAttribute ( "value", i->second.sValue.c_str() );
         CEGUITinyXML::TiXmlNode* node = root->LinkEndChild ( element );
     }
 
@@ -6,6 +6,11 @@
 #ifndef _CONFIGURATION_H
 #define _CONFIGURATION_H
 #include <sstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
 #include "dLib/dString/dPath.h"
 #include "dLib/dConf/DefaultOptions.h"
 #include "dLib/dFile/dFile.h"
@@ -13,45 +18,52 @@
 #include "dLib/dConf/ArkanaDefaultSettings.h"
 
 namespace FTS {
+    /// The options of one configuration file. A configuration may be shared
+    /// between threads, see \a ConfigurationStore, so all of its methods lock.
     class Configuration 
     {
         public:
+            typedef std::shared_ptr<Configuration> Ptr;
+
+            /// Gets called with the name of an option whose value has changed.
+            typedef std::function<void(const String& in_optName)> Listener;
+
             static Options buildFromFile(const Path& in_fileName);
+            static Path resolveFileName(const String& in_fileName, bool in_useUserPath = true);
             Configuration(File& in_file, const DefaultOptions& in_defaults );
             Configuration(const String& in_fileName, const DefaultOptions& in_defaults, bool in_useUserPath = true );
             Configuration(const Options& in_options); 
             Configuration ( const FTS::DefaultOptions& in_defaults );
             void save();
+            /// \return The file this configuration is saved to, empty if none.
+            const Path& getFileName() const { return m_confFileName; }
 
             template<class T, typename std::enable_if < (std::is_arithmetic<T>{} && !std::is_same<T, bool>{}), int > ::type = 0 >
-            T get(String in_optName)
+            T get(const String& in_optName) const
             {
+                // The value has already been parsed when it was set, only check
+                // whether it fits into what is asked for.
                 T ret;
-                std::istringstream i(get< std::string > (in_optName));
-                char c = 0;
-                if(!(i >> ret) || i.get(c))
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if(!convert(this->value(in_optName), ret, std::is_integral<T>{}))
                     throw CorruptDataException(in_optName, "Bad cast of option in Configuration::get<>()", MsgType::Horror);
                 return ret;
             }
             template<class T, typename std::enable_if < std::is_same<T, bool>{}, int > ::type = 0 >
-            T get(String in_optName)
+            T get(const String& in_optName) const
             {
-                auto v = get<std::string>(in_optName);
-                if(v == "True") {
-                    return true;
-                }
-                if(v == "False") {
-                    return false;
+                std::lock_guard<std::mutex> lock(m_mutex);
+                const Value& v = this->value(in_optName);
+                if(v.bIsBool) {
+                    return v.bValue;
                 }
                 throw CorruptDataException(in_optName, "Bad cast of option in Configuration::get<>()", MsgType::Horror);
             }
             template<class T, typename std::enable_if < std::is_same<T, std::string>{}, int > ::type = 0 >
-            T get(String in_optName)
+            T get(const String& in_optName) const
             {
-                if(m_opts.count(in_optName) != 0) {
-                    return m_opts[in_optName].str();
-                }
-                throw CorruptDataException(in_optName, "Unknown option name in Configuration::get<>()", MsgType::Horror);
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return this->value(in_optName).sValue.str();
             }
             
             void set(String in_optName, const char * value);
@@ -59,11 +71,57 @@ namespace FTS {
             void set(String in_optName, int value);
             void set(String in_optName, float value);
             void set(String in_optName, bool value);
+
+            std::size_t subscribe(const String& in_optName, Listener in_listener);
+            void unsubscribe(std::size_t in_id);
         private:
+            friend class ConfigurationStore;
+
+            /// An option's value, along with what it means as a number or a bool.
+            /// These are worked out once when the value is set, so that getting
+            /// a typed value doesn't need to parse anything.
+            struct Value {
+                Value() {}
+                explicit Value(const String& in_sValue);
+
+                String sValue;
+                bool bIsInt = false;
+                bool bIsFloat = false;
+                bool bIsBool = false;
+                int64_t iValue = 0;
+                double dValue = 0.0;
+                bool bValue = false;
+            };
+
+            template<class T>
+            static bool convert(const Value& in_v, T& out_val, std::true_type /*integral*/)
+            {
+                if(!in_v.bIsInt)
+                    return false;
+                if(in_v.iValue < 0 ? !std::is_signed<T>{} || in_v.iValue < static_cast<int64_t>(std::numeric_limits<T>::min())
+                                   : static_cast<uint64_t>(in_v.iValue) > static_cast<uint64_t>(std::numeric_limits<T>::max()))
+                    return false;
+                out_val = static_cast<T>(in_v.iValue);
+                return true;
+            }
+            template<class T>
+            static bool convert(const Value& in_v, T& out_val, std::false_type /*floating point*/)
+            {
+                out_val = static_cast<T>(in_v.dValue);
+                return in_v.bIsFloat;
+            }
+
+            const Value& value(const String& in_optName) const;
+            std::map<String, Value> values() const;
+            void setValues(const Configuration& in_other);
             void parse(CEGUITinyXML::TiXmlDocument& doc);
             Path m_confFileName;
-            Options m_opts;
+            /// Guards \a m_opts and the listeners.
+            mutable std::mutex m_mutex;
+            std::map<String, Value> m_opts;
             Options m_defaults;
+            std::map<std::size_t, std::pair<String, Listener>> m_listeners;
+            std::size_t m_nextListenerId = 1;
     };
 }
 
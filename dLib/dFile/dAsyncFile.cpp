@@ -0,0 +1,310 @@
+/**
+ * \file dAsyncFile.cpp
+ * \brief This file contains the implementation of the service that opens
+ *        files in the background.
+ **/
+
+#include "dAsyncFile.h"
+#include "logging/FlightRecorder.h"
+#include "logging/Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace FTS;
+
+std::shared_ptr<AsyncFile> File::openAsync(const Path& in_sFileName, const WriteMode& in_mode, int in_iPriority, std::function<void(AsyncFile&)> in_onDone)
+{
+    return AsyncFileLoader::getSingleton().request(in_sFileName, in_mode, in_iPriority, in_onDone);
+}
+
+AsyncFile::AsyncFile(const Path& in_sFileName, const File::WriteMode& in_mode, int in_iPriority, Callback in_onDone)
+    : m_sName(in_sFileName)
+    , m_mode(in_mode)
+    , m_onDone(in_onDone)
+    , m_iPriority(in_iPriority)
+{
+}
+
+AsyncFile::~AsyncFile()
+{
+}
+
+/// \return A lock on the loader's mutex or, if there is no loader anymore, no
+///         lock at all, as then nobody else touches the request anymore.
+std::unique_lock<std::mutex> AsyncFile::lockLoader()
+{
+    AsyncFileLoader* pLoader = AsyncFileLoader::getSingletonPtr();
+    if(pLoader == NULL)
+        return std::unique_lock<std::mutex>();
+
+    return std::unique_lock<std::mutex>(pLoader->m_mutex);
+}
+
+/// \return What the request is doing right now.
+AsyncFile::State AsyncFile::getState() const
+{
+    std::unique_lock<std::mutex> lock = lockLoader();
+    return m_state;
+}
+
+/// \return Whether the request is over, be it successfully or not. If it is,
+///         \a get does not block.
+bool AsyncFile::isReady() const
+{
+    State state = this->getState();
+    return state == Done || state == Failed || state == Cancelled;
+}
+
+/// \return The priority the request is served with.
+int AsyncFile::getPriority() const
+{
+    std::unique_lock<std::mutex> lock = lockLoader();
+    return m_iPriority;
+}
+
+/// Blocks until the request is over, be it successfully or not.
+void AsyncFile::wait() const
+{
+    AsyncFileLoader* pLoader = AsyncFileLoader::getSingletonPtr();
+    if(pLoader == NULL)
+        return;
+
+    std::unique_lock<std::mutex> lock(pLoader->m_mutex);
+    pLoader->m_requestDone.wait(lock, [this]() {
+        return m_state == Done || m_state == Failed || m_state == Cancelled;
+    });
+}
+
+/** Takes the opened file, waiting for it if needed.
+ *
+ * \return The opened file. NULL if the request got cancelled or if the file
+ *         has already been taken.
+ *
+ * \exception Any exception \a File::open threw while opening the file.
+ */
+File::Ptr AsyncFile::get()
+{
+    this->wait();
+
+    std::unique_lock<std::mutex> lock = lockLoader();
+    if(m_state == Failed)
+        std::rethrow_exception(m_pError);
+
+    return std::move(m_pFile);
+}
+
+/** Cancels the request. A request that is being loaded right now is loaded
+ *  to the end, but its file is thrown away.
+ *
+ * \return true if the request got cancelled, false if it was over already.
+ */
+bool AsyncFile::cancel()
+{
+    AsyncFileLoader* pLoader = AsyncFileLoader::getSingletonPtr();
+    if(pLoader == NULL)
+        return false;
+
+    std::unique_lock<std::mutex> lock(pLoader->m_mutex);
+    if(m_state == Queued) {
+        // Find it by identity, the queue's order doesn't help here.
+        for(auto i = pLoader->m_queue.begin() ; i != pLoader->m_queue.end() ; ++i) {
+            if(i->get() == this) {
+                pLoader->m_queue.erase(i);
+                break;
+            }
+        }
+    } else if(m_state != Loading) {
+        return false;
+    }
+
+    m_state = Cancelled;
+    pLoader->m_requestDone.notify_all();
+    return true;
+}
+
+/** Raises the priority of a request that still waits in the queue, for
+ *  example because the player suddenly needs what it loads.
+ *
+ * \param in_iPriority The new priority. Lower priorities than the current one
+ *                     are ignored.
+ *
+ * \return true if the priority has been raised, false if it wasn't needed or
+ *         the request is not waiting anymore.
+ */
+bool AsyncFile::boost(int in_iPriority)
+{
+    AsyncFileLoader* pLoader = AsyncFileLoader::getSingletonPtr();
+    if(pLoader == NULL)
+        return false;
+
+    std::unique_lock<std::mutex> lock(pLoader->m_mutex);
+    if(m_state != Queued || in_iPriority <= m_iPriority)
+        return false;
+
+    // The priority is part of the key, so take it out of the queue to change it.
+    for(auto i = pLoader->m_queue.begin() ; i != pLoader->m_queue.end() ; ++i) {
+        if(i->get() == this) {
+            AsyncFile::Ptr pMe = *i;
+            pLoader->m_queue.erase(i);
+            m_iPriority = in_iPriority;
+            pLoader->m_queue.insert(pMe);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool AsyncFileLoader::ByPriority::operator()(const AsyncFile::Ptr& a, const AsyncFile::Ptr& b) const
+{
+    if(a->m_iPriority != b->m_iPriority)
+        return a->m_iPriority > b->m_iPriority;
+
+    return a->m_uiSequence < b->m_uiSequence;
+}
+
+/** Starts the I/O threads and registers the loader to be updated.
+ *
+ * \param in_nThreads How many files may be opened at the same time. At least
+ *                    one thread is started.
+ */
+AsyncFileLoader::AsyncFileLoader(std::size_t in_nThreads)
+{
+    // Lazy singletons used while opening files must not be created by two
+    // threads at the same time, so create them right now.
+    CompressorFactory::getSingleton();
+
+    for(std::size_t i = 0 ; i < std::max<std::size_t>(in_nThreads, 1) ; ++i) {
+        m_threads.push_back(std::thread(&AsyncFileLoader::work, this));
+    }
+
+    UpdateableManager::getSingleton().add("Async File Loader", this);
+}
+
+/// Cancels all requests that wait in the queue, finishes the ones that are
+/// being loaded right now and stops the I/O threads. Callbacks of requests
+/// that are not delivered yet are not called anymore.
+AsyncFileLoader::~AsyncFileLoader()
+{
+    UpdateableManager::getSingleton().rem("Async File Loader");
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bQuit = true;
+        for(auto i = m_queue.begin() ; i != m_queue.end() ; ++i) {
+            (*i)->m_state = AsyncFile::Cancelled;
+        }
+        m_queue.clear();
+    }
+
+    m_newRequest.notify_all();
+    for(auto i = m_threads.begin() ; i != m_threads.end() ; ++i) {
+        i->join();
+    }
+    m_requestDone.notify_all();
+}
+
+/** Queues a file to be opened in the background, see \a File::openAsync.
+ *
+ * \param in_sFileName The name of the file to open.
+ * \param in_mode The write mode that should be used when writing to the file.
+ * \param in_iPriority Requests with a higher priority are served first.
+ * \param in_onDone Called on the main thread once the file is opened or failed
+ *                  to open. May be empty.
+ *
+ * \return The handle of the request.
+ */
+AsyncFile::Ptr AsyncFileLoader::request(const Path& in_sFileName, const File::WriteMode& in_mode, int in_iPriority, AsyncFile::Callback in_onDone)
+{
+    AsyncFile::Ptr pRequest(new AsyncFile(in_sFileName, in_mode, in_iPriority, in_onDone));
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        pRequest->m_uiSequence = m_uiNextSequence++;
+        m_queue.insert(pRequest);
+        FlightRecorder::record(FlightEvent::FileOpenAsync, static_cast<int64_t>(pRequest->m_uiSequence), in_iPriority, static_cast<int64_t>(m_queue.size()));
+    }
+
+    m_newRequest.notify_one();
+    return pRequest;
+}
+
+/** Calls the callbacks of all requests that are done since the last call.
+ *  This has to be called on the main thread, it is done during the updates.
+ *
+ * \return The number of requests that were done.
+ */
+std::size_t AsyncFileLoader::deliverCompleted()
+{
+    // Don't keep the lock while calling the callbacks, they may well want to
+    // open more files.
+    std::list<AsyncFile::Ptr> lCompleted;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        lCompleted.swap(m_completed);
+    }
+
+    for(auto i = lCompleted.begin() ; i != lCompleted.end() ; ++i) {
+        if((*i)->m_onDone)
+            (*i)->m_onDone(**i);
+    }
+
+    return lCompleted.size();
+}
+
+bool AsyncFileLoader::update(const Clock&)
+{
+    this->deliverCompleted();
+    return true;
+}
+
+std::size_t AsyncFileLoader::getQueueLength() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_queue.size();
+}
+
+/// The loop of every I/O thread: take the most important request and open its
+/// file, until the loader quits.
+void AsyncFileLoader::work()
+{
+    FTS_PROFILE_THREAD("AsyncFileLoader");
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(true) {
+        m_newRequest.wait(lock, [this]() {return m_bQuit || !m_queue.empty();});
+        if(m_bQuit)
+            return;
+
+        AsyncFile::Ptr pRequest = *m_queue.begin();
+        m_queue.erase(m_queue.begin());
+        pRequest->m_state = AsyncFile::Loading;
+        lock.unlock();
+
+        File::Ptr pFile;
+        std::exception_ptr pError;
+        auto start = std::chrono::steady_clock::now();
+        try {
+            FTS_PROFILE_SCOPE("AsyncFileLoader::open");
+            pFile = File::open(pRequest->m_sName, pRequest->m_mode);
+        } catch(...) {
+            pError = std::current_exception();
+        }
+        FlightRecorder::record(FlightEvent::FileOpened, static_cast<int64_t>(pRequest->m_uiSequence),
+                               std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count(),
+                               pError ? 1 : 0);
+
+        lock.lock();
+
+        // If it has been cancelled meanwhile, nobody wants the file anymore.
+        if(pRequest->m_state == AsyncFile::Loading) {
+            pRequest->m_pFile = std::move(pFile);
+            pRequest->m_pError = pError;
+            pRequest->m_state = pError ? AsyncFile::Failed : AsyncFile::Done;
+            m_completed.push_back(pRequest);
+        }
+
+        m_requestDone.notify_all();
+    }
+}
@@ -0,0 +1,131 @@
+///
+///\file dAsyncFile.h
+///\brief This file contains the service that opens files in the background.
+///*/
+
+#ifndef FTS_DASYNCFILE_H
+#define FTS_DASYNCFILE_H
+
+#include "main.h"
+#include "dLib/dFile/dFile.h"
+#include "main/Updateable.h"
+#include "utilities/Singleton.h"
+
+#include <set>
+#include <list>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+
+namespace FTS {
+    class AsyncFileLoader;
+
+/// A handle to a file that is being opened in the background, see
+/// \a File::openAsync. It is kind of a future of a \a File::Ptr.
+class AsyncFile {
+public:
+    typedef std::shared_ptr<AsyncFile> Ptr;
+    typedef std::function<void(AsyncFile&)> Callback;
+
+    typedef enum {
+        /// Waiting for a free I/O thread.
+        Queued,
+        /// An I/O thread is opening the file right now.
+        Loading,
+        /// The file is open and can be taken with \a get.
+        Done,
+        /// Opening the file threw an exception, \a get re-throws it.
+        Failed,
+        /// The request has been cancelled, there is no file.
+        Cancelled,
+    } State;
+
+    AsyncFile(const Path& in_sFileName, const File::WriteMode& in_mode, int in_iPriority, Callback in_onDone);
+    virtual ~AsyncFile();
+
+    /// \return The name of the file that is being opened.
+    inline const Path& getName() const {return m_sName;};
+
+    State getState() const;
+    bool isReady() const;
+    int getPriority() const;
+
+    void wait() const;
+    File::Ptr get();
+    bool cancel();
+    bool boost(int in_iPriority);
+
+private:
+    Path m_sName;
+    File::WriteMode m_mode;
+    Callback m_onDone;
+
+    // All of the following are guarded by the loader's mutex.
+    int m_iPriority;
+    /// Requests of the same priority are served in the order they came in.
+    std::uint64_t m_uiSequence = 0;
+    State m_state = Queued;
+    File::Ptr m_pFile;
+    std::exception_ptr m_pError;
+
+    static std::unique_lock<std::mutex> lockLoader();
+
+    friend class AsyncFileLoader;
+};
+
+/// This service opens files on a small pool of I/O threads, so that reading
+/// and decompressing doesn't stall the frame. Requests with a higher priority
+/// are served first.\n
+///
+/// Once a file is opened, the callback of its request is called on the main
+/// thread, when the \a UpdateableManager updates the loader. Like that, the
+/// callbacks don't need to care about threads at all.
+///
+/// \note Only one loader may exist at a time, \a File::openAsync uses it.
+class AsyncFileLoader : public Singleton<AsyncFileLoader>, public Updateable {
+public:
+    AsyncFileLoader(std::size_t in_nThreads = 2);
+    virtual ~AsyncFileLoader();
+
+    AsyncFile::Ptr request(const Path& in_sFileName, const File::WriteMode& in_mode, int in_iPriority = 0, AsyncFile::Callback in_onDone = nullptr);
+
+    std::size_t deliverCompleted();
+    virtual bool update(const Clock&);
+    /// The callbacks are called on the main thread, also when the simulation
+    /// runs on a thread of its own.
+    virtual Phase getUpdatePhase() const {return PreRender;};
+
+    /// \return How many requests wait for a free I/O thread.
+    std::size_t getQueueLength() const;
+
+private:
+    /// Orders the queue: highest priority first, then first come first served.
+    struct ByPriority {
+        bool operator()(const AsyncFile::Ptr& a, const AsyncFile::Ptr& b) const;
+    };
+
+    std::vector<std::thread> m_threads;
+    std::set<AsyncFile::Ptr, ByPriority> m_queue;
+    /// Requests that are done but whose callback has not been called yet.
+    std::list<AsyncFile::Ptr> m_completed;
+    std::uint64_t m_uiNextSequence = 0;
+    bool m_bQuit = false;
+
+    /// Guards everything above and the state of all requests.
+    mutable std::mutex m_mutex;
+    /// Signaled when there is a new request or when the loader quits.
+    std::condition_variable m_newRequest;
+    /// Signaled when a request is done.
+    mutable std::condition_variable m_requestDone;
+
+    void work();
+
+    friend class AsyncFile;
+};
+
+} // namespace FTS
+
+#endif // FTS_DASYNCFILE_H
@@ -8,10 +8,14 @@
 #include "dFile.h"
 
 #include "logging/logger.h"
+#include "logging/PerfCounters.h"
 
 #ifndef D_FILE_NO_ARCHMAP
 # include "dLib/dArchive/dArchive.h"
-std::map<FTS::String, FTS::Archive*> FTS::File::m_lArchivesToLook;
+FTS::VFSIndex FTS::File::m_vfs;
+std::mutex FTS::File::m_vfsMutex;
+std::size_t FTS::File::m_nVFSLoads = 0;
+std::condition_variable FTS::File::m_vfsIdle;
 #endif
 
 #include <sys/stat.h>
@@ -19,6 +23,36 @@ std::map<FTS::String, FTS::Archive*> FTS::File::m_lArchivesToLook;
 using namespace FTS;
 namespace fs = std::experimental::filesystem;
 
+namespace {
+    /// ftell and fseek only go as far as a long, which may have 32 bits.
+    int64_t tell64(std::FILE *in_pFile)
+    {
+#if WINDOOF
+        return _ftelli64(in_pFile);
+#else
+        return static_cast<int64_t>(ftello(in_pFile));
+#endif
+    }
+
+    int seek64(std::FILE *in_pFile, int64_t in_iPos, int in_iWhence)
+    {
+#if WINDOOF
+        return _fseeki64(in_pFile, in_iPos, in_iWhence);
+#else
+        return fseeko(in_pFile, static_cast<off_t>(in_iPos), in_iWhence);
+#endif
+    }
+}
+
+const std::uint64_t File::MapThreshold;
+
+namespace {
+    /// Only files on the disk count, not the ones that are in an archive.
+    PerfCounter g_fileOpens("file.opens");
+    PerfCounter g_fileBytesRead("file.bytesRead");
+    PerfCounter g_fileBytesMapped("file.bytesMapped");
+}
+
 UnknownProtocolException::UnknownProtocolException(const Path& in_sFile) throw()
     : LoggableException(new I18nLoggerCmd("UnknownProtocol", MsgType::Error, in_sFile.protocol(), in_sFile))
 {
@@ -35,16 +69,47 @@ FileAlreadyExistException::FileAlreadyExistException(const Path& in_sFile) throw
 }
 
 #ifndef D_FILE_NO_ARCHMAP
-std::pair<String, Archive*> File::isInArchive(const Path& in_sFile)
+bool File::isInArchive(const Path& in_sFile)
 {
-    // Run trough all entries that have the directory as key.
-    for(std::map<String, Archive *>::iterator i = m_lArchivesToLook.begin() ; i != m_lArchivesToLook.end() ; ++i) {
-        if(dynamic_cast<FileChunk *>(i->second->getChunk(in_sFile)))
-            return *i;
+    std::lock_guard<std::mutex> lock(m_vfsMutex);
+    return m_vfs.find(in_sFile) != NULL;
+}
+
+std::shared_ptr<const RawDataContainer> File::getFromArchive(const Path& in_sFile, String& out_sArchiveID)
+{
+    FileChunk* pChunk = NULL;
+    {
+        std::lock_guard<std::mutex> lock(m_vfsMutex);
+        const VFSEntry* pEntry = m_vfs.find(in_sFile);
+        if(pEntry == NULL)
+            return std::shared_ptr<const RawDataContainer>();
+
+        out_sArchiveID = pEntry->pArchive->getName();
+        pChunk = pEntry->pChunk;
+
+        // Whoever takes the chunk out of the index waits for us to be done
+        // with it before freeing it, so we can load it without the lock and
+        // don't make everybody else wait on our disk.
+        m_nVFSLoads++;
     }
 
-    // Nothing found? that's life...
-    return std::make_pair(Path(),reinterpret_cast<FTS::Archive*>(NULL));
+    // However the load ends, we're done with the chunk afterwards.
+    struct LoadDone {
+        ~LoadDone() {
+            std::lock_guard<std::mutex> lock(m_vfsMutex);
+            if(--m_nVFSLoads == 0)
+                m_vfsIdle.notify_all();
+        }
+    } done;
+
+    // The chunk serializes loading itself. Once we have its content, the
+    // content stays alive on its own.
+    return pChunk->getRawContent();
+}
+
+void File::waitForVFSLoads(std::unique_lock<std::mutex>& in_lock)
+{
+    m_vfsIdle.wait(in_lock, []{return m_nVFSLoads == 0;});
 }
 #endif
 
@@ -60,6 +125,31 @@ File::File(const Path& in_sFileName, const WriteMode& in_mode, const SaveMode& i
     m_pSDC->setCursorPos(0);
 }
 
+File::File(const Path& in_sFileName, const WriteMode& in_mode, const SaveMode& in_saveMode, CopyOnWriteDataContainer* in_pBorrowed)
+    : m_sName(in_sFileName)
+    , m_mode(in_mode)
+    , m_saveMode(in_saveMode)
+    , m_pSDC(new StreamedDataContainer())
+{
+    // Only the first few bytes are looked at to determine the compressor.
+    m_pOriginalCompressor = CompressorFactory::getSingleton().determine(in_pBorrowed);
+
+    if(m_pOriginalCompressor->getName() == NoCompressor().getName()) {
+        // Uncompressed data can be read right out of the borrowed memory, it
+        // only gets copied on the first write.
+        m_pSDC->bindDC(in_pBorrowed);
+    } else {
+        try {
+            m_pOriginalCompressor->decompress(*m_pSDC, in_pBorrowed);
+        } catch(...) {
+            delete in_pBorrowed;
+            throw;
+        }
+        delete in_pBorrowed;
+    }
+    m_pSDC->setCursorPos(0);
+}
+
 File::File(const File& o)
     : m_sName(o.m_sName)
     , m_mode(o.m_mode)
@@ -106,7 +196,7 @@ bool File::available(const Path& in_sFileName, const WriteMode& in_mode)
 
 #ifndef D_FILE_NO_ARCHMAP
     // Search in the archives
-    if(File::isInArchive(in_sFileName).second != NULL) {
+    if(File::isInArchive(in_sFileName)) {
         return true;
     }
 #endif
@@ -139,27 +229,35 @@ File::Ptr File::open(const Path& in_sFileName, const WriteMode& in_mode)
     } else if(in_sFileName.protocol() != "file") {
         // We want to open a transport protocol.
         throw UnknownProtocolException(in_sFileName);
+    } else {
 #ifndef D_FILE_NO_ARCHMAP
-    } else if(File::isInArchive(in_sFileName).second != NULL) {
-        // The file we want to open is present in a registered archive.
-
-        // Get some info about that archive where it is in.
-        std::pair<String, Archive*>bla = File::isInArchive(in_sFileName);
-
-        // We need to get the file out of the archive. We're sure the cast will
-        // succeed as File::isInArchive above didn't return NULL for this one.
-        FileChunk *pChk = dynamic_cast<FileChunk *>(bla.second->getChunk(in_sFileName));
-
-        // The raw data container will be copied by the file object.
-        File* pFile = new File(in_sFileName, in_mode, File::OverwriteFile, *(pChk->getRawContent()));
-
-        // Now with that info we can later on store the file back into the archive.
-        pFile->m_sMyArchiveID = bla.first;
-        return File::Ptr(pFile);
+        // The file we want to open may be present in a registered archive.
+        String sArchiveID;
+        std::shared_ptr<const RawDataContainer> pChunkData = File::getFromArchive(in_sFileName, sArchiveID);
+        if(pChunkData) {
+            // The file object shares the chunk's data until it gets modified.
+            File* pFile = new File(in_sFileName, in_mode, File::OverwriteFile, new SharedDataContainer(pChunkData));
+
+            // Now with that info we can later on store the file back into the archive.
+            pFile->m_sMyArchiveID = sArchiveID;
+            return File::Ptr(pFile);
+        }
 #endif
-    } else {
+
         // We want to open a regular file on the local disk.
 
+        // Big files that are only read don't need to be read as a whole, the
+        // OS loads only the pages we really touch. If mapping fails for
+        // whatever reason, just read the file the usual way.
+        if(in_mode == File::Read) {
+            MappedDataContainer *pMapped = MappedDataContainer::map(in_sFileName.c_str(), static_cast<std::size_t>(File::MapThreshold));
+            if(pMapped != NULL) {
+                g_fileOpens.add();
+                g_fileBytesMapped.add(static_cast<std::int64_t>(pMapped->getSize()));
+                return File::Ptr(new File(in_sFileName, in_mode, File::OverwriteFile, pMapped));
+            }
+        }
+
         // Open the file.
         std::FILE *pFile = fopen(in_sFileName.c_str(), "rb");
         if(pFile == NULL) {
@@ -180,6 +278,8 @@ File::Ptr File::open(const Path& in_sFileName, const WriteMode& in_mode)
 
         // The data container takes over the control over the data.
         SAFE_FCLOSE(pFile);
+        g_fileOpens.add();
+        g_fileBytesRead.add(static_cast<std::int64_t>(uiDataLen));
         return File::Ptr(new File(in_sFileName, in_mode, File::OverwriteFile, data));
     }
 }
@@ -266,11 +366,16 @@ const File& File::save(const Compressor& in_comp) const
 #ifndef D_FILE_NO_ARCHMAP
     // Maybe the file came from an archive? save it back.
     if(!m_sMyArchiveID.empty()) {
-        if(m_lArchivesToLook.find(m_sMyArchiveID) != m_lArchivesToLook.end()) {
+        Archive* pOpenArch = NULL;
+        {
+            std::lock_guard<std::mutex> lock(m_vfsMutex);
+            pOpenArch = m_vfs.findArchive(m_sMyArchiveID);
+        }
+
+        if(pOpenArch != NULL) {
             // If the archive is still open, we can just use it.
-            Archive* pArch = m_lArchivesToLook[m_sMyArchiveID];
-            pArch->give(new FileChunk(File::Ptr(new File(*this))), true);
-            pArch->save();
+            pOpenArch->give(new FileChunk(File::Ptr(new File(*this))), true);
+            pOpenArch->save();
         } else {
             // No more open, we need to open it now.
             Archive::Ptr pArch;
@@ -362,17 +467,22 @@ const File& File::saveToBuf(StreamedDataContainer& out_buf, const Compressor& in
 }
 
 #ifndef D_FILE_NO_ARCHMAP
-void File::addArchiveToLook(Archive *in_pArch)
+void File::addArchiveToLook(Archive *in_pArch, int in_iPriority)
 {
-    m_lArchivesToLook[in_pArch->getName()] = in_pArch;
+    std::lock_guard<std::mutex> lock(m_vfsMutex);
+    m_vfs.addArchive(in_pArch, in_iPriority);
 }
 
 void File::remArchiveToLook(Archive *in_pArch)
 {
-    std::map<String, Archive*>::iterator i = m_lArchivesToLook.find(in_pArch->getName());
-    if(i != m_lArchivesToLook.end()) {
-        m_lArchivesToLook.erase(i);
-    } else {
+    bool bRemoved = false;
+    {
+        std::unique_lock<std::mutex> lock(m_vfsMutex);
+        bRemoved = m_vfs.removeArchive(in_pArch);
+        waitForVFSLoads(lock);
+    }
+
+    if(!bRemoved) {
         // Print some warning but otherwise ignore it:
         FTS18N("InvParam", MsgType::Warning, in_pArch->getName());
     }
@@ -380,10 +490,9 @@ void File::remArchiveToLook(Archive *in_pArch)
 
 void File::autoRemArchiveToLook(Archive *in_pArch)
 {
-    std::map<String, Archive*>::iterator i = m_lArchivesToLook.find(in_pArch->getName());
-    if(i != m_lArchivesToLook.end()) {
-        m_lArchivesToLook.erase(i);
-    }
+    std::unique_lock<std::mutex> lock(m_vfsMutex);
+    m_vfs.removeArchive(in_pArch);
+    waitForVFSLoads(lock);
 }
 #endif
 
@@ -404,19 +513,24 @@ uint64_t File::getSize(std::FILE *in_pFile)
     if(NULL == in_pFile)
         throw FileNotExistException("NULL");
 
-    long lOrigPos = ftell(in_pFile);
-    if(lOrigPos == -1)
+    int64_t iOrigPos = tell64(in_pFile);
+    if(iOrigPos == -1)
         throw SyscallException("File::getSize::ftell");
 
-    if(0 != fseek(in_pFile, 0, SEEK_END))
+    if(0 != seek64(in_pFile, 0, SEEK_END))
         throw SyscallException("File::getSize::fseek(0, SEEK_END)");
 
-    long lSize = ftell(in_pFile);
+    int64_t iSize = tell64(in_pFile);
+
+    if(0 != seek64(in_pFile, iOrigPos, SEEK_SET))
+        throw SyscallException("File::getSize::fseek("+String::nr(iOrigPos)+", SEEK_SET)");
 
-    if(0 != fseek(in_pFile, lOrigPos, SEEK_SET))
-        throw SyscallException("File::getSize::fseek("+String::nr(lOrigPos)+", SEEK_SET)");
+    return static_cast<uint64_t>(iSize);
+}
 
-    return static_cast<uint64_t>(lSize);
+bool File::seek(std::FILE *in_pFile, uint64_t in_uiPos)
+{
+    return in_pFile != NULL && 0 == seek64(in_pFile, static_cast<int64_t>(in_uiPos), SEEK_SET);
 }
 
 std::size_t File::write(const void *in_ptr, std::size_t in_size, std::size_t in_nmemb)
@@ -495,12 +609,13 @@ int FileUtils::rmdir(const Path& in_dPath)
 
 bool FileUtils::fileExists(const Path& in_sFileName, const File::WriteMode& in_mode)
 {
+    // A single stat tells both whether it exists and what we may do with it.
     std::error_code ec;
-    auto fileName = fs::path(in_sFileName.c_str());
-    if(!fs::exists(fileName, ec)) {
+    auto status = fs::status(fs::path(in_sFileName.c_str()), ec);
+    if(!fs::exists(status)) {
         return false;
     }
-    auto perm = fs::status(fileName).permissions();
+    auto perm = status.permissions();
 
     if(in_mode == File::Insert)
         return (perm & fs::perms::owner_write) != fs::perms::none ;
@@ -517,20 +632,15 @@ bool FileUtils::dirExists(const Path& in_sDirName)
         return false;
     }
 
-    auto dirName = fs::path(in_sDirName.c_str());
     std::error_code ec;
-    if(fs::exists(dirName, ec)) {
-        if(fs::is_directory(dirName, ec)) {
-            return true;
-        }
-    }
-    
-    return false;
+    return fs::is_directory(fs::status(fs::path(in_sDirName.c_str()), ec));
 }
 
 bool FileUtils::exists(const Path& in_sPathname)
 {
-    return fileExists(in_sPathname) || dirExists(in_sPathname);
+    // Files and directories alike, so no need to ask twice.
+    std::error_code ec;
+    return fs::exists(fs::status(fs::path(in_sPathname.c_str()), ec));
 }
 
 int FileUtils::fileCopy(const Path& in_sFrom, const Path& in_sTo, bool in_bOverwrite)
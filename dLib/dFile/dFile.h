@@ -15,15 +15,22 @@
 #include "utilities/StreamedDataContainer.h"
 #include "main/Exception.h"
 #include "logging/logger.h"
+#ifndef D_FILE_NO_ARCHMAP
+# include "dLib/dFile/dVFS.h"
+#endif
 
 #include <memory>
 #include <map>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 #include <cstdio>  // std::FILE
 #include <cstddef> // std::size_t
 
 namespace FTS {
     class Archive;
     class FileChunk;
+    class AsyncFile;
 
 class UnknownProtocolException : public LoggableException {
 public:
@@ -71,6 +78,10 @@ public:
     /// The auto-pointer to a file.
     typedef std::unique_ptr<File> Ptr;
 
+    /// Files opened in \a Read mode that are at least this big (in bytes) are
+    /// mapped into memory instead of being read as a whole.
+    static const std::uint64_t MapThreshold = 64 * 1024;
+
 protected:
     Path m_sName;           ///< This is the name of the file.
     WriteMode m_mode;       ///< How we should write data into this file.
@@ -82,21 +93,42 @@ protected:
     Compressor::Ptr m_pOriginalCompressor;
 
 #ifndef D_FILE_NO_ARCHMAP
-    /// A list of archives to look in for files to open.
-    static std::map<String, Archive*> m_lArchivesToLook;
+    /// The index of all files in the archives to look in for files to open.
+    static VFSIndex m_vfs;
+    /// Files may be opened from other threads, see \a openAsync. This guards
+    /// \a m_vfs and the chunks it points to while they are looked at.
+    static std::mutex m_vfsMutex;
+    /// How many chunks are being loaded from disk without \a m_vfsMutex held.
+    /// A chunk that has been taken out of \a m_vfs may only be freed once this
+    /// dropped to zero, see \a waitForVFSLoads.
+    static std::size_t m_nVFSLoads;
+    /// Signalled whenever \a m_nVFSLoads drops to zero.
+    static std::condition_variable m_vfsIdle;
+    /// Waits until no chunk is being loaded anymore. \a in_lock must hold
+    /// \a m_vfsMutex, it is released while waiting.
+    static void waitForVFSLoads(std::unique_lock<std::mutex>& in_lock);
 
     /// Checks if the file with the given name is located in one of the archives to
-    /// look in. The archive list works kind-of like a stack: we first look in the
-    /// last added archive, then in the second-last and so forth.\n
+    /// look in. If several archives contain it, the one with the highest
+    /// priority wins, and among these the last added one.\n
     ///
     /// The file class has a list of archives that it looks into for a file before
-    /// loading it from disk.
+    /// loading it from disk. They are all indexed together, so this is a single
+    /// lookup no matter how many archives there are.
     ///
     ///\param in_sFile The filename to look for in the archives (with the path), for
     ///                example bla.fts or Data/bla.fts
-    ///\return A pointer to the archive where the file was found or NULL if the file
-    ///        is in no archive that has to be checked.
-    static std::pair<String, Archive*>isInArchive(const Path &in_sFile);
+    ///\return true if the file is in one of the archives that have to be checked.
+    static bool isInArchive(const Path &in_sFile);
+
+    /// Gets the content of a file out of the archives to look in, the same way
+    /// \a isInArchive finds it.
+    ///
+    ///\param in_sFile The filename to look for in the archives.
+    ///\param out_sArchiveID Receives the name of the archive the file is in.
+    ///\return The raw content of the file's chunk or an empty pointer if the
+    ///        file is in no archive that has to be checked.
+    static std::shared_ptr<const RawDataContainer> getFromArchive(const Path &in_sFile, String& out_sArchiveID);
 
     /// The ID of the archive I got extracted from, if that is the case.
     String m_sMyArchiveID;
@@ -116,9 +148,30 @@ protected:
     ///                               decompression of the data.
     File(const Path& in_sFileName, const WriteMode& in_mode, const SaveMode& in_saveMode, const RawDataContainer& in_cont);
 
+    /// This constructs a FTS::File object that takes over data it doesn't own,
+    /// like a file mapped into memory or the data of an archive's chunk. If the
+    /// data is compressed, it is decompressed and the borrowed data released,
+    /// else the borrowed data itself becomes the file's content, until the
+    /// first modification.
+    ///
+    ///\param in_sFileName The name of the opened file.
+    ///\param in_mode The write mode that should be used when writing to the file.
+    ///\param in_saveMode How the default file saving will be handled (overwrite existing?)
+    ///\param in_pBorrowed The contents, the file object takes control over it.
+    ///
+    ///\exception CompressorException You may get any of the compressor's exceptions
+    ///                               forwarded if something went wrong during
+    ///                               decompression of the data.
+    File(const Path& in_sFileName, const WriteMode& in_mode, const SaveMode& in_saveMode, CopyOnWriteDataContainer* in_pBorrowed);
+
     /// \internal Only for class-use.
     File(const File& o);
     File& operator=(const File& o);
+
+    // Archives need to know whether they are themselves in an archive.
+    friend class Archive;
+    // File chunks hand out files sharing their data.
+    friend class FileChunk;
 public:
     /// Destroys the file object. CARE: This will not save the file before doing so.
     virtual ~File();
@@ -138,7 +191,10 @@ public:
     /// If the file does not exist or can not be opened for reading, an exception
     /// will be thrown. The file is fully loaded into memory ; any operation done
     /// on this object is done in memory, it is only flushed to disk upon calling
-    /// the \a save method or a similar one.
+    /// the \a save method or a similar one.\n
+    /// Uncompressed files on the local disk that are opened in \a Read mode and
+    /// are at least \a MapThreshold bytes big are mapped into memory instead,
+    /// so only the parts that are actually read get loaded from the disk.
     ///
     ///\param in_sFileName The path to the file to open.
     ///\param in_mode How to perform operations on the file by default.
@@ -163,6 +219,22 @@ public:
     ///      (e.g. by pressing Ctrl+Z in the console or so..)
     static File::Ptr open(const Path& in_sFileName, const WriteMode& in_mode);
 
+    /// Opens a file like \a open does, but in the background, on one of the
+    /// threads of the \a AsyncFileLoader, which must exist.
+    ///
+    ///\param in_sFileName The name of the file to open.
+    ///\param in_mode The write mode that should be used when writing to the file.
+    ///\param in_iPriority Requests with a higher priority are served first.
+    ///\param in_onDone Called on the main thread, during the updates of the
+    ///                 \a UpdateableManager, once the file is opened or failed
+    ///                 to open. Not called if the request got cancelled.
+    ///
+    ///\return A handle to wait for the file, get it, cancel the request or
+    ///        change its priority.
+    ///
+    ///\note Any exception \a open throws is thrown by \a AsyncFile::get.
+    static std::shared_ptr<AsyncFile> openAsync(const Path& in_sFileName, const WriteMode& in_mode, int in_iPriority = 0, std::function<void(AsyncFile&)> in_onDone = nullptr);
+
     /// This method creates a file object from reading raw data.
     /// The file object fully resides in memory ; any operation done
     /// on this object is done in memory, it is only flushed to disk upon calling
@@ -341,9 +413,12 @@ public:
     /// flexibility.
     ///
     ///\param in_pArch The archive that has to be added to the list
+    ///\param in_iPriority Files in archives with a higher priority hide the same
+    ///                    files in archives with a lower priority. Among equal
+    ///                    priorities, the archive added last wins.
     ///
-    ///\note The archive is added in no special category, it is just added like this.
-    static void addArchiveToLook(Archive* in_pArch);
+    ///\note Adding an archive that is already in the list only changes its priority.
+    static void addArchiveToLook(Archive* in_pArch, int in_iPriority = 0);
 
     /// This removes an archive from the list of archives to check for files on opening.
     /// For more informations on this theme, check our dokuwiki->design docs->map->
@@ -379,6 +454,13 @@ public:
 
     // Information methods.
 
+    /// \return True if the file's content still lies in a memory-mapped file
+    ///         on the disk, false if it has been loaded into memory.
+    inline bool isMapped() const {const MappedDataContainer *p = dynamic_cast<const MappedDataContainer*>(m_pSDC->getBoundDC()); return p != NULL && p->isMapped();};
+    /// \return True if the file's content still is the very same memory as the
+    ///         one of the archive chunk it has been opened from, false if the
+    ///         file has its own copy.
+    inline bool isShared() const {const SharedDataContainer *p = dynamic_cast<const SharedDataContainer*>(m_pSDC->getBoundDC()); return p != NULL && p->isBorrowed();};
     /// \return True if the file is loaded, false if not.
     inline bool isLoaded() const {return !m_pSDC->invalid();};
     /// \return True if the end of file has been reached, false else.
@@ -420,12 +502,19 @@ public:
     ///\exception FileNotExistException \a in_pFile is NULL
     ///\exception SyscallException Any of the system-calls used to work with the file failed.
     ///
-    ///\note Although the return value is a 64-bit unsigned integer, the support for
-    ///      large files (>4GB) is not implemented/tested yet.
     ///\note The file position indicator will be at the same position after a call
     ///      to this method.
     static std::uint64_t getSize(std::FILE* out_pFile);
 
+    /// This method places the file position indicator of an already-opened file
+    /// descriptor, also behind 2 GiB where a long only has 32 bits.
+    ///
+    ///\param in_pFile The file to move in.
+    ///\param in_uiPos The position, counted from the beginning of the file.
+    ///
+    ///\return true if it worked, false if not.
+    static bool seek(std::FILE* in_pFile, std::uint64_t in_uiPos);
+
     // Data extraction functions, wrappers around the SDC, for convenience.
 
     /// This places the cursor at an arbitrary position in the file data. If you
@@ -0,0 +1,258 @@
+/**
+ * \file dVFS.cpp
+ * \brief This file contains the implementation of the index of the virtual
+ *        file system made of all archives the File class looks into.
+ **/
+
+#include "dVFS.h"
+#include "dLib/dArchive/dArchive.h"
+
+using namespace FTS;
+
+/// The hash table starts with this many slots. Must be a power of two.
+#define D_VFS_MIN_SLOTS 64
+
+VFSIndex::VFSIndex()
+    : m_vSlots(D_VFS_MIN_SLOTS)
+{
+}
+
+VFSIndex::~VFSIndex()
+{
+}
+
+/** Brings a path into the form it is stored in the index, that is the form
+ *  chunk names have: without leading "current directory" parts.
+ *
+ * \param in_sPath The path to normalize.
+ *
+ * \return The normalized path.
+ */
+String VFSIndex::normalize(const String& in_sPath)
+{
+    String sPath = in_sPath;
+    while(sPath.left(2) == "./" || sPath.left(2) == ".\\") {
+        sPath = String(sPath, 2);
+    }
+    return sPath;
+}
+
+/** Adds all files of an archive to the index. If the archive already is in
+ *  the index, it is re-added with the new priority, as if added just now.
+ *
+ * \param in_pArch The archive to add. It must stay alive until it is removed.
+ * \param in_iPriority Files of archives with a higher priority hide files with
+ *                     the same name in archives with a lower priority.
+ */
+void VFSIndex::addArchive(Archive* in_pArch, int in_iPriority)
+{
+    if(in_pArch == NULL)
+        return;
+
+    this->removeArchive(in_pArch);
+
+    Overlay overlay = {in_pArch, in_iPriority, m_uiNextSequence++};
+    m_vArchives.push_back(overlay);
+
+    for(Archive::ChunkMap::const_iterator i = in_pArch->begin() ; i != in_pArch->end() ; ++i) {
+        FileChunk* pChunk = dynamic_cast<FileChunk*>(i->second);
+        if(pChunk == NULL)
+            continue;
+
+        Provider provider = {{in_pArch, pChunk}, overlay.iPriority, overlay.uiSequence};
+        this->insert(VFSIndex::normalize(i->first), provider);
+    }
+}
+
+/** Removes all files of an archive from the index.
+ *
+ * \param in_pArch The archive to remove.
+ *
+ * \return true if the archive was in the index, false if not.
+ */
+bool VFSIndex::removeArchive(const Archive* in_pArch)
+{
+    for(std::vector<Overlay>::iterator i = m_vArchives.begin() ; i != m_vArchives.end() ; ++i) {
+        if(i->pArchive != in_pArch)
+            continue;
+
+        m_vArchives.erase(i);
+        for(Archive::ChunkMap::const_iterator iChunk = in_pArch->begin() ; iChunk != in_pArch->end() ; ++iChunk) {
+            this->erase(VFSIndex::normalize(iChunk->first), in_pArch);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+/// \return Whether the given archive is in the index.
+bool VFSIndex::hasArchive(const Archive* in_pArch) const
+{
+    return this->getOverlay(in_pArch) != NULL;
+}
+
+/// \param in_sName The name of the archive file.
+/// \return The archive in the index that has been loaded from the given file,
+///         NULL if there is none.
+Archive* VFSIndex::findArchive(const String& in_sName) const
+{
+    for(std::vector<Overlay>::const_iterator i = m_vArchives.begin() ; i != m_vArchives.end() ; ++i) {
+        if(i->pArchive->getName() == in_sName)
+            return i->pArchive;
+    }
+
+    return NULL;
+}
+
+/** Adds a chunk that has been added to an archive after the archive has been
+ *  added to the index. Does nothing if the archive isn't in the index.
+ *
+ * \param in_pArch The archive the chunk has been added to.
+ * \param in_pChunk The chunk that has been added.
+ */
+void VFSIndex::addChunk(Archive* in_pArch, FileChunk* in_pChunk)
+{
+    const Overlay* pOverlay = this->getOverlay(in_pArch);
+    if(pOverlay == NULL || in_pChunk == NULL)
+        return;
+
+    Provider provider = {{in_pArch, in_pChunk}, pOverlay->iPriority, pOverlay->uiSequence};
+    this->insert(VFSIndex::normalize(in_pChunk->getName()), provider);
+}
+
+/** Removes a chunk that is about to be taken out of an archive. Does nothing
+ *  if the archive isn't in the index.
+ *
+ * \param in_pArch The archive the chunk is taken out of.
+ * \param in_sChunkName The name of the chunk that is taken out.
+ */
+void VFSIndex::removeChunk(const Archive* in_pArch, const String& in_sChunkName)
+{
+    if(!this->hasArchive(in_pArch))
+        return;
+
+    this->erase(VFSIndex::normalize(in_sChunkName), in_pArch);
+}
+
+/** Looks up a file in the index.
+ *
+ * \param in_sPath The path of the file to look for.
+ *
+ * \return Where to find the file, NULL if it is in none of the archives. The
+ *         returned entry is only valid until the index is modified.
+ */
+const VFSEntry* VFSIndex::find(const String& in_sPath) const
+{
+    if(m_nUsed == 0)
+        return NULL;
+
+    String sPath = VFSIndex::normalize(in_sPath);
+    const Slot& slot = m_vSlots[this->findSlot(sPath, ChunkIndexEntry::hashName(sPath))];
+    return slot.vProviders.empty() ? NULL : &slot.vProviders.front().entry;
+}
+
+const VFSIndex::Overlay* VFSIndex::getOverlay(const Archive* in_pArch) const
+{
+    for(std::vector<Overlay>::const_iterator i = m_vArchives.begin() ; i != m_vArchives.end() ; ++i) {
+        if(i->pArchive == in_pArch)
+            return &(*i);
+    }
+
+    return NULL;
+}
+
+/// \return The slot that holds the given path or, if there is none, the
+///         empty slot where it would have to be inserted.
+std::size_t VFSIndex::findSlot(const String& in_sPath, std::uint32_t in_uiHash) const
+{
+    std::size_t mask = m_vSlots.size() - 1;
+    for(std::size_t i = in_uiHash & mask ; ; i = (i + 1) & mask) {
+        const Slot& slot = m_vSlots[i];
+        if(slot.vProviders.empty() || (slot.uiHash == in_uiHash && slot.sPath == in_sPath))
+            return i;
+    }
+}
+
+void VFSIndex::insert(const String& in_sPath, const Provider& in_provider)
+{
+    // Keep the table at most three quarters full, so probes stay short.
+    if((m_nUsed + 1) * 4 > m_vSlots.size() * 3)
+        this->rehash(m_vSlots.size() * 2);
+
+    std::uint32_t uiHash = ChunkIndexEntry::hashName(in_sPath);
+    Slot& slot = m_vSlots[this->findSlot(in_sPath, uiHash)];
+    if(slot.vProviders.empty()) {
+        slot.uiHash = uiHash;
+        slot.sPath = in_sPath;
+        ++m_nUsed;
+    }
+
+    // An archive provides a file only once, the new chunk replaces the old one.
+    for(std::vector<Provider>::iterator i = slot.vProviders.begin() ; i != slot.vProviders.end() ; ++i) {
+        if(i->entry.pArchive == in_provider.entry.pArchive) {
+            slot.vProviders.erase(i);
+            break;
+        }
+    }
+
+    // Keep the winner in front.
+    std::vector<Provider>::iterator i = slot.vProviders.begin();
+    while(i != slot.vProviders.end() && (i->iPriority > in_provider.iPriority
+      || (i->iPriority == in_provider.iPriority && i->uiSequence > in_provider.uiSequence))) {
+        ++i;
+    }
+    slot.vProviders.insert(i, in_provider);
+}
+
+void VFSIndex::erase(const String& in_sPath, const Archive* in_pArch)
+{
+    std::size_t iSlot = this->findSlot(in_sPath, ChunkIndexEntry::hashName(in_sPath));
+    Slot& slot = m_vSlots[iSlot];
+
+    for(std::vector<Provider>::iterator i = slot.vProviders.begin() ; i != slot.vProviders.end() ; ++i) {
+        if(i->entry.pArchive == in_pArch) {
+            slot.vProviders.erase(i);
+            if(slot.vProviders.empty())
+                this->eraseSlot(iSlot);
+            return;
+        }
+    }
+}
+
+/// Empties a slot and moves the slots that follow it back where needed, so
+/// that no probe sequence gets interrupted. This way no tombstones are needed.
+void VFSIndex::eraseSlot(std::size_t in_iSlot)
+{
+    std::size_t mask = m_vSlots.size() - 1;
+    std::size_t iHole = in_iSlot;
+    m_vSlots[iHole] = Slot();
+    --m_nUsed;
+
+    for(std::size_t j = (iHole + 1) & mask ; !m_vSlots[j].vProviders.empty() ; j = (j + 1) & mask) {
+        // Where this entry would like to be. It may only move into the hole
+        // if the hole lies between that place and where it is now.
+        std::size_t iHome = m_vSlots[j].uiHash & mask;
+        bool bStays = iHole < j ? (iHole < iHome && iHome <= j)
+                                : (iHole < iHome || iHome <= j);
+        if(bStays)
+            continue;
+
+        m_vSlots[iHole] = std::move(m_vSlots[j]);
+        m_vSlots[j] = Slot();
+        iHole = j;
+    }
+}
+
+void VFSIndex::rehash(std::size_t in_nSlots)
+{
+    std::vector<Slot> vOld(in_nSlots);
+    vOld.swap(m_vSlots);
+
+    for(std::vector<Slot>::iterator i = vOld.begin() ; i != vOld.end() ; ++i) {
+        if(i->vProviders.empty())
+            continue;
+
+        m_vSlots[this->findSlot(i->sPath, i->uiHash)] = std::move(*i);
+    }
+}
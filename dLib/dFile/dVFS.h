@@ -0,0 +1,105 @@
+///
+///\file dVFS.h
+///\brief This file contains the index of the virtual file system made of all
+///       archives the File class looks into.
+///*/
+
+#ifndef FTS_DVFS_H
+#define FTS_DVFS_H
+
+#include "main.h"
+#include "dLib/dString/dString.h"
+
+#include <vector>
+#include <cstddef> // std::size_t
+#include <cstdint>
+
+namespace FTS {
+    class Archive;
+    class FileChunk;
+
+/// Where a file of the virtual file system can be found.
+struct VFSEntry {
+    /// The archive that holds the file.
+    Archive* pArchive = nullptr;
+    /// The chunk within \a pArchive that holds the file.
+    FileChunk* pChunk = nullptr;
+};
+
+/// This is a single index over all files of all archives that are registered
+/// as overlays of the file system. Looking a file up is one hash probe, no
+/// matter how many archives there are.\n
+///
+/// Every archive has a priority. If several archives contain the same file,
+/// the one with the highest priority wins. Among archives of the same priority,
+/// the one that has been added last wins. If the winning archive is removed,
+/// the file of the next archive becomes visible again.\n
+///
+/// The index is an open-addressing hash table with linear probing, keyed by the
+/// normalized path of the file.
+class VFSIndex {
+public:
+    VFSIndex();
+    virtual ~VFSIndex();
+
+    void addArchive(Archive* in_pArch, int in_iPriority = 0);
+    bool removeArchive(const Archive* in_pArch);
+    bool hasArchive(const Archive* in_pArch) const;
+    Archive* findArchive(const String& in_sName) const;
+
+    void addChunk(Archive* in_pArch, FileChunk* in_pChunk);
+    void removeChunk(const Archive* in_pArch, const String& in_sChunkName);
+
+    const VFSEntry* find(const String& in_sPath) const;
+
+    /// \return The number of different files in the index.
+    inline std::size_t getFileCount() const {return m_nUsed;};
+    /// \return The number of archives that are indexed.
+    inline std::size_t getArchiveCount() const {return m_vArchives.size();};
+
+    static String normalize(const String& in_sPath);
+
+private:
+    /// An archive in the index and how it ranks.
+    struct Overlay {
+        Archive* pArchive;
+        int iPriority;
+        /// Archives added later win over older ones of the same priority.
+        std::uint64_t uiSequence;
+    };
+
+    /// One provider of a file, with the ranking of its archive.
+    struct Provider {
+        VFSEntry entry;
+        int iPriority;
+        std::uint64_t uiSequence;
+    };
+
+    /// One slot of the hash table. It is empty if it has no providers.
+    struct Slot {
+        std::uint32_t uiHash = 0;
+        String sPath;
+        /// Sorted so that the winning provider is the first one.
+        std::vector<Provider> vProviders;
+    };
+
+    /// The hash table, its size is always a power of two.
+    std::vector<Slot> m_vSlots;
+    /// The number of slots in use.
+    std::size_t m_nUsed = 0;
+    /// All archives that are indexed.
+    std::vector<Overlay> m_vArchives;
+    /// The sequence number the next archive gets.
+    std::uint64_t m_uiNextSequence = 0;
+
+    const Overlay* getOverlay(const Archive* in_pArch) const;
+    std::size_t findSlot(const String& in_sPath, std::uint32_t in_uiHash) const;
+    void insert(const String& in_sPath, const Provider& in_provider);
+    void erase(const String& in_sPath, const Archive* in_pArch);
+    void eraseSlot(std::size_t in_iSlot);
+    void rehash(std::size_t in_nSlots);
+};
+
+} // namespace FTS
+
+#endif // FTS_DVFS_H
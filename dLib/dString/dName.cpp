@@ -0,0 +1,93 @@
+#include "dLib/dString/dName.h"
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+using namespace FTS;
+
+/// All interned strings.
+struct FTS::Name::Table {
+    Table();
+
+    std::mutex mutex;
+    /// Entries never move once they are in here, names point at them.
+    std::deque<Entry> entries;
+    std::unordered_map<String, const Entry*, cstring_hash, cstring_eqcomp> index;
+    /// The entry of the empty string. It is there from the start and never
+    /// changes, so it can be used without locking.
+    const Entry* pEmpty;
+};
+
+FTS::Name::Table::Table()
+{
+    Entry e;
+    e.hash = cstring_hash()(e.s);
+    e.id = 0;
+    entries.push_back(e);
+
+    pEmpty = &entries.back();
+    index[pEmpty->s] = pEmpty;
+}
+
+/// \return The table of all interned strings. It is a function-local static
+///         because names may be created during the static initialisation of
+///         other files. It is never destroyed, as names are still used by
+///         the clean-up that runs at exit, after the statics are gone.
+FTS::Name::Table& FTS::Name::table()
+{
+    static Table* pTable = new Table;
+    return *pTable;
+}
+
+FTS::Name::Name()
+    : m_pEntry(table().pEmpty)
+{
+}
+
+FTS::Name::Name(const String& in_s)
+    : m_pEntry(intern(in_s))
+{
+}
+
+FTS::Name::Name(const char* in_psz)
+    : m_pEntry(intern(String(in_psz)))
+{
+}
+
+/** Finds the one entry of a string, creating it if it's the first time the
+ *  string is seen.
+ *
+ * \param in_s The string to intern.
+ *
+ * \return The entry of the string, valid until the end of the program.
+ */
+const Name::Entry* FTS::Name::intern(const String& in_s)
+{
+    Table& table = Name::table();
+    if(in_s.empty())
+        return table.pEmpty;
+
+    std::lock_guard<std::mutex> lock(table.mutex);
+
+    auto i = table.index.find(in_s);
+    if(i != table.index.end())
+        return i->second;
+
+    Entry e;
+    e.s = in_s;
+    e.hash = cstring_hash()(in_s);
+    e.id = static_cast<std::uint32_t>(table.entries.size());
+    table.entries.push_back(e);
+
+    const Entry* pEntry = &table.entries.back();
+    table.index[in_s] = pEntry;
+    return pEntry;
+}
+
+std::size_t FTS::Name::count()
+{
+    Table& table = Name::table();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    return table.entries.size();
+}
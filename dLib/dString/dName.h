@@ -0,0 +1,67 @@
+#ifndef FTS_NAME_H
+#define FTS_NAME_H
+
+#include "dLib/dString/dString.h"
+
+#include <cstdint>
+#include <functional>
+
+namespace FTS {
+
+    /// A string that has been interned: every distinct string only exists once
+    /// in the whole program, so names are compared and hashed in O(1) by just
+    /// looking at the entry they point to. Use it as a key where the same few
+    /// strings (file, uniform, chunk names, ...) are looked up over and over,
+    /// and keep the name around instead of the string.
+    ///
+    /// \note Interning costs one lookup in a global, locked table, so a name
+    ///       should be made once (for example a static) and then reused.
+    /// \note Interned strings are never forgotten, don't make names out of
+    ///       strings that are only used once.
+    class Name {
+    public:
+        /// The empty name. It exists from the start, so this doesn't lock.
+        Name();
+        explicit Name(const String& in_s);
+        explicit Name(const char* in_psz);
+
+        /// \return The string this name stands for. It lives as long as the program.
+        inline const String& str() const {return m_pEntry->s;};
+        /// \return The precomputed hash of the string.
+        inline std::size_t hash() const {return m_pEntry->hash;};
+        /// \return A number unique to this name, the order in which names got
+        ///         interned for the first time.
+        inline std::uint32_t id() const {return m_pEntry->id;};
+        inline bool empty() const {return m_pEntry->s.empty();};
+
+        inline bool operator==(const Name& in_other) const {return m_pEntry == in_other.m_pEntry;};
+        inline bool operator!=(const Name& in_other) const {return m_pEntry != in_other.m_pEntry;};
+        /// \note This is NOT the alphabetical order, but the order of \a id.
+        inline bool operator<(const Name& in_other) const {return m_pEntry->id < in_other.m_pEntry->id;};
+
+        /// \return How many different names exist.
+        static std::size_t count();
+
+    private:
+        struct Entry {
+            String s;
+            std::size_t hash;
+            std::uint32_t id;
+        };
+
+        struct Table;
+        static Table& table();
+        static const Entry* intern(const String& in_s);
+
+        const Entry* m_pEntry;
+    };
+
+}
+
+namespace std {
+    template<> struct hash<FTS::Name> {
+        std::size_t operator()(const FTS::Name& in_name) const {return in_name.hash();};
+    };
+}
+
+#endif
@@ -9,6 +9,11 @@
 #include <sstream>
 #include <limits>
 #include <algorithm>
+#include <type_traits>
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#  include <charconv>
+#endif
 
 #ifdef D_USE_CEGUI
 #  include "CEGUIString.h"
@@ -53,7 +58,8 @@ String::String(const unsigned char* in_pszString)
 { }
 
 String::String(const String& in_sString)
-    : m_s(in_sString.str())
+    : m_s(in_sString.m_s)
+    , m_uiMetrics(in_sString.m_uiMetrics.load(std::memory_order_relaxed))
 { }
 
 String::String(const std::string& in_sString)
@@ -88,6 +94,47 @@ String::StringSize String::strlen() const
     return ret;
 }
 
+/** Does the same as \a strlen, but remembers the result so that the string
+ *  only has to be walked the first time.
+ *
+ * \return The length of the string in characters and in bytes.
+ */
+String::StringSize String::metrics() const
+{
+    std::uint64_t uiMetrics = m_uiMetrics.load(std::memory_order_relaxed);
+    if(uiMetrics & MetricsKnown)
+        return StringSize(uiMetrics & MetricsMaxLen, (uiMetrics >> 31) & MetricsMaxLen);
+
+    StringSize len = this->strlen();
+    std::string::size_type nChars = std::get<0>(len);
+    std::string::size_type nBytes = std::get<1>(len);
+    if(nBytes <= MetricsMaxLen) {
+        uiMetrics = MetricsKnown | nChars | (static_cast<std::uint64_t>(nBytes) << 31);
+        if(nChars == nBytes && nBytes == m_s.size())
+            uiMetrics |= MetricsSingleByte;
+        m_uiMetrics.store(uiMetrics, std::memory_order_relaxed);
+    }
+
+    return len;
+}
+
+/// \return Whether every character of the string is one byte, so that character
+///         indices can be used as byte indices. This is true for ASCII strings.
+bool String::isSingleByte() const
+{
+    this->metrics();
+    return (m_uiMetrics.load(std::memory_order_relaxed) & MetricsSingleByte) != 0;
+}
+
+/// Remembers that the string is made of single byte characters only, for when
+/// it is known without walking it, like for numbers.
+void String::setSingleByteMetrics()
+{
+    std::uint64_t uiLen = m_s.size();
+    if(uiLen <= MetricsMaxLen)
+        m_uiMetrics.store(MetricsKnown | MetricsSingleByte | uiLen | (uiLen << 31), std::memory_order_relaxed);
+}
+
 const char* String::advance(const char* in_pszString, std::string::size_type in_utf8Len) const
 {
     const char * p = in_pszString;
@@ -141,7 +188,7 @@ int String::getByteCount(const char* in_pszString, std::string::size_type in_utf
 
 std::string::size_type String::byteCount() const
 {
-    StringSize len = strlen();
+    StringSize len = this->metrics();
     return std::get<1>(len);
 }
 
@@ -206,6 +253,14 @@ String::String(const uint8_t *in_pszString, std::string::size_type in_iStart, st
 
 String::String(const String& in_sString, std::string::size_type in_iStart, std::string::size_type in_iLength)
 {
+    // No need to walk the characters if each of them is a byte.
+    if(in_sString.isSingleByte()) {
+        if(in_iStart < in_sString.m_s.size())
+            m_s = in_sString.m_s.substr(in_iStart, in_iLength);
+        this->setSingleByteMetrics();
+        return;
+    }
+
     this->fromStringWithLength(in_sString.c_str(), in_iStart, in_iLength);
 }
 
@@ -214,174 +269,186 @@ String::String(const std::string& in_sString, std::string::size_type in_iStart,
     this->fromStringWithLength(in_sString.c_str(), in_iStart, in_iLength);
 }
 
-String String::nr(const int8_t& o, std::streamsize in_iWidth, char in_cFill, std::ios_base::fmtflags in_fmtfl)
-{
-    String s = String::fromSpecialNumber<int8_t>(o);
-    if(!s.empty())
-        return s;
+/** Makes a string out of some characters, filled up to a minimal width the
+ *  way a stream does it.
+ *
+ * \param in_pBegin The first character.
+ * \param in_pEnd After the last character.
+ * \param in_iWidth The minimal width of the string, in bytes.
+ * \param in_cFill What to fill the string up with.
+ * \param in_bLeft Whether the characters go to the left (and the fill to the right).
+ *
+ * \return The string, which is known to be ASCII if \a in_cFill is.
+ */
+String String::padded(const char* in_pBegin, const char* in_pEnd, std::streamsize in_iWidth, char in_cFill, bool in_bLeft)
+{
+    std::string::size_type nChars = static_cast<std::string::size_type>(in_pEnd - in_pBegin);
+    std::string::size_type nFill = in_iWidth > 0 && static_cast<std::string::size_type>(in_iWidth) > nChars ?
+                                   static_cast<std::string::size_type>(in_iWidth) - nChars : 0;
+
+    String ret;
+    ret.m_s.reserve(nChars + nFill);
+    if(!in_bLeft)
+        ret.m_s.append(nFill, in_cFill);
+    ret.m_s.append(in_pBegin, nChars);
+    if(in_bLeft)
+        ret.m_s.append(nFill, in_cFill);
+
+    if(nFill == 0 || (static_cast<unsigned char>(in_cFill) & 0x80) == 0)
+        ret.setSingleByteMetrics();
+    return ret;
+}
+
+/** Writes an integer like a stream would, but without one in the usual cases.
+ *
+ * \param T The type the number is written as by a stream.
+ * \param in_o The number to write.
+ * \param in_iWidth The minimal width, see std::ios_base::width.
+ * \param in_cFill The character to fill up to the width with.
+ * \param in_fmtfl The stream flags to write it with.
+ *
+ * \return The number as a string.
+ */
+template <typename T>
+String String::formatInteger(T in_o, std::streamsize in_iWidth, char in_cFill, std::ios_base::fmtflags in_fmtfl)
+{
+#ifdef __cpp_lib_to_chars
+    // Only the base and the side to fill are supported without a stream.
+    std::ios_base::fmtflags base = in_fmtfl & std::ios::basefield;
+    std::ios_base::fmtflags adjust = in_fmtfl & std::ios::adjustfield;
+    if((in_fmtfl & ~(std::ios::basefield | std::ios::adjustfield)) == 0
+       && (base == 0 || base == std::ios::dec || base == std::ios::hex || base == std::ios::oct)
+       && (adjust == 0 || adjust == std::ios::left || adjust == std::ios::right)) {
+        // Enough for 64 bit in octal.
+        char buf[32];
+        std::to_chars_result res;
+        if(base == std::ios::hex || base == std::ios::oct) {
+            // Streams write negative numbers in hex or oct as their two's complement.
+            res = std::to_chars(buf, buf + sizeof(buf), static_cast<typename std::make_unsigned<T>::type>(in_o), base == std::ios::hex ? 16 : 8);
+        } else {
+            res = std::to_chars(buf, buf + sizeof(buf), in_o);
+        }
+
+        if(res.ec == std::errc())
+            return String::padded(buf, res.ptr, in_iWidth, in_cFill, adjust == std::ios::left);
+    }
+#endif
 
     std::stringstream out;
     out.width(in_iWidth);
     out.fill(in_cFill);
     out.flags(in_fmtfl);
-    // Cast to int prevents that it is taken as a char, without the cast,
-    // if o is for example 16, the ascii char 16 would be created instead of
-    // a string containing "16" (one six).
-    out << (int)o;
+    out << in_o;
 
     return String(out.str());
 }
 
-String String::nr(const uint8_t& o, std::streamsize in_iWidth, char in_cFill, std::ios_base::fmtflags in_fmtfl)
+/** Writes a floating point number like a stream would, but without one in the
+ *  usual cases.
+ *
+ * \param T float or double.
+ * \param in_o The number to write.
+ * \param in_iPrecision The precision, see std::ios_base::precision, -1 to
+ *                      keep the default of a stream.
+ * \param in_iWidth The minimal width, see std::ios_base::width.
+ * \param in_cFill The character to fill up to the width with.
+ * \param in_fmtfl The stream flags to write it with.
+ *
+ * \return The number as a string.
+ */
+template <typename T>
+String String::formatFloat(T in_o, std::streamsize in_iPrecision, std::streamsize in_iWidth, char in_cFill, std::ios_base::fmtflags in_fmtfl)
 {
-    String s = String::fromSpecialNumber<uint8_t>(o);
-    if(!s.empty())
-        return s;
+    String s = String::fromSpecialNumber<T>(in_o);
+    if(!s.empty()) {
+        std::stringstream out;
+        out.width(in_iWidth);
+        out.fill(in_cFill);
+        out << s;
+        return String(out.str());
+    }
+
+#ifdef __cpp_lib_to_chars
+    // Only fixed notation and the side to fill are supported without a stream.
+    std::ios_base::fmtflags adjust = in_fmtfl & std::ios::adjustfield;
+    if((in_fmtfl & ~(std::ios::floatfield | std::ios::adjustfield | std::ios::basefield)) == 0
+       && (in_fmtfl & std::ios::floatfield) == std::ios::fixed
+       && (adjust == 0 || adjust == std::ios::left || adjust == std::ios::right)
+       && in_iPrecision >= -1 && in_iPrecision <= 32) {
+        // Big numbers don't fit and go through the stream.
+        char buf[64];
+        int iPrecision = in_iPrecision == -1 ? 6 : static_cast<int>(in_iPrecision);
+        std::to_chars_result res = std::to_chars(buf, buf + sizeof(buf), in_o, std::chars_format::fixed, iPrecision);
+        if(res.ec == std::errc())
+            return String::padded(buf, res.ptr, in_iWidth, in_cFill, adjust == std::ios::left);
+    }
+#endif
 
     std::stringstream out;
+    if(in_iPrecision != (std::streamsize)-1)
+        out.precision(in_iPrecision);
     out.width(in_iWidth);
     out.fill(in_cFill);
     out.flags(in_fmtfl);
+    out << in_o;
+
+    return String(out.str());
+}
+
+String String::nr(const int8_t& o, std::streamsize in_iWidth, char in_cFill, std::ios_base::fmtflags in_fmtfl)
+{
     // Cast to int prevents that it is taken as a char, without the cast,
     // if o is for example 16, the ascii char 16 would be created instead of
     // a string containing "16" (one six).
-    out << (int)o;
+    return String::formatInteger<int>(o, in_iWidth, in_cFill, in_fmtfl);
+}
 
-    return String(out.str());
+String String::nr(const uint8_t& o, std::streamsize in_iWidth, char in_cFill, std::ios_base::fmtflags in_fmtfl)
+{
+    // Cast to int prevents that it is taken as a char, without the cast,
+    // if o is for example 16, the ascii char 16 would be created instead of
+    // a string containing "16" (one six).
+    return String::formatInteger<int>(o, in_iWidth, in_cFill, in_fmtfl);
 }
 
 String String::nr(const int16_t& o, std::streamsize in_iWidth, char in_cFill, std::ios_base::fmtflags in_fmtfl)
 {
-    String s = String::fromSpecialNumber<int16_t>(o);
-    if(!s.empty())
-        return s;
-
-    std::stringstream out;
-    out.width(in_iWidth);
-    out.fill(in_cFill);
-    out.flags(in_fmtfl);
-    out << (short)o;
-
-    return String(out.str());
+    return String::formatInteger<short>(o, in_iWidth, in_cFill, in_fmtfl);
 }
 
 String String::nr(const uint16_t& o, std::streamsize in_iWidth, char in_cFill, std::ios_base::fmtflags in_fmtfl)
 {
-    String s = String::fromSpecialNumber<uint16_t>(o);
-    if(!s.empty())
-        return s;
-
-    std::stringstream out;
-    out.width(in_iWidth);
-    out.fill(in_cFill);
-    out.flags(in_fmtfl);
-    out << (unsigned short)o;
-
-    return String(out.str());
+    return String::formatInteger<unsigned short>(o, in_iWidth, in_cFill, in_fmtfl);
 }
 
 String String::nr(const int32_t& o, std::streamsize in_iWidth, char in_cFill, std::ios_base::fmtflags in_fmtfl)
 {
-    String s = String::fromSpecialNumber<int32_t>(o);
-    if(!s.empty())
-        return s;
-
-    std::stringstream out;
-    out.width(in_iWidth);
-    out.fill(in_cFill);
-    out.flags(in_fmtfl);
-    out << (int)o;
-
-    return String(out.str());
+    return String::formatInteger<int>(o, in_iWidth, in_cFill, in_fmtfl);
 }
 
 String String::nr(const uint32_t& o, std::streamsize in_iWidth, char in_cFill, std::ios_base::fmtflags in_fmtfl)
 {
-    String s = String::fromSpecialNumber<uint32_t>(o);
-    if(!s.empty())
-        return s;
-
-    std::stringstream out;
-    out.width(in_iWidth);
-    out.fill(in_cFill);
-    out.flags(in_fmtfl);
-    out << (unsigned int)o;
-
-    return String(out.str());
+    return String::formatInteger<unsigned int>(o, in_iWidth, in_cFill, in_fmtfl);
 }
 
 String String::nr(const int64_t& o, std::streamsize in_iWidth, char in_cFill, std::ios_base::fmtflags in_fmtfl)
 {
-    String s = String::fromSpecialNumber<int64_t>(o);
-    if(!s.empty())
-        return s;
-
-    std::stringstream out;
-    out.width(in_iWidth);
-    out.fill(in_cFill);
-    out.flags(in_fmtfl);
-    out << (long long)o;
-
-    return String(out.str());
+    return String::formatInteger<long long>(o, in_iWidth, in_cFill, in_fmtfl);
 }
 
 String String::nr(const uint64_t& o, std::streamsize in_iWidth, char in_cFill, std::ios_base::fmtflags in_fmtfl)
 {
-    String s = String::fromSpecialNumber<uint64_t>(o);
-    if(!s.empty())
-        return s;
-
-    std::stringstream out;
-    out.width(in_iWidth);
-    out.fill(in_cFill);
-    out.flags(in_fmtfl);
-    out << (unsigned long long)o;
-
-    return String(out.str());
+    return String::formatInteger<unsigned long long>(o, in_iWidth, in_cFill, in_fmtfl);
 }
 
 String String::nr(const float& o, std::streamsize in_iPrecision, std::streamsize in_iWidth, char in_cFill, std::ios_base::fmtflags in_fmtfl)
 {
-    String s = String::fromSpecialNumber<float>(o);
-    if(!s.empty()) {
-        std::stringstream out;
-        out.width(in_iWidth);
-        out.fill(in_cFill);
-        out << s;
-        return String(out.str());
-    }
-
-    std::stringstream out;
-    if(in_iPrecision != (std::streamsize)-1)
-        out.precision(in_iPrecision);
-    out.width(in_iWidth);
-    out.fill(in_cFill);
-    out.flags(in_fmtfl);
-    out << o;
-
-    return String(out.str());
+    return String::formatFloat<float>(o, in_iPrecision, in_iWidth, in_cFill, in_fmtfl);
 }
 
 String String::nr(const double& o, std::streamsize in_iPrecision, std::streamsize in_iWidth, char in_cFill, std::ios_base::fmtflags in_fmtfl)
 {
-    String s = String::fromSpecialNumber<double>(o);
-    if(!s.empty()) {
-        std::stringstream out;
-        out.width(in_iWidth);
-        out.fill(in_cFill);
-        out << s;
-        return String(out.str());
-    }
-
-    std::stringstream out;
-    if(in_iPrecision != (std::streamsize)-1)
-        out.precision(in_iPrecision);
-    out.width(in_iWidth);
-    out.fill(in_cFill);
-    out.flags(in_fmtfl);
-    out << o;
-
-    return String(out.str());
+    return String::formatFloat<double>(o, in_iPrecision, in_iWidth, in_cFill, in_fmtfl);
 }
 
 String String::b(const bool& o)
@@ -397,7 +464,7 @@ String String::left(std::string::size_type in_iLength) const
     if(this->empty() || in_iLength < 1)
         return String::EMPTY;
 
-    return String(m_s, 0, in_iLength);
+    return String(*this, 0, in_iLength);
 }
 
 String String::right(std::string::size_type in_iLength) const
@@ -406,9 +473,9 @@ String String::right(std::string::size_type in_iLength) const
         return String::EMPTY;
 
     if(in_iLength >= this->len())
-        return String(this->str());
+        return *this;
 
-    return String(this->str(), this->len()-in_iLength, in_iLength);
+    return String(*this, this->len()-in_iLength, in_iLength);
 }
 
 String String::mid(std::string::size_type in_iLengthLeft, std::string::size_type in_iLengthRight) const
@@ -421,7 +488,7 @@ String String::mid(std::string::size_type in_iLengthLeft, std::string::size_type
     if(in_iLengthLeft + in_iLengthRight >= this->len())
         return String::EMPTY;
 
-    return String(this->str(), in_iLengthLeft, this->len()-in_iLengthLeft-in_iLengthRight);
+    return String(*this, in_iLengthLeft, this->len()-in_iLengthLeft-in_iLengthRight);
 }
 
 String String::sfromHex(uint8_t in_cNumber, bool in_bCaps)
@@ -608,13 +675,13 @@ bool String::empty() const
 
 std::string::size_type String::len() const
 {
-    StringSize len = strlen();
+    StringSize len = this->metrics();
     return std::get<0>(len);
 }
 
 int String::lenInt() const
 {
-    StringSize len = strlen();
+    StringSize len = this->metrics();
     return (int)std::get<0>(len);
 }
 
@@ -624,33 +691,33 @@ String& String::removeChar(std::string::size_type in_ulIndex)
         return *this;
 
     if(in_ulIndex >= this->len()) {
-        m_s = this->left(this->len()-1).str();
+        *this = this->left(this->len()-1);
         return *this;
     }
 
     String tmpA(*this, 0, in_ulIndex);
     String tmpB(*this, in_ulIndex+1);
 
-    m_s = (tmpA + tmpB).str();
+    *this = tmpA + tmpB;
     return *this;
 }
 
 String& String::addChar(std::string::size_type in_ulIndex, unsigned char in_cChar)
 {
     if(in_ulIndex == 0) {
-        m_s = (String::chr(in_cChar) + *this).str();
+        *this = String::chr(in_cChar) + *this;
         return *this;
     }
 
     if(in_ulIndex >= this->len()) {
-        m_s = (*this + String::chr(in_cChar)).str();
+        *this += String::chr(in_cChar);
         return *this;
     }
 
     String strA(*this, 0, in_ulIndex);
     String strB(*this, in_ulIndex);
 
-    m_s = (strA + String::chr(in_cChar) + strB).str();
+    *this = strA + String::chr(in_cChar) + strB;
     return *this;
 }
 
@@ -672,7 +739,7 @@ String& String::replaceStr(std::string::size_type in_ulIndex,
     String strA(*this, 0, in_ulIndex);
     String strB(*this, in_ulIndex + in_ulLenght);
 
-    m_s = (strA + in_pszNew + strB).str();
+    *this = strA + in_pszNew + strB;
     return *this;
 }
 
@@ -880,6 +947,7 @@ String& String::operator =(const char *in_pszString)
     else
         m_s = in_pszString;
 
+    this->invalidateMetrics();
     return *this;
 }
 
@@ -889,11 +957,8 @@ String& String::operator =(const String& in_sString)
     if(this == &in_sString)
         return *this;
 
-    // Set me to the empty string.
-    if(in_sString.empty())
-        this->m_s = String::EMPTY.str();
-
-    m_s = in_sString.str();
+    m_s = in_sString.m_s;
+    m_uiMetrics.store(in_sString.m_uiMetrics.load(std::memory_order_relaxed), std::memory_order_relaxed);
     return *this;
 }
 
@@ -927,6 +992,7 @@ void String::operator +=(const char *in_pszString)
         return;
 
     m_s += in_pszString;
+    this->invalidateMetrics();
 }
 
 void String::operator +=(const String& in_sString)
@@ -934,7 +1000,12 @@ void String::operator +=(const String& in_sString)
     if(in_sString.empty())
         return;
 
+    // Two strings of single byte characters make one, no need to walk it later.
+    std::uint64_t uiMine = m_uiMetrics.load(std::memory_order_relaxed);
+    std::uint64_t uiOther = in_sString.m_uiMetrics.load(std::memory_order_relaxed);
     this->operator +=(in_sString.c_str());
+    if((uiMine & MetricsSingleByte) && (uiOther & MetricsSingleByte))
+        this->setSingleByteMetrics();
 }
 
 bool String::operator == (const char *in_pszString) const
@@ -992,6 +1063,8 @@ bool String::operator <(const String& in_sString) const
 
 unsigned char& String::operator[] (std::string::size_type in_iIndex)
 {
+    // We can't know what will be written into it.
+    this->invalidateMetrics();
     return reinterpret_cast<unsigned char&>(m_s.at(in_iIndex));
 }
 
@@ -1000,6 +1073,9 @@ unsigned char String::getCharAt(std::string::size_type in_iIndex) const
     if(this->empty() || in_iIndex >= this->len())
         return 0;
 
+    if(this->isSingleByte())
+        return static_cast<unsigned char>(m_s[in_iIndex]);
+
     return *(advance(this->c_str(), in_iIndex));
 }
 
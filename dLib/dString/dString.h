@@ -4,6 +4,8 @@
 /* Why do my own ? because I like reinvent the wheel ... maybe i'll write my own OpenGL hehe ... no. */
 
 #include "main.h"
+#include <atomic>
+#include <cstdint>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -32,13 +34,38 @@ class String {
 private:
     std::string m_s;
 
+    /// What \a strlen finds out about \a m_s, remembered because the whole
+    /// string has to be walked for it. 0 means it is not known (yet), every
+    /// change to \a m_s has to reset it. Else it is made of the bits below.
+    /// It is atomic because a const string may be measured by several threads
+    /// at once, but is only loaded and stored, never locked.
+    mutable std::atomic<std::uint64_t> m_uiMetrics{0};
+    /// Set if \a m_uiMetrics is known.
+    static const std::uint64_t MetricsKnown = 1ull << 63;
+    /// Set if every character is a single byte and there is no 0 byte inside,
+    /// then character indices are byte indices. This is the case for ASCII.
+    static const std::uint64_t MetricsSingleByte = 1ull << 62;
+    /// The lowest 31 bits are the length in characters, the next 31 bits the
+    /// length in bytes. Longer strings are just never remembered.
+    static const std::uint64_t MetricsMaxLen = (1ull << 31) - 1;
+
     template <typename T>
     static String fromSpecialNumber(T number);
+    template <typename T>
+    static String formatInteger(T in_o, std::streamsize in_iWidth, char in_cFill, std::ios_base::fmtflags in_fmtfl);
+    template <typename T>
+    static String formatFloat(T in_o, std::streamsize in_iPrecision, std::streamsize in_iWidth, char in_cFill, std::ios_base::fmtflags in_fmtfl);
+    static String padded(const char* in_pBegin, const char* in_pEnd, std::streamsize in_iWidth, char in_cFill, bool in_bLeft);
     void fromStringWithLength(const char* in_pszString, std::string::size_type in_iStart, std::string::size_type in_iLength);
     int getByteCount(const char* in_pszString, std::string::size_type in_utf8Len);
     const char* advance(const char* in_pszString, std::string::size_type in_utf8Len) const;
     typedef std::tuple<std::string::size_type, std::string::size_type> StringSize;
     StringSize strlen() const;
+    StringSize metrics() const;
+    bool isSingleByte() const;
+    void setSingleByteMetrics();
+    /// Forgets the metrics, to be called whenever \a m_s changes.
+    inline void invalidateMetrics() {m_uiMetrics.store(0, std::memory_order_relaxed);};
 public:
     static const String sWhiteSpace;
 
@@ -649,6 +676,19 @@ struct cstring_eqcomp {
   {return lhs==rhs;}
 };
 
+    /// Use this to hash strings, for example in unordered maps (32 bit FNV-1a of the UTF-8 bytes).
+struct cstring_hash {
+  std::size_t operator() (const FTS::String& s) const
+  {
+    std::uint32_t uiHash = 2166136261u;
+    for(const unsigned char *p = reinterpret_cast<const unsigned char *>(s.c_str()) ; *p ; ++p) {
+      uiHash ^= *p;
+      uiHash *= 16777619u;
+    }
+    return uiHash;
+  }
+};
+
 template <class Generator>
 FTS::String FTS::String::random(const String& in_sPattern, Generator gen)
 {
@@ -7,45 +7,216 @@
 
 
 #include "dString.h"
-#include "dLib/dConf/configuration.h"
+#include "dLib/dConf/ConfigurationStore.h"
 #include "dTranslation.h"
 #include "logging/logger.h"
+#include "utilities/DataContainer.h"
+
+#include <experimental/filesystem>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace fs = std::experimental::filesystem;
 
 using namespace FTS;
 
+/// The version of the binary cache files, to be increased when they change.
+#define D_TRANSLATION_CACHE_VERSION 1
+
+namespace {
+    /// Guards all the static state below.
+    std::mutex g_translationMutex;
+    /// The tables that have been loaded already, by language and file.
+    std::map< std::pair<String, String>, std::shared_ptr<const TranslationTable> > g_translationTables;
+    /// Where to keep the compiled tables, empty if nowhere.
+    Path g_sTranslationCacheDir;
+
+    /// Describes how the source files of a table look like now, to find out
+    /// whether the cache is stale.
+    String fingerprint(const std::vector<Path>& in_sources)
+    {
+        String sFingerprint;
+        for(const Path& sSource : in_sources) {
+            std::error_code ec;
+            std::uintmax_t uiSize = fs::file_size(sSource.c_str(), ec);
+            auto mtime = fs::last_write_time(sSource.c_str(), ec);
+            sFingerprint += sSource + ":" + String::nr(static_cast<uint64_t>(ec ? 0 : uiSize))
+                          + ":" + String::nr(static_cast<int64_t>(ec ? 0 : mtime.time_since_epoch().count())) + "\n";
+        }
+        return sFingerprint;
+    }
+
+    /** Reads a compiled table out of the cache.
+     *
+     * \param in_sCache The cache file.
+     * \param in_sources The XML files the table has been compiled from.
+     * \param out_table Receives the translations.
+     *
+     * \return false if there is no usable cache, because it doesn't exist, is
+     *         broken or the XML files changed since it has been written.
+     */
+    bool readCache(const Path& in_sCache, const std::vector<Path>& in_sources, TranslationTable& out_table)
+    {
+        try {
+            if(!FileUtils::fileExists(in_sCache))
+                return false;
+
+            File::Ptr pFile = File::open(in_sCache, File::Read);
+
+            // The last four bytes are the checksum of everything else.
+            if(pFile->getSize() < sizeof(std::uint32_t))
+                return false;
+            std::uint64_t uiDataSize = pFile->getSize() - sizeof(std::uint32_t);
+            ConstRawDataContainer data(pFile->getDataContainer().getData(), static_cast<std::size_t>(uiDataSize));
+            pFile->setCursorPos(uiDataSize);
+            if(pFile->readui32() != data.fletcher32())
+                return false;
+            pFile->setCursorPos(0);
+
+            if(pFile->readstr() != "FTSTRC" || pFile->readui8() != D_TRANSLATION_CACHE_VERSION)
+                return false;
+
+            // The sources must not have changed since then.
+            if(pFile->readstr() != fingerprint(in_sources))
+                return false;
+
+            std::uint32_t nEntries = pFile->readui32();
+            out_table.reserve(nEntries);
+            for(std::uint32_t i = 0 ; i < nEntries && pFile->getCursorPos() < uiDataSize ; ++i) {
+                String sKey = pFile->readstr();
+                out_table[sKey] = pFile->readstr();
+            }
+            if(out_table.size() == nEntries)
+                return true;
+        } catch(const ArkanaException&) {
+        }
+
+        out_table.clear();
+        return false;
+    }
+
+    /** Writes a compiled table into the cache. Failing to do so is not a
+     *  problem, the table will just be compiled again the next time.
+     *
+     * \param in_sCache The cache file.
+     * \param in_sources The XML files the table has been compiled from.
+     * \param in_table The translations.
+     */
+    void writeCache(const Path& in_sCache, const std::vector<Path>& in_sources, const TranslationTable& in_table)
+    {
+        try {
+            File::Ptr pFile = File::overwriteDelayed(in_sCache, File::Insert);
+            pFile->write("FTSTRC");
+            pFile->write(static_cast<std::uint8_t>(D_TRANSLATION_CACHE_VERSION));
+            pFile->write(fingerprint(in_sources));
+            pFile->write(static_cast<std::uint32_t>(in_table.size()));
+            for(auto i = in_table.begin() ; i != in_table.end() ; ++i) {
+                pFile->write(i->first);
+                pFile->write(i->second);
+            }
+
+            std::uint32_t uiFletcher32 = pFile->getDataContainer().fletcher32();
+            pFile->write(uiFletcher32);
+            pFile->save();
+        } catch(const ArkanaException& e) {
+            FTSMSGDBG("Could not write the translation cache " + in_sCache + ": " + e.what(), 1);
+        }
+    }
+}
+
+/** Gets the translations of a domain in the language the player chose.
+ *  The XML files of the translations are only read the first time a domain is
+ *  needed in a language, after that all translations share the same table.
+ *
+ * \param in_sFile The domain, that is the name of the file in the language
+ *                 directory, without extension. For example "ui".
+ */
 Translation::Translation(const String& in_sFile)
     : m_bLogging(true)
 {
-    Configuration conf("conf.xml", ArkanaDefaultSettings());
-    Path sFile = Path::datadir("Languages") + Path(conf.get<std::string>("Language")) + Path(in_sFile + ".xml");
-    Options optTranslation = Configuration::buildFromFile(sFile);
-    m_confTranslation = new Configuration(optTranslation);
-    sFile = Path::datadir("Languages/English") + Path(in_sFile + ".xml");;
-    optTranslation = Configuration::buildFromFile(sFile);
-    m_confTranslationDefault = new Configuration(optTranslation);
-
+    Configuration::Ptr pConf = ConfigurationStore::getSingleton().getMainConf();
+    m_pTable = Translation::load(pConf->get<std::string>("Language"), in_sFile);
 }
+
 Translation::~Translation() 
 {
-    delete m_confTranslation;
-    delete m_confTranslationDefault;
 }
 
-String Translation::get(String in_sString)
+const String* Translation::find(const String& in_sString) const
 {
-    try {
-        return m_confTranslation->get<std::string>(in_sString);
-    } catch(CorruptDataException& ) {
-        try {
-            // If there was an error, first try in English. If that doesn't work, load default error string.
-            return m_confTranslationDefault->get<std::string>(in_sString);
-        } catch(CorruptDataException&) {
-            // Print a warning to the logfile.
-            if(m_bLogging) {
-                FTSMSG(String("Missing translation for ") + in_sString, MsgType::WarningNoMB);
-            }
-        }
+    auto i = m_pTable->find(in_sString);
+    return i == m_pTable->end() ? nullptr : &i->second;
+}
+
+/// \return The translation of \a in_sString, or the English one if there is
+///         none. If there is no English one either, an empty string.
+String Translation::get(const String& in_sString) const
+{
+    const String* pTranslated = this->find(in_sString);
+    if(pTranslated != nullptr)
+        return *pTranslated;
+
+    // Print a warning to the logfile.
+    if(m_bLogging) {
+        FTSMSG(String("Missing translation for ") + in_sString, MsgType::WarningNoMB);
     }
     return String::EMPTY;
 }
 
+/** Makes the translations keep their compiled tables in binary files, so that
+ *  the next time they are needed, no XML needs to be parsed. A cached table
+ *  is only used as long as its XML files didn't change.
+ *
+ * \param in_sDir The directory to keep the files in, empty to not use any.
+ */
+void Translation::setCacheDir(const Path& in_sDir)
+{
+    std::lock_guard<std::mutex> lock(g_translationMutex);
+    g_sTranslationCacheDir = in_sDir;
+}
+
+/// Forgets all tables, so that they are loaded again when they are needed.
+/// Translations that exist already keep their table.
+void Translation::unloadAll()
+{
+    std::lock_guard<std::mutex> lock(g_translationMutex);
+    g_translationTables.clear();
+}
+
+/** Gets the table of a domain in a language, loading it if needed.
+ *
+ * \param in_sLanguage The language to translate into.
+ * \param in_sFile The domain.
+ *
+ * \return The table, with the English translations where the language has none.
+ */
+std::shared_ptr<const TranslationTable> Translation::load(const String& in_sLanguage, const String& in_sFile)
+{
+    std::lock_guard<std::mutex> lock(g_translationMutex);
+    std::shared_ptr<const TranslationTable>& pTable = g_translationTables[std::make_pair(in_sLanguage, in_sFile)];
+    if(pTable)
+        return pTable;
+
+    std::vector<Path> sources;
+    sources.push_back(Path::datadir("Languages/English") + Path(in_sFile + ".xml"));
+    sources.push_back(Path::datadir("Languages") + Path(in_sLanguage) + Path(in_sFile + ".xml"));
+
+    std::shared_ptr<TranslationTable> pNew = std::make_shared<TranslationTable>();
+    Path sCache = g_sTranslationCacheDir.empty() ? Path() : g_sTranslationCacheDir + Path(in_sLanguage) + Path(in_sFile + ".bin");
+    if(sCache.empty() || !readCache(sCache, sources, *pNew)) {
+        // The language's translations override the English ones.
+        for(const Path& sSource : sources) {
+            Options opts = Configuration::buildFromFile(sSource);
+            for(auto i = opts.begin() ; i != opts.end() ; ++i) {
+                (*pNew)[i->first] = i->second;
+            }
+        }
+
+        if(!sCache.empty())
+            writeCache(sCache, sources, *pNew);
+    }
+
+    pTable = pNew;
+    return pTable;
+}
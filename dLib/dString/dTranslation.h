@@ -1,21 +1,37 @@
 #ifndef FTS_TRANSLATION_H
 #define FTS_TRANSLATION_H
 
+#include "dLib/dString/dPath.h"
+
+#include <memory>
+#include <unordered_map>
 
 namespace FTS {
 
+    /// All translations of one domain (file) into one language, with the
+    /// English ones filling the gaps. Once built, it never changes, so it can
+    /// be shared between all users and threads.
+    typedef std::unordered_map<String, String, cstring_hash, cstring_eqcomp> TranslationTable;
+
     class Translation {
     public:
-        Translation(const class String& in_sFile);
+        Translation(const String& in_sFile);
         virtual ~Translation() ;
-        String get(String in_sString);
+        String get(const String& in_sString) const;
+        /// \return The translation of \a in_sString, nullptr if there is none,
+        ///         not even in English. Nothing gets logged.
+        const String* find(const String& in_sString) const;
         void setNoLogging(bool noLogging = true) {m_bLogging = !noLogging;} // Useful for unit testing
+
+        static void setCacheDir(const Path& in_sDir);
+        static void unloadAll();
     private:
-        class Configuration* m_confTranslationDefault;
-        class Configuration* m_confTranslation;
+        static std::shared_ptr<const TranslationTable> load(const String& in_sLanguage, const String& in_sFile);
+
+        std::shared_ptr<const TranslationTable> m_pTable;
         bool m_bLogging;
     };
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -8,7 +8,7 @@
 #include "game/game_rlv.h"
 
 #include "dLib/dArchive/dArchive.h" // To unload the map archive
-#include "dLib/dConf/configuration.h"
+#include "dLib/dConf/ConfigurationStore.h"
 #include "dLib/dString/dTranslation.h"
 #include "graphic/graphic.h" // For the ICP and RB.
 #include "input/input.h" // For the keyboard shortcuts.
@@ -55,10 +55,10 @@ GameRlv::~GameRlv()
  */
 bool GameRlv::load()
 {
-    Configuration conf ("conf.xml", ArkanaDefaultSettings());
+    Configuration::Ptr pConf = ConfigurationStore::getSingleton().getMainConf();
 
-    m_screenWidth  = conf.get<int>("HRes");
-    m_screenHeight = conf.get<int>("VRes");
+    m_screenWidth  = pConf->get<int>("HRes");
+    m_screenHeight = pConf->get<int>("VRes");
     // Change the camera. TODO: Make this in the map's script.
     this->getMainCamera().resetOrientation();
     this->getMainCamera().position(Vector(0.0f,-60.0f,80.0f));
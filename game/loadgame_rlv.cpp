@@ -15,6 +15,7 @@
 #include <elements/CEGUIProgressBar.h> // For the progressbar.
 
 #include "game/game_rlv.h"
+#include "3d/Renderer.h" // To know whether anybody can press a button.
 #include "graphic/graphic.h" // For the ICP and RB.
 #include "ui/ui.h" // For loadlayout.
 #include "ui/ui_menu.h" // Go back there if some important thing failed.
@@ -23,6 +24,7 @@
 #include "logging/logger.h"
 #include "logging/ftslogger.h" // To suppress all dlgs while in loadscreen.
 #include "logging/Chronometer.h"
+#include "logging/Profiler.h"
 #include "map/map.h"
 #include "map/mapinfo.h"
 #include "scripting/DaoVm.h"
@@ -392,6 +394,8 @@ void FTS::LoadGameRlv::setState( ILoadGameState* state )
 
 void FTS::LoadGameRlv::StateLoadBeginning::doLoad( LoadGameRlv * context )
 {
+    FTS_PROFILE_SCOPE("LoadGameRlv::StateLoadBeginning");
+
     // Do nothing in this stage, only update the screen.
 
     // This stage is done, show the user what will be done in the next one.
@@ -401,6 +405,8 @@ void FTS::LoadGameRlv::StateLoadBeginning::doLoad( LoadGameRlv * context )
 
 void FTS::LoadGameRlv::StateLoadMapInfo::doLoad( LoadGameRlv * context )
 {
+    FTS_PROFILE_SCOPE("LoadGameRlv::StateLoadMapInfo");
+
     context->m_pGame->getMap()->getInfo()->load();
     context->setupLoadscreenDetails(context->m_pGame->getMap()->getInfo());
 
@@ -412,6 +418,8 @@ void FTS::LoadGameRlv::StateLoadMapInfo::doLoad( LoadGameRlv * context )
 
 void FTS::LoadGameRlv::StateLoadTerrainInfo::doLoad( LoadGameRlv * context )
 {
+    FTS_PROFILE_SCOPE("LoadGameRlv::StateLoadTerrainInfo");
+
     // This stage loads the various informations about the terrain.
     context->m_pTerrainLoadingInfo = new Terrain::SLoadingInfo(context->m_pGame->getMap()
         ->getInfo()
@@ -433,6 +441,8 @@ void FTS::LoadGameRlv::StateLoadTerrainInfo::doLoad( LoadGameRlv * context )
 
 void FTS::LoadGameRlv::StateLoadTerrainQuads::doLoad( LoadGameRlv * context )
 {
+    FTS_PROFILE_SCOPE("LoadGameRlv::StateLoadTerrainQuads");
+
     // This stage loads the quads of the terrain.
     Terrain *pT = context->m_pGame->getMap()->m_pTerrain;
     if(ERR_OK != pT->loadQuads(*context->m_pTerrainLoadingInfo)) {
@@ -451,6 +461,8 @@ void FTS::LoadGameRlv::StateLoadTerrainQuads::doLoad( LoadGameRlv * context )
 
 void FTS::LoadGameRlv::StateLoadTerrainLoadLowerTiles::doLoad( LoadGameRlv * context )
 {
+    FTS_PROFILE_SCOPE("LoadGameRlv::StateLoadTerrainLoadLowerTiles");
+
     // This stage loads the lower tiles of the terrain.
     Terrain *pT = context->m_pGame->getMap()->m_pTerrain;
     if(ERR_OK != pT->loadLowerTiles(*context->m_pTerrainLoadingInfo)) {
@@ -466,6 +478,8 @@ void FTS::LoadGameRlv::StateLoadTerrainLoadLowerTiles::doLoad( LoadGameRlv * con
 
 void FTS::LoadGameRlv::StateLoadTerrainCompileLowerTileset::doLoad( LoadGameRlv * context )
 {
+    FTS_PROFILE_SCOPE("LoadGameRlv::StateLoadTerrainCompileLowerTileset");
+
     // This stage loads compiles the lower tileset of the terrain.
     Terrain *pT = context->m_pGame->getMap()->m_pTerrain;
     if(ERR_OK != pT->compileLowerTiles(*context->m_pTerrainLoadingInfo)) {
@@ -483,6 +497,8 @@ void FTS::LoadGameRlv::StateLoadTerrainCompileLowerTileset::doLoad( LoadGameRlv
 
 void FTS::LoadGameRlv::StateLoadTerrainUpperTiles::doLoad( LoadGameRlv * context )
 {
+    FTS_PROFILE_SCOPE("LoadGameRlv::StateLoadTerrainUpperTiles");
+
     // This stage loads the upper tiles of the terrain.
     Terrain *pT = context->m_pGame->getMap()->m_pTerrain;
     if(ERR_OK != pT->loadUpperTiles(*context->m_pTerrainLoadingInfo)) {
@@ -498,6 +514,8 @@ void FTS::LoadGameRlv::StateLoadTerrainUpperTiles::doLoad( LoadGameRlv * context
 
 void FTS::LoadGameRlv::StateLoadTerrainPrecalc::doLoad( LoadGameRlv * context )
 {
+    FTS_PROFILE_SCOPE("LoadGameRlv::StateLoadTerrainPrecalc");
+
     // This stage pre-calculates the texture coordinates and normals.
     Terrain *pT = context->m_pGame->getMap()->m_pTerrain;
     pT->precalcTexCoords(*context->m_pTerrainLoadingInfo);
@@ -511,6 +529,8 @@ void FTS::LoadGameRlv::StateLoadTerrainPrecalc::doLoad( LoadGameRlv * context )
 
 void FTS::LoadGameRlv::StateLoadForests::doLoad( LoadGameRlv * context )
 {
+    FTS_PROFILE_SCOPE("LoadGameRlv::StateLoadForests");
+
     // This stage load the forests (if there are some)
     //         if(FileUtils::fileExists(TEMP "forests") && FileUtils::fileExists(TEMP "forests.conf")) {
     //             m_pGame->getMap()->loadForests(TEMP "forests", TEMP "forests.conf");
@@ -524,6 +544,8 @@ void FTS::LoadGameRlv::StateLoadForests::doLoad( LoadGameRlv * context )
 
 void FTS::LoadGameRlv::StateLoadScripts::doLoad( LoadGameRlv * context )
 {
+    FTS_PROFILE_SCOPE("LoadGameRlv::StateLoadScripts");
+
     DaoVm::getSingleton().pushContext(); // Start a new context in the vm.
     DaoVm::getSingleton().execute(Path("MapLoad.dao"));
     // This stage is done, show the user what will be done in the next one.
@@ -533,9 +555,15 @@ void FTS::LoadGameRlv::StateLoadScripts::doLoad( LoadGameRlv * context )
 
 void FTS::LoadGameRlv::StateLoadFinalize::doLoad( LoadGameRlv * context )
 {
+    FTS_PROFILE_SCOPE("LoadGameRlv::StateLoadFinalize");
+
     // This stage is done, show the user what will be done in the next one.
     String sTxt = context->getTranslation("Loadscr_Stage_Starting");
-    if(context->m_pGame->getMap()->getInfo()->getPressBtn()) {
+    if(Renderer::isHeadless()) {
+        // Nobody is there to press a button, start right away.
+        RunlevelManager::getSingleton().prepareRunlevelEntrance(context->m_pGame);
+        context->m_pGame = nullptr;
+    } else if(context->m_pGame->getMap()->getInfo()->getPressBtn()) {
         sTxt += " " + context->getTranslation("PressEnterToCont");
 
         // Wait for a button to be pressed? The register a callback.
@@ -553,5 +581,6 @@ void FTS::LoadGameRlv::StateLoadFinalize::doLoad( LoadGameRlv * context )
 
 void FTS::LoadGameRlv::StateLoadDone::doLoad( LoadGameRlv * context )
 {
+    FTS_PROFILE_SCOPE("LoadGameRlv::StateLoadDone");
 
 }
@@ -145,6 +145,8 @@ public:
     void render2D(const Clock&) override;
     String getName() override;
     bool update(const Clock&) override;
+    /// Loads one stage per frame, also OpenGL and CEGUI stuff.
+    Phase getUpdatePhase() const override {return PreRender;};
     void setState(ILoadGameState* state);
 };
 };
@@ -20,7 +20,7 @@
 #include "main/runlevels.h"
 #include "ui/ui_menu_online.h" // To get back there in og_chatCheckEvents.
 #include "dLib/dString/dString.h"
-#include "dLib/dConf/configuration.h"
+#include "dLib/dConf/ConfigurationStore.h"
 
 using namespace FTS;
 
@@ -73,18 +73,18 @@ int FTS::Player::og_connectMaster(uint32_t in_uiTimeoutMS)
         SAFE_DELETE(m_pcMasterServer);
     }
 
-    Configuration conf ("conf.xml", ArkanaDefaultSettings());
+    Configuration::Ptr pConf = ConfigurationStore::getSingleton().getMainConf();
 
-    String sServer = conf.get<std::string>("MasterServerName");
-    int iPort = conf.get<int>("MasterServerPort");
-    unsigned long timeout= conf.get<int>( "ConnectionConnectTimeOut" );
+    String sServer = pConf->get<std::string>("MasterServerName");
+    int iPort = pConf->get<int>("MasterServerPort");
+    unsigned long timeout= pConf->get<int>( "ConnectionConnectTimeOut" );
     FTSMSGDBG("  Connecting to the master server "+sServer+":"+String::nr(iPort), 3);
     m_pcMasterServer =  Connection::create(Connection::eConnectionType::D_CONNECTION_TRADITIONAL, sServer.c_str(), iPort, timeout);
     if(!m_pcMasterServer->isConnected()) {
         SAFE_DELETE(m_pcMasterServer);
         return -1;
     }
-    m_pcMasterServer->setMaxWaitMillisec( conf.get<int>( "ConnectionTimeOut" ) );
+    m_pcMasterServer->setMaxWaitMillisec( pConf->get<int>( "ConnectionTimeOut" ) );
     return ERR_OK;
 }
 
@@ -33,7 +33,7 @@ FTS::Anim::~Anim()
 int FTS::Anim::load()
 {
     try {
-        FTSMSGDBG("Loading animation from file '"+m_sFile+"'", 2);
+        FTSMSGDBG("Loading animation from file '{1}'", 2, m_sFile);
 
         // First, if there's still something loaded, unload it.
         if(m_bLoaded)
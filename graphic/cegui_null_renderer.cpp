@@ -0,0 +1,110 @@
+#include "cegui_null_renderer.h"
+
+#include <CEGUIExceptions.h>
+#include <CEGUIImageCodec.h>
+#include <CEGUIResourceProvider.h>
+#include <CEGUISystem.h>
+
+namespace CEGUI
+{
+
+NullTexture::NullTexture(Renderer* owner)
+    : Texture(owner)
+    , d_width(0)
+    , d_height(0)
+{
+}
+
+NullTexture::~NullTexture()
+{
+}
+
+void NullTexture::loadFromFile(const String& filename, const String& resourceGroup)
+{
+    // Decode it like the OpenGL texture does, only to know the size.
+    NullRenderer* renderer = static_cast<NullRenderer*>(getRenderer());
+    RawDataContainer texFile;
+    System::getSingleton().getResourceProvider()->loadRawDataContainer(filename, texFile, resourceGroup);
+    Texture* res = renderer->getImageCodec().load(texFile, this);
+    System::getSingleton().getResourceProvider()->unloadRawDataContainer(texFile);
+    if(res == 0) {
+        throw RendererException("NullTexture::loadFromFile - " +
+                                renderer->getImageCodec().getIdentifierString() +
+                                " failed to load image '" + filename + "'.");
+    }
+}
+
+void NullTexture::loadFromMemory(const void* /*buffPtr*/, uint buffWidth, uint buffHeight, PixelFormat /*pixelFormat*/)
+{
+    d_width = static_cast<ushort>(buffWidth);
+    d_height = static_cast<ushort>(buffHeight);
+}
+
+NullRenderer::NullRenderer(int width, int height, ImageCodec* codec)
+    : d_display_area(0.0f, 0.0f, static_cast<float>(width), static_cast<float>(height))
+    , d_queueing(true)
+    , d_imageCodec(codec)
+{
+    d_identifierString = "CEGUI::NullRenderer - Arkana-FTS renderer for running without a display";
+}
+
+NullRenderer::~NullRenderer()
+{
+    destroyAllTextures();
+}
+
+Texture* NullRenderer::createTexture(void)
+{
+    NullTexture* tex = new NullTexture(this);
+    d_texturelist.push_back(tex);
+    return tex;
+}
+
+Texture* NullRenderer::createTexture(const String& filename, const String& resourceGroup)
+{
+    NullTexture* tex = new NullTexture(this);
+    try {
+        tex->loadFromFile(filename, resourceGroup);
+    } catch(RendererException&) {
+        delete tex;
+        throw;
+    }
+    d_texturelist.push_back(tex);
+    return tex;
+}
+
+Texture* NullRenderer::createTexture(float size)
+{
+    NullTexture* tex = new NullTexture(this);
+    tex->loadFromMemory(0, static_cast<uint>(size), static_cast<uint>(size), Texture::PF_RGBA);
+    d_texturelist.push_back(tex);
+    return tex;
+}
+
+void NullRenderer::destroyTexture(Texture* texture)
+{
+    if(texture) {
+        NullTexture* tex = static_cast<NullTexture*>(texture);
+        d_texturelist.remove(tex);
+        delete tex;
+    }
+}
+
+void NullRenderer::destroyAllTextures(void)
+{
+    while(!d_texturelist.empty()) {
+        destroyTexture(*(d_texturelist.begin()));
+    }
+}
+
+void NullRenderer::setDisplaySize(const Size& sz)
+{
+    if(d_display_area.getSize() != sz) {
+        d_display_area.setSize(sz);
+
+        EventArgs args;
+        fireEvent(EventDisplaySizeChanged, args, EventNamespace);
+    }
+}
+
+} // End of CEGUI namespace section
@@ -0,0 +1,77 @@
+#ifndef D_CEGUI_NULL_RENDERER_H
+#define D_CEGUI_NULL_RENDERER_H
+
+#include <CEGUIRenderer.h>
+#include <CEGUITexture.h>
+
+#include <list>
+
+namespace CEGUI
+{
+class ImageCodec;
+
+/*!
+  \brief
+  A texture that only knows its size.
+
+  The images are still decoded, so that loading them costs what it costs
+  with a real renderer, but their pixels are thrown away.
+*/
+class NullTexture : public Texture {
+    ushort d_width;
+    ushort d_height;
+public:
+    NullTexture(Renderer* owner);
+    virtual ~NullTexture();
+
+    virtual ushort getWidth(void) const {return d_width;}
+    virtual ushort getHeight(void) const {return d_height;}
+
+    virtual void loadFromFile(const String& filename, const String& resourceGroup);
+    virtual void loadFromMemory(const void* buffPtr, uint buffWidth, uint buffHeight, PixelFormat pixelFormat);
+};
+
+/*!
+  \brief
+  Renderer for running without a display.
+
+  The whole GUI is laid out and every quad is handed to the renderer just
+  like with the OpenGL renderer, but nothing gets drawn.
+*/
+class NullRenderer : public Renderer {
+    Rect d_display_area;
+    bool d_queueing;
+    ImageCodec* d_imageCodec;
+    std::list<NullTexture*> d_texturelist;
+public:
+    NullRenderer(int width, int height, ImageCodec* codec);
+    virtual ~NullRenderer();
+
+    virtual void addQuad(const Rect&, float, const Texture*, const Rect&, const ColourRect&, QuadSplitMode) {}
+    virtual void doRender(void) {}
+    virtual void clearRenderList(void) {}
+    virtual void setQueueingEnabled(bool setting) {d_queueing = setting;}
+    virtual bool isQueueingEnabled(void) const {return d_queueing;}
+
+    virtual Texture* createTexture(void);
+    virtual Texture* createTexture(const String& filename, const String& resourceGroup);
+    virtual Texture* createTexture(float size);
+    virtual void destroyTexture(Texture* texture);
+    virtual void destroyAllTextures(void);
+
+    virtual float getWidth(void) const {return d_display_area.getWidth();}
+    virtual float getHeight(void) const {return d_display_area.getHeight();}
+    virtual Size getSize(void) const {return d_display_area.getSize();}
+    virtual Rect getRect(void) const {return Rect(d_display_area.d_left, d_display_area.d_top, d_display_area.d_right, d_display_area.d_bottom);}
+    virtual uint getMaxTextureSize(void) const {return 16384;}
+    virtual uint getHorzScreenDPI(void) const {return 96;}
+    virtual uint getVertScreenDPI(void) const {return 96;}
+
+    void setDisplaySize(const Size& sz);
+
+    ImageCodec& getImageCodec() {return *d_imageCodec;}
+};
+
+} // End of CEGUI namespace section
+
+#endif /* D_CEGUI_NULL_RENDERER_H */
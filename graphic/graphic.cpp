@@ -3,12 +3,13 @@
 #include "3d/3d.h"
 
 #include "dLib/dFile/dFile.h"
-#include "dLib/dConf/configuration.h"
+#include "dLib/dConf/ConfigurationStore.h"
 #include "graphic/errtex.h"
 #include "graphic/graphic.h"
 #include "graphic/image.h"
 #include "3d/3d.h"
 #include "3d/Mathfwd.h"
+#include "3d/Renderer.h"
 #include "logging/logger.h"
 #include "logging/Chronometer.h"
 #include "utilities/Math.h"
@@ -18,10 +19,15 @@
 #  include <CEGUIDefaultResourceProvider.h>
 #endif
 
+#include <atomic>
 #include <cmath> // floor and ceil
 
 using namespace FTS;
 
+namespace {
+    PerfCounter g_textureBinds("gl.textureBinds");
+}
+
 Graphic::TextureFilter Graphic::toTexureFilter(int i)
 {
     if(i == (int)Nearest_Nearest)
@@ -137,10 +143,16 @@ void Graphic::create(const uint8_t * const in_pData, uint16_t in_uiW, uint16_t i
         memcpy(pPOTData + (uint32_t)y*m_uiRealW*4, in_pData + (uint32_t)y*m_uiW*4, (uint32_t)m_uiW*4);
     }
 
-    // Ask for the memory for the texture.
-    glGenTextures(1, &m_uiID);
+    // Ask for the memory for the texture. Without a display, there's nobody
+    // to ask, but the texture still needs a name of its own.
+    if(Renderer::isHeadless()) {
+        static std::atomic<GLuint> s_uiNextHeadlessID(1);
+        m_uiID = s_uiNextHeadlessID++;
+    } else {
+        glGenTextures(1, &m_uiID);
+    }
     verifGL("Graphic::create(" + String::nr(in_uiW) + "x" + String::nr(in_uiH) + ") glGenTextures");
-    FTSMSGDBG("Created texture with ID "+String::nr(m_uiID), 3);
+    FTSMSGDBG("Created texture with ID {1}", 3, m_uiID);
 
     // Set the texture's params
     glBindTexture(GL_TEXTURE_2D, m_uiID);
@@ -150,10 +162,10 @@ void Graphic::create(const uint8_t * const in_pData, uint16_t in_uiW, uint16_t i
     // Choose the filter, depending on what the settings are.
     // But we can force a filter in code by setting the
     // in_iForceFilter parameter to a value different then 0.
-    Configuration conf ("conf.xml", ArkanaDefaultSettings());
+    Configuration::Ptr pConf = ConfigurationStore::getSingleton().getMainConf();
 
     if(in_forceFilter == DefaultFilter)
-        m_usedFilter = toTexureFilter(conf.get<int>("TextureFilter"));
+        m_usedFilter = toTexureFilter(pConf->get<int>("TextureFilter"));
     else
         m_usedFilter = in_forceFilter;
 
@@ -177,7 +189,7 @@ void Graphic::create(const uint8_t * const in_pData, uint16_t in_uiW, uint16_t i
     // But we can force a filter in code by setting the
     // in_iForceFilter parameter to a value different then 0.
     if(in_forceAnisotropy == DefaultAnisotropy)
-        m_usedAnisotropy = toAnisotropy(conf.get<bool>("Anisotropic"));
+        m_usedAnisotropy = toAnisotropy(pConf->get<bool>("Anisotropic"));
     else
         m_usedAnisotropy = in_forceAnisotropy;
 
@@ -233,7 +245,7 @@ void Graphic::destroy()
 
 bool Graphic::isLoaded() const
 {
-    return (m_uiID != 0) && glIsTexture(m_uiID);
+    return (m_uiID != 0) && (Renderer::isHeadless() || glIsTexture(m_uiID));
 }
 
 /// Copies the pixel-data from the graphics card into a buffer.
@@ -259,6 +271,14 @@ uint8_t *Graphic::copyPixels(bool in_bRealTextureSize) const
         return NULL;
     }
 
+    // Without a display, the pixels are gone, only their size is known.
+    if(Renderer::isHeadless()) {
+        uint32_t uiSize = in_bRealTextureSize ? (uint32_t)m_uiRealW*(uint32_t)m_uiRealH*4 : (uint32_t)m_uiW*(uint32_t)m_uiH*4;
+        uint8_t *pMem = new uint8_t[uiSize];
+        memset(pMem, 0, uiSize);
+        return pMem;
+    }
+
     verifGL("Graphic::copyPixels(id="+String::nr(m_uiID)+") start");
 
     // First at all, select the texture and store the previously selected one.
@@ -390,6 +410,7 @@ int Graphic::draw(int16_t in_iX, int16_t in_iY) const
 
     // Draw a rectangle with the texture on it.
     glColor3f(1.0f, 1.0f, 1.0f);
+    g_drawCalls.add();
     glBegin(GL_TRIANGLE_STRIP);
         // Top left
       glTexCoord2f(m_pfTexcoord[0], m_pfTexcoord[1]);
@@ -435,6 +456,7 @@ int Graphic::drawSub(int16_t in_iX, int16_t in_iY, uint16_t in_iSubX,
 
     // Draw a rectangle with the texture on it.
     glColor3f(1.0f, 1.0f, 1.0f);
+    g_drawCalls.add();
     glBegin(GL_TRIANGLE_STRIP);
         // Top left
       glTexCoord2f(fLeftTex, fTopTex);
@@ -475,6 +497,7 @@ int Graphic::drawRot(int16_t in_iX, int16_t in_iY, float in_fDegrees) const
 
     // Draw a rectangle with the texture on it.
     glColor3f(1.0f, 1.0f, 1.0f);
+    g_drawCalls.add();
     glBegin(GL_TRIANGLE_STRIP);
         // Top left
       glTexCoord2f(m_pfTexcoord[0], m_pfTexcoord[1]);
@@ -512,6 +535,7 @@ int Graphic::drawZoom(int16_t in_iX, int16_t in_iY, float in_fZoomX, float in_fZ
 
     // And finally, draw a rectangle with the texture on it.
     glColor3f(1.0f, 1.0f, 1.0f);
+    g_drawCalls.add();
     glBegin(GL_TRIANGLE_STRIP);
         // Top left
       glTexCoord2f(m_pfTexcoord[0], m_pfTexcoord[1]);
@@ -549,6 +573,7 @@ int Graphic::drawColoured(int16_t in_iX, int16_t in_iY,
 
     // Draw a rectangle with the texture on it.
     glColor4f(in_fR, in_fG, in_fB, in_fA);
+    g_drawCalls.add();
     glBegin(GL_TRIANGLE_STRIP);
         // Top left
       glTexCoord2f(m_pfTexcoord[0], m_pfTexcoord[1]);
@@ -586,6 +611,7 @@ int Graphic::drawEx(int16_t in_iX, int16_t in_iY, uint16_t in_iSubX,
 
     // And finally, draw a rectangle with the texture on it.
     glColor3f( 1.0f, 1.0f, 1.0f );
+    g_drawCalls.add();
     glBegin( GL_TRIANGLE_STRIP );
         // Top left
       glTexCoord2f( m_pfTexcoord[0], m_pfTexcoord[1] );
@@ -641,6 +667,7 @@ void Graphic::select(uint8_t in_iTexUnit) const
         glActiveTexture(GL_TEXTURE0 + in_iTexUnit);
         glEnable(GL_TEXTURE_2D); /// \TODO: We only need GL_TEXTURE_2D as long as we use old-style OpenGL! (Currently only in quad.cpp)
         glBindTexture(GL_TEXTURE_2D, m_uiID);
+        g_textureBinds.add();
         GraphicManager::getSingleton().setSelectedGraphic(in_iTexUnit, this->getID());
         verifGL("Graphic::select(id="+String::nr(m_uiID)+", texUnit="+String::nr(in_iTexUnit)+") end");
     } else {
@@ -951,13 +978,14 @@ Graphic *Graphic::copyResized(uint16_t in_uiNewW, uint16_t in_uiNewH) const
 const String FTS::GraphicManager::ErrorTextureName = "Error";
 
 GraphicManager::GraphicManager()
+    : m_errorTextureName(GraphicManager::ErrorTextureName)
 {
-    FTSMSGDBG("Initialised graphics manager, max texture size: "+String::nr(this->getMaxTextureSize()), 2);
+    FTSMSGDBG("Initialised graphics manager, max texture size: {1}", 2, this->getMaxTextureSize());
 
     // Create the texture that will be used for erroneous textures.
     Graphic *pErrGraph = new Graphic();
     pErrGraph->create(reinterpret_cast<const uint8_t * const>(g_errTex.pixel_data), g_errTex.width, g_errTex.height);
-    m_mGraphicsFromFiles[GraphicManager::ErrorTextureName] = pErrGraph;
+    m_mGraphicsFromFiles[m_errorTextureName] = pErrGraph;
 
     m_vSelectedTextures.assign(this->getMaxTextureUnits(), 0);
 }
@@ -968,12 +996,12 @@ GraphicManager::~GraphicManager()
 
     // Everything should already be deleted.
 
-    for(std::map<String, Graphic *>::iterator i = m_mGraphicsFromFiles.begin() ; i != m_mGraphicsFromFiles.end() ; ++i) {
+    for(GraphicMap::iterator i = m_mGraphicsFromFiles.begin() ; i != m_mGraphicsFromFiles.end() ; ++i) {
         // If there was an error loading that graphic, we close one eye.
         if(i->second == this->getErrorTexture())
             continue;
 
-        FTS18N("Graph_NotUnloaded_File", MsgType::Horror, i->first);
+        FTS18N("Graph_NotUnloaded_File", MsgType::Horror, i->first.str());
     }
 
     // First, search that graphic in the list of graphics made from memory.
@@ -986,7 +1014,7 @@ GraphicManager::~GraphicManager()
     }
 
     // Destroy the error texture.
-    SAFE_DELETE(m_mGraphicsFromFiles[GraphicManager::ErrorTextureName]);
+    SAFE_DELETE(m_mGraphicsFromFiles[m_errorTextureName]);
 
     m_mGraphicsFromFiles.clear();
     m_lGraphicsFromMem.clear();
@@ -1002,7 +1030,7 @@ Graphic *GraphicManager::getOrLoadGraphic(File& out_file, String in_sGraphicName
     }
 
     // Check if the graphic has already been loaded.
-    std::map<String, Graphic*>::iterator i = m_mGraphicsFromFiles.find(in_sGraphicName);
+    GraphicMap::iterator i = m_mGraphicsFromFiles.find(Name(in_sGraphicName));
     if(i != m_mGraphicsFromFiles.end())
         return i->second;
 
@@ -1024,7 +1052,7 @@ Graphic *GraphicManager::getOrLoadGraphic(File& out_file, String in_sGraphicName
 
         // We can safely add it into the map at that position as the map does not
         // contain anything on this position ; tested before.
-        m_mGraphicsFromFiles[in_sGraphicName] = pGraph;
+        m_mGraphicsFromFiles[Name(in_sGraphicName)] = pGraph;
 
         loadChron.measure();
         return pGraph;
@@ -1037,18 +1065,25 @@ Graphic *GraphicManager::getOrLoadGraphic(File& out_file, String in_sGraphicName
 Graphic *GraphicManager::getOrLoadGraphic(const String &in_sFileName,
                                           Graphic::TextureFilter in_forceFilter,
                                           Graphic::Anisotropy in_forceAnisotropy)
+{
+    return this->getOrLoadGraphic(Name(in_sFileName), in_forceFilter, in_forceAnisotropy);
+}
+
+Graphic *GraphicManager::getOrLoadGraphic(const Name &in_fileName,
+                                          Graphic::TextureFilter in_forceFilter,
+                                          Graphic::Anisotropy in_forceAnisotropy)
 {
     // Check if the graphic has already been loaded.
-    std::map<String, Graphic*>::iterator i = m_mGraphicsFromFiles.find(in_sFileName);
+    GraphicMap::iterator i = m_mGraphicsFromFiles.find(in_fileName);
     if(i != m_mGraphicsFromFiles.end())
         return i->second;
 
     try {
-        LoggingChronometer loadChron("Loading of graphic file " + in_sFileName, 2);
+        LoggingChronometer loadChron("Loading of graphic file " + in_fileName.str(), 2);
 
         // Read the content of the file and decode it.
         ImageFormat fmt;
-        *File::open(in_sFileName, File::Read) >> fmt;
+        *File::open(in_fileName.str(), File::Read) >> fmt;
 
         // Create a new texture with the decoded data.
         Graphic* pGraph = new Graphic();
@@ -1057,7 +1092,7 @@ Graphic *GraphicManager::getOrLoadGraphic(const String &in_sFileName,
 
         // We can safely add it into the map at that position as the map does not
         // contain anything on this position ; tested before.
-        m_mGraphicsFromFiles[in_sFileName] = pGraph;
+        m_mGraphicsFromFiles[in_fileName] = pGraph;
 
         loadChron.measure();
         return pGraph;
@@ -1066,7 +1101,7 @@ Graphic *GraphicManager::getOrLoadGraphic(const String &in_sFileName,
 
         // If it hasn't been loaded successfully, we still add it to the map as being
         // the error texture. To avoid hundreds of reload trials.
-        m_mGraphicsFromFiles[in_sFileName] = this->getErrorTextureNonConst();
+        m_mGraphicsFromFiles[in_fileName] = this->getErrorTextureNonConst();
 
         return this->getErrorTextureNonConst();
     }
@@ -1149,7 +1184,7 @@ Graphic *GraphicManager::getOrCreateResizedGraphic(const String &in_sOrig, uint1
 
     // We can safely add it into the map at that position as the map does not
     // contain anything on this position ; tested before.
-    m_mGraphicsFromFiles[sName] = pGraph;
+    m_mGraphicsFromFiles[Name(sName)] = pGraph;
 
 #ifdef DEBUG
     pGraph->toFTSImageFormat()->save(Path::userdir("Logfiles") + Path(sName + ".png"));
@@ -1173,12 +1208,12 @@ std::list<Graphic *>::iterator GraphicManager::findUnnamedGraphicFromMem(const G
     return i;
 }
 
-std::map<String, Graphic *>::iterator GraphicManager::findUnnamedGraphicFromFile(const Graphic *in_pGraphic)
+GraphicManager::GraphicMap::iterator GraphicManager::findUnnamedGraphicFromFile(const Graphic *in_pGraphic)
 {
-    std::map<String, Graphic*>::iterator i = m_mGraphicsFromFiles.begin();
+    GraphicMap::iterator i = m_mGraphicsFromFiles.begin();
     for( ; i != m_mGraphicsFromFiles.end() ; ++i) {
         // We won't give you the error texture! you'd delete it! (happens rly!)
-        if(i->second == in_pGraphic && i->first != GraphicManager::ErrorTextureName) {
+        if(i->second == in_pGraphic && i->first != m_errorTextureName) {
             return i;
         }
     }
@@ -1193,9 +1228,9 @@ void GraphicManager::destroyGraphic(const String &in_sFileName)
     if(in_sFileName == GraphicManager::ErrorTextureName)
         return;
 
-    FTSMSGDBG("Destroying graphic " + in_sFileName, 4);
+    FTSMSGDBG("Destroying graphic {1}", 4, in_sFileName);
 
-    std::map<String, Graphic*>::iterator i = m_mGraphicsFromFiles.find(in_sFileName);
+    GraphicMap::iterator i = m_mGraphicsFromFiles.find(Name(in_sFileName));
 
     // If we got no graphic named like this, we just quit.
     if(i == m_mGraphicsFromFiles.end()) {
@@ -1223,7 +1258,7 @@ void GraphicManager::destroyGraphic(Graphic *& in_graphic)
     // First, search that graphic in the list of graphics made from memory.
     std::list<Graphic *>::iterator iMem = this->findUnnamedGraphicFromMem(in_graphic);
     if(iMem != m_lGraphicsFromMem.end()) {
-        FTSMSGDBG("Destroying unnamed graphic from mem ("+String::nr((*iMem)->getW())+"x"+String::nr((*iMem)->getH())+")", 4);
+        FTSMSGDBG("Destroying unnamed graphic from mem ({1}x{2})", 4, (*iMem)->getW(), (*iMem)->getH());
 
         // Only delete the graphic if it is not the error graphic!
         if(*iMem != this->getErrorTexture()) {
@@ -1238,10 +1273,9 @@ void GraphicManager::destroyGraphic(Graphic *& in_graphic)
     }
 
     // Then, search it in the list of graphics made from a file:
-    std::map<String, Graphic *>::iterator iFile = this->findUnnamedGraphicFromFile(in_graphic);
+    GraphicMap::iterator iFile = this->findUnnamedGraphicFromFile(in_graphic);
     if(iFile != m_mGraphicsFromFiles.end()) {
-        String sName = iFile->first;
-        FTSMSGDBG("Destroying graphic " + sName, 4);
+        FTSMSGDBG("Destroying graphic {1}", 4, iFile->first.str());
 
         // Again, don't delete the graphic if it is the error graphic but
         // used in another name.
@@ -1262,12 +1296,17 @@ void GraphicManager::destroyGraphic(Graphic *& in_graphic)
 
 bool GraphicManager::isGraphicPresent(const String &in_sFileName)
 {
-    return m_mGraphicsFromFiles.find(in_sFileName) != m_mGraphicsFromFiles.end();
+    return this->isGraphicPresent(Name(in_sFileName));
+}
+
+bool GraphicManager::isGraphicPresent(const Name &in_fileName)
+{
+    return m_mGraphicsFromFiles.find(in_fileName) != m_mGraphicsFromFiles.end();
 }
 
 const Graphic *GraphicManager::getErrorTexture() const
 {
-    std::map<String, Graphic *>::const_iterator i = m_mGraphicsFromFiles.find(GraphicManager::ErrorTextureName);
+    GraphicMap::const_iterator i = m_mGraphicsFromFiles.find(m_errorTextureName);
     if(i == m_mGraphicsFromFiles.end())
         return NULL;
     return i->second;
@@ -1275,6 +1314,10 @@ const Graphic *GraphicManager::getErrorTexture() const
 
 uint64_t GraphicManager::getMaxTextureSize() const
 {
+    // Without a display, anything goes.
+    if(Renderer::isHeadless())
+        return 16384;
+
     verifGL("Graphic::getMaxTextureSize start");
     GLint iMaxTex = 0;
     glGetIntegerv(GL_MAX_TEXTURE_SIZE, &iMaxTex);
@@ -1284,6 +1327,9 @@ uint64_t GraphicManager::getMaxTextureSize() const
 
 uint8_t GraphicManager::getMaxTextureUnits() const
 {
+    if(Renderer::isHeadless())
+        return 16;
+
     verifGL("Graphic::getMaxTextureUnits start");
     GLint iMaxTex = 0;
     glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &iMaxTex);
@@ -1312,10 +1358,10 @@ int GraphicManager::renameGraphic(const String &in_sOldName, const String &in_sN
         return -1;
 
     // Here, we're sure this exists.
-    std::map<String, Graphic *>::iterator i = m_mGraphicsFromFiles.find(in_sOldName);
+    GraphicMap::iterator i = m_mGraphicsFromFiles.find(Name(in_sOldName));
     Graphic *g = i->second;
     m_mGraphicsFromFiles.erase(i);
-    m_mGraphicsFromFiles[in_sNewName] = g;
+    m_mGraphicsFromFiles[Name(in_sNewName)] = g;
     return ERR_OK;
 }
 
@@ -1406,12 +1452,12 @@ Graphic *GraphicManager::resizeGraphic(Graphic *& in_pOrig, uint16_t in_uiNewW,
     }
 
     // Then, search it in the list of graphics made from a file:
-    std::map<String, Graphic *>::iterator iFile = this->findUnnamedGraphicFromFile(in_pOrig);
+    GraphicMap::iterator iFile = this->findUnnamedGraphicFromFile(in_pOrig);
     // Again, don't resize the graphic if it is the error graphic but
     // used in another name.
     if(iFile != m_mGraphicsFromFiles.end() && iFile->second != this->getErrorTexture()) {
         // Delegate the work.
-        in_pOrig = this->resizeGraphic(iFile->first, in_uiNewW, in_uiNewH);
+        in_pOrig = this->resizeGraphic(iFile->first.str(), in_uiNewW, in_uiNewH);
         return in_pOrig;
     }
 
@@ -1459,12 +1505,12 @@ Graphic *GraphicManager::resizeGraphic(Graphic *&in_pOrig, float in_fRatio)
     }
 
     // Then, search it in the list of graphics made from a file:
-    std::map<String, Graphic *>::iterator iFile = this->findUnnamedGraphicFromFile(in_pOrig);
+    GraphicMap::iterator iFile = this->findUnnamedGraphicFromFile(in_pOrig);
     // Again, don't resize the graphic if it is the error graphic but
     // used in another name.
     if(iFile != m_mGraphicsFromFiles.end() && iFile->second != this->getErrorTexture()) {
         // Delegate the work.
-        in_pOrig = this->resizeGraphic(iFile->first, in_fRatio);
+        in_pOrig = this->resizeGraphic(iFile->first.str(), in_fRatio);
         return in_pOrig;
     }
 
@@ -1481,7 +1527,7 @@ Graphic *GraphicManager::resizeGraphic(Graphic *&in_pOrig, float in_fRatio)
 void GraphicManager::grabAllGraphics()
 {
     // First, grab all graphics that were loaded from file.
-    for(std::map<String, Graphic*>::iterator i = m_mGraphicsFromFiles.begin() ; i != m_mGraphicsFromFiles.end() ; ++i) {
+    for(GraphicMap::iterator i = m_mGraphicsFromFiles.begin() ; i != m_mGraphicsFromFiles.end() ; ++i) {
         i->second->grab();
     }
 
@@ -1499,7 +1545,7 @@ void GraphicManager::grabAllGraphics()
 void GraphicManager::restoreAllGraphics()
 {
     // First, restore all graphics that were loaded from file.
-    for(std::map<String, Graphic*>::iterator i = m_mGraphicsFromFiles.begin() ; i != m_mGraphicsFromFiles.end() ; ++i) {
+    for(GraphicMap::iterator i = m_mGraphicsFromFiles.begin() ; i != m_mGraphicsFromFiles.end() ; ++i) {
         i->second->restore();
     }
 
@@ -4,8 +4,10 @@
 #include "main.h"
 #include "utilities/Singleton.h"
 #include "dLib/dString/dString.h"
+#include "dLib/dString/dName.h"
 
 #include <map>
+#include <unordered_map>
 #include <list>
 #include <vector>
 
@@ -118,16 +120,20 @@ private:
 };
 
 class GraphicManager : public Singleton<GraphicManager> {
+    typedef std::unordered_map<Name, Graphic *> GraphicMap;
+
     /// All graphics that have been loaded from a file, mapped to their filename.
-    std::map<String, Graphic *>m_mGraphicsFromFiles;
+    GraphicMap m_mGraphicsFromFiles;
+    /// The name of the error texture, as a key into \a m_mGraphicsFromFiles.
+    const Name m_errorTextureName;
     /// All graphics that have been created from memory (network packets, ...).
     std::list<Graphic *>m_lGraphicsFromMem;
 
     /// The non-const pendant may only be used internally.
-    inline Graphic *getErrorTextureNonConst() {return m_mGraphicsFromFiles["Error"];};
+    inline Graphic *getErrorTextureNonConst() {return m_mGraphicsFromFiles[m_errorTextureName];};
 
     std::list<Graphic *>::iterator findUnnamedGraphicFromMem(const Graphic *in_pGraphic);
-    std::map<String, Graphic *>::iterator findUnnamedGraphicFromFile(const Graphic *in_pGraphic);
+    GraphicMap::iterator findUnnamedGraphicFromFile(const Graphic *in_pGraphic);
 
     /// For optimisation: keeps track of which texture is selected in which slot.
     std::vector<uint32_t> m_vSelectedTextures;
@@ -148,6 +154,9 @@ public:
     Graphic *getOrLoadGraphic(const String &in_sFileName,
                               Graphic::TextureFilter in_forceFilter = Graphic::DefaultFilter,
                               Graphic::Anisotropy in_forceAnisotropy = Graphic::DefaultAnisotropy);
+    Graphic *getOrLoadGraphic(const Name &in_fileName,
+                              Graphic::TextureFilter in_forceFilter = Graphic::DefaultFilter,
+                              Graphic::Anisotropy in_forceAnisotropy = Graphic::DefaultAnisotropy);
     Graphic *getOrLoadGraphic(FTS::File& out_file, String in_sGraphicName = String::EMPTY,
                               Graphic::TextureFilter in_forceFilter = Graphic::DefaultFilter,
                               Graphic::Anisotropy in_forceAnisotropy = Graphic::DefaultAnisotropy);
@@ -166,6 +175,7 @@ public:
     // Misc. stuff //
     const Graphic *getErrorTexture() const;
     bool isGraphicPresent(const String &in_sFileName);
+    bool isGraphicPresent(const Name &in_fileName);
     uint64_t getMaxTextureSize() const;
     uint8_t getMaxTextureUnits() const;
 
@@ -37,7 +37,7 @@ ImageFormat::~ImageFormat()
  */
 File& ImageFormat::restore(File& in_File)
 {
-    FTSMSGDBG("Loading image from file '"+in_File.getName()+"'", 3);
+    FTSMSGDBG("Loading image from file '{1}'", 3, in_File.getName());
 
     this->unload();
 
@@ -121,7 +121,7 @@ int ImageFormat::load(const ConstRawDataContainer &in_data)
  */
 File& ImageFormat::store(File& out_File) const
 {
-    FTSMSGDBG("Writing image to file '"+out_File.getName()+"'", 3);
+    FTSMSGDBG("Writing image to file '{1}'", 3, out_File.getName());
 
     // First, create the png file in memory.
     std::vector<unsigned char> out;
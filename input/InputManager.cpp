@@ -612,7 +612,7 @@ bool InputManager::handleEvent(const SDL_Event& ev)
         // This character is utf8 coded and can be at max 4 bytes big.
         // It must be converted to utf32 so that CEGUI can handle it.
         auto unicode = utf8_32({ (uint8_t)ev.text.text[0] ,(uint8_t)ev.text.text[1],(uint8_t)ev.text.text[2],(uint8_t)ev.text.text[3] });
-        FTSMSGDBG("  Text: " + String(ev.text.text) + "\n", 5);
+        FTSMSGDBG("  Text: {1}\n", 5, ev.text.text);
         m_keyTab[m_LastPressedKey].utf32 = unicode;
         this->handleUTF32(unicode);
     }
@@ -215,6 +215,7 @@ public:
 
     bool handleEvent(const SDL_Event& ev);
     bool update(const Clock&);
+    Phase getUpdatePhase() const {return Input;};
 
     int add(InputCombo *in_pCombo);
     int add(const String &in_sName, const Key::Enum& in_k, CommandBase *in_pCmd, bool in_bOnPress = true);
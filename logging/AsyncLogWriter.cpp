@@ -0,0 +1,375 @@
+#include "logging/AsyncLogWriter.h"
+#include "logging/FlightRecorder.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_WIN32)
+#  include <io.h>
+#endif
+
+using namespace FTS;
+
+/** Starts the writer thread.
+ *
+ * \param in_pFile The file to write into, the writer closes it when it is
+ *                 destroyed.
+ * \param in_nSlots How many lines may wait to be written, this is rounded up
+ *                  to a power of two.
+ * \param in_flushInterval How long a written line may stay in the buffers of
+ *                         the file before it gets flushed. With 0, every
+ *                         batch of lines is flushed right away.
+ */
+AsyncLogWriter::AsyncLogWriter(std::FILE* in_pFile, std::size_t in_nSlots, std::chrono::milliseconds in_flushInterval)
+    : m_pFile(in_pFile)
+    , m_buffer(new char[BufferSize])
+    , m_nBuffered(0)
+    , m_enqueuePos(0)
+    , m_dequeuePos(0)
+    , m_nStalls(0)
+    , m_bWriting(false)
+    , m_bCrashing(false)
+    , m_bSleeping(false)
+    , m_flushInterval(in_flushInterval)
+{
+    std::size_t nSlots = 2;
+    while(nSlots < in_nSlots)
+        nSlots *= 2;
+
+    m_slots.reset(new Slot[nSlots]);
+    m_mask = nSlots - 1;
+    for(std::size_t i = 0 ; i < nSlots ; ++i) {
+        m_slots[i].seq.store(i, std::memory_order_relaxed);
+        m_slots[i].time = 0;
+    }
+
+    // Whatever has been written before has to come first in a crash, too.
+    if(m_pFile) {
+        std::fflush(m_pFile);
+#if defined(_WIN32)
+        m_fd = _fileno(m_pFile);
+#else
+        m_fd = fileno(m_pFile);
+#endif
+    }
+
+    m_thread = std::thread(&AsyncLogWriter::work, this);
+}
+
+/// Writes all lines that have been pushed, flushes and closes the file.
+AsyncLogWriter::~AsyncLogWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bQuit = true;
+        m_wakeUp.notify_one();
+    }
+    m_thread.join();
+
+    if(m_pFile) {
+        // After a crash, writeOnCrash already wrote the buffer.
+        if(!m_bCrashing.load())
+            this->flushBuffer();
+        std::fclose(m_pFile);
+    }
+}
+
+/** Hands a line over to the writer thread. This may be called from any thread.
+ *
+ * \param in_sLine The line to write, it is written as-is.
+ * \param in_time When the line has been logged. If it is not 0, the line gets
+ *                prefixed by the \a timestamp and ends with a newline.
+ */
+void AsyncLogWriter::push(std::string in_sLine, std::time_t in_time)
+{
+    // Every slot knows the position at which it is free to be filled, so the
+    // producers only need to agree on who gets which position.
+    bool bStalled = false;
+    std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    Slot* pSlot = nullptr;
+    for(;;) {
+        pSlot = &m_slots[pos & m_mask];
+        std::size_t seq = pSlot->seq.load(std::memory_order_acquire);
+        std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+        if(diff == 0) {
+            if(m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        } else if(diff < 0) {
+            // The writer didn't take that slot out yet, the ring is full.
+            if(!bStalled)
+                m_nStalls.fetch_add(1, std::memory_order_relaxed);
+            bStalled = true;
+            this->wake();
+            std::this_thread::yield();
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        } else {
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    pSlot->sLine = std::move(in_sLine);
+    pSlot->time = in_time;
+    pSlot->seq.store(pos + 1, std::memory_order_release);
+
+    this->wake();
+}
+
+/// Waits until every line that has been pushed before is written and flushed
+/// to the disk. Use it when the lines must not get lost, for example when
+/// something goes horribly wrong.
+void AsyncLogWriter::flush()
+{
+    std::size_t target = m_enqueuePos.load(std::memory_order_acquire);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if(m_flushed >= target)
+        return;
+
+    m_flushRequest = std::max(m_flushRequest, target);
+    m_wakeUp.notify_one();
+    m_flushDone.wait(lock, [this, target]() {return m_flushed >= target || m_bQuit || m_bCrashing.load();});
+}
+
+/// \param in_flushInterval How long a written line may stay in the buffers of
+///                         the file, 0 to flush every batch right away.
+void AsyncLogWriter::setFlushInterval(std::chrono::milliseconds in_flushInterval)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_flushInterval = in_flushInterval;
+    m_wakeUp.notify_one();
+}
+
+/** Writes the lines that are not in the file yet, right now and from the
+ *  thread that calls it. This is meant for signal handlers, when the game is
+ *  crashing and the writer thread won't get to it anymore: it doesn't lock
+ *  or allocate, and only uses the write system call.\n
+ *
+ *  The writer thread stops writing once this has been called. Lines that are
+ *  still waiting in the ring are stamped with the seconds since the epoch,
+ *  as the local time can't be worked out safely in a signal handler.
+ */
+void AsyncLogWriter::writeOnCrash()
+{
+    if(m_fd < 0)
+        return;
+
+    // Let the writer finish the line it is at, unless it's the one crashing
+    // or stuck. Pairs with beginWriting.
+    m_bCrashing.store(true);
+    for(std::uint32_t i = 0 ; i < (1u << 28) && m_bWriting.load() ; ++i) {
+    }
+
+    FlightRecorder::writeAll(m_fd, m_buffer.get(), std::min(m_nBuffered.load(std::memory_order_acquire), BufferSize));
+
+    std::size_t pos = m_dequeuePos.load(std::memory_order_acquire);
+    for(std::size_t i = 0 ; i <= m_mask ; ++i, ++pos) {
+        const Slot& slot = m_slots[pos & m_mask];
+        if(slot.seq.load(std::memory_order_acquire) != pos + 1)
+            break;
+
+        if(slot.time != 0) {
+            char szStamp[32];
+            char* p = szStamp + sizeof(szStamp);
+            const char szSuffix[] = " -- ";
+            p -= sizeof(szSuffix) - 1;
+            std::memcpy(p, szSuffix, sizeof(szSuffix) - 1);
+            std::uint64_t uiTime = static_cast<std::uint64_t>(slot.time);
+            do {
+                *--p = static_cast<char>('0' + uiTime % 10);
+                uiTime /= 10;
+            } while(uiTime > 0);
+            *--p = '@';
+            FlightRecorder::writeAll(m_fd, p, static_cast<std::size_t>(szStamp + sizeof(szStamp) - p));
+        }
+
+        FlightRecorder::writeAll(m_fd, slot.sLine.data(), slot.sLine.size());
+        if(slot.time != 0 && (slot.sLine.empty() || slot.sLine.back() != '\n'))
+            FlightRecorder::writeAll(m_fd, "\n", 1);
+    }
+}
+
+/// The crash hook of the flight recorder, see \a FlightRecorder::setCrashHook.
+/// \param in_pWriter The \a AsyncLogWriter whose lines to write.
+void AsyncLogWriter::onCrash(void* in_pWriter)
+{
+    static_cast<AsyncLogWriter*>(in_pWriter)->writeOnCrash();
+}
+
+/// \return The prefix of a line logged at \a in_time, like "17-10-2026_13-37-00 -- ".
+std::string AsyncLogWriter::timestamp(std::time_t in_time)
+{
+    struct tm t;
+#if defined(_WIN32)
+    localtime_s(&t, &in_time);
+#else
+    localtime_r(&in_time, &t);
+#endif
+
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%.2d-%.2d-%.4d_%.2d-%.2d-%.2d -- ",
+                  t.tm_mday, t.tm_mon + 1, t.tm_year + 1900,
+                  t.tm_hour, t.tm_min, t.tm_sec);
+    return buf;
+}
+
+/// Takes the next line out of the ring, only the writer thread may do this.
+/// \return false if the next line isn't there yet.
+bool AsyncLogWriter::pop(std::string& out_sLine, std::time_t& out_time)
+{
+    std::size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+    Slot& slot = m_slots[pos & m_mask];
+    if(slot.seq.load(std::memory_order_acquire) != pos + 1)
+        return false;
+
+    out_sLine.swap(slot.sLine);
+    slot.sLine.clear();
+    out_time = slot.time;
+
+    // The slot may be filled again once the producers went round the ring.
+    slot.seq.store(pos + m_mask + 1, std::memory_order_release);
+    m_dequeuePos.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+/// Wakes the writer thread up if it is sleeping. Only then the mutex is needed.
+void AsyncLogWriter::wake()
+{
+    // Pairs with the fence in work(): either the writer sees the new line or
+    // we see it going to sleep.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(m_bSleeping.load(std::memory_order_relaxed) && m_bSleeping.exchange(false)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_wakeUp.notify_one();
+    }
+}
+
+void AsyncLogWriter::write(const std::string& in_sLine, std::time_t in_time)
+{
+    if(!m_pFile)
+        return;
+
+    if(in_time != 0) {
+        if(in_time != m_lastTime) {
+            m_sLastStamp = timestamp(in_time);
+            m_lastTime = in_time;
+        }
+        this->append(m_sLastStamp.data(), m_sLastStamp.size());
+    }
+
+    this->append(in_sLine.data(), in_sLine.size());
+
+    // Like before, timestamped lines always end the line.
+    if(in_time != 0 && (in_sLine.empty() || in_sLine.back() != '\n'))
+        this->append("\n", 1);
+}
+
+/// Adds written data to \a m_buffer, making room by writing the buffer into
+/// the file if needed.
+void AsyncLogWriter::append(const char* in_pData, std::size_t in_uiSize)
+{
+    std::size_t nBuffered = m_nBuffered.load(std::memory_order_relaxed);
+    if(in_uiSize > BufferSize - nBuffered) {
+        this->flushBuffer();
+        nBuffered = 0;
+    }
+
+    if(in_uiSize >= BufferSize) {
+        std::fwrite(in_pData, 1, in_uiSize, m_pFile);
+        std::fflush(m_pFile);
+        return;
+    }
+
+    std::memcpy(m_buffer.get() + nBuffered, in_pData, in_uiSize);
+    m_nBuffered.store(nBuffered + in_uiSize, std::memory_order_release);
+}
+
+/// Puts everything in \a m_buffer into the file and flushes it.
+void AsyncLogWriter::flushBuffer()
+{
+    std::size_t nBuffered = m_nBuffered.load(std::memory_order_relaxed);
+    if(nBuffered > 0)
+        std::fwrite(m_buffer.get(), 1, nBuffered, m_pFile);
+    std::fflush(m_pFile);
+    m_nBuffered.store(0, std::memory_order_release);
+}
+
+/// Only while this returned true, the writer thread may take lines out of the
+/// ring and write them. \return false once the game is crashing.
+bool AsyncLogWriter::beginWriting()
+{
+    // Either we see the crash or the crash sees us writing.
+    m_bWriting.store(true);
+    if(!m_bCrashing.load())
+        return true;
+
+    m_bWriting.store(false);
+    return false;
+}
+
+/// Ends what \a beginWriting allowed.
+void AsyncLogWriter::endWriting()
+{
+    m_bWriting.store(false);
+}
+
+void AsyncLogWriter::work()
+{
+    std::string sLine;
+    std::time_t time = 0;
+    bool bDirty = false;
+    auto lastFlush = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for(;;) {
+        lock.unlock();
+        if(this->beginWriting()) {
+            while(this->pop(sLine, time)) {
+                this->write(sLine, time);
+                bDirty = true;
+            }
+            this->endWriting();
+        }
+        lock.lock();
+
+        // Whatever is left has been written by writeOnCrash.
+        if(m_bCrashing.load())
+            break;
+
+        auto now = std::chrono::steady_clock::now();
+        if(bDirty && (m_flushRequest > m_flushed || m_bQuit || now - lastFlush >= m_flushInterval)) {
+            if(m_pFile && this->beginWriting()) {
+                this->flushBuffer();
+                this->endWriting();
+            }
+            bDirty = false;
+            lastFlush = now;
+        }
+
+        std::size_t dequeuePos = m_dequeuePos.load(std::memory_order_relaxed);
+        if(!bDirty && m_flushed != dequeuePos) {
+            m_flushed = dequeuePos;
+            m_flushDone.notify_all();
+        }
+
+        bool bEmpty = m_slots[dequeuePos & m_mask].seq.load(std::memory_order_acquire) != dequeuePos + 1;
+        if(m_bQuit && bEmpty && dequeuePos == m_enqueuePos.load(std::memory_order_acquire))
+            break;
+
+        // Sleep until somebody pushes, but flush the written lines in time.
+        // A line that has been claimed but isn't there yet comes in a moment.
+        m_bSleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(m_slots[dequeuePos & m_mask].seq.load(std::memory_order_acquire) != dequeuePos + 1) {
+            if(m_flushRequest > dequeuePos || m_bQuit)
+                m_wakeUp.wait_for(lock, std::chrono::milliseconds(1));
+            else if(bDirty)
+                m_wakeUp.wait_for(lock, m_flushInterval - (now - lastFlush));
+            else
+                m_wakeUp.wait(lock);
+        }
+        m_bSleeping.store(false, std::memory_order_relaxed);
+    }
+
+    m_flushDone.notify_all();
+}
@@ -0,0 +1,113 @@
+#ifndef D_ASYNCLOGWRITER_H
+#define D_ASYNCLOGWRITER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace FTS {
+
+/// Writes lines into a log file on a thread of its own, so that logging
+/// doesn't wait for the disk.\n
+///
+/// Any thread can \a push a line, it goes into a fixed ring of slots without
+/// taking any lock. The writer thread takes the lines out in batches, writes
+/// them and only flushes the file every now and then, see \a flush for when
+/// the lines have to be on the disk right now.\n
+///
+/// The lines of one thread are written in the order they have been pushed.
+/// If the ring is full, \a push waits for the writer to make room instead of
+/// dropping lines.\n
+///
+/// When the game crashes, \a writeOnCrash gets out what is still waiting.
+class AsyncLogWriter {
+public:
+    AsyncLogWriter(std::FILE* in_pFile, std::size_t in_nSlots = 4096, std::chrono::milliseconds in_flushInterval = std::chrono::milliseconds(500));
+    virtual ~AsyncLogWriter();
+
+    void push(std::string in_sLine, std::time_t in_time = 0);
+    void flush();
+    void writeOnCrash();
+    static void onCrash(void* in_pWriter);
+
+    void setFlushInterval(std::chrono::milliseconds in_flushInterval);
+
+    /// \return How often \a push had to wait for a free slot.
+    inline std::uint64_t getStalls() const {return m_nStalls.load(std::memory_order_relaxed);};
+
+    static std::string timestamp(std::time_t in_time);
+
+private:
+    struct Slot {
+        /// Who may use the slot, see \a push and \a pop.
+        std::atomic<std::size_t> seq;
+        std::string sLine;
+        std::time_t time;
+    };
+
+    /// How much is written into the file at once.
+    static const std::size_t BufferSize = 64 * 1024;
+
+    std::FILE* m_pFile;
+    /// The file descriptor of \a m_pFile, for \a writeOnCrash.
+    int m_fd = -1;
+    std::unique_ptr<Slot[]> m_slots;
+    std::size_t m_mask;
+
+    /// Written lines that aren't in the file yet. This is not the buffer of
+    /// \a m_pFile so that \a writeOnCrash can get at it.
+    std::unique_ptr<char[]> m_buffer;
+    std::atomic<std::size_t> m_nBuffered;
+
+    /// The next slot a producer claims.
+    std::atomic<std::size_t> m_enqueuePos;
+    /// The next slot the writer takes, only the writer changes it.
+    std::atomic<std::size_t> m_dequeuePos;
+    std::atomic<std::uint64_t> m_nStalls;
+
+    /// The prefix of the last timestamp, they mostly stay the same.
+    std::time_t m_lastTime = 0;
+    std::string m_sLastStamp;
+
+    /// Set while the writer thread is taking lines out of the ring or writing
+    /// them, see \a beginWriting.
+    std::atomic<bool> m_bWriting;
+    /// Set by \a writeOnCrash, the writer thread doesn't write anymore then.
+    std::atomic<bool> m_bCrashing;
+
+    /// Set by the writer when it is about to sleep, so that the producers
+    /// only need to take the mutex to wake it up.
+    std::atomic<bool> m_bSleeping;
+    bool m_bQuit = false;
+    /// Everything up to this position has to be flushed as soon as possible.
+    std::size_t m_flushRequest = 0;
+    /// Everything up to this position is flushed.
+    std::size_t m_flushed = 0;
+    std::chrono::milliseconds m_flushInterval;
+
+    /// Guards the writer's sleep, the flush positions, the interval and quitting.
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    std::condition_variable m_flushDone;
+    std::thread m_thread;
+
+    bool pop(std::string& out_sLine, std::time_t& out_time);
+    void wake();
+    void write(const std::string& in_sLine, std::time_t in_time);
+    void append(const char* in_pData, std::size_t in_uiSize);
+    void flushBuffer();
+    bool beginWriting();
+    void endWriting();
+    void work();
+};
+
+} // namespace FTS
+
+#endif // D_ASYNCLOGWRITER_H
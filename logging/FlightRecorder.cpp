@@ -0,0 +1,299 @@
+#include "logging/FlightRecorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#if defined(_WIN32)
+#  include <io.h>
+#  include <fcntl.h>
+#  include <sys/stat.h>
+#else
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+using namespace FTS;
+
+namespace {
+    const std::chrono::steady_clock::time_point g_start = std::chrono::steady_clock::now();
+
+    const FlightEventInfo g_events[] = {
+        {FlightSubsystem::General,  "Started",       false, {nullptr, nullptr, nullptr}},
+        {FlightSubsystem::General,  "Frame",         false, {"frame", "us", nullptr}},
+        {FlightSubsystem::General,  "Signal",        false, {"signal", nullptr, nullptr}},
+        {FlightSubsystem::General,  "Exception",     true,  {nullptr, nullptr, nullptr}},
+        {FlightSubsystem::Runlevel, "RunlevelEnter", true,  {nullptr, nullptr, nullptr}},
+        {FlightSubsystem::File,     "FileOpenAsync", false, {"request", "priority", "queued"}},
+        {FlightSubsystem::File,     "FileOpened",    false, {"request", "us", "failed"}},
+        {FlightSubsystem::Archive,  "ArchiveLoaded", false, {"chunks", "format", nullptr}},
+        {FlightSubsystem::Archive,  "ChunkLoaded",   false, {"bytes", "us", nullptr}},
+        {FlightSubsystem::Logger,   "LogError",      true,  {nullptr, nullptr, nullptr}},
+        {FlightSubsystem::Logger,   "LogHorror",     true,  {nullptr, nullptr, nullptr}},
+    };
+    static_assert(sizeof(g_events) / sizeof(g_events[0]) == static_cast<std::size_t>(FlightEvent::Count), "Every event needs a description.");
+
+    const char* g_subsystems[] = {"General", "Runlevel", "File", "Archive", "Logger"};
+    static_assert(sizeof(g_subsystems) / sizeof(g_subsystems[0]) == static_cast<std::size_t>(FlightSubsystem::Count), "Every subsystem needs a name.");
+}
+
+const char FlightRecorder::Magic[8] = {'F', 'T', 'S', 'F', 'L', 'I', 'G', 'H'};
+FlightRecorder::Slot FlightRecorder::s_slots[FlightRecorder::Capacity];
+std::atomic<std::uint64_t> FlightRecorder::s_uiNext(0);
+std::atomic<std::uint32_t> FlightRecorder::s_uiNextThread(1);
+const std::time_t FlightRecorder::s_startTime = std::time(nullptr);
+char FlightRecorder::s_szCrashDumpFile[512] = {0};
+std::atomic<void (*)(void*)> FlightRecorder::s_pfnCrashHook(nullptr);
+std::atomic<void*> FlightRecorder::s_pCrashHookArg(nullptr);
+
+/** Records an event. This is cheap enough to be called every frame.
+ *
+ * \param in_event What happened.
+ * \param in_a, in_b, in_c What the event has to say about it, see \a describe.
+ */
+void FlightRecorder::record(FlightEvent in_event, std::int64_t in_a, std::int64_t in_b, std::int64_t in_c)
+{
+    std::uint64_t uiSeq = s_uiNext.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = s_slots[uiSeq % Capacity];
+
+    // Mark it as torn until it is complete.
+    slot.seq.store(0, std::memory_order_relaxed);
+    slot.uiTime = now();
+    slot.uiSubsystem = static_cast<std::uint16_t>(describe(in_event).subsystem);
+    slot.uiEvent = static_cast<std::uint16_t>(in_event);
+    slot.uiThread = threadNumber();
+    slot.args[0] = in_a;
+    slot.args[1] = in_b;
+    slot.args[2] = in_c;
+    slot.seq.store(uiSeq + 1, std::memory_order_release);
+}
+
+/// Records an event whose arguments are a piece of text, of which only the
+/// first 24 bytes are kept.
+/// \param in_event What happened.
+/// \param in_pszText What the event has to say about it.
+void FlightRecorder::recordText(FlightEvent in_event, const char* in_pszText)
+{
+    std::int64_t args[3] = {0, 0, 0};
+    if(in_pszText)
+        std::strncpy(reinterpret_cast<char*>(args), in_pszText, sizeof(args));
+    record(in_event, args[0], args[1], args[2]);
+}
+
+/** Writes all records into a file, which the ftsflight tool can read. This
+ *  only uses functions that may be called from within a signal handler.
+ *
+ * \param in_pszFileName Where to write the dump to, an existing file is overwritten.
+ *
+ * \return Whether the dump has been written completely.
+ */
+bool FlightRecorder::dump(const char* in_pszFileName)
+{
+    static_assert(sizeof(Slot) == sizeof(FlightRecord), "The decoder reads the slots as records.");
+
+#if defined(_WIN32)
+    int fd = _open(in_pszFileName, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    int fd = ::open(in_pszFileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+    if(fd < 0)
+        return false;
+
+    DumpHeader header;
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.uiVersion = Version;
+    header.uiRecordSize = sizeof(Slot);
+    header.nRecords = Capacity;
+    header.uiNext = s_uiNext.load(std::memory_order_acquire);
+    header.startTime = static_cast<std::int64_t>(s_startTime);
+    header.uiDumpTime = now();
+
+    bool bOk = writeAll(fd, &header, sizeof(header))
+            && writeAll(fd, s_slots, sizeof(s_slots));
+
+#if defined(_WIN32)
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+    return bOk;
+}
+
+/// Makes sure the records get dumped when the game crashes with a fatal
+/// signal (segmentation fault, abort, ...). After dumping, the signal is
+/// handled as if nobody caught it.
+/// \param in_pszFileName Where to write the dump to.
+void FlightRecorder::installCrashHandler(const char* in_pszFileName)
+{
+    // The handler may not allocate anything, so keep it ready.
+    std::strncpy(s_szCrashDumpFile, in_pszFileName, sizeof(s_szCrashDumpFile) - 1);
+
+    std::signal(SIGSEGV, &FlightRecorder::onSignal);
+    std::signal(SIGABRT, &FlightRecorder::onSignal);
+    std::signal(SIGFPE, &FlightRecorder::onSignal);
+    std::signal(SIGILL, &FlightRecorder::onSignal);
+#ifdef SIGBUS
+    std::signal(SIGBUS, &FlightRecorder::onSignal);
+#endif
+}
+
+/** Sets a function to call when the game crashes, after the records have been
+ *  dumped. It runs in the signal handler, so it may only do what is allowed
+ *  there, see \a writeAll. Only one hook is kept.
+ *
+ * \param in_pfnHook The function to call, nullptr to remove the hook.
+ * \param in_pArg What to give to \a in_pfnHook.
+ */
+void FlightRecorder::setCrashHook(void (*in_pfnHook)(void*), void* in_pArg)
+{
+    // The handler may run at any time, it must never see a hook with the
+    // argument of another one.
+    s_pfnCrashHook.store(nullptr);
+    s_pCrashHookArg.store(in_pArg);
+    s_pfnCrashHook.store(in_pfnHook);
+}
+
+/** Writes everything or nothing, only using what may be used in a signal
+ *  handler.
+ *
+ * \param in_fd The file descriptor to write to.
+ * \param in_pData What to write.
+ * \param in_uiSize How many bytes to write.
+ *
+ * \return Whether everything has been written.
+ */
+bool FlightRecorder::writeAll(int in_fd, const void* in_pData, std::size_t in_uiSize)
+{
+    const char* p = static_cast<const char*>(in_pData);
+    while(in_uiSize > 0) {
+#if defined(_WIN32)
+        int n = _write(in_fd, p, static_cast<unsigned int>(in_uiSize));
+#else
+        ssize_t n = ::write(in_fd, p, in_uiSize);
+#endif
+        if(n <= 0)
+            return false;
+        p += n;
+        in_uiSize -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+/// \return How to show \a in_event.
+const FlightEventInfo& FlightRecorder::describe(FlightEvent in_event)
+{
+    static const FlightEventInfo unknown = {FlightSubsystem::Count, nullptr, false, {"a", "b", "c"}};
+    std::size_t i = static_cast<std::size_t>(in_event);
+    return i < static_cast<std::size_t>(FlightEvent::Count) ? g_events[i] : unknown;
+}
+
+/// \return The name of \a in_subsystem, nullptr if it is unknown.
+const char* FlightRecorder::subsystemName(FlightSubsystem in_subsystem)
+{
+    std::size_t i = static_cast<std::size_t>(in_subsystem);
+    return i < static_cast<std::size_t>(FlightSubsystem::Count) ? g_subsystems[i] : nullptr;
+}
+
+/** Turns a dump into readable text, oldest record first. The time of each
+ *  record is shown relative to when the dump was made.
+ *
+ * \param in_dump The dump, as written by \a dump.
+ * \param out_text Where to write the text to.
+ *
+ * \return false if \a in_dump is no dump this version can read.
+ */
+bool FlightRecorder::decode(std::istream& in_dump, std::ostream& out_text)
+{
+    DumpHeader header;
+    if(!in_dump.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        return false;
+    if(std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.uiVersion != Version || header.uiRecordSize != sizeof(FlightRecord))
+        return false;
+    // No dump has more records than the recorder keeps, a broken one may say so.
+    if(header.nRecords > Capacity)
+        return false;
+
+    std::vector<FlightRecord> records(static_cast<std::size_t>(header.nRecords));
+    if(!in_dump.read(reinterpret_cast<char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(FlightRecord))))
+        return false;
+
+    // Only the records that were complete and not overwritten yet.
+    std::uint64_t uiOldest = header.uiNext > header.nRecords ? header.uiNext - header.nRecords : 0;
+    records.erase(std::remove_if(records.begin(), records.end(), [&](const FlightRecord& r) {
+        return r.uiSeq == 0 || r.uiSeq <= uiOldest || r.uiSeq > header.uiNext;
+    }), records.end());
+    std::sort(records.begin(), records.end(), [](const FlightRecord& a, const FlightRecord& b) {
+        return a.uiSeq < b.uiSeq;
+    });
+
+    std::time_t startTime = static_cast<std::time_t>(header.startTime);
+    char szStart[64] = {0};
+    std::strftime(szStart, sizeof(szStart), "%d-%m-%Y_%H-%M-%S", std::localtime(&startTime));
+    out_text << "Flight recorder started " << szStart << ", dumped after " << header.uiDumpTime / 1000000.0
+             << "s, " << records.size() << " of " << header.uiNext << " records:" << std::endl;
+
+    char buf[256];
+    for(const FlightRecord& r : records) {
+        const FlightEventInfo& info = describe(static_cast<FlightEvent>(r.uiEvent));
+        const char* pszSubsystem = subsystemName(static_cast<FlightSubsystem>(r.uiSubsystem));
+
+        double dAgo = (static_cast<double>(r.uiTime) - static_cast<double>(header.uiDumpTime)) / 1000000.0;
+        std::snprintf(buf, sizeof(buf), "%+14.6fs T%-3u %-9s ", dAgo, r.uiThread, pszSubsystem ? pszSubsystem : "?");
+        out_text << buf;
+        if(info.pszName) {
+            std::snprintf(buf, sizeof(buf), "%-14s", info.pszName);
+        } else {
+            std::snprintf(buf, sizeof(buf), "#%-13u", static_cast<unsigned>(r.uiEvent));
+        }
+        out_text << buf;
+
+        if(info.bText) {
+            char szText[sizeof(r.args) + 1] = {0};
+            std::memcpy(szText, r.args, sizeof(r.args));
+            out_text << " '" << szText << "'";
+        } else {
+            for(int i = 0 ; i < 3 ; ++i) {
+                if(info.pszArgs[i])
+                    out_text << " " << info.pszArgs[i] << "=" << r.args[i];
+            }
+        }
+        out_text << std::endl;
+    }
+
+    return true;
+}
+
+/// \return Microseconds since the recorder started.
+std::uint64_t FlightRecorder::now()
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - g_start).count());
+}
+
+/// \return The number of the calling thread, the first one to record gets 1.
+std::uint32_t FlightRecorder::threadNumber()
+{
+    static thread_local std::uint32_t uiThread = 0;
+    if(uiThread == 0)
+        uiThread = s_uiNextThread.fetch_add(1, std::memory_order_relaxed);
+    return uiThread;
+}
+
+void FlightRecorder::onSignal(int in_iSignal)
+{
+    record(FlightEvent::Signal, in_iSignal);
+    dump(s_szCrashDumpFile);
+
+    // Whatever else wants out. This comes last as it is riskier than a dump.
+    void (*pfnHook)(void*) = s_pfnCrashHook.load();
+    if(pfnHook != nullptr)
+        pfnHook(s_pCrashHookArg.load());
+
+    // Let it crash like it would have without us.
+    std::signal(in_iSignal, SIG_DFL);
+    std::raise(in_iSignal);
+}
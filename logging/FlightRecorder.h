@@ -0,0 +1,132 @@
+#ifndef D_FLIGHTRECORDER_H
+#define D_FLIGHTRECORDER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <iosfwd>
+
+namespace FTS {
+
+/// The parts of the game events come from.
+/// \note These are written into the dumps, only ever add new ones at the end.
+enum class FlightSubsystem : std::uint16_t {
+    General = 0,
+    Runlevel,
+    File,
+    Archive,
+    Logger,
+    Count
+};
+
+/// What can be recorded, see \a FlightRecorder::describe for what the
+/// arguments of each event mean.
+/// \note These are written into the dumps, only ever add new ones at the end.
+enum class FlightEvent : std::uint16_t {
+    Started = 0,
+    Frame,
+    Signal,
+    Exception,
+    RunlevelEnter,
+    FileOpenAsync,
+    FileOpened,
+    ArchiveLoaded,
+    ChunkLoaded,
+    LogError,
+    LogHorror,
+    Count
+};
+
+/// How an event is shown by the decoder.
+struct FlightEventInfo {
+    FlightSubsystem subsystem;
+    const char* pszName;
+    /// Whether the arguments are a piece of text, see \a FlightRecorder::recordText.
+    bool bText;
+    /// The meaning of the integer arguments, nullptr for unused ones.
+    const char* pszArgs[3];
+};
+
+/// One entry of the recorder. This is exactly how it is written to the dump.
+struct FlightRecord {
+    /// The number of the record plus one, 0 while it is being written.
+    std::uint64_t uiSeq;
+    /// When it happened, in microseconds since the recorder started.
+    std::uint64_t uiTime;
+    std::uint16_t uiSubsystem;
+    std::uint16_t uiEvent;
+    /// A small number for the thread it happened on, the main thread is 1.
+    std::uint32_t uiThread;
+    std::int64_t args[3];
+};
+
+/// This records the last few thousand things that happened in the game into
+/// memory, in a compact binary form. It is cheap enough to be always on and
+/// doesn't allocate anything, so it can be dumped to the disk when the game
+/// crashes, even from a signal handler. The ftsflight tool turns the dumps
+/// into readable text.
+///
+/// Any thread may record, the oldest records get overwritten.
+class FlightRecorder {
+public:
+    /// How many records are kept.
+    static const std::size_t Capacity = 8192;
+    /// Written at the start of every dump.
+    static const char Magic[8];
+    static const std::uint32_t Version = 1;
+
+    static void record(FlightEvent in_event, std::int64_t in_a = 0, std::int64_t in_b = 0, std::int64_t in_c = 0);
+    static void recordText(FlightEvent in_event, const char* in_pszText);
+
+    static bool dump(const char* in_pszFileName);
+    static void installCrashHandler(const char* in_pszFileName);
+    static void setCrashHook(void (*in_pfnHook)(void*), void* in_pArg);
+    static bool writeAll(int in_fd, const void* in_pData, std::size_t in_uiSize);
+
+    static const FlightEventInfo& describe(FlightEvent in_event);
+    static const char* subsystemName(FlightSubsystem in_subsystem);
+    static bool decode(std::istream& in_dump, std::ostream& out_text);
+
+private:
+    /// A record in memory, the sequence number is atomic so that a torn
+    /// record can be told apart in the dump.
+    struct Slot {
+        std::atomic<std::uint64_t> seq;
+        std::uint64_t uiTime;
+        std::uint16_t uiSubsystem;
+        std::uint16_t uiEvent;
+        std::uint32_t uiThread;
+        std::int64_t args[3];
+    };
+
+    /// What comes before the records in a dump.
+    struct DumpHeader {
+        char magic[8];
+        std::uint32_t uiVersion;
+        std::uint32_t uiRecordSize;
+        std::uint64_t nRecords;
+        /// The sequence number the next record would have gotten.
+        std::uint64_t uiNext;
+        /// The wall-clock time at which the recorder started.
+        std::int64_t startTime;
+        /// When the dump was made, in microseconds since the recorder started.
+        std::uint64_t uiDumpTime;
+    };
+
+    static Slot s_slots[Capacity];
+    static std::atomic<std::uint64_t> s_uiNext;
+    static std::atomic<std::uint32_t> s_uiNextThread;
+    static const std::time_t s_startTime;
+    static char s_szCrashDumpFile[512];
+    static std::atomic<void (*)(void*)> s_pfnCrashHook;
+    static std::atomic<void*> s_pCrashHookArg;
+
+    static std::uint64_t now();
+    static std::uint32_t threadNumber();
+    static void onSignal(int in_iSignal);
+};
+
+} // namespace FTS
+
+#endif // D_FLIGHTRECORDER_H
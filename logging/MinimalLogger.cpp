@@ -8,6 +8,12 @@ using namespace FTS;
 
 MinimalLogger::MinimalLogger(int in_iDbgLv) : m_iDbgLv(in_iDbgLv)
 {
+#if defined(DEBUG)
+    m_iMaxDbgLv = in_iDbgLv;
+#else
+    // Debug messages are not written at all.
+    m_iMaxDbgLv = 0;
+#endif
 }
 
 MinimalLogger::~MinimalLogger()
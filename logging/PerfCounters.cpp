@@ -0,0 +1,271 @@
+#include "logging/PerfCounters.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <mutex>
+
+using namespace FTS;
+
+namespace {
+    /// A registered counter, with what the registry needs to remember about it.
+    struct Entry {
+        PerfCounter* pCounter;
+        /// The total of a counter at the end of the last frame.
+        std::int64_t iLastTotal;
+        /// The samples of a histogram since the start.
+        std::int64_t nTotalSamples;
+
+        /// What happened since the last line of the CSV file.
+        std::int64_t iCsvLastTotal;
+        std::int64_t nCsvSamples;
+        std::int64_t iCsvSum;
+        std::int64_t iCsvMax;
+    };
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<Entry> entries;
+        std::vector<PerfCounterValue> lastFrame;
+
+        std::FILE* pCsv = nullptr;
+        std::chrono::milliseconds csvInterval;
+        std::chrono::steady_clock::time_point csvStart;
+        std::chrono::steady_clock::time_point csvLastLine;
+        std::int64_t nCsvFrames = 0;
+        /// The counters changed since the last line, the columns need to be named again.
+        bool bCsvHeader = true;
+    };
+
+    /// This is never destroyed, static counters may go away after it would.
+    Registry& registry()
+    {
+        static Registry* pRegistry = new Registry;
+        return *pRegistry;
+    }
+
+    void registerCounter(PerfCounter* in_pCounter)
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.entries.push_back(Entry{in_pCounter, 0, 0, 0, 0, 0, 0});
+        r.bCsvHeader = true;
+    }
+
+    void writeCsvHeader(Registry& r)
+    {
+        std::fputs("seconds,frames", r.pCsv);
+        for(const Entry& e : r.entries) {
+            const char* pszName = e.pCounter->getName();
+            if(e.pCounter->getKind() == PerfCounter::Histogram) {
+                std::fprintf(r.pCsv, ",%s.count,%s.mean,%s.max", pszName, pszName, pszName);
+            } else {
+                std::fprintf(r.pCsv, ",%s", pszName);
+            }
+        }
+        std::fputc('\n', r.pCsv);
+        r.bCsvHeader = false;
+    }
+
+    /// Writes what happened since the last line, \a r.lastFrame has to be up to date.
+    void writeCsvLine(Registry& r, std::chrono::steady_clock::time_point in_now)
+    {
+        if(r.bCsvHeader)
+            writeCsvHeader(r);
+
+        double dSeconds = std::chrono::duration<double>(in_now - r.csvStart).count();
+        std::fprintf(r.pCsv, "%.3f,%lld", dSeconds, static_cast<long long>(r.nCsvFrames));
+        for(std::size_t i = 0 ; i < r.entries.size() ; ++i) {
+            Entry& e = r.entries[i];
+            const PerfCounterValue& v = r.lastFrame[i];
+            switch(v.kind) {
+            case PerfCounter::Counter:
+                std::fprintf(r.pCsv, ",%lld", static_cast<long long>(v.iTotal - e.iCsvLastTotal));
+                e.iCsvLastTotal = v.iTotal;
+                break;
+            case PerfCounter::Gauge:
+                std::fprintf(r.pCsv, ",%lld", static_cast<long long>(v.iValue));
+                break;
+            case PerfCounter::Histogram:
+                std::fprintf(r.pCsv, ",%lld,%.3f,%lld", static_cast<long long>(e.nCsvSamples),
+                             e.nCsvSamples > 0 ? static_cast<double>(e.iCsvSum) / static_cast<double>(e.nCsvSamples) : 0.0,
+                             static_cast<long long>(e.nCsvSamples > 0 ? e.iCsvMax : 0));
+                e.nCsvSamples = 0;
+                e.iCsvSum = 0;
+                break;
+            }
+        }
+        std::fputc('\n', r.pCsv);
+
+        r.nCsvFrames = 0;
+        r.csvLastLine = in_now;
+    }
+}
+
+/** Registers a counter, it stays registered until it is destroyed.
+ *
+ * \param in_pszName The name to show, it has to live as long as the counter.
+ *                   Best use a literal like "gl.drawCalls".
+ * \param in_kind How the values are to be understood.
+ */
+PerfCounter::PerfCounter(const char* in_pszName, Kind in_kind)
+    : m_pszName(in_pszName)
+    , m_kind(in_kind)
+    , m_iValue(0)
+    , m_nSamples(0)
+    , m_iMin(std::numeric_limits<std::int64_t>::max())
+    , m_iMax(std::numeric_limits<std::int64_t>::min())
+{
+    registerCounter(this);
+}
+
+/** Registers a counter that is counted somewhere else, like in a library that
+ *  doesn't know about us.
+ *
+ * \param in_pszName The name to show, it has to live as long as the counter.
+ * \param in_total Called once per frame, it has to return the total so far.
+ */
+PerfCounter::PerfCounter(const char* in_pszName, std::function<std::int64_t()> in_total)
+    : m_pszName(in_pszName)
+    , m_kind(Counter)
+    , m_total(in_total)
+    , m_iValue(0)
+    , m_nSamples(0)
+    , m_iMin(std::numeric_limits<std::int64_t>::max())
+    , m_iMax(std::numeric_limits<std::int64_t>::min())
+{
+    registerCounter(this);
+}
+
+PerfCounter::~PerfCounter()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.entries.erase(std::remove_if(r.entries.begin(), r.entries.end(), [this](const Entry& e) {
+        return e.pCounter == this;
+    }), r.entries.end());
+    r.bCsvHeader = true;
+}
+
+/// Adds a sample to a histogram, for example the size of a single read.
+void PerfCounter::sample(std::int64_t in_i)
+{
+    m_nSamples.fetch_add(1, std::memory_order_relaxed);
+    m_iValue.fetch_add(in_i, std::memory_order_relaxed);
+
+    std::int64_t iMin = m_iMin.load(std::memory_order_relaxed);
+    while(in_i < iMin && !m_iMin.compare_exchange_weak(iMin, in_i, std::memory_order_relaxed)) {
+    }
+    std::int64_t iMax = m_iMax.load(std::memory_order_relaxed);
+    while(in_i > iMax && !m_iMax.compare_exchange_weak(iMax, in_i, std::memory_order_relaxed)) {
+    }
+}
+
+/// Ends the current frame: takes the values of all counters during that frame,
+/// and writes them into the CSV file if it is time to. Call it once per frame
+/// on the main thread.
+void PerfCounters::frame()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    r.lastFrame.clear();
+    for(Entry& e : r.entries) {
+        PerfCounter& c = *e.pCounter;
+        PerfCounterValue v = {c.getName(), c.getKind(), 0, 0, 0, 0, 0.0};
+
+        switch(c.getKind()) {
+        case PerfCounter::Counter:
+            v.iTotal = c.m_total ? c.m_total() : c.m_iValue.load(std::memory_order_relaxed);
+            v.iValue = v.iTotal - e.iLastTotal;
+            e.iLastTotal = v.iTotal;
+            break;
+        case PerfCounter::Gauge:
+            v.iValue = v.iTotal = c.m_iValue.load(std::memory_order_relaxed);
+            break;
+        case PerfCounter::Histogram:
+            {
+                std::int64_t nSamples = c.m_nSamples.exchange(0, std::memory_order_relaxed);
+                std::int64_t iSum = c.m_iValue.exchange(0, std::memory_order_relaxed);
+                std::int64_t iMin = c.m_iMin.exchange(std::numeric_limits<std::int64_t>::max(), std::memory_order_relaxed);
+                std::int64_t iMax = c.m_iMax.exchange(std::numeric_limits<std::int64_t>::min(), std::memory_order_relaxed);
+
+                e.nTotalSamples += nSamples;
+                v.iValue = nSamples;
+                v.iTotal = e.nTotalSamples;
+                if(nSamples > 0) {
+                    v.iMin = iMin;
+                    v.iMax = iMax;
+                    v.dMean = static_cast<double>(iSum) / static_cast<double>(nSamples);
+
+                    e.iCsvMax = e.nCsvSamples > 0 ? std::max(e.iCsvMax, iMax) : iMax;
+                    e.nCsvSamples += nSamples;
+                    e.iCsvSum += iSum;
+                }
+            }
+            break;
+        }
+
+        r.lastFrame.push_back(v);
+    }
+
+    if(r.pCsv) {
+        r.nCsvFrames++;
+        auto now = std::chrono::steady_clock::now();
+        if(now - r.csvLastLine >= r.csvInterval)
+            writeCsvLine(r, now);
+    }
+}
+
+/// \return The values of all counters during the last frame, in the order
+///         they have been registered.
+std::vector<PerfCounterValue> PerfCounters::getLastFrame()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return r.lastFrame;
+}
+
+/** Starts writing the counters into a CSV file: a line every \a in_interval,
+ *  with what happened since the line before. Counters get a column with the
+ *  events, gauges with their value and histograms three: the number of
+ *  samples, their mean and their maximum.
+ *
+ * \param in_sFileName The file to write, it is overwritten.
+ * \param in_interval How often to write a line.
+ *
+ * \return false if the file can't be written.
+ */
+bool PerfCounters::startCsv(const std::string& in_sFileName, std::chrono::milliseconds in_interval)
+{
+    PerfCounters::stopCsv();
+
+    std::FILE* pCsv = std::fopen(in_sFileName.c_str(), "w");
+    if(!pCsv)
+        return false;
+
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.pCsv = pCsv;
+    r.csvInterval = in_interval;
+    r.csvStart = r.csvLastLine = std::chrono::steady_clock::now();
+    r.nCsvFrames = 0;
+    r.bCsvHeader = true;
+    for(Entry& e : r.entries) {
+        e.iCsvLastTotal = e.iLastTotal;
+        e.nCsvSamples = 0;
+        e.iCsvSum = 0;
+    }
+    return true;
+}
+
+/// Stops writing the CSV file and closes it.
+void PerfCounters::stopCsv()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    if(r.pCsv) {
+        std::fclose(r.pCsv);
+        r.pCsv = nullptr;
+    }
+}
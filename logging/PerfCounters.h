@@ -0,0 +1,88 @@
+#ifndef D_PERFCOUNTERS_H
+#define D_PERFCOUNTERS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace FTS {
+
+/// A number that tells something about the workload of the game, like the
+/// draw calls or the bytes read. Subsystems keep them around as static objects
+/// and update them from any thread, which only costs an atomic addition.
+/// \a PerfCounters turns them into values per frame.
+class PerfCounter {
+public:
+    enum Kind {
+        Counter,   ///< Only ever goes up, shown per frame and in total.
+        Gauge,     ///< Goes up and down, like the number of things alive.
+        Histogram, ///< A sample per event, shown as count, min, mean and max per frame.
+    };
+
+    PerfCounter(const char* in_pszName, Kind in_kind = Counter);
+    PerfCounter(const char* in_pszName, std::function<std::int64_t()> in_total);
+    ~PerfCounter();
+
+    PerfCounter(const PerfCounter&) = delete;
+    PerfCounter& operator=(const PerfCounter&) = delete;
+
+    /// Counts \a in_i events, or adds \a in_i to a gauge.
+    inline void add(std::int64_t in_i = 1) {m_iValue.fetch_add(in_i, std::memory_order_relaxed);};
+    /// Takes \a in_i away from a gauge.
+    inline void sub(std::int64_t in_i = 1) {m_iValue.fetch_sub(in_i, std::memory_order_relaxed);};
+    /// Sets a gauge to \a in_i.
+    inline void set(std::int64_t in_i) {m_iValue.store(in_i, std::memory_order_relaxed);};
+    void sample(std::int64_t in_i);
+
+    inline const char* getName() const {return m_pszName;};
+    inline Kind getKind() const {return m_kind;};
+
+private:
+    friend class PerfCounters;
+
+    const char* m_pszName;
+    Kind m_kind;
+    /// Where the total of a counter comes from, if it isn't counted here.
+    std::function<std::int64_t()> m_total;
+
+    /// The total of a counter, the value of a gauge or the sum of the samples
+    /// of a histogram during the current frame.
+    std::atomic<std::int64_t> m_iValue;
+    std::atomic<std::int64_t> m_nSamples;
+    std::atomic<std::int64_t> m_iMin;
+    std::atomic<std::int64_t> m_iMax;
+};
+
+/// The value of a counter during a frame.
+struct PerfCounterValue {
+    const char* pszName;
+    PerfCounter::Kind kind;
+    /// Counters: the events during the frame. Gauges: the value at the end of
+    /// the frame. Histograms: the number of samples during the frame.
+    std::int64_t iValue;
+    /// Counters: the events since the start. Histograms: the samples since the
+    /// start. Gauges: the value again.
+    std::int64_t iTotal;
+    /// Histograms only, of the samples during the frame.
+    std::int64_t iMin;
+    std::int64_t iMax;
+    double dMean;
+};
+
+/// Keeps track of all \a PerfCounter s. At every \a frame, their values are
+/// taken and, if wanted, written into a CSV file every now and then.
+class PerfCounters {
+public:
+    static void frame();
+    static std::vector<PerfCounterValue> getLastFrame();
+
+    static bool startCsv(const std::string& in_sFileName, std::chrono::milliseconds in_interval);
+    static void stopCsv();
+};
+
+} // namespace FTS
+
+#endif // D_PERFCOUNTERS_H
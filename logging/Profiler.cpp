@@ -0,0 +1,338 @@
+#include "logging/Profiler.h"
+
+#if D_PROFILE
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+
+using namespace FTS;
+
+namespace {
+    const std::chrono::steady_clock::time_point g_start = std::chrono::steady_clock::now();
+
+    /// Zones nested deeper than this are counted as if they were this deep.
+    const std::uint32_t MaxDepth = 64;
+
+    /// Everything a thread measured since the last frame, or since the capture
+    /// started while capturing.
+    struct ThreadBuffer {
+        /// Only the owning thread and the profiler itself use it.
+        std::mutex mutex;
+        std::vector<Profiler::Event> events;
+        /// The events before this one have already been summed up.
+        std::size_t nAggregated = 0;
+        /// The time of the zones that ended, per depth, which is still waiting
+        /// to be taken out of the zone they are nested in.
+        std::uint64_t childNs[MaxDepth + 1] = {0};
+
+        std::uint32_t uiThread = 0;
+        std::string sName;
+        bool bExited = false;
+    };
+
+    struct ProfilerState {
+        /// Protects everything in here, take it before the one of a buffer.
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+        std::uint32_t uiNextThread = 1;
+
+        std::vector<ProfileZoneStats> lastFrame;
+        std::uint64_t uiLastFrameStart = 0;
+        std::uint64_t uiLastFrameNs = 0;
+        std::uint64_t nFrames = 0;
+
+        bool bCapturing = false;
+        std::string sCaptureFile;
+        std::size_t nMaxEvents = 0;
+        std::size_t nCaptured = 0;
+        std::size_t nDropped = 0;
+    };
+
+    /// This is never destroyed, zones may still end while the program exits.
+    ProfilerState& state()
+    {
+        static ProfilerState* pState = new ProfilerState;
+        return *pState;
+    }
+
+    /// Lets the profiler know when the thread of a buffer ends, so that the
+    /// buffer can go away once its events are not needed anymore.
+    struct BufferOwner {
+        ThreadBuffer* pBuffer = nullptr;
+
+        ~BufferOwner()
+        {
+            if(pBuffer) {
+                std::lock_guard<std::mutex> lock(state().mutex);
+                pBuffer->bExited = true;
+            }
+        }
+    };
+
+    thread_local BufferOwner t_owner;
+    thread_local std::uint32_t t_uiDepth = 0;
+
+    ThreadBuffer& threadBuffer()
+    {
+        if(!t_owner.pBuffer) {
+            ProfilerState& s = state();
+            std::unique_ptr<ThreadBuffer> pBuffer(new ThreadBuffer);
+            t_owner.pBuffer = pBuffer.get();
+
+            std::lock_guard<std::mutex> lock(s.mutex);
+            pBuffer->uiThread = s.uiNextThread++;
+            s.buffers.push_back(std::move(pBuffer));
+        }
+        return *t_owner.pBuffer;
+    }
+
+    void addToStats(std::vector<ProfileZoneStats>& out_stats, const char* in_pszName, std::uint64_t in_uiTotalNs, std::uint64_t in_uiSelfNs)
+    {
+        // There are only a few dozen zones, and the same name usually is the
+        // same literal anyway.
+        auto i = std::find_if(out_stats.begin(), out_stats.end(), [in_pszName](const ProfileZoneStats& z) {
+            return z.pszName == in_pszName || std::strcmp(z.pszName, in_pszName) == 0;
+        });
+        if(i == out_stats.end()) {
+            out_stats.push_back(ProfileZoneStats{in_pszName, 0, 0, 0});
+            i = out_stats.end() - 1;
+        }
+
+        i->nCalls++;
+        i->uiTotalNs += in_uiTotalNs;
+        i->uiSelfNs += in_uiSelfNs;
+    }
+
+    void writeJsonString(std::ostream& out, const char* in_psz)
+    {
+        out << '"';
+        for(const char* p = in_psz ; *p ; ++p) {
+            if(*p == '"' || *p == '\\') {
+                out << '\\' << *p;
+            } else if(static_cast<unsigned char>(*p) < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(*p));
+                out << buf;
+            } else {
+                out << *p;
+            }
+        }
+        out << '"';
+    }
+
+    /// Chrome traces count in microseconds, but may have decimals.
+    void writeMicroseconds(std::ostream& out, std::uint64_t in_uiNs)
+    {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%llu.%03u", static_cast<unsigned long long>(in_uiNs / 1000), static_cast<unsigned>(in_uiNs % 1000));
+        out << buf;
+    }
+}
+
+/** Ends the current frame: sums up all zones that ended since the last call,
+ *  on all threads, into the stats of that frame. Call it once per frame, on
+ *  the main thread, best through \a FTS_PROFILE_FRAME.
+ */
+void Profiler::frame()
+{
+    std::uint64_t uiNow = now();
+    std::vector<ProfileZoneStats> stats;
+
+    ProfilerState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    for(auto i = s.buffers.begin() ; i != s.buffers.end() ; ) {
+        ThreadBuffer& buf = **i;
+        {
+            std::lock_guard<std::mutex> bufLock(buf.mutex);
+
+            // A zone is added when it ends, that is after all zones nested in it.
+            for(std::size_t e = buf.nAggregated ; e < buf.events.size() ; ++e) {
+                const Event& ev = buf.events[e];
+                std::uint32_t uiDepth = std::min(ev.uiDepth, MaxDepth - 1);
+                std::uint64_t uiNs = ev.uiEnd - ev.uiStart;
+                std::uint64_t uiChildNs = buf.childNs[uiDepth + 1];
+                buf.childNs[uiDepth + 1] = 0;
+                buf.childNs[uiDepth] += uiNs;
+                addToStats(stats, ev.pszName, uiNs, uiNs > uiChildNs ? uiNs - uiChildNs : 0);
+            }
+            buf.childNs[0] = 0;
+
+            if(s.bCapturing) {
+                std::size_t nNew = buf.events.size() - buf.nAggregated;
+                std::size_t nKeep = std::min(nNew, s.nMaxEvents - s.nCaptured);
+                s.nCaptured += nKeep;
+                s.nDropped += nNew - nKeep;
+                buf.events.resize(buf.nAggregated + nKeep);
+            } else {
+                buf.events.clear();
+            }
+            buf.nAggregated = buf.events.size();
+        }
+
+        if(buf.bExited && buf.events.empty()) {
+            i = s.buffers.erase(i);
+        } else {
+            ++i;
+        }
+    }
+
+    std::sort(stats.begin(), stats.end(), [](const ProfileZoneStats& a, const ProfileZoneStats& b) {
+        return a.uiTotalNs > b.uiTotalNs;
+    });
+    s.lastFrame.swap(stats);
+    s.uiLastFrameNs = s.nFrames > 0 ? uiNow - s.uiLastFrameStart : 0;
+    s.uiLastFrameStart = uiNow;
+    s.nFrames++;
+}
+
+/// \return Where the time went during the last frame, the zone that took the
+///         longest comes first.
+std::vector<ProfileZoneStats> Profiler::getLastFrame()
+{
+    std::lock_guard<std::mutex> lock(state().mutex);
+    return state().lastFrame;
+}
+
+/// \return How long the last frame took in nanoseconds, 0 before the second frame.
+std::uint64_t Profiler::getLastFrameNs()
+{
+    std::lock_guard<std::mutex> lock(state().mutex);
+    return state().uiLastFrameNs;
+}
+
+/// \return How many frames have ended.
+std::uint64_t Profiler::getFrameCount()
+{
+    std::lock_guard<std::mutex> lock(state().mutex);
+    return state().nFrames;
+}
+
+/** Starts keeping all zones, from the next frame on, to write them out as a
+ *  trace when the capture stops.
+ *
+ * \param in_sFileName Where \a stopCapture writes the trace to.
+ * \param in_nMaxEvents How many zones to keep at most, the ones after that
+ *                      are dropped. A zone takes 32 bytes.
+ */
+void Profiler::startCapture(const std::string& in_sFileName, std::size_t in_nMaxEvents)
+{
+    ProfilerState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.bCapturing = true;
+    s.sCaptureFile = in_sFileName;
+    s.nMaxEvents = in_nMaxEvents;
+    s.nCaptured = 0;
+    s.nDropped = 0;
+}
+
+bool Profiler::isCapturing()
+{
+    std::lock_guard<std::mutex> lock(state().mutex);
+    return state().bCapturing;
+}
+
+/// Stops capturing and writes the trace into the file given to \a startCapture.
+/// \return false if there was no capture or the file couldn't be written.
+bool Profiler::stopCapture()
+{
+    std::string sFileName;
+    {
+        std::lock_guard<std::mutex> lock(state().mutex);
+        if(!state().bCapturing)
+            return false;
+        sFileName = state().sCaptureFile;
+    }
+
+    std::ofstream trace(sFileName.c_str());
+    Profiler::stopCapture(trace);
+    return static_cast<bool>(trace);
+}
+
+/** Stops capturing and writes the trace in the Chrome trace event format. Only
+ *  the zones of the frames that have ended are part of it.
+ *
+ * \param out_trace Where to write the JSON to.
+ *
+ * \return The number of zones written.
+ */
+std::size_t Profiler::stopCapture(std::ostream& out_trace)
+{
+    ProfilerState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    out_trace << "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedEvents\":" << s.nDropped << "},\"traceEvents\":[";
+    std::size_t nWritten = 0;
+    for(auto& pBuf : s.buffers) {
+        std::lock_guard<std::mutex> bufLock(pBuf->mutex);
+
+        out_trace << (pBuf == s.buffers.front() ? "\n" : ",\n")
+                  << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << pBuf->uiThread << ",\"args\":{\"name\":";
+        writeJsonString(out_trace, pBuf->sName.empty() ? ("Thread " + std::to_string(pBuf->uiThread)).c_str() : pBuf->sName.c_str());
+        out_trace << "}}";
+
+        for(std::size_t e = 0 ; e < pBuf->nAggregated ; ++e) {
+            const Event& ev = pBuf->events[e];
+            out_trace << ",\n{\"name\":";
+            writeJsonString(out_trace, ev.pszName);
+            out_trace << ",\"cat\":\"fts\",\"ph\":\"X\",\"pid\":1,\"tid\":" << pBuf->uiThread << ",\"ts\":";
+            writeMicroseconds(out_trace, ev.uiStart);
+            out_trace << ",\"dur\":";
+            writeMicroseconds(out_trace, ev.uiEnd - ev.uiStart);
+            out_trace << "}";
+            nWritten++;
+        }
+
+        // Whatever ended after the last frame still needs to be summed up.
+        pBuf->events.erase(pBuf->events.begin(), pBuf->events.begin() + static_cast<std::ptrdiff_t>(pBuf->nAggregated));
+        pBuf->nAggregated = 0;
+    }
+    out_trace << "\n]}" << std::endl;
+
+    s.bCapturing = false;
+    s.nCaptured = 0;
+    return nWritten;
+}
+
+/// \param in_pszName What the calling thread is called in the traces.
+void Profiler::setThreadName(const char* in_pszName)
+{
+    ThreadBuffer& buf = threadBuffer();
+    std::lock_guard<std::mutex> lock(state().mutex);
+    buf.sName = in_pszName;
+}
+
+/// Adds a zone that has been measured on the calling thread.
+void Profiler::addEvent(const Event& in_event)
+{
+    ThreadBuffer& buf = threadBuffer();
+    std::lock_guard<std::mutex> lock(buf.mutex);
+    buf.events.push_back(in_event);
+}
+
+/// \return Nanoseconds since the profiler started.
+std::uint64_t Profiler::now()
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_start).count());
+}
+
+ProfileZone::ProfileZone(const char* in_pszName)
+    : m_pszName(in_pszName)
+    , m_uiStart(Profiler::now())
+    , m_uiDepth(t_uiDepth++)
+{
+}
+
+ProfileZone::~ProfileZone()
+{
+    Profiler::Event ev = {m_pszName, m_uiStart, Profiler::now(), m_uiDepth};
+    t_uiDepth--;
+    Profiler::addEvent(ev);
+}
+
+#endif // D_PROFILE
@@ -0,0 +1,103 @@
+#ifndef D_PROFILER_H
+#define D_PROFILER_H
+
+/// The profiler is always built into debug builds. Release builds only get it
+/// when D_PROFILE is defined to 1 (the FTS_PROFILE cmake option), otherwise
+/// all of the FTS_PROFILE_* macros expand to nothing.
+#ifndef D_PROFILE
+#  if defined(DEBUG)
+#    define D_PROFILE 1
+#  else
+#    define D_PROFILE 0
+#  endif
+#endif
+
+#if D_PROFILE
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace FTS {
+
+/// How much time went into one zone during a frame, summed over all threads.
+struct ProfileZoneStats {
+    const char* pszName;
+    std::uint32_t nCalls;
+    /// The time spent in the zone, including the zones nested in it.
+    std::uint64_t uiTotalNs;
+    /// The time spent in the zone itself, without the zones nested in it.
+    std::uint64_t uiSelfNs;
+};
+
+/// Collects the zones that have been measured by \a ProfileZone (better use
+/// \a FTS_PROFILE_SCOPE) on any thread. Every thread has a buffer of its own,
+/// so that measuring only contends with the profiler itself once per frame.
+///
+/// At every \a frame, the zones are summed up into the stats of that frame.
+/// While capturing, they are kept to be written out as a Chrome trace, which
+/// can be opened in chrome://tracing or https://ui.perfetto.dev.
+class Profiler {
+public:
+    /// A zone that has been measured, the times are in nanoseconds since the
+    /// profiler started.
+    struct Event {
+        const char* pszName;
+        std::uint64_t uiStart;
+        std::uint64_t uiEnd;
+        std::uint32_t uiDepth;
+    };
+
+    static void frame();
+    static std::vector<ProfileZoneStats> getLastFrame();
+    static std::uint64_t getLastFrameNs();
+    static std::uint64_t getFrameCount();
+
+    static void startCapture(const std::string& in_sFileName = std::string(), std::size_t in_nMaxEvents = 1 << 20);
+    static bool isCapturing();
+    static bool stopCapture();
+    static std::size_t stopCapture(std::ostream& out_trace);
+
+    static void setThreadName(const char* in_pszName);
+    static void addEvent(const Event& in_event);
+    static std::uint64_t now();
+};
+
+/// Measures the time between its construction and destruction.
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* in_pszName);
+    ~ProfileZone();
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* m_pszName;
+    std::uint64_t m_uiStart;
+    std::uint32_t m_uiDepth;
+};
+
+} // namespace FTS
+
+#  define FTS_PROFILE_CONCAT_(a, b) a##b
+#  define FTS_PROFILE_CONCAT(a, b) FTS_PROFILE_CONCAT_(a, b)
+/// Measures the rest of the current scope. The name has to live forever,
+/// best use a string literal like "Terrain::draw".
+#  define FTS_PROFILE_SCOPE(name) ::FTS::ProfileZone FTS_PROFILE_CONCAT(ftsProfileZone, __LINE__)(name)
+/// Ends the current frame, call this once per frame on the main thread.
+#  define FTS_PROFILE_FRAME() ::FTS::Profiler::frame()
+/// Names the calling thread in the traces.
+#  define FTS_PROFILE_THREAD(name) ::FTS::Profiler::setThreadName(name)
+
+#else
+
+#  define FTS_PROFILE_SCOPE(name) ((void)0)
+#  define FTS_PROFILE_FRAME() ((void)0)
+#  define FTS_PROFILE_THREAD(name) ((void)0)
+
+#endif // D_PROFILE
+
+#endif // D_PROFILER_H
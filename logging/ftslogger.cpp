@@ -2,19 +2,22 @@
 #include <CEGUI.h>
 
 #include "logging/ftslogger.h"
+#include "logging/AsyncLogWriter.h"
+#include "logging/FlightRecorder.h"
 #include "ui/ui.h"
 #include "ui/ui_commands.h"
 #include "input/input.h"
 #include "utilities/console.h"
 #include "dLib/dFile/dFile.h"
-#include "dLib/dConf/configuration.h"
+#include "dLib/dConf/ConfigurationStore.h"
 #include "dLib/dString/dTranslation.h"
 #include <ctime>
 
 using namespace FTS;
 
 DefaultLogger::DefaultLogger()
-    : m_pLogFile(nullptr)
+    : m_pLogWriter(nullptr)
+    , m_mainThread(std::this_thread::get_id())
     , m_bLastDbg(false)
     , m_iGDLL(0)
     , m_lastMessageType(MsgType::Raw)
@@ -35,10 +38,10 @@ DefaultLogger::DefaultLogger()
     // If the log dir doesn't exist, create it.
     FileUtils::mkdirIfNeeded(Path::userdir("Logfiles"), false);
 
-    Configuration conf("conf.xml", ArkanaDefaultSettings());
-    m_iGDLL = conf.get<int>("DebugLevel");
+    Configuration::Ptr pConf = ConfigurationStore::getSingleton().getMainConf();
+    this->applyGDLL(pConf->get<int>("DebugLevel"));
 
-    if(!m_pLogFile) {
+    {
         // Create a filename consisting of date and time.
         struct tm *newtime;
         time_t long_time;
@@ -55,14 +58,20 @@ DefaultLogger::DefaultLogger()
         String sFileName = Path::userdir("Logfiles") + Path(sOnlyName);
 
         // Create the log file.
-        m_pLogFile = fopen(sFileName.c_str(), "w+");
-        if(!m_pLogFile) {
+        FILE *pLogFile = fopen(sFileName.c_str(), "w+");
+        if(!pLogFile) {
             printf("HORROR: COULD NOT CREATE THE LOGFILE '%s': '%s' !\n",
                    sFileName.c_str(), strerror(errno));
         } else {
-            fprintf(m_pLogFile, "=====================\n");
-            fprintf(m_pLogFile, "== Logging started ==\n");
-            fprintf(m_pLogFile, "=====================\n\n");
+            fprintf(pLogFile, "=====================\n");
+            fprintf(pLogFile, "== Logging started ==\n");
+            fprintf(pLogFile, "=====================\n\n");
+
+            // From now on, the messages are only flushed every now and then.
+            int iFlushInterval = pConf->get<int>("LogFlushInterval");
+            m_pLogWriter = new AsyncLogWriter(pLogFile, 4096, std::chrono::milliseconds(std::max(iFlushInterval, 0)));
+            // But if the game crashes, they still have to get out.
+            FlightRecorder::setCrashHook(&AsyncLogWriter::onCrash, m_pLogWriter);
         }
     }
     m_translation = new Translation("messages");
@@ -70,7 +79,9 @@ DefaultLogger::DefaultLogger()
 
 DefaultLogger::~DefaultLogger()
 {
-    SAFE_FCLOSE(m_pLogFile);
+    if(m_pLogWriter)
+        FlightRecorder::setCrashHook(nullptr, nullptr);
+    SAFE_DELETE(m_pLogWriter);
     delete m_translation;
 }
 
@@ -91,18 +102,24 @@ int DefaultLogger::loadConfig()
  */
 int DefaultLogger::setGDLL(int in_iValue)
 {
-    if(in_iValue < 1) {
-        m_iGDLL = 1;
-    } else {
-        m_iGDLL = in_iValue;
-    }
-    Configuration conf ("conf.xml", ArkanaDefaultSettings());
+    this->applyGDLL(in_iValue < 1 ? 1 : in_iValue);
+    Configuration::Ptr pConf = ConfigurationStore::getSingleton().getMainConf();
 
-    conf.set("DebugLevel", m_iGDLL);
-    conf.save();
+    pConf->set("DebugLevel", m_iGDLL);
+    pConf->save();
     return ERR_OK;
 }
 
+/// Sets the GDLL without storing it in the configuration.
+/// \param in_iGDLL The new value for the GDLL.
+void DefaultLogger::applyGDLL(int in_iGDLL)
+{
+    m_iGDLL = in_iGDLL;
+
+    // The log file gets everything up to level 4 anyway, see doMessage.
+    m_iMaxDbgLv = std::max(m_iGDLL, 4);
+}
+
 /// Returns the Global Debug Level Limit.
 /** This returns the Global Debug Level Limit. See the \c MsgType::Enum enum and
  *  the \c message function if you don't know what it is.
@@ -164,8 +181,9 @@ String DefaultLogger::formatI18nMessage(const String &in_sMsgID,
 {
     String sErrMsg;
 
-    // This avoids infinite recursion.
-    if(m_bIsInTranslation) {
+    // This avoids infinite recursion. While the messages aren't loaded yet,
+    // for example when loading them fails, there is nothing to translate with.
+    if(m_bIsInTranslation || m_translation == nullptr) {
         sErrMsg = in_sMsgID + "(" + in_sArg1 + ","
                                   + in_sArg2 + ","
                                   + in_sArg3 + ","
@@ -378,8 +396,10 @@ int DefaultLogger::doMessage(const String &in_sMsg, const MsgType::Enum& in_Grav
         return -1;
     }
 
+    bool bMainThread = std::this_thread::get_id() == m_mainThread;
+
     // If there is an error before comes the DONE message, write the FAILED message.
-    if(m_bLastDbg && (in_Gravity == MsgType::Error || in_Gravity == MsgType::Horror))
+    if(bMainThread && m_bLastDbg && (in_Gravity == MsgType::Error || in_Gravity == MsgType::Horror))
         this->failConsoleMessage();
 
     // If this is a debug message that has debug level 5, only logg this if
@@ -393,15 +413,20 @@ int DefaultLogger::doMessage(const String &in_sMsg, const MsgType::Enum& in_Grav
     case MsgType::Warning:
     case MsgType::WarningNoMB:
         sMessage = "FTS: Warning: ";
-        Console::Attr(Console::ATTRIBUTE::CHANGEFG, Console::COLOR::BLUE);
+        if(bMainThread)
+            Console::Attr( Console::ATTRIBUTE::CHANGEFG, Console::COLOR::BLUE );
         break;
     case MsgType::Error:
         sMessage = "FTS: Error: ";
-        Console::Attr( Console::ATTRIBUTE::CHANGEFG, Console::COLOR::RED );
+        FlightRecorder::recordText(FlightEvent::LogError, in_sMsg.c_str());
+        if(bMainThread)
+            Console::Attr( Console::ATTRIBUTE::CHANGEFG, Console::COLOR::RED );
         break;
     case MsgType::Horror:
         sMessage = "FTS: HORROR: ";
-        Console::Attr( Console::ATTRIBUTE::CHANGEFG, Console::COLOR::DARKRED );
+        FlightRecorder::recordText(FlightEvent::LogHorror, in_sMsg.c_str());
+        if(bMainThread)
+            Console::Attr( Console::ATTRIBUTE::CHANGEFG, Console::COLOR::DARKRED );
         break;
     case MsgType::Raw:
         if(in_iDbgLv > 1) {
@@ -412,7 +437,8 @@ int DefaultLogger::doMessage(const String &in_sMsg, const MsgType::Enum& in_Grav
         }
         break;
     case MsgType::GoodMessage:
-        Console::Attr( Console::ATTRIBUTE::CHANGEFG, Console::COLOR::DARKGREEN );
+        if(bMainThread)
+            Console::Attr( Console::ATTRIBUTE::CHANGEFG, Console::COLOR::DARKGREEN );
         break;
     case MsgType::Message:
     case MsgType::MessageNoMB:
@@ -447,7 +473,7 @@ int DefaultLogger::doMessage(const String &in_sMsg, const MsgType::Enum& in_Grav
         break;
     }
 
-    if(in_iDbgLv != 5) {
+    if(in_iDbgLv != 5 && bMainThread) {
 #if 0
         // If it's the same message again, don't display it, just
         // count the repeats it has.
@@ -479,37 +505,33 @@ int DefaultLogger::doMessage(const String &in_sMsg, const MsgType::Enum& in_Grav
     }
 
     /* Now that we have our message ready, write it to log file and console when needed. */
-    if(in_iDbgLv != 5 && m_pLogFile) {
-        /* In the file, we write the time/date too. */
-        struct tm *newtime;
-        time_t long_time;
+    if(in_iDbgLv != 5 && m_pLogWriter) {
+        // The writer adds the time/date and the missing \n.
+        m_pLogWriter->push(sMessage.str(), time(nullptr));
 
-        time(&long_time);
-        newtime = localtime(&long_time);        // What a struggle to just get the time and date.
-
-        fprintf(m_pLogFile, "%.2d-%.2d-%.4d_%.2d-%.2d-%.2d -- ",
-                newtime->tm_mday, newtime->tm_mon + 1,
-                newtime->tm_year + 1900, newtime->tm_hour, newtime->tm_min,
-                newtime->tm_sec);
-        // In the logfile, we add a \n if there is none.
-        if(sMessage.right(1) != "\n")
-            fprintf(m_pLogFile, "%s\n", sMessage.c_str());
-        else
-            fprintf(m_pLogFile, "%s", sMessage.c_str());
-        fflush(m_pLogFile);
+        // Whatever happens after a horror, it has to be in the file.
+        if(in_Gravity == MsgType::Horror)
+            m_pLogWriter->flush();
     }
 
     if(in_iDbgLv <= getGDLL()) {
         if(!m_bMute) {
             printf("%s", sMessage.c_str());
-            fflush(stdout);
+
+            // A "doing ..." has to be seen before its "Done", and errors
+            // right away. Everything else ends the line anyway.
+            if(sMessage.right(1) != "\n" || in_Gravity == MsgType::Error || in_Gravity == MsgType::Horror)
+                fflush(stdout);
+        }
+        if(bMainThread) {
+            m_bLastDbg = (in_Gravity == MsgType::Raw) && (in_iDbgLv == 1);
+            Console::Attr( Console::ATTRIBUTE::NORMAL );
+            m_lastMessageTime.reset();
         }
-        m_bLastDbg = (in_Gravity == MsgType::Raw) && (in_iDbgLv == 1);
-        Console::Attr( Console::ATTRIBUTE::NORMAL );
-        m_lastMessageTime.reset();
     }
 
-    createWindow(in_Gravity, sMessage);
+    if(bMainThread)
+        createWindow(in_Gravity, sMessage);
 
     return ERR_OK;
 }
@@ -528,8 +550,8 @@ int DefaultLogger::doneConsoleMessage()
         putchar('\n');
     }
 
-    if(m_pLogFile)
-        fprintf(m_pLogFile, "Done\n");
+    if(m_pLogWriter)
+        m_pLogWriter->push("Done\n");
 
     return ERR_OK;
 }
@@ -548,12 +570,19 @@ int DefaultLogger::failConsoleMessage()
         putchar('\n');
     }
 
-    if(m_pLogFile)
-        fprintf(m_pLogFile, "Failed");
+    if(m_pLogWriter)
+        m_pLogWriter->push("Failed");
 
     return ERR_OK;
 }
 
+/// Waits until every message logged so far is on the disk.
+void DefaultLogger::flush()
+{
+    if(m_pLogWriter)
+        m_pLogWriter->flush();
+}
+
 int DefaultLogger::createWindow(MsgType::Enum in_Gravity, const String &in_sMessage)
 {
     String sTitle;
@@ -604,9 +633,9 @@ DefaultLoggerDlg::DefaultLoggerDlg(MsgType::Enum in_Gravity, const String &in_sM
     try {
         // Load the window. Do it manually to avoid infinite recursion if there
         // is an error during loading of the window !
-        Configuration conf ("conf.xml", ArkanaDefaultSettings());
+        Configuration::Ptr pConf = ConfigurationStore::getSingleton().getMainConf();
 
-        String sWindowName = "dlg_message." + conf.get<std::string>("Language") + ".layout";
+        String sWindowName = "dlg_message." + pConf->get<std::string>("Language") + ".layout";
         m_pRoot = CEGUI::WindowManager::getSingleton().loadWindowLayout(sWindowName);
         String sTitle = m_pRoot->getText();
 
@@ -6,11 +6,17 @@
 #include "logging/logger.h"
 #include "logging/Chronometer.h"
 
+#include <thread>
+
 namespace FTS {
 
 class DefaultLogger : public Logger {
 private:
-    FILE *m_pLogFile;
+    /// Writes the log file on its own thread.
+    class AsyncLogWriter* m_pLogWriter;
+    /// The console and the dialogs are only touched from this thread, the
+    /// others only write into the log file and print their message.
+    std::thread::id m_mainThread;
     bool m_bLastDbg;
     // GlobalDebugLevelLimit: The level up to wich the debug messages are shown.
     int m_iGDLL;
@@ -33,6 +39,7 @@ private:
 
     int createWindow(MsgType::Enum in_Gravity, const String &in_sMessage);
     int doMessage(const String &in_sMsg, const MsgType::Enum& in_Gravity, int in_iDbgLv = 0);
+    void applyGDLL(int in_iGDLL);
 
 protected:
     virtual String formatMessage(const String &in_pszMsg,
@@ -138,6 +145,7 @@ public:
                       );
     int doneConsoleMessage();
     int failConsoleMessage();
+    void flush();
 
     int setGDLL(int in_iValue);
     int getGDLL();
@@ -7,16 +7,25 @@
 #include "utilities/PolymorphicCopyable.h"
 #include "logging/MsgType.h"
 
+#include <type_traits>
+
 namespace FTS {
 
 class Logger : public Singleton<Logger> {
 protected:
+    /// The highest debug level that still ends up somewhere, see \a isLogged.
+    int m_iMaxDbgLv = 5;
+
     /// Protect constructor.
     Logger() {};
 
 public:
     virtual ~Logger() {};
 
+    /// \return Whether a debug message of level \a in_iDbgLv would be written
+    ///         anywhere at all. If not, there is no need to even format it.
+    inline bool isLogged(int in_iDbgLv) const {return in_iDbgLv <= m_iMaxDbgLv;};
+
     virtual int loadConfig() = 0;
 
     virtual void stfu() = 0;
@@ -138,6 +147,80 @@ int FTSMSGDBG(const FTS::String &in_pszMsg, int in_iDbgLv, const FTS::String &in
 
 namespace FTS {
 
+/// Turns an argument of a debug message into the text that replaces its {n}.
+/// Only called once it is clear that the message really gets logged.
+inline const String& logArg(const String& in_s) {return in_s;}
+inline String logArg(const char* in_s) {return String(in_s);}
+inline String logArg(const std::string& in_s) {return String(in_s);}
+inline String logArg(char in_c) {return String::chr(static_cast<unsigned char>(in_c));}
+inline String logArg(bool in_b) {return String::b(in_b);}
+
+template<typename T>
+inline typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, String>::type logArg(T in_i)
+{
+    return String::nr(static_cast<int64_t>(in_i));
+}
+
+template<typename T>
+inline typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value, String>::type logArg(T in_i)
+{
+    return String::nr(static_cast<uint64_t>(in_i));
+}
+
+template<typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value, String>::type logArg(T in_f)
+{
+    return String::nr(static_cast<double>(in_f));
+}
+
+} // namespace FTS
+
+/// Writes a debug message, but only formats it if its level gets logged at
+/// all. Use this instead of gluing the message together by hand:
+/// \code
+///     FTSMSGDBG("Reading {1} '{2}' with size {3}", 3, this->getTypeName(), m_sName, m_uiPayloadLength);
+/// \endcode
+/// costs a single comparison when level 3 is filtered out, while
+/// \code
+///     FTSMSGDBG("Reading "+this->getTypeName()+" '"+m_sName+"' with size "+String::nr(m_uiPayloadLength), 3);
+/// \endcode
+/// always builds the whole string.
+///
+/// \param in_pszFmt The message, with {1} to {9} where the arguments go.
+/// \param in_iDbgLv The debug level of the message.
+/// \param in_args Up to nine strings, numbers or bools, or anything else
+///                that has a \a logArg, see \a FTS::logArg.
+template<typename... Args>
+inline int FTSMSGDBG(const char* in_pszFmt, int in_iDbgLv, const Args&... in_args)
+{
+    static_assert(sizeof...(Args) <= 9, "A message can have at most nine arguments.");
+
+    FTS::Logger* pLogger = FTS::Logger::getSingletonPtr();
+    if(pLogger == nullptr || !pLogger->isLogged(in_iDbgLv))
+        return ERR_OK;
+
+    // Arguments of other types can have a logArg in their own namespace.
+    using FTS::logArg;
+    return pLogger->messageDbg(FTS::String(in_pszFmt), in_iDbgLv, logArg(in_args)...);
+}
+
+/// The same as the \a FTSMSGDBG template, for a message that is translated.
+template<typename... Args>
+inline int FTS18NDBG(const char* in_pszMsgID, int in_iDbgLv, const Args&... in_args)
+{
+    static_assert(sizeof...(Args) <= 9, "A message can have at most nine arguments.");
+
+    FTS::Logger* pLogger = FTS::Logger::getSingletonPtr();
+    if(pLogger == nullptr || !pLogger->isLogged(in_iDbgLv))
+        return ERR_OK;
+
+    // Arguments of other types can have a logArg in their own namespace.
+    using FTS::logArg;
+    return pLogger->i18nMessageDbg(FTS::String(in_pszMsgID), in_iDbgLv, logArg(in_args)...);
+}
+
+namespace FTS {
+
 class BaseLoggerCmd : public CommandBase, public PolymorphicCopyable {
 public:
     BaseLoggerCmd() {};
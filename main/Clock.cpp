@@ -7,6 +7,7 @@
 using namespace FTS;
 
 FTS::Clock::Clock()
+    : m_dAlpha(1.0)
 {
     m_startTime = std::chrono::steady_clock::now();
     m_lastTick = m_startTime;
@@ -21,7 +22,11 @@ void FTS::Clock::tick()
 {
     m_lastTick = m_currentTime;
     m_currentTime = std::chrono::steady_clock::now();
+    this->countTick();
+}
 
+void FTS::Clock::countTick()
+{
     // Update the list of ticks in the last second: remove all ticks that are
     // older than one second.
     while ( !m_lastTicks.empty() && std::chrono::duration_cast< std::chrono::milliseconds >( m_currentTime - m_lastTicks.front() ).count() > 1000 )
@@ -47,3 +52,62 @@ double FTS::Clock::getTPS() const
     return (double)m_lastTicks.size();
 }
 
+
+/** Creates a simulation clock, it starts at the same time as a clock would.
+ *
+ * \param in_uiStepsPerSec How many steps make one second.
+ * \param in_uiMaxStepsPerFrame How many steps \a accumulate allows at most.
+ */
+FTS::SimulationClock::SimulationClock(unsigned int in_uiStepsPerSec, unsigned int in_uiMaxStepsPerFrame)
+    : m_step(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds(1)) / std::max(in_uiStepsPerSec, 1u))
+    , m_accumulated(0)
+    , m_uiMaxStepsPerFrame(std::max(in_uiMaxStepsPerFrame, 1u))
+    , m_nDroppedSteps(0)
+{
+    m_dAlpha = 0.0;
+}
+
+/** Adds the real time that passed since the last time to the time the
+ *  simulation has to catch up with.
+ *
+ * \param in_dSeconds How much real time passed.
+ *
+ * \return How many steps are due now, \a tick the clock and simulate for each.
+ *          If more are due than allowed per frame, the others are dropped.
+ */
+unsigned int FTS::SimulationClock::accumulate(double in_dSeconds)
+{
+    m_accumulated += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(std::max(in_dSeconds, 0.0)));
+
+    auto nSteps = m_accumulated / m_step;
+    if(nSteps > m_uiMaxStepsPerFrame) {
+        m_nDroppedSteps += nSteps - m_uiMaxStepsPerFrame;
+        m_accumulated -= m_step * (nSteps - m_uiMaxStepsPerFrame);
+        nSteps = m_uiMaxStepsPerFrame;
+    }
+
+    // That's where we'll be once the due steps are done.
+    m_dAlpha = std::chrono::duration<double>(m_accumulated - m_step * nSteps) / m_step;
+    return static_cast<unsigned int>(nSteps);
+}
+
+/** Advances the clock by exactly one step.
+ */
+void FTS::SimulationClock::tick()
+{
+    m_lastTick = m_currentTime;
+    m_currentTime += m_step;
+    if(m_accumulated >= m_step)
+        m_accumulated -= m_step;
+    this->countTick();
+}
+
+double FTS::SimulationClock::getStep() const
+{
+    return std::chrono::duration<double>( m_step ).count();
+}
+
+std::chrono::steady_clock::duration FTS::SimulationClock::getTimeToNextStep() const
+{
+    return m_accumulated >= m_step ? std::chrono::steady_clock::duration::zero() : m_step - m_accumulated;
+}
@@ -27,6 +27,14 @@ public:
     */
     double getTPS() const;
 
+    /*! Returns how far the simulation got on towards its next step, from 0
+        to 1, when it runs at a fixed rate. Rendering may use it to
+        interpolate between the last two simulated states. Without a fixed
+        rate the simulation is up to date, and this is 1.
+    */
+    double getAlpha() const {return m_dAlpha;};
+    void setAlpha(double in_dAlpha) {m_dAlpha = in_dAlpha;};
+
 protected:
     std::chrono::steady_clock::time_point m_startTime;
     std::chrono::steady_clock::time_point m_lastTick;
@@ -34,7 +42,44 @@ protected:
 
     std::list<std::chrono::steady_clock::time_point> m_lastTicks;
 
+    double m_dAlpha;
+
+    void countTick();
+
+private:
+};
+
+/*! A clock for the simulation that doesn't follow the real time, but advances
+    by the same step on every tick. Like that, the simulation costs the same
+    and behaves the same no matter how fast the frames are drawn.
+
+    The real time that passes is collected by accumulate(), which tells how
+    many steps are due. If it falls too far behind, the simulation slows down
+    rather than taking ever more steps per frame.
+*/
+class SimulationClock : public Clock
+{
+public:
+    SimulationClock(unsigned int in_uiStepsPerSec, unsigned int in_uiMaxStepsPerFrame);
+
+    unsigned int accumulate(double in_dSeconds);
+    virtual void tick();
+
+    /*! Returns the length of one step, in seconds.
+    */
+    double getStep() const;
+    /*! Returns how much real time is missing until the next step is due.
+    */
+    std::chrono::steady_clock::duration getTimeToNextStep() const;
+    /*! Returns how many steps have been skipped because they were too many.
+    */
+    uint64_t getDroppedSteps() const {return m_nDroppedSteps;};
+
 private:
+    std::chrono::steady_clock::duration m_step;
+    std::chrono::steady_clock::duration m_accumulated;
+    unsigned int m_uiMaxStepsPerFrame;
+    uint64_t m_nDroppedSteps;
 };
 
 }; // namespace FTS
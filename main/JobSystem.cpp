@@ -0,0 +1,395 @@
+#include "main/JobSystem.h"
+
+#include "dLib/dString/dString.h"
+#include "logging/Profiler.h"
+
+#include <algorithm>
+
+using namespace FTS;
+
+namespace {
+    /// The job system the calling thread belongs to, if any, and its queue.
+    thread_local JobSystem* t_pSystem = nullptr;
+    thread_local std::size_t t_iQueue = 0;
+}
+
+JobCounter::JobCounter()
+    : m_nPending(0)
+{
+}
+
+/** Starts the worker threads.
+ *
+ * \param in_nWorkers How many threads to start besides the calling one, which
+ *                    becomes the main thread. With none, the jobs are only
+ *                    done while the main thread waits for them.
+ */
+JobSystem::JobSystem(std::size_t in_nWorkers)
+    : m_mainThread(std::this_thread::get_id())
+    , m_nQueued(0)
+    , m_nextForeignQueue(0)
+    , m_nSteals(0)
+    , m_nSleeping(0)
+    , m_nWaiting(0)
+{
+    for(std::size_t i = 0 ; i <= in_nWorkers ; ++i) {
+        m_queues.push_back(std::unique_ptr<Queue>(new Queue));
+    }
+
+    t_pSystem = this;
+    t_iQueue = 0;
+    for(std::size_t i = 1 ; i <= in_nWorkers ; ++i) {
+        m_workers.push_back(std::thread(&JobSystem::work, this, i));
+    }
+}
+
+/// Lets the workers finish all jobs that have been started, then does the
+/// remaining main thread jobs.
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_bQuit = true;
+        m_wakeUp.notify_all();
+    }
+    for(auto i = m_workers.begin() ; i != m_workers.end() ; ++i) {
+        i->join();
+    }
+
+    // Without workers, nobody did the jobs of the main thread's queue yet.
+    Job job;
+    while(this->takeJob(job)) {
+        this->execute(job);
+    }
+
+    if(t_pSystem == this)
+        t_pSystem = nullptr;
+}
+
+/// \return One worker for every core but the one of the main thread, at least one.
+std::size_t JobSystem::defaultWorkerCount()
+{
+    std::size_t nCores = std::thread::hardware_concurrency();
+    return nCores > 2 ? nCores - 1 : 1;
+}
+
+/** Hands a job over to the job system. This may be called from any thread,
+ *  also from within a job.
+ *
+ * \param in_job What to do.
+ * \param in_pCounter Counted up now and down once the job is done, so that
+ *                    one can \a wait for it. May be nullptr.
+ * \param in_pAfter The job only starts once this counter is done. May be nullptr.
+ * \param in_affinity Who may do the job.
+ */
+void JobSystem::run(std::function<void()> in_job, JobCounter* in_pCounter, JobCounter* in_pAfter, Affinity in_affinity)
+{
+    if(in_pCounter)
+        in_pCounter->m_nPending.fetch_add(1, std::memory_order_relaxed);
+
+    Job job = {std::move(in_job), in_pCounter, in_affinity == MainThread};
+    if(in_pAfter) {
+        // The last job of that counter starts the ones waiting for it, see finish().
+        std::lock_guard<std::mutex> lock(in_pAfter->m_mutex);
+        if(in_pAfter->m_nPending.load(std::memory_order_acquire) > 0) {
+            in_pAfter->m_waiting.push_back(std::move(job));
+            return;
+        }
+    }
+
+    this->schedule(std::move(job));
+}
+
+/** Helps doing jobs until all jobs counted by \a in_counter are done.
+ *
+ * \param in_counter The counter to wait for, it may be destroyed right after.
+ *
+ * \exception If one of the counted jobs threw, the first exception is
+ *            re-thrown here once all of them are done.
+ */
+void JobSystem::wait(JobCounter& in_counter)
+{
+    Job job;
+    while(!in_counter.isDone()) {
+        if(this->takeJob(job)) {
+            this->execute(job);
+            continue;
+        }
+
+        // Nothing to help with, sleep until the counter is done or there is.
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_nWaiting.fetch_add(1);
+        m_waitDone.wait(lock, [this, &in_counter]() {return this->hasJobFor(in_counter);});
+        m_nWaiting.fetch_sub(1);
+    }
+
+    // Taking the lock makes sure the last job let go of the counter.
+    std::exception_ptr pError;
+    {
+        std::lock_guard<std::mutex> lock(in_counter.m_mutex);
+        std::swap(pError, in_counter.m_pError);
+    }
+    if(pError)
+        std::rethrow_exception(pError);
+}
+
+/// Does all jobs that only the main thread may do, call it once per frame
+/// from the main thread. Jobs added meanwhile are done the next time.
+/// \return How many jobs have been done.
+std::size_t JobSystem::runMainThreadJobs()
+{
+    std::deque<Job> jobs;
+    {
+        std::lock_guard<std::mutex> lock(m_mainMutex);
+        jobs.swap(m_mainJobs);
+    }
+
+    for(auto i = jobs.begin() ; i != jobs.end() ; ++i) {
+        this->execute(*i);
+    }
+    return jobs.size();
+}
+
+/** Calls \a in_work for consecutive ranges of the items from 0 to
+ *  \a in_nItems - 1, as jobs, and waits until all of them are done.
+ *
+ * \param in_nItems How many items there are.
+ * \param in_nGrain How many items a job works on at most. With 0, the items
+ *                  are split in about four jobs per thread.
+ * \param in_work Gets the first item and the one after the last of a range.
+ *
+ * \exception If the work throws, the exception of the first range that threw
+ *            is re-thrown once all ranges are done. Like that, the same
+ *            exception comes out no matter in which order the ranges ran.
+ */
+void JobSystem::parallelFor(std::size_t in_nItems, std::size_t in_nGrain, const std::function<void(std::size_t, std::size_t)>& in_work)
+{
+    if(in_nItems == 0)
+        return;
+
+    std::size_t nGrain = in_nGrain;
+    if(nGrain == 0)
+        nGrain = std::max<std::size_t>(in_nItems / (4 * m_queues.size()), 1);
+
+    // There's no need for a job for the range this thread would take anyway.
+    if(nGrain >= in_nItems) {
+        in_work(0, in_nItems);
+        return;
+    }
+
+    // Each range only ever touches its own slot.
+    std::vector<std::exception_ptr> errors((in_nItems + nGrain - 1) / nGrain);
+    JobCounter counter;
+    for(std::size_t iBegin = 0 ; iBegin < in_nItems ; iBegin += nGrain) {
+        std::size_t iEnd = std::min(iBegin + nGrain, in_nItems);
+        std::exception_ptr& pError = errors[iBegin / nGrain];
+        this->run([&in_work, &pError, iBegin, iEnd]() {
+            try {
+                in_work(iBegin, iEnd);
+            } catch(...) {
+                pError = std::current_exception();
+            }
+        }, &counter);
+    }
+    this->wait(counter);
+
+    for(auto i = errors.begin() ; i != errors.end() ; ++i) {
+        if(*i)
+            std::rethrow_exception(*i);
+    }
+}
+
+void JobSystem::schedule(Job in_job)
+{
+    if(in_job.bMainThread) {
+        {
+            std::lock_guard<std::mutex> lock(m_mainMutex);
+            m_mainJobs.push_back(std::move(in_job));
+        }
+        // The main thread may be waiting for it.
+        this->wakeWaiting();
+        return;
+    }
+
+    // Jobs of threads that don't belong to us go to the workers in turn.
+    std::size_t iQueue = 0;
+    if(t_pSystem == this) {
+        iQueue = t_iQueue;
+    } else if(m_queues.size() > 1) {
+        iQueue = 1 + m_nextForeignQueue.fetch_add(1, std::memory_order_relaxed) % (m_queues.size() - 1);
+    }
+
+    {
+        Queue& q = *m_queues[iQueue];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.jobs.push_back(std::move(in_job));
+    }
+
+    // Pairs with the worker going to sleep: either it sees the job or we see
+    // it sleeping.
+    m_nQueued.fetch_add(1);
+    if(m_nSleeping.load() > 0) {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_wakeUp.notify_one();
+    }
+    this->wakeWaiting();
+}
+
+/// Takes the next job the calling thread should do: its own newest one, a
+/// main thread job if it is the main thread, or else another thread's oldest.
+/// \return false if there is nothing to do right now.
+bool JobSystem::takeJob(Job& out_job)
+{
+    std::size_t iOwn = t_pSystem == this ? t_iQueue : m_queues.size();
+    if(iOwn < m_queues.size()) {
+        Queue& q = *m_queues[iOwn];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if(!q.jobs.empty()) {
+            out_job = std::move(q.jobs.back());
+            q.jobs.pop_back();
+            m_nQueued.fetch_sub(1);
+            return true;
+        }
+    }
+
+    if(std::this_thread::get_id() == m_mainThread) {
+        std::lock_guard<std::mutex> lock(m_mainMutex);
+        if(!m_mainJobs.empty()) {
+            out_job = std::move(m_mainJobs.front());
+            m_mainJobs.pop_front();
+            return true;
+        }
+    }
+
+    if(m_nQueued.load(std::memory_order_relaxed) == 0)
+        return false;
+
+    // Start looking at the next queue, so that not all thieves go for the same.
+    for(std::size_t i = 1 ; i <= m_queues.size() ; ++i) {
+        std::size_t iVictim = (iOwn + i) % m_queues.size();
+        if(iVictim == iOwn)
+            continue;
+
+        Queue& q = *m_queues[iVictim];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if(!q.jobs.empty()) {
+            out_job = std::move(q.jobs.front());
+            q.jobs.pop_front();
+            m_nQueued.fetch_sub(1);
+            m_nSteals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::execute(Job& in_job)
+{
+    try {
+        in_job.work();
+    } catch(...) {
+        if(in_job.pCounter) {
+            std::lock_guard<std::mutex> lock(in_job.pCounter->m_mutex);
+            if(!in_job.pCounter->m_pError)
+                in_job.pCounter->m_pError = std::current_exception();
+        }
+    }
+
+    // Let go of what the work captured right now, not when the next job comes.
+    in_job.work = nullptr;
+    if(in_job.pCounter)
+        this->finish(*in_job.pCounter);
+}
+
+/// Counts a job of \a in_counter as done. The last one starts the jobs that
+/// wait for the counter.
+void JobSystem::finish(JobCounter& in_counter)
+{
+    std::size_t nPending = in_counter.m_nPending.load(std::memory_order_acquire);
+    for(;;) {
+        if(nPending > 1) {
+            if(in_counter.m_nPending.compare_exchange_weak(nPending, nPending - 1, std::memory_order_acq_rel))
+                return;
+            continue;
+        }
+
+        // This seems to be the last one. Once the counter is done, the one
+        // waiting for it may destroy it, so it only becomes done while we hold
+        // its lock, which wait() takes before it returns.
+        std::vector<Job> waiting;
+        {
+            std::lock_guard<std::mutex> lock(in_counter.m_mutex);
+            if(!in_counter.m_nPending.compare_exchange_strong(nPending, 0))
+                continue;
+            waiting.swap(in_counter.m_waiting);
+        }
+
+        for(auto i = waiting.begin() ; i != waiting.end() ; ++i) {
+            this->schedule(std::move(*i));
+        }
+        this->wakeWaiting();
+        return;
+    }
+}
+
+/// Wakes up the threads in \a wait, so that they look again whether their
+/// counter is done or whether they can help.
+void JobSystem::wakeWaiting()
+{
+    // Pairs with wait(): either it sees what changed or we see it waiting.
+    if(m_nWaiting.load() == 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_sleepMutex);
+    m_waitDone.notify_all();
+}
+
+/// \return Whether \a in_counter is done or there is a job the calling thread
+///         could take. Only call it while holding \a m_sleepMutex.
+bool JobSystem::hasJobFor(const JobCounter& in_counter)
+{
+    if(in_counter.m_nPending.load() == 0 || m_nQueued.load() > 0)
+        return true;
+
+    if(std::this_thread::get_id() != m_mainThread)
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_mainMutex);
+    return !m_mainJobs.empty();
+}
+
+void JobSystem::work(std::size_t in_iQueue)
+{
+    t_pSystem = this;
+    t_iQueue = in_iQueue;
+    FTS_PROFILE_THREAD("Job worker");
+
+    Job job;
+    for(;;) {
+        if(this->takeJob(job)) {
+            this->execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        if(m_bQuit && m_nQueued.load() == 0)
+            break;
+
+        m_nSleeping.fetch_add(1);
+        m_wakeUp.wait(lock, [this]() {return m_nQueued.load() > 0 || m_bQuit;});
+        m_nSleeping.fetch_sub(1);
+    }
+}
+
+/// Like \a JobSystem::parallelFor, but if there is no job system, all the
+/// items are done right here in one range.
+void FTS::parallelForRanges(std::size_t in_nItems, std::size_t in_nGrain, const std::function<void(std::size_t, std::size_t)>& in_work)
+{
+    JobSystem* pJobs = JobSystem::getSingletonPtr();
+    if(pJobs) {
+        pJobs->parallelFor(in_nItems, in_nGrain, in_work);
+    } else if(in_nItems > 0) {
+        in_work(0, in_nItems);
+    }
+}
@@ -0,0 +1,144 @@
+#ifndef D_JOBSYSTEM_H
+#define D_JOBSYSTEM_H
+
+#include "utilities/Singleton.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace FTS {
+    class JobCounter;
+
+/// A piece of work that has been handed to the \a JobSystem.
+struct Job {
+    std::function<void()> work;
+    /// Counted down once the work is done, may be nullptr.
+    JobCounter* pCounter;
+    /// Whether only the main thread may do this work, for example because it
+    /// uses OpenGL.
+    bool bMainThread;
+};
+
+/// Counts the jobs that are not done yet, see \a JobSystem::run. Other jobs
+/// may wait for a counter to reach zero before they start.\n
+///
+/// The counter may be used again once it reached zero, but it must only be
+/// destroyed after \a JobSystem::wait returned for it.
+class JobCounter : public NonCopyable {
+public:
+    JobCounter();
+
+    /// \return Whether all jobs counted by this are done.
+    inline bool isDone() const {return m_nPending.load(std::memory_order_acquire) == 0;};
+
+private:
+    std::atomic<std::size_t> m_nPending;
+
+    /// Guards the jobs that wait for this counter and the error.
+    std::mutex m_mutex;
+    std::vector<Job> m_waiting;
+    /// The first exception one of the jobs threw, \a JobSystem::wait re-throws it.
+    std::exception_ptr m_pError;
+
+    friend class JobSystem;
+};
+
+/// Spreads small jobs over one worker thread per core. Every thread has a
+/// queue of its own: it does its newest job first, and when it runs out of
+/// work, it steals the oldest job of another thread. Threads that wait for
+/// jobs to be done help doing them in the meantime.\n
+///
+/// Jobs that must run on the main thread, like everything that touches
+/// OpenGL, are kept apart: the main thread does them once per frame in
+/// \a runMainThreadJobs and whenever it waits.
+///
+/// \note Only one job system may exist at a time. The thread that creates it
+///       is its main thread.
+class JobSystem : public Singleton<JobSystem> {
+public:
+    typedef enum {
+        AnyThread,  ///< Any thread may do the job.
+        MainThread, ///< Only the main thread may do the job.
+    } Affinity;
+
+    JobSystem(std::size_t in_nWorkers = JobSystem::defaultWorkerCount());
+    virtual ~JobSystem();
+
+    void run(std::function<void()> in_job, JobCounter* in_pCounter = nullptr, JobCounter* in_pAfter = nullptr, Affinity in_affinity = AnyThread);
+    void wait(JobCounter& in_counter);
+    std::size_t runMainThreadJobs();
+
+    void parallelFor(std::size_t in_nItems, std::size_t in_nGrain, const std::function<void(std::size_t, std::size_t)>& in_work);
+
+    /// \return How many worker threads there are, besides the main thread.
+    inline std::size_t getWorkerCount() const {return m_workers.size();};
+    /// \return How many jobs have been stolen from another thread's queue.
+    inline std::uint64_t getSteals() const {return m_nSteals.load(std::memory_order_relaxed);};
+
+    static std::size_t defaultWorkerCount();
+
+private:
+    /// The jobs of one thread. Cache line aligned, so that threads working on
+    /// their own queue don't get in each other's way.
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    /// Queue 0 belongs to the main thread, the others to the workers.
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_workers;
+    std::thread::id m_mainThread;
+
+    /// The jobs only the main thread may do.
+    std::mutex m_mainMutex;
+    std::deque<Job> m_mainJobs;
+
+    /// How many jobs are in all queues, the main thread's ones not counted.
+    std::atomic<std::size_t> m_nQueued;
+    /// Where the jobs of threads that don't belong to us go next.
+    std::atomic<std::size_t> m_nextForeignQueue;
+    std::atomic<std::uint64_t> m_nSteals;
+
+    /// Guards the workers' sleep and quitting.
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wakeUp;
+    std::atomic<std::size_t> m_nSleeping;
+    bool m_bQuit = false;
+
+    /// Threads in \a wait sleep on this, also guarded by \a m_sleepMutex.
+    /// They are woken up when a counter is done and when there are new jobs
+    /// they could help with.
+    std::condition_variable m_waitDone;
+    std::atomic<std::size_t> m_nWaiting;
+
+    void schedule(Job in_job);
+    bool takeJob(Job& out_job);
+    void execute(Job& in_job);
+    void finish(JobCounter& in_counter);
+    void wakeWaiting();
+    bool hasJobFor(const JobCounter& in_counter);
+    void work(std::size_t in_iQueue);
+};
+
+void parallelForRanges(std::size_t in_nItems, std::size_t in_nGrain, const std::function<void(std::size_t, std::size_t)>& in_work);
+
+/// \return The grain to give to \a parallelForRanges so that the items are
+///         split into \a in_nRanges ranges at most. With 0 ranges, 0, so the
+///         job system decides.
+inline std::size_t rangeGrain(std::size_t in_nItems, std::size_t in_nRanges)
+{
+    return in_nRanges == 0 ? 0 : (in_nItems + in_nRanges - 1) / in_nRanges;
+}
+
+} // namespace FTS
+
+#endif // D_JOBSYSTEM_H
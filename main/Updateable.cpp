@@ -1,88 +1,359 @@
 #include "Updateable.h"
 
+#include "main/JobSystem.h"
 #include "dLib/dString/dString.h"
+#include "logging/Profiler.h"
+
+#include <algorithm>
 
 using namespace FTS;
 
+namespace {
+    /// How many thread safe items one job updates at most. Updating a single
+    /// one is too little work to be worth a job.
+    const std::size_t ParallelGrain = 16;
+
+    const char* PhaseNames[Updateable::PhaseCount] = {
+        "Updates: Input",
+        "Updates: Runlevels",
+        "Updates: Simulation",
+        "Updates: Animation",
+        "Updates: Audio",
+        "Updates: PreRender",
+    };
+
+    /// A handle is the slot in the lower half and its generation in the upper
+    /// one. Generations start at 1, so no handle is 0.
+    inline UpdateableManager::Handle makeHandle(std::uint32_t in_iSlot, std::uint32_t in_generation)
+    {
+        return static_cast<UpdateableManager::Handle>(in_generation) << 32 | in_iSlot;
+    }
+
+    inline std::uint32_t slotOf(UpdateableManager::Handle in_h)
+    {
+        return static_cast<std::uint32_t>(in_h & 0xffffffff);
+    }
+
+    inline std::uint32_t generationOf(UpdateableManager::Handle in_h)
+    {
+        return static_cast<std::uint32_t>(in_h >> 32);
+    }
+}
+
 UpdateableManager::UpdateableManager()
+    : m_nSlots(0)
+    , m_bUpdating(false)
+    , m_nRemoved(0)
 {
 }
 
 UpdateableManager::~UpdateableManager()
 {
     // Remove everything that is left in here.
-    while(!m_all.empty()) {
-        String key = m_all.begin()->first;
-        delete m_all.begin()->second;
-        // We erase it using the key so that if the updateable's destructor
-        // unregisters itself, we won't run into trouble here.
-        m_all.erase(key);
-    }
-
-    for(std::size_t lastSize = m_anonymous.size() ; !m_anonymous.empty() ; lastSize = m_anonymous.size()) {
-        delete *m_anonymous.begin();
+    for(std::uint32_t i = 0 ; i < m_slots.size() ; ++i) {
+        Updateable* pUpd = m_slots[i].pUpd;
+        if(!pUpd)
+            continue;
 
+        Handle h = makeHandle(i, m_slots[i].generation);
+        delete pUpd;
         // We remove the entry only in case the destructor didn't do it himself.
-        if(m_anonymous.size() == lastSize)
-            m_anonymous.erase(m_anonymous.begin());
+        this->rem(h);
     }
 }
 
-UpdateableManager& UpdateableManager::add(const FTS::String& in_sName, Updateable* in_pUpd)
+UpdateableManager::Handle UpdateableManager::add(Updateable* in_pUpd, const Name& in_debugName)
 {
-    m_all[in_sName] = in_pUpd;
+    Handle h = this->reserve();
+    this->change(Change{Change::Add, h, in_pUpd, in_debugName});
+    return h;
+}
+
+UpdateableManager& UpdateableManager::rem(Handle in_h)
+{
+    Updateable* pUpd = nullptr;
+    std::uint32_t iSlot = slotOf(in_h);
+    if(iSlot < m_slots.size() && m_slots[iSlot].generation == generationOf(in_h))
+        pUpd = m_slots[iSlot].pUpd;
+
+    this->change(Change{Change::RemHandle, in_h, pUpd, Name()});
     return *this;
 }
 
+UpdateableManager::Handle UpdateableManager::add(const FTS::String& in_sName, Updateable* in_pUpd)
+{
+    return this->add(Name(in_sName), in_pUpd);
+}
+
 UpdateableManager& UpdateableManager::rem(const FTS::String& in_sName)
 {
-    m_all.erase(in_sName);
-    return *this;
+    return this->rem(Name(in_sName));
+}
+
+UpdateableManager::Handle UpdateableManager::add(const FTS::Name& in_name, Updateable* in_pUpd)
+{
+    Handle h = this->reserve();
+    this->change(Change{Change::AddNamed, h, in_pUpd, in_name});
+    return h;
 }
 
-UpdateableManager& UpdateableManager::add(Updateable* in_pUpd)
+UpdateableManager& UpdateableManager::rem(const FTS::Name& in_name)
 {
-    m_anonymous.insert(in_pUpd);
+    // Nobody changes the names during a phase, so looking it up is safe.
+    Updateable* pUpd = nullptr;
+    auto i = m_named.find(in_name);
+    if(i != m_named.end())
+        pUpd = m_slots[slotOf(i->second)].pUpd;
+
+    this->change(Change{Change::RemName, InvalidHandle, pUpd, in_name});
     return *this;
 }
 
 UpdateableManager& UpdateableManager::rem(Updateable* in_pUpd)
 {
-    // First search through the list of anonymous items.
-    m_anonymous.erase(in_pUpd);
+    this->change(Change{Change::RemPointer, InvalidHandle, in_pUpd, Name()});
+    return *this;
+}
+
+Name UpdateableManager::getName(Handle in_h) const
+{
+    std::uint32_t iSlot = slotOf(in_h);
+    if(iSlot >= m_slots.size() || m_slots[iSlot].generation != generationOf(in_h) || !m_slots[iSlot].pUpd)
+        return Name();
+
+    return m_slots[iSlot].name;
+}
+
+/** Updates everybody, one phase after the other. Within a phase, the items
+ *  that aren't thread safe are updated one after the other first, then the
+ *  thread safe ones in parallel, if there is a \a JobSystem.\n
+ *
+ *  Items added or removed meanwhile, even from other threads, are only added
+ *  or removed once the current phase is over. Removed items aren't updated
+ *  anymore right away though, so that they may be deleted.
+ *
+ * \param c The clock of the game.
+ * \param in_first The first phase to update.
+ * \param in_last The last phase to update. When the simulation runs at a
+ *                fixed rate, its phases are updated apart from the others.
+ *
+ * \return A reference to myself.
+ */
+UpdateableManager& UpdateableManager::doUpdates(const Clock& c, Updateable::Phase in_first, Updateable::Phase in_last)
+{
+    FTS_PROFILE_SCOPE("UpdateableManager::doUpdates");
 
-    // Not found in the anonymous list? search the named list then.
-    for(auto i = m_all.begin() ; i != m_all.end() ; ++i) {
-        if(i->second == in_pUpd) {
-            m_all.erase(i);
-            return *this;
+    m_bUpdating = true;
+    try {
+        for(int iPhase = in_first ; iPhase <= in_last ; ++iPhase) {
+            if(!m_unplaced.empty())
+                this->place();
+
+            FTS_PROFILE_SCOPE(PhaseNames[iPhase]);
+            this->updatePhase(m_phases[iPhase], c);
+            this->endPhase();
         }
+    } catch(...) {
+        // Don't lose what happened until now.
+        this->endPhase();
+        m_bUpdating = false;
+        throw;
     }
+    m_bUpdating = false;
 
     return *this;
 }
 
-UpdateableManager& UpdateableManager::doUpdates(const Clock& c)
+void UpdateableManager::updatePhase(Batch& in_batch, const Clock& in_c)
 {
-    for(UpdateableMap::iterator i = m_all.begin() ; i != m_all.end() ; ) {
+    for(auto i = in_batch.serial.begin() ; i != in_batch.serial.end() ; ++i) {
         // When returning false, it means that this updater wants us to stop
-        // updating it. We *can* erase the entry while iterating, just the
-        // iterator that points to the entry gets invalidated, others stay valid.
-        if(!i->second->update(c)) {
-            m_all.erase(i++); // Note: post-increment.
-        } else {
-            ++i;
+        // updating it.
+        if(!this->removedMeanwhile(i->pUpd) && !i->pUpd->update(in_c))
+            m_finished.push_back(makeHandle(i->iSlot, m_slots[i->iSlot].generation));
+    }
+
+    if(in_batch.parallel.empty())
+        return;
+
+    // Every job only writes the flags of its own items.
+    m_parallelFinished.assign(in_batch.parallel.size(), 0);
+    parallelForRanges(in_batch.parallel.size(), ParallelGrain, [this, &in_batch, &in_c](std::size_t in_iBegin, std::size_t in_iEnd) {
+        for(std::size_t i = in_iBegin ; i < in_iEnd ; ++i) {
+            Updateable* pUpd = in_batch.parallel[i].pUpd;
+            if(!this->removedMeanwhile(pUpd) && !pUpd->update(in_c))
+                m_parallelFinished[i] = 1;
+        }
+    });
+
+    for(std::size_t i = 0 ; i < in_batch.parallel.size() ; ++i) {
+        if(m_parallelFinished[i]) {
+            std::uint32_t iSlot = in_batch.parallel[i].iSlot;
+            m_finished.push_back(makeHandle(iSlot, m_slots[iSlot].generation));
         }
     }
+}
+
+/// Removes the items that asked for it and does the additions and removals
+/// that have been waiting for the end of the phase.
+void UpdateableManager::endPhase()
+{
+    for(auto i = m_finished.begin() ; i != m_finished.end() ; ++i) {
+        this->release(*i);
+    }
+    m_finished.clear();
 
-    for(auto i = m_anonymous.begin() ; i != m_anonymous.end() ; ) {
-        // Same story as above.
-        if(!(*i)->update(c)) {
-            m_anonymous.erase(i++);
-        } else {
-            ++i;
+    std::vector<Change> changes;
+    {
+        std::lock_guard<std::mutex> lock(m_changesMutex);
+        changes.swap(m_changes);
+        m_removed.clear();
+        m_nRemoved.store(0, std::memory_order_release);
+    }
+
+    for(auto i = changes.begin() ; i != changes.end() ; ++i) {
+        this->apply(*i);
+    }
+}
+
+/// Sorts the items that have been added into the batch of their phase. This
+/// waits until they are updated the first time, as they may be added from
+/// their constructor, when asking them for their phase doesn't work yet.
+void UpdateableManager::place()
+{
+    for(auto i = m_unplaced.begin() ; i != m_unplaced.end() ; ++i) {
+        Slot& slot = m_slots[*i];
+        // It may have been removed meanwhile, or even added again.
+        if(!slot.pUpd || slot.iPos != NotPlaced)
+            continue;
+
+        slot.phase = slot.pUpd->getUpdatePhase();
+        slot.bThreadSafe = slot.pUpd->isUpdateThreadSafe();
+
+        std::vector<Entry>& entries = this->entriesOf(slot);
+        slot.iPos = static_cast<std::uint32_t>(entries.size());
+        entries.push_back(Entry{slot.pUpd, *i});
+    }
+    m_unplaced.clear();
+}
+
+std::vector<UpdateableManager::Entry>& UpdateableManager::entriesOf(const Slot& in_slot)
+{
+    Batch& batch = m_phases[in_slot.phase];
+    return in_slot.bThreadSafe ? batch.parallel : batch.serial;
+}
+
+/// \return A handle for an item that is going to be added, with a free slot.
+UpdateableManager::Handle UpdateableManager::reserve()
+{
+    std::lock_guard<std::mutex> lock(m_changesMutex);
+    if(m_freeSlots.empty())
+        return makeHandle(m_nSlots++, 1);
+
+    std::uint32_t iSlot = m_freeSlots.back();
+    m_freeSlots.pop_back();
+    return makeHandle(iSlot, m_slots[iSlot].generation);
+}
+
+/// Does the change right away, or at the end of the phase if updating.
+void UpdateableManager::change(const Change& in_change)
+{
+    if(!m_bUpdating) {
+        this->apply(in_change);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_changesMutex);
+    m_changes.push_back(in_change);
+    if(in_change.kind != Change::Add && in_change.kind != Change::AddNamed && in_change.pUpd) {
+        m_removed.push_back(in_change.pUpd);
+        m_nRemoved.store(m_removed.size(), std::memory_order_release);
+    }
+}
+
+void UpdateableManager::apply(const Change& in_change)
+{
+    switch(in_change.kind) {
+    case Change::AddNamed:
+    {
+        auto i = m_named.find(in_change.name);
+        if(i != m_named.end())
+            this->release(i->second);
+        m_named[in_change.name] = in_change.h;
+    }
+    // Fall through.
+    case Change::Add:
+    {
+        std::uint32_t iSlot = slotOf(in_change.h);
+        if(iSlot >= m_slots.size())
+            m_slots.resize(iSlot + 1);
+
+        Slot& slot = m_slots[iSlot];
+        slot.pUpd = in_change.pUpd;
+        slot.name = in_change.name;
+        slot.iPos = NotPlaced;
+        m_unplaced.push_back(iSlot);
+        break;
+    }
+    case Change::RemHandle:
+        this->release(in_change.h);
+        break;
+    case Change::RemName:
+    {
+        auto i = m_named.find(in_change.name);
+        if(i != m_named.end())
+            this->release(i->second);
+        break;
+    }
+    case Change::RemPointer:
+        for(std::uint32_t i = 0 ; i < m_slots.size() ; ++i) {
+            if(m_slots[i].pUpd == in_change.pUpd)
+                this->release(makeHandle(i, m_slots[i].generation));
         }
+        break;
     }
+}
 
-    return *this;
+/// Takes the item out of its batch and frees its slot, if it still is there.
+void UpdateableManager::release(Handle in_h)
+{
+    std::uint32_t iSlot = slotOf(in_h);
+    if(iSlot >= m_slots.size())
+        return;
+
+    Slot& slot = m_slots[iSlot];
+    if(!slot.pUpd || slot.generation != generationOf(in_h))
+        return;
+
+    // The last one of the batch takes its place.
+    if(slot.iPos != NotPlaced) {
+        std::vector<Entry>& entries = this->entriesOf(slot);
+        entries[slot.iPos] = entries.back();
+        m_slots[entries[slot.iPos].iSlot].iPos = slot.iPos;
+        entries.pop_back();
+    }
+
+    auto iNamed = m_named.find(slot.name);
+    if(iNamed != m_named.end() && iNamed->second == in_h)
+        m_named.erase(iNamed);
+
+    slot.pUpd = nullptr;
+    slot.name = Name();
+    slot.iPos = NotPlaced;
+    if(++slot.generation == 0)
+        slot.generation = 1;
+
+    std::lock_guard<std::mutex> lock(m_changesMutex);
+    m_freeSlots.push_back(iSlot);
+}
+
+/// \return Whether \a in_pUpd has been removed during the current phase.
+bool UpdateableManager::removedMeanwhile(Updateable* in_pUpd)
+{
+    // That's the usual case, no need to lock then.
+    if(m_nRemoved.load(std::memory_order_acquire) == 0)
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_changesMutex);
+    return std::find(m_removed.begin(), m_removed.end(), in_pUpd) != m_removed.end();
 }
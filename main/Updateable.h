@@ -2,9 +2,13 @@
 #define D_UPDATEABLE_H
 
 #include <utilities/Singleton.h>
+#include "dLib/dString/dName.h"
 
-#include <set>
+#include <atomic>
+#include <cstdint>
 #include <map>
+#include <mutex>
+#include <vector>
 
 namespace FTS {
 
@@ -15,43 +19,159 @@ class Clock;
 /// to the \a UpdateableManager.
 class Updateable {
 public:
+    /// The phases of a frame, updated one after the other in this order.
+    typedef enum {
+        Input,      ///< Reading the player's input.
+        Runlevels,  ///< The current runlevel, always on the main thread.
+        Simulation, ///< The game logic and movers.
+        Animation,  ///< Animating what has been moved.
+        Audio,      ///< The sound system.
+        PreRender,  ///< Everything that only prepares drawing the frame.
+        PhaseCount
+    } Phase;
+
     /// \return true means keep on being updated, false means stop updating me.
     virtual bool update(const Clock&) = 0;
     virtual ~Updateable() {};
+
+    /// \return The phase during which this wants to be updated.
+    virtual Phase getUpdatePhase() const {return Simulation;};
+    /// \return Whether this may be updated on any thread, at the same time as
+    ///         the other thread safe updateables of its phase.
+    virtual bool isUpdateThreadSafe() const {return false;};
 };
 
 class UpdateableManager : public LazySingleton<UpdateableManager> {
-    typedef std::map<String, Updateable*> UpdateableMap;
-    UpdateableMap m_all;
+public:
+    /// Identifies a registered item. A handle never identifies another item,
+    /// also once its item has been removed and its slot is used again.
+    typedef std::uint64_t Handle;
+    static const Handle InvalidHandle = 0;
+
+private:
+    static const std::uint32_t NotPlaced = 0xffffffff;
+
+    /// Every item lives in a slot, the free ones get used again.
+    struct Slot {
+        Updateable* pUpd = nullptr;
+        /// Counted up whenever the slot gets free, it is part of the handle.
+        std::uint32_t generation = 1;
+        /// Where it is in the batch of its phase, if it has been sorted in yet.
+        std::uint32_t iPos = NotPlaced;
+        Updateable::Phase phase = Updateable::Simulation;
+        bool bThreadSafe = false;
+        /// Only to know what it is, or to find it by name if it is a named one.
+        Name name;
+    };
+    std::vector<Slot> m_slots;
+    std::vector<std::uint32_t> m_freeSlots;
+    /// How many slots have been handed out, maybe not all of them exist yet.
+    std::uint32_t m_nSlots;
+    /// The items that still need to be sorted into the batch of their phase.
+    std::vector<std::uint32_t> m_unplaced;
+
+    /// The few items that want to be found by their name.
+    std::map<Name, Handle> m_named;
+
+    /// One item to update.
+    struct Entry {
+        Updateable* pUpd;
+        std::uint32_t iSlot;
+    };
+
+    /// What is updated during one phase, first the serial items one after the
+    /// other, then the thread safe ones in parallel.
+    struct Batch {
+        std::vector<Entry> serial;
+        std::vector<Entry> parallel;
+    };
+    Batch m_phases[Updateable::PhaseCount];
 
-    std::set<Updateable*> m_anonymous;
+    /// While updating, additions and removals wait for the end of the phase.
+    struct Change {
+        typedef enum {
+            Add,
+            AddNamed,
+            RemHandle,
+            RemName,
+            RemPointer,
+        } Kind;
+        Kind kind;
+        Handle h;
+        Updateable* pUpd;
+        Name name;
+    };
+    bool m_bUpdating;
+    /// Guards the changes, the removed items and the free slots.
+    std::mutex m_changesMutex;
+    std::vector<Change> m_changes;
+    /// The items removed during the current phase, they mustn't be updated anymore.
+    std::vector<Updateable*> m_removed;
+    std::atomic<std::size_t> m_nRemoved;
+    /// The items of the current phase that asked to stop being updated.
+    std::vector<Handle> m_finished;
+    std::vector<char> m_parallelFinished;
 
     UpdateableManager();
     friend class LazySingleton<UpdateableManager>;
+
+    Handle reserve();
+    void change(const Change& in_change);
+    void apply(const Change& in_change);
+    void release(Handle in_h);
+    std::vector<Entry>& entriesOf(const Slot& in_slot);
+    bool removedMeanwhile(Updateable* in_pUpd);
+    void place();
+    void updatePhase(Batch& in_batch, const Clock& in_c);
+    void endPhase();
 public:
     virtual ~UpdateableManager();
 
-    /// Adds a named item to be updated on every game tick.
-    /// \param in_sName The name of the item.
+    /// Adds an item to be updated on every game tick.
     /// \param in_pUpd The item to be updated.
+    /// \param in_debugName What the item is, only used to inspect it.
+    /// \return The handle to remove the item with.
+    Handle add(Updateable *in_pUpd, const Name& in_debugName = Name());
+    /// Removes an item from the list of items to be updated on every game
+    /// tick. Removing an item that is already gone does nothing.
+    /// \param in_h The handle \a add returned for the item.
     /// \return A reference to myself.
-    UpdateableManager& add(const String& in_sName, Updateable *in_pUpd);
+    UpdateableManager& rem(Handle in_h);
+
+    /// Adds a named item to be updated on every game tick. It replaces the
+    /// item that had that name so far.
+    /// \param in_sName The name of the item.
+    /// \param in_pUpd The item to be updated.
+    /// \return The handle to remove the item with.
+    Handle add(const String& in_sName, Updateable *in_pUpd);
     /// Removes a named item from the list of items to be updated on every game tick.
     /// \param in_sName The name of the item to remove.
     /// \return A reference to myself.
     UpdateableManager& rem(const String& in_sName);
 
-    /// Adds an anonymous item to be updated on every game tick.
+    /// Adds a named item to be updated on every game tick. It replaces the
+    /// item that had that name so far.
+    /// \param in_name The name of the item.
     /// \param in_pUpd The item to be updated.
+    /// \return The handle to remove the item with.
+    Handle add(const Name& in_name, Updateable *in_pUpd);
+    /// Removes a named item from the list of items to be updated on every game tick.
+    /// \param in_name The name of the item to remove.
     /// \return A reference to myself.
-    UpdateableManager& add(Updateable *in_pUpd);
-    /// Removes an anonymous or named item from the list of items to be updated
-    /// on every game tick. Use the named version for named items, it is faster.
+    UpdateableManager& rem(const Name& in_name);
+
+    /// Removes an item from the list of items to be updated on every game
+    /// tick. This has to look through all of them, use the handle instead.
     /// \param in_pUpd The item to be removed.
     /// \return A reference to myself.
     UpdateableManager& rem(Updateable *in_pUpd);
 
-    UpdateableManager& doUpdates(const Clock&);
+    /// \return The name the item has been added with, empty if it is gone.
+    Name getName(Handle in_h) const;
+    /// \return How many items are updated.
+    inline std::size_t count() const {return m_slots.size() - m_freeSlots.size();};
+
+    UpdateableManager& doUpdates(const Clock&, Updateable::Phase in_first = Updateable::Input, Updateable::Phase in_last = Updateable::PreRender);
 };
 
 }; // namespace FTS
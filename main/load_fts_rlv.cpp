@@ -15,10 +15,13 @@
 
 #include "main/version.h" // For the version info.
 #include "logging/ftslogger.h"
+#include "logging/Profiler.h"
 #include "utilities/console.h" 
 #include "utilities/fps_calculator.h" // To init the FPSCalculator.
 #include "graphic/graphic.h" // To draw the loading picture.
 #include "graphic/cegui_ftsimg_codec.h" // To create/init the image codec.
+#include "graphic/cegui_null_renderer.h" // To run CEGUI without a display.
+#include "game/loadgame_rlv.h" // To go straight to a map.
 #include "game/player.h" // To create "this" player. TODO FIXME: need this ?
 #include "ui/ui.h" // Needed alot.
 #include "ui/ui_menu.h" // To enter the main menu runlevel.
@@ -32,7 +35,7 @@
 #include "sound/fts_Snd.h" // To init the sound system.
 
 #include "dLib/dFile/dFile.h"
-#include "dLib/dConf/configuration.h"
+#include "dLib/dConf/ConfigurationStore.h"
 
 #include <openglrenderer.h>
 #include <SDL.h>
@@ -40,7 +43,9 @@
 using namespace FTS;
 
 /// Default constructor.
-FTS::LoadFTSRlv::LoadFTSRlv()
+/// \param in_sMap The map to load once done, instead of entering the main menu.
+FTS::LoadFTSRlv::LoadFTSRlv(const Path& in_sMap)
+    : m_sMap(in_sMap)
 {
 }
 
@@ -60,6 +65,7 @@ FTS::LoadFTSRlv::~LoadFTSRlv()
  */
 bool FTS::LoadFTSRlv::load()
 {
+    FTS_PROFILE_SCOPE("LoadFTSRlv::load");
     FTS18N("Init");
 
     // First of all, write the current version into the versionfile.
@@ -103,13 +109,13 @@ bool FTS::LoadFTSRlv::load()
     new Renderer;
     new GraphicManager;
 
-    Configuration conf ("conf.xml", ArkanaDefaultSettings());
+    Configuration::Ptr pConf = ConfigurationStore::getSingleton().getMainConf();
 
-    m_screenWidth  = conf.get<int>("HRes");
-    m_screenHeight = conf.get<int>("VRes");
+    m_screenWidth  = pConf->get<int>("HRes");
+    m_screenHeight = pConf->get<int>("VRes");
 
     // Load the logo and we are fine for our first display.
-    String sLang = conf.get<std::string>("Language");
+    String sLang = pConf->get<std::string>("Language");
     m_sLogoFile = Path::datadir("Graphics/ui") + Path("Loading." + sLang + ".png");
     if(!FileUtils::fileExists(m_sLogoFile, File::Read)) {
         m_sLogoFile = Path::datadir("Graphics/ui") + Path("Loading.English.png");
@@ -189,6 +195,7 @@ void FTS::LoadFTSRlv::render2D(const Clock&)
  */
 bool FTS::LoadFTSRlv::update(const Clock&)
 {
+    FTS_PROFILE_SCOPE("LoadFTSRlv::update");
     auto timeBegin = std::chrono::steady_clock::now();
     switch(m_eNextTodo) {
     case LoadBeginning:
@@ -230,8 +237,12 @@ bool FTS::LoadFTSRlv::update(const Clock&)
         m_eNextTodo = LoadDone;
         break;
     default:
-        // We're done loading, prepare to enter the main menu runlevel.
-        RunlevelManager::getSingleton().prepareRunlevelEntrance(new MainMenuRlv());
+        // We're done loading, prepare to enter the main menu runlevel, or to
+        // load the map that has been asked for right away.
+        if(m_sMap.empty())
+            RunlevelManager::getSingleton().prepareRunlevelEntrance(new MainMenuRlv());
+        else
+            RunlevelManager::getSingleton().prepareRunlevelEntrance(new LoadGameRlv(m_sMap, 12));
         break;
     }
 
@@ -271,9 +282,14 @@ int FTS::LoadFTSRlv::initCEGUI()
         // Need to use the traditional new CEGUI is not our class.
         CEGUI::FTSImageCodec::init();
         CEGUI::ArkanaResourceProvider *pRP = new CEGUI::ArkanaResourceProvider;
-        CEGUI::Renderer *pRenderer =
-            new CEGUI::OpenGLRenderer(0, getW(), getH(),
-                                      CEGUI::FTSImageCodec::getSingletonPtr());
+        CEGUI::Renderer *pRenderer = nullptr;
+        if(Renderer::isHeadless()) {
+            pRenderer = new CEGUI::NullRenderer(getW(), getH(),
+                                                CEGUI::FTSImageCodec::getSingletonPtr());
+        } else {
+            pRenderer = new CEGUI::OpenGLRenderer(0, getW(), getH(),
+                                                  CEGUI::FTSImageCodec::getSingletonPtr());
+        }
         new CEGUI::System(pRenderer,
                           pRP,
                           (CEGUI::XMLParser *)0,
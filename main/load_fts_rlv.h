@@ -12,6 +12,7 @@
 #include "main/runlevels.h"
 
 #include "dLib/dString/dString.h"
+#include "dLib/dString/dPath.h"
 
 namespace FTS {
     class Graphic;
@@ -20,6 +21,8 @@ class LoadFTSRlv : public Runlevel {
 private:
     /// The name of the logo to display.
     String m_sLogoFile;
+    /// The map to load right away, if any.
+    Path m_sMap;
 
     /// The root window that contains progress bar etc.
     CEGUI::Window *m_pRootWin = nullptr;
@@ -44,12 +47,14 @@ private:
     void updateProgressbar();
 
 public:
-    LoadFTSRlv();
+    LoadFTSRlv(const Path& in_sMap = Path());
     virtual ~LoadFTSRlv();
     bool load() override;
     bool unload() override;
     void render2D(const Clock&) override;
     bool update(const Clock&) override;
+    /// Loads one thing per frame, also OpenGL and CEGUI stuff.
+    Phase getUpdatePhase() const override {return PreRender;};
     String getName() override;
 };
 
@@ -2,9 +2,24 @@
 #include <CEGUI.h>
 #include <SDL.h>
 #include <time.h>
+#include <cstring>
+#include <connection.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "ui/ui.h"
 #include "logging/ftslogger.h"
+#include "logging/FlightRecorder.h"
+#include "logging/Profiler.h"
+#include "logging/PerfCounters.h"
 #include "game/player.h"
 #include "graphic/graphic.h"
 #include "utilities/console.h"
@@ -12,6 +27,7 @@
 #include "main/load_fts_rlv.h"
 #include "main/Clock.h"
 #include "main/Updateable.h"
+#include "main/JobSystem.h"
 #include "main/version.h" // To write the version into a file.
 #include "3d/Renderer.h" // to create/delete the renderer singleton.
 #include "3d/Shader.h" // to create/delete the shader manager.
@@ -21,8 +37,11 @@
 #include "scripting/DaoVm.h"
 
 #include "dLib/dConf/configuration.h"
+#include "dLib/dConf/ConfigurationStore.h"
 #include "dLib/dMem/dMem.h"
 #include "dLib/dFile/dFile.h"
+#include "dLib/dFile/dAsyncFile.h"
+#include "dLib/dString/dTranslation.h"
 
 
 using namespace FTS;
@@ -31,7 +50,7 @@ using namespace FTS;
 /* Local prototypes           */
 /* -------------------------- */
 void printCmdHelp(char *in_pszAppName);
-int enterMainLoop();
+int enterMainLoop(int64_t in_nMaxFrames);
 int cleanFTS(void);
 void exitfunc(void);
 
@@ -73,6 +92,14 @@ String PRINT_FUN_DBG =
 String PRINT_FUN_DBG = "";
 #endif // DEBUG
 
+namespace {
+    // The network library counts its traffic itself, these only show it.
+    PerfCounter g_netPacketsSent("net.packetsSent", []() {return static_cast<int64_t>(Connection::getTotalTraffic().packetsSent);});
+    PerfCounter g_netPacketsReceived("net.packetsReceived", []() {return static_cast<int64_t>(Connection::getTotalTraffic().packetsReceived);});
+    PerfCounter g_netBytesSent("net.bytesSent", []() {return static_cast<int64_t>(Connection::getTotalTraffic().bytesSent);});
+    PerfCounter g_netBytesReceived("net.bytesReceived", []() {return static_cast<int64_t>(Connection::getTotalTraffic().bytesReceived);});
+}
+
 int main(int argc, char *argv[])
 {
     try {
@@ -82,18 +109,27 @@ int main(int argc, char *argv[])
         signal(SIGPIPE, SIG_IGN); /* Ignore broken pipe */
 #endif /* SIGPIPE */
 
+        // Whatever happens now, leave a trace of what led to it.
+        FlightRecorder::record(FlightEvent::Started);
+        FlightRecorder::installCrashHandler("CriticalError.flight");
+        FTS_PROFILE_THREAD("Main");
+
         // In debug mode, always run the tests on startup!
 #ifdef DEBUG
         // The -tDaoVm disables the DaoVm tests, as currently the Dao VM cannot be
         // initialized more than one time. This is the fault of Dao, not Arkana.
-        const char* test_argv[] = {"./tests", "fts", "-tDaoVm", "-Shaders"};
-        int failures = run_tests(sizeof(test_argv)/sizeof(test_argv[0]), test_argv);
+        std::vector<const char*> test_argv = {"./tests", "fts", "-tDaoVm", "-Shaders"};
+        // The benchmarks take their time, they only run when asked for.
+        bool bBenchmarks = argc >= 2 && std::string(argv[1]) == "run-benchmarks";
+        if(!bBenchmarks)
+            test_argv.push_back("-benchmark_");
+        int failures = run_tests(static_cast<int>(test_argv.size()), test_argv.data());
         if(failures > 0) {
             Console::Pause();
             return failures;
         }
 
-        if( argc >= 2 && std::string(argv[1]) == "run-test-only" ) {
+        if( bBenchmarks || (argc >= 2 && std::string(argv[1]) == "run-test-only") ) {
             Console::Pause();
             return 0;
         }
@@ -121,6 +157,14 @@ int main(int argc, char *argv[])
 
         srand((unsigned)time(NULL));
 
+        // Without a display, SDL mustn't even look for one.
+        for(int i = 1; i < argc; i++) {
+            if(!strcmp("--headless", argv[i]))
+                Renderer::setHeadless(true);
+        }
+        if(Renderer::isHeadless())
+            SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+
         // We need this one ready here already in order to be able to get things
         // like timer, best video mode, ...
         if(-1 == SDL_Init(SDL_INIT_VIDEO)) {
@@ -128,6 +172,9 @@ int main(int argc, char *argv[])
             return -1;
         }
 
+        // Keep the compiled translations around for the next start.
+        Translation::setCacheDir(Path::userdir("Cache/Languages"));
+
         // Init the logging system.
         DefaultLogger* pDefLog = new DefaultLogger;
 
@@ -140,6 +187,8 @@ int main(int argc, char *argv[])
         new GUI();
 
         // The arguments loop.
+        int64_t nMaxFrames = 0;
+        Path sMap;
         for(int i = 1; i < argc; i++) {
             if(argv[i][0] == '-') {
                 switch (argv[i][1]) {
@@ -151,6 +200,17 @@ int main(int argc, char *argv[])
                         // Set the debug level to the number given in the next arg.
                     } else if(!strcmp("debug", &argv[i][2])) {
                         pDefLog->setGDLL(atoi(argv[++i]));
+#if D_PROFILE
+                    } else if(!strcmp("profile", &argv[i][2]) && i + 1 < argc) {
+                        // Capture a trace of the whole session.
+                        Profiler::startCapture(argv[++i]);
+#endif
+                    } else if(!strcmp("frames", &argv[i][2]) && i + 1 < argc) {
+                        // Quit after that many frames.
+                        nMaxFrames = atoll(argv[++i]);
+                    } else if(!strcmp("map", &argv[i][2]) && i + 1 < argc) {
+                        // Skip the menu and load that map right away.
+                        sMap = Path(argv[++i]);
                     }
                     break;
                     // The user needs help
@@ -170,19 +230,39 @@ int main(int argc, char *argv[])
         // Load the debug level from the logger.
         Logger::getSingleton().loadConfig();
 
+        // Keep a record of the performance counters, if wanted.
+        Configuration::Ptr pConf = ConfigurationStore::getSingleton().getMainConf();
+        std::string sCountersCsv = pConf->get<std::string>("PerfCountersCsv");
+        if(!sCountersCsv.empty()) {
+            Path sFileName = Path::userdir("Logfiles") + Path(sCountersCsv);
+            if(!PerfCounters::startCsv(sFileName.str(), std::chrono::milliseconds(pConf->get<int>("PerfCountersInterval")))) {
+                FTS18N("File_Write", MsgType::Warning, sFileName, std::strerror(errno));
+            }
+        }
+
         // Print a lil nice message.
         std::puts(PRINT_FUN.c_str());
         std::puts(PRINT_FUN_DBG.c_str());
 
+        // Files may be loaded in the background from now on.
+        new AsyncFileLoader();
+        // And work may be spread over all cores.
+        new JobSystem();
+
         // And get the stone rolling ...
         new RunlevelManager();
-        RunlevelManager::getSingleton().prepareRunlevelEntrance(new LoadFTSRlv());
+        RunlevelManager::getSingleton().prepareRunlevelEntrance(new LoadFTSRlv(sMap));
 
-        enterMainLoop();
+        enterMainLoop(nMaxFrames);
     } catch(const std::exception& ex) {
         std::cout << "Uncaught exception: " << ex.what() << std::endl;
         std::ofstream fCritLog("CriticalError.txt");
         fCritLog << ex.what();
+        FlightRecorder::recordText(FlightEvent::Exception, ex.what());
+        FlightRecorder::dump("CriticalError.flight");
+        DefaultLogger* pLog = dynamic_cast<DefaultLogger*>(Logger::getSingletonPtr());
+        if(pLog)
+            pLog->flush();
         Console::Foreground(true);
         return 1;
     }
@@ -202,6 +282,10 @@ int cleanFTS(void)
 
     // Deinit the runlevelmanager, that also unloads+deletes the current rlv.
     delete RunlevelManager::getSingletonPtr();
+    // Nobody is left to start jobs, let the ones that run finish.
+    delete JobSystem::getSingletonPtr();
+    // Nobody is left to wait for files being loaded.
+    delete AsyncFileLoader::getSingletonPtr();
     delete ShaderManager::getSingletonPtr();
     delete GraphicManager::getSingletonPtr();
     delete Renderer::getSingletonPtr();
@@ -231,6 +315,15 @@ int cleanFTS(void)
         Logger::getSingleton().doneConsoleMessage();
     } catch(const ArkanaException&) { }
 
+    PerfCounters::stopCsv();
+
+#if D_PROFILE
+    if(Profiler::isCapturing()) {
+        FTS_PROFILE_FRAME();
+        Profiler::stopCapture();
+    }
+#endif
+
     delete GUI::getSingletonPtr();
     delete ISndSys::getSingletonPtr();
 
@@ -241,7 +334,120 @@ int cleanFTS(void)
     return ERR_OK;
 }
 
-int enterMainLoop()
+namespace {
+    /// The lock the main thread and the simulation thread take turns through.
+    /// Unlike a mutex, it goes to whoever asked for it first. Like that, the
+    /// main thread, which takes it again right after letting go of it, can't
+    /// keep the simulation from ever getting it.
+    class WorldLock {
+    public:
+        void lock()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            std::uint64_t ticket = m_nextTicket++;
+            m_turn.wait(lock, [this, ticket]() {return m_serving == ticket;});
+        }
+
+        void unlock()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_serving;
+            m_turn.notify_all();
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_turn;
+        std::uint64_t m_nextTicket = 0;
+        std::uint64_t m_serving = 0;
+    };
+
+    /// Updates the simulation phases at a fixed rate on a thread of its own.
+    /// The main thread and this one take turns through the world lock: the
+    /// main thread holds it from reading the input until the frame is drawn,
+    /// then lets the simulation do the steps that are due meanwhile.\n
+    ///
+    /// Like that, the updateables of the simulation, animation and audio
+    /// phases never run at the same time as the rest of the game, but they
+    /// mustn't touch OpenGL nor CEGUI, as that only works on the main thread.
+    class SimulationThread {
+    public:
+        SimulationThread(SimulationClock& in_clock, WorldLock& in_worldLock)
+            : m_clock(in_clock)
+            , m_worldLock(in_worldLock)
+            , m_bRunning(true)
+        {
+            m_thread = std::thread(&SimulationThread::run, this);
+        }
+
+        ~SimulationThread()
+        {
+            m_bRunning = false;
+            m_thread.join();
+        }
+
+        /// Re-throws what the simulation threw, call it with the world lock held.
+        void rethrow()
+        {
+            if(m_pError)
+                std::rethrow_exception(m_pError);
+        }
+
+    private:
+        SimulationClock& m_clock;
+        WorldLock& m_worldLock;
+        std::atomic<bool> m_bRunning;
+        std::exception_ptr m_pError;
+        std::thread m_thread;
+
+        void run()
+        {
+            FTS_PROFILE_THREAD("Simulation");
+
+            Clock real;
+            while(m_bRunning) {
+                std::chrono::steady_clock::duration sleep;
+                {
+                    std::lock_guard<WorldLock> lock(m_worldLock);
+                    try {
+                        real.tick();
+                        for(unsigned int n = m_clock.accumulate(real.getDeltaT()) ; n > 0 ; --n) {
+                            m_clock.tick();
+                            UpdateableManager::getSingleton().doUpdates(m_clock, Updateable::Simulation, Updateable::Audio);
+                        }
+                    } catch(...) {
+                        m_pError = std::current_exception();
+                        return;
+                    }
+                    sleep = m_clock.getTimeToNextStep();
+                }
+                std::this_thread::sleep_for(sleep);
+            }
+        }
+    };
+
+    /// \return The integer option \a in_sName, or the nearest end of the range
+    ///         from \a in_iMin to \a in_iMax if it is out of it.
+    unsigned int getOptionInRange(const Configuration& in_conf, const String& in_sName, int in_iMin, int in_iMax)
+    {
+        int iValue = in_conf.get<int>(in_sName);
+        if(iValue < in_iMin || iValue > in_iMax) {
+            FTSMSG("The option {1} is {2}, but it has to be from {3} to {4}.", MsgType::WarningNoMB,
+                   in_sName, String::nr(iValue), String::nr(in_iMin), String::nr(in_iMax));
+            iValue = std::min(std::max(iValue, in_iMin), in_iMax);
+        }
+        return static_cast<unsigned int>(iValue);
+    }
+}
+
+/* enterMainLoop: Runs the game until it is quit.
+ *
+ * param in_nMaxFrames: Quit after that many frames and print how long they
+ *                      took, or 0 to run until the player quits.
+ *
+ * return: ERR_OK
+ */
+int enterMainLoop(int64_t in_nMaxFrames)
 {
     Runlevel *pRlv = RunlevelManager::getSingleton().getCurrRunlevel();
     SDL_Event sdlEvent;
@@ -251,8 +457,32 @@ int enterMainLoop()
     pRlv = RunlevelManager::getSingleton().realEnterRunlevel();
 
     Clock c;
+    int64_t iFrame = 0;
+    std::vector<double> frameTimes;
+    if(in_nMaxFrames > 0)
+        frameTimes.reserve(static_cast<std::size_t>(in_nMaxFrames));
+    UpdateableManager& updates = UpdateableManager::getSingleton();
+
+    // The simulation may run at a fixed rate, decoupled from the frame rate.
+    // Without a rate, it is updated once per frame, for the real time.
+    Configuration::Ptr pConf = ConfigurationStore::getSingleton().getMainConf();
+    std::unique_ptr<SimulationClock> pSim;
+    WorldLock worldLock;
+    std::unique_ptr<SimulationThread> pSimThread;
+    unsigned int uiSimHz = getOptionInRange(*pConf, "SimulationHz", 0, 1000);
+    if(uiSimHz > 0) {
+        pSim.reset(new SimulationClock(uiSimHz, getOptionInRange(*pConf, "SimulationMaxSteps", 1, 100)));
+        if(pConf->get<bool>("SimulationThread"))
+            pSimThread.reset(new SimulationThread(*pSim, worldLock));
+    }
 
     while(bCont) {
+        // The previous frame has ended, measure this one.
+        FTS_PROFILE_FRAME();
+        PerfCounters::frame();
+        FTS_PROFILE_SCOPE("enterMainLoop");
+        std::unique_lock<WorldLock> world(worldLock);
+
         while(SDL_PollEvent(&sdlEvent)) {
             if(InputManager::getSingleton().handleEvent(sdlEvent))
                 continue;
@@ -277,23 +507,74 @@ int enterMainLoop()
         pRlv = RunlevelManager::getSingleton().realEnterRunlevel();
 
         c.tick();
+        FlightRecorder::record(FlightEvent::Frame, ++iFrame, static_cast<int64_t>(c.getDeltaT() * 1e6));
+        if(in_nMaxFrames > 0) {
+            frameTimes.push_back(c.getDeltaT());
+            bCont = bCont && iFrame < in_nMaxFrames;
+        }
 
         // Update everybody who wants that!
-        UpdateableManager::getSingleton().doUpdates(c);
+        if(!pSim) {
+            updates.doUpdates(c);
+        } else {
+            // The input and the runlevel are always updated on the main thread.
+            updates.doUpdates(c, Updateable::Input, Updateable::Runlevels);
+            if(pSimThread) {
+                pSimThread->rethrow();
+            } else {
+                // Catch up with the real time, step by step.
+                for(unsigned int n = pSim->accumulate(c.getDeltaT()) ; n > 0 ; --n) {
+                    pSim->tick();
+                    updates.doUpdates(*pSim, Updateable::Simulation, Updateable::Audio);
+                }
+            }
+
+            // What is drawn lies between the last step and the next one.
+            c.setAlpha(pSim->getAlpha());
+            updates.doUpdates(c, Updateable::PreRender, Updateable::PreRender);
+        }
+
+        // Do what the jobs left for the main thread, like uploading to OpenGL.
+        JobSystem::getSingleton().runMainThreadJobs();
 
         // Set up the camera of that runlevel and then let it render its stuff.
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        Renderer::getSingleton().enter3DMode(pRlv->getActiveCamera());
-        pRlv->render3D(c);
-        Renderer::getSingleton().enter2DMode(Renderer::getSingleton().getDefault2DCamera());
-        pRlv->render2D(c);
-
-        glFinish();
-        glFlush();
-        SDL_GL_SwapWindow(Renderer::getSingleton().getWindow());
+        {
+            FTS_PROFILE_SCOPE("Runlevel::render3D");
+            Renderer::getSingleton().enter3DMode(pRlv->getActiveCamera());
+            pRlv->render3D(c);
+        }
+        {
+            FTS_PROFILE_SCOPE("Runlevel::render2D");
+            Renderer::getSingleton().enter2DMode(Renderer::getSingleton().getDefault2DCamera());
+            pRlv->render2D(c);
+        }
+
+        world.unlock();
+        if(!Renderer::isHeadless()) {
+            // This is where we wait for the graphics card.
+            FTS_PROFILE_SCOPE("SwapWindow");
+            glFinish();
+            glFlush();
+            SDL_GL_SwapWindow(Renderer::getSingleton().getWindow());
+        }
         verifGL("Main");
     }
 
+    // How long did the frames take?
+    if(!frameTimes.empty()) {
+        double dTotal = 0.0;
+        for(double d : frameTimes) {
+            dTotal += d;
+        }
+        std::sort(frameTimes.begin(), frameTimes.end());
+        auto ms = [&frameTimes](double in_dFraction) {
+            return frameTimes[static_cast<std::size_t>(in_dFraction * (frameTimes.size() - 1))] * 1000.0;
+        };
+        std::cout << frameTimes.size() << " frames in " << dTotal << "s: mean " << dTotal * 1000.0 / frameTimes.size()
+                  << "ms, median " << ms(0.5) << "ms, 99th percentile " << ms(0.99) << "ms, worst " << ms(1.0) << "ms" << std::endl;
+    }
+
     return ERR_OK;
 }
 
@@ -312,6 +593,12 @@ void printCmdHelp(char *in_pszAppName)
     std::puts("options:");
     std::puts("\t-h, --help  Prints this help");
     std::puts("\t-d, --debug Sets the debug level to LEVEL(1->5)");
+#if D_PROFILE
+    std::puts("\t--profile FILE Writes a Chrome trace of where the time went to FILE");
+#endif
+    std::puts("\t--headless  Runs without a display, nothing gets drawn");
+    std::puts("\t--frames N  Quits after N frames and prints how long they took");
+    std::puts("\t--map FILE  Loads the map FILE right away, without the menu");
     std::puts("-------------------------------------------------");
     std::puts("This software is distributed under the GNU/GPL license v2 or higher.");
     std::puts("See LICENSE.txt for more details.");
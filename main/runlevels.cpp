@@ -7,6 +7,8 @@
 #include "input/input.h" // For the cursor loading.
 #include "game/player.h"
 #include "logging/logger.h"
+#include "logging/FlightRecorder.h"
+#include "logging/Profiler.h"
 #include "utilities/console.h"
 #include "map/map.h"
 #include "mdlviewer/mdlviewer_main.h"
@@ -209,11 +211,14 @@ FTS::Runlevel *FTS::RunlevelManager::realEnterRunlevel()
     if (m_pRunlevelToEnter == NULL)
         return m_pCurrRunlevel;
 
+    FTS_PROFILE_SCOPE("RunlevelManager::realEnterRunlevel");
+
     Runlevel* pOldRLV = m_pCurrRunlevel;
 
     try {
         // Say that we prepare to enter a runlevel.
         FTS18NDBG("EnterRlv", 1);
+        FlightRecorder::recordText(FlightEvent::RunlevelEnter, m_pRunlevelToEnter->getName().c_str());
         Console::Attr(Console::ATTRIBUTE::CHANGEFG, Console::COLOR::BLUE);
         FTSMSG(m_pRunlevelToEnter->getName(), MsgType::Raw);
         Console::Attr(Console::ATTRIBUTE::NORMAL);
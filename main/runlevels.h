@@ -11,7 +11,7 @@
 #include "main.h"
 #include "main/Updateable.h"
 
-int enterMainLoop();
+int enterMainLoop(int64_t in_nMaxFrames);
 
 namespace FTS {
 
@@ -90,6 +90,9 @@ public:
      *  \author Pompei2
      */
     virtual bool update(const Clock& in_c) {return true;};
+    /// Runlevels use CEGUI and switch runlevels, so they are updated on the
+    /// main thread, also when the simulation runs on a thread of its own.
+    virtual Phase getUpdatePhase() const {return Runlevels;};
 
     /** This method needs to be overloaded. It has to return a unique name for
      *  the runlevel.
@@ -169,7 +172,7 @@ public:
 };
 
 class RunlevelManager : public Singleton<RunlevelManager> {
-    friend int ::enterMainLoop();
+    friend int ::enterMainLoop(int64_t);
 protected:
     /// The currently active runlevel.
     Runlevel *m_pCurrRunlevel;
@@ -14,7 +14,7 @@
 #include "logging/logger.h"
 #include "utilities/utilities.h"
 #include "dLib/dFile/dFile.h"
-#include "dLib/dConf/configuration.h"
+#include "dLib/dConf/ConfigurationStore.h"
 
 #include <cmath>
 
@@ -176,14 +176,14 @@ void Quad::initTexCoords(const Tileset * in_pTileset,
                          char in_cBottomRight,
                          uint16_t in_cUpperTile)
 {
-    Configuration conf ("conf.xml", ArkanaDefaultSettings());
+    Configuration::Ptr pConf = ConfigurationStore::getSingleton().getMainConf();
 
     if(!m_bComplex) {
         in_pTileset->lower()
                    ->getTileTexCoords(m_fTexCoordLowerTile, in_cTopLeft, in_cTopRight,
                                       in_cBottomLeft, in_cBottomRight, m_cBlendmask);
         // Whether to enable or disable multi texturing.
-        if(conf.get<bool>("MultiTexturing")) {
+        if(pConf->get<bool>("MultiTexturing")) {
             m_fTexCoordDetail[0] = m_usX / FTS_DETAILMAP_QUADS;
             m_fTexCoordDetail[1] = m_usY / FTS_DETAILMAP_QUADS;
             m_fTexCoordDetail[2] = 1.0f / FTS_DETAILMAP_QUADS;
@@ -210,7 +210,7 @@ void Quad::initTexCoords(const Tileset * in_pTileset,
         m_fCplxTexCoordLowerTile[9] = fTexCoordLowerTile[3];
 
         // Whether to enable or disable multi texturing.
-        if(conf.get<bool>("MultiTexturing")) {
+        if(pConf->get<bool>("MultiTexturing")) {
             m_fTexCoordDetail[0] = m_usX / FTS_DETAILMAP_QUADS;
             m_fTexCoordDetail[1] = m_usY / FTS_DETAILMAP_QUADS;
             m_fTexCoordDetail[2] = 1.0f / (FTS_DETAILMAP_QUADS * 4.0f);
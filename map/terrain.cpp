@@ -3,11 +3,13 @@
 #include "map/quad.h"
 
 #include "dLib/dFile/dFile.h"
-#include "dLib/dConf/configuration.h"
+#include "dLib/dConf/ConfigurationStore.h"
 
 #include "3d/3d.h"
 #include "3d/Math.h"
 #include "logging/logger.h"
+#include "logging/Profiler.h"
+#include "main/JobSystem.h"
 #include "graphic/graphic.h"
 #include "utilities/utilities.h"
 #include "ui/ui.h"
@@ -70,10 +72,10 @@ Terrain::~Terrain(void)
 int Terrain::loadInfo(const String &in_sTerrainFile, SLoadingInfo &out_info)
 {
     // First, check for multitexturing and complex quads options.
-    Configuration conf ("conf.xml", ArkanaDefaultSettings());
+    Configuration::Ptr pConf = ConfigurationStore::getSingleton().getMainConf();
 
-    m_bMultiTex = conf.get<bool>("MultiTexturing");
-    m_bComplex  = conf.get<bool>("ComplexQuads");
+    m_bMultiTex = pConf->get<bool>("MultiTexturing");
+    m_bComplex  = pConf->get<bool>("ComplexQuads");
 
     if(in_sTerrainFile.empty() || out_info.sMapName.empty()) {
         FTS18N("InvParam", MsgType::Horror, "Terrain::load");
@@ -339,7 +341,9 @@ void Terrain::precalcNormals()
     float fXDecal = -m_usWidth * FTS_QUAD_SIZE / 2.0f;
     float fYDecal = m_usHeight * FTS_QUAD_SIZE / 2.0f;
 
-    for(int y = 0, i = 0; y < m_usHeight; y++) {
+    // Every row only writes its own vertices, so the rows can go in parallel.
+    parallelForRanges(m_usHeight, 0, [&](std::size_t in_yBegin, std::size_t in_yEnd) {
+    for(int y = static_cast<int>(in_yBegin), i = y * m_usWidth; y < static_cast<int>(in_yEnd); y++) {
         for(int x = 0; x < m_usWidth; x++, i++) {
             // Add the upper left vertex of that quad.
             vVertices[_XY_(x,y)] = Vector( x * FTS_QUAD_SIZE + fXDecal,
@@ -372,6 +376,7 @@ void Terrain::precalcNormals()
             }
         }
     }
+    });
 
     // Now, calculate the normal of every four edges of every quad, and add it
     // To the probably already calculated normal of that vertice, or to 0.
@@ -451,14 +456,22 @@ void Terrain::precalcNormals()
     }
 
     // Finally, normalize everything and send the information to the quads.
-    for(int y = 0, i = 0; y < m_usHeight; y++) {
+    // Neighbouring quads share vertices, so all of them are normalized first.
+    parallelForRanges((m_usWidth+1)*(m_usHeight+1), 0, [vNormals](std::size_t in_iBegin, std::size_t in_iEnd) {
+        for(std::size_t i = in_iBegin ; i < in_iEnd ; ++i) {
+            vNormals[i].normalize();
+        }
+    });
+    parallelForRanges(m_usHeight, 0, [&](std::size_t in_yBegin, std::size_t in_yEnd) {
+    for(int y = static_cast<int>(in_yBegin), i = y * m_usWidth; y < static_cast<int>(in_yEnd); y++) {
         for(int x = 0; x < m_usWidth; x++, i++) {
-            m_pQuads[i].setupNormals(vNormals[_XY_(x,y)].normalize(),
-                                     vNormals[_XY_(x+1,y)].normalize(),
-                                     vNormals[_XY_(x,y+1)].normalize(),
-                                     vNormals[_XY_(x+1,y+1)].normalize());
+            m_pQuads[i].setupNormals(vNormals[_XY_(x,y)],
+                                     vNormals[_XY_(x+1,y)],
+                                     vNormals[_XY_(x,y+1)],
+                                     vNormals[_XY_(x+1,y+1)]);
         }
     }
+    });
 
     SAFE_DELETE_ARR(vVertices);
     SAFE_DELETE_ARR(vNormals);
@@ -483,6 +496,7 @@ void Terrain::precalcNormals()
  */
 int Terrain::draw(unsigned int in_uiTicks)
 {
+    FTS_PROFILE_SCOPE("Terrain::draw");
     verifGL("Terrain::draw start");
 
     // We select the tilemap as primary texture.
@@ -509,6 +523,7 @@ int Terrain::draw(unsigned int in_uiTicks)
     static float fYDecal = m_usHeight * FTS_QUAD_SIZE / 2.0f;
 
     // Draw all the quads.
+    g_drawCalls.add();
     glBegin(GL_QUADS);
     glColor3f(1.0f,1.0f,1.0f);
     for(int y = 0, i = 0; y < m_usHeight; y++) {
@@ -533,6 +548,7 @@ int Terrain::draw(unsigned int in_uiTicks)
         glDepthMask(GL_FALSE);
 
         // Draw all the quads in a second step.
+        g_drawCalls.add();
         glBegin(GL_QUADS);
         glColor3f(1.0f,1.0f,1.0f);
         for(int y = 0, i = 0; y < m_usHeight; y++) {
@@ -564,6 +580,7 @@ int Terrain::draw(unsigned int in_uiTicks)
 #ifdef DEBUG
     //extern bool g_bDrawNormals;
     if(g_bDrawNormals) {
+        g_drawCalls.add();
         glBegin(GL_LINES);
         glColor3f(1.0f,1.0f,1.0f);
         for(int y = 0, i = 0; y < m_usHeight; y++) {
@@ -107,8 +107,8 @@ FTS::SndFile::SndFile(const Path& in_sName)
                 ++ptr;
             }
 
-            FTSMSGDBG("Bitstream is {1} channel, {2}Hz", 3, String::nr((int32_t)vi->channels), String::nr((int32_t)vi->rate));
-            FTSMSGDBG("Decoded length: {1} samples", 3, String::nr(ov_pcm_total(&vf,-1)));
+            FTSMSGDBG("Bitstream is {1} channel, {2}Hz", 3, vi->channels, vi->rate);
+            FTSMSGDBG("Decoded length: {1} samples", 3, ov_pcm_total(&vf,-1));
             FTSMSGDBG("Encoded by: {1}",  3, ov_comment(&vf,-1)->vendor);
         }
 
@@ -125,7 +125,7 @@ FTS::SndFile::SndFile(const Path& in_sName)
             } else if (ret < 0) {
                 /* error in the stream.  Not a problem, just reporting it in
                 case we (the app) cares.  In this case, we don't. */
-                FTSMSGDBG("ov_read returns error : section {1} remaining size {2}",3, String::nr(current_section), String::nr(remainingSize));
+                FTSMSGDBG("ov_read returns error : section {1} remaining size {2}", 3, current_section, remainingSize);
                 eof=1;
                 //throw CorruptDataException(sCompleteFilename, "ov_read returns error\n");
             } else {
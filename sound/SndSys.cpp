@@ -15,7 +15,7 @@
 #include "fts_Snd.h"
 #include "sound/SndObjNone.h"
 #include "sound/SndSysNone.h"
-#include "dLib/dConf/configuration.h"
+#include "dLib/dConf/ConfigurationStore.h"
 
 namespace FTS {
 
@@ -49,12 +49,12 @@ ISndSys *ISndSys::createSoundSys()
 #if defined(TEST_SND)
     return new SndSysOpenAL;
 #else
-    Configuration conf ("conf.xml", ArkanaDefaultSettings());
+    Configuration::Ptr pConf = ConfigurationStore::getSingleton().getMainConf();
 
 #if D_SND_SYS == D_FTS_OpenAL
 
     // Use The OpenAL driver if the sound is enabled in the options.
-    if(conf.get<bool>("SoundEnabled")) {
+    if(pConf->get<bool>("SoundEnabled")) {
         // If we have sound installed the ctor should work. Otherwise an exception is
         // generated. Then the dummy sound system is used.
         // On linux this usually fails if the dsp device is busy.
@@ -80,7 +80,7 @@ ISndSys *ISndSys::createSoundSys()
 
     // Only display the warning if the user wanted to have sound, if he didn't
     // want any sound, it is normal that we create the dummy sound system here!
-    if(conf.get<bool>("SoundEnabled"))
+    if(pConf->get<bool>("SoundEnabled"))
         FTS18N("SND_NoSys", MsgType::Warning);
 
     return FTS::ISndSys::getSingletonPtr();
@@ -89,9 +89,9 @@ ISndSys *ISndSys::createSoundSys()
 
     float ISndSys::getNormalizedVolume(const String& in_optName)
     {
-        Configuration conf ("conf.xml", ArkanaDefaultSettings());
+        Configuration::Ptr pConf = ConfigurationStore::getSingleton().getMainConf();
 
-        int iVol = conf.get<int>(in_optName);
+        int iVol = pConf->get<int>(in_optName);
         float vol = float( iVol < 0 ? 0 : (iVol > 100 ? 100 : iVol) );
         return vol /  100.f ;
     }
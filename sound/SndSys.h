@@ -45,6 +45,7 @@ protected:
 public:
     static ISndSys* createSoundSys();
     virtual ~ISndSys();
+    virtual Phase getUpdatePhase() const {return Audio;};
 
     virtual String getType() = 0;
     virtual ISndObj* CreateSndObj(SndGroup::Enum in_enumGroup, const Path& in_filename, SndPlayMode::Enum in_enumMode = SndPlayMode::Single) = 0;
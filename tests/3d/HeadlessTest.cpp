@@ -0,0 +1,84 @@
+#include "dLib/aTest/TestHarness.h"
+
+#include "3d/3d.h"
+#include "3d/Renderer.h"
+
+using namespace FTS;
+
+SUITE(Headless);
+
+namespace {
+    /// Runs without a display for as long as it lives.
+    struct HeadlessScope {
+        HeadlessScope() {Renderer::setHeadless(true);};
+        ~HeadlessScope() {Renderer::setHeadless(false);};
+    };
+}
+
+TEST_INSUITE(Headless, ProgramsCompileAndLink)
+{
+    HeadlessScope headless;
+
+    GLuint vert = glCreateShader(GL_VERTEX_SHADER);
+    GLuint frag = glCreateShader(GL_FRAGMENT_SHADER);
+    GLuint prog = glCreateProgram();
+    CHECK(vert != 0);
+    CHECK(frag != 0);
+    CHECK(prog != 0);
+    CHECK(vert != frag);
+    CHECK(frag != prog);
+
+    glCompileShader(vert);
+    GLint iStatus = GL_FALSE;
+    glGetShaderiv(vert, GL_COMPILE_STATUS, &iStatus);
+    CHECK_EQUAL(GL_TRUE, iStatus);
+
+    glAttachShader(prog, vert);
+    glAttachShader(prog, frag);
+    glLinkProgram(prog);
+    iStatus = GL_FALSE;
+    glGetProgramiv(prog, GL_LINK_STATUS, &iStatus);
+    CHECK_EQUAL(GL_TRUE, iStatus);
+
+    // And there's nothing to complain about.
+    GLint iLogLength = 42;
+    glGetProgramiv(prog, GL_INFO_LOG_LENGTH, &iLogLength);
+    CHECK_EQUAL(0, iLogLength);
+    GLchar szLog[16] = "garbage";
+    GLsizei nLength = 42;
+    glGetShaderInfoLog(vert, sizeof(szLog), &nLength, szLog);
+    CHECK_EQUAL(0, nLength);
+    CHECK_EQUAL(0, szLog[0]);
+
+    glDeleteProgram(prog);
+    glDeleteShader(frag);
+    glDeleteShader(vert);
+}
+
+TEST_INSUITE(Headless, NothingIsFound)
+{
+    HeadlessScope headless;
+
+    GLuint prog = glCreateProgram();
+    CHECK_EQUAL(-1, glGetAttribLocation(prog, "aVertexPosition"));
+    CHECK_EQUAL(-1, glGetUniformLocation(prog, "uModelViewProjectionMatrix"));
+    CHECK(!glHasExtension("GL_ARB_shading_language_include"));
+}
+
+TEST_INSUITE(Headless, BuffersGetNames)
+{
+    HeadlessScope headless;
+
+    GLuint buffers[3] = {0, 0, 0};
+    glGenBuffers(3, buffers);
+    CHECK(buffers[0] != 0);
+    CHECK(buffers[1] != buffers[0]);
+    CHECK(buffers[2] != buffers[1]);
+
+    GLuint vao = 0;
+    glGenVertexArrays(1, &vao);
+    CHECK(vao != 0);
+
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(3, buffers);
+}
@@ -3,9 +3,14 @@
 #include "dLib/aTest/TestHarness.h"
 
 #include "dLib/dConf/configuration.h"
+#include "dLib/dConf/ConfigurationStore.h"
 #include "dLib/dConf/DefaultOptions.h"
 #include "Settings.h"
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 using namespace FTS;
 using namespace std;
 
@@ -226,4 +231,110 @@ TEST_INSUITE(tConfiguration, Unknown_Key)
         FAIL("Get unknown int option");
     } catch(CorruptDataException&) {
     }
-}
\ No newline at end of file
+}
+TEST_INSUITE(tConfiguration, TypeTestIntRange)
+{
+    Configuration conf{TestOptions()};
+    conf.set("int", "-1");
+    CHECK_EQUAL(-1, conf.get<int>("int"));
+    try {
+        auto v = conf.get<unsigned int>("int");
+        FAIL("Get unsigned of a negative option");
+    } catch(CorruptDataException& ) {
+    }
+
+    conf.set("int", "9000000000");
+    CHECK_EQUAL(9000000000LL, conf.get<long long>("int"));
+    try {
+        auto v = conf.get<int>("int");
+        FAIL("Get int of a too big option");
+    } catch(CorruptDataException& ) {
+    }
+}
+
+TEST_INSUITE(tConfiguration, StoreSharesConfigurations)
+{
+    std::string confFileName = "conf_test2.xml";
+    Configuration::Ptr pConf = ConfigurationStore::getSingleton().get<TestOptions>(confFileName, false);
+    CHECK_EQUAL(pConf, ConfigurationStore::getSingleton().get(confFileName, TestOptions(), false));
+    CHECK_EQUAL(100, pConf->get<int>("int"));
+
+    // Changes are seen by everybody using it, without saving.
+    pConf->set("int", 42);
+    CHECK_EQUAL(42, ConfigurationStore::getSingleton().get<TestOptions>(confFileName, false)->get<int>("int"));
+
+    // Once forgotten, it is read again, but whoever still holds the old one
+    // can keep using it.
+    ConfigurationStore::getSingleton().forget(confFileName, false);
+    CHECK_EQUAL(100, ConfigurationStore::getSingleton().get<TestOptions>(confFileName, false)->get<int>("int"));
+    CHECK_EQUAL(42, pConf->get<int>("int"));
+    ConfigurationStore::getSingleton().forget(confFileName, false);
+}
+
+TEST_INSUITE(tConfiguration, StoreFollowsSavedConfigurations)
+{
+    std::string confFileName = "conf_test.xml";
+    Configuration::Ptr pShared = ConfigurationStore::getSingleton().get(confFileName, Settings("German"), false);
+    CHECK_EQUAL(32, pShared->get<int>("BPP"));
+
+    Configuration conf(confFileName, Settings("German"), false);
+    conf.set("BPP", 16);
+    CHECK_EQUAL(32, pShared->get<int>("BPP"));
+    conf.save();
+    CHECK_EQUAL(16, pShared->get<int>("BPP"));
+
+    // Restore the original value.
+    pShared->set("BPP", 32);
+    pShared->save();
+    ConfigurationStore::getSingleton().forget(confFileName, false);
+}
+
+TEST_INSUITE(tConfiguration, SubscribersGetNotified)
+{
+    Configuration conf{TestOptions()};
+    std::vector<String> intChanges, allChanges;
+    std::size_t intId = conf.subscribe("int", [&intChanges](const String& in_optName) {intChanges.push_back(in_optName);});
+    std::size_t allId = conf.subscribe("", [&allChanges](const String& in_optName) {allChanges.push_back(in_optName);});
+
+    conf.set("int", 5);
+    conf.set("int", 5); // Didn't change, nobody is bothered.
+    conf.set("bool", false);
+    CHECK_EQUAL(1, intChanges.size());
+    CHECK_EQUAL("int", intChanges[0]);
+    CHECK_EQUAL(2, allChanges.size());
+    CHECK_EQUAL("bool", allChanges[1]);
+    CHECK_EQUAL(5, conf.get<int>("int"));
+
+    conf.unsubscribe(intId);
+    conf.set("int", 6);
+    CHECK_EQUAL(1, intChanges.size());
+    CHECK_EQUAL(3, allChanges.size());
+    conf.unsubscribe(allId);
+}
+
+TEST_INSUITE(tConfiguration, SharedBetweenThreads)
+{
+    Configuration conf{TestOptions()};
+
+    // Listeners are called without the configuration being locked.
+    int iSeen = 0;
+    std::size_t id = conf.subscribe("int", [&conf, &iSeen](const String&) {iSeen = conf.get<int>("int");});
+    conf.set("int", 7);
+    CHECK_EQUAL(7, iSeen);
+    conf.unsubscribe(id);
+
+    // A reader never sees a half-written value.
+    std::atomic<bool> bBad(false);
+    std::thread reader([&conf, &bBad]() {
+        for(int i = 0 ; i < 20000 ; ++i) {
+            std::string s = conf.get<std::string>("String");
+            if(s != "short" && s != "a value that is too long for any small string buffer")
+                bBad = true;
+        }
+    });
+    for(int i = 0 ; i < 20000 ; ++i) {
+        conf.set("String", i % 2 ? "short" : "a value that is too long for any small string buffer");
+    }
+    reader.join();
+    CHECK(!bBad);
+}
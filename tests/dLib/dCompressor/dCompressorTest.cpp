@@ -0,0 +1,183 @@
+#include "dLib/aTest/TestHarness.h"
+
+#include "dLib/dCompressor/blocklzo_compressor.h"
+#include "dLib/dCompressor/minilzo_compressor.h"
+#include "logging/MinimalLogger.h"
+#include "utilities/DataContainer.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+using namespace FTS;
+
+SUITE(dCompressor);
+
+class CompressorSetup : public TestSetup {
+public:
+    void setup()
+    {
+        new MinimalLogger(1);
+    }
+    void teardown()
+    {
+        delete Logger::getSingletonPtr();
+    }
+};
+
+/// Half of it compresses well, the other half not at all.
+static RawDataContainer makeData(size_t in_uiSize)
+{
+    RawDataContainer data(in_uiSize);
+    uint32_t uiRand = 12345;
+    for(size_t i = 0 ; i < in_uiSize ; ++i) {
+        uiRand = uiRand * 1103515245 + 12345;
+        data.getData()[i] = (i / 1000) % 2 ? static_cast<uint8_t>(uiRand >> 16) : static_cast<uint8_t>(i / 7);
+    }
+    return data;
+}
+
+static bool sameData(const DataContainer& a, const uint8_t* b, size_t in_uiSize)
+{
+    return a.getSize() == in_uiSize && (in_uiSize == 0 || std::memcmp(a.getData(), b, in_uiSize) == 0);
+}
+
+TEST_INSUITE_WITHSETUP(dCompressor, Compressor, BlockLZORoundTrip)
+{
+    // Small blocks and many threads, to have lots of blocks on lots of threads.
+    BlockLZOCompressor comp(1000, 4);
+    const size_t sizes[] = {0, 1, 999, 1000, 1001, 4000, 12345, 100000};
+    for(size_t uiSize : sizes) {
+        RawDataContainer data = makeData(uiSize);
+
+        StreamedDataContainer compressed;
+        comp.compress(compressed, &data);
+        CHECK(comp.isMyType(compressed.getBoundDC()));
+        CHECK_EQUAL(uiSize, comp.getDecompressedSize(compressed.getBoundDC()));
+
+        StreamedDataContainer decompressed;
+        comp.decompress(decompressed, compressed.getBoundDC());
+        if(uiSize > 0) {
+            CHECK(sameData(data, decompressed.getBoundDC()->getData(), uiSize));
+        }
+    }
+}
+
+TEST_INSUITE_WITHSETUP(dCompressor, Compressor, BlockLZOCompresses)
+{
+    RawDataContainer data(1024 * 1024);
+    for(size_t i = 0 ; i < data.getSize() ; ++i) {
+        data.getData()[i] = static_cast<uint8_t>(i % 13);
+    }
+
+    BlockLZOCompressor comp;
+    StreamedDataContainer compressed;
+    CHECK(comp.compress(compressed, &data));
+    CHECK(compressed.getBoundDC()->getSize() < data.getSize() / 10);
+}
+
+TEST_INSUITE_WITHSETUP(dCompressor, Compressor, BlockLZODecompressesRanges)
+{
+    BlockLZOCompressor comp(1000, 3);
+    RawDataContainer data = makeData(10500);
+    StreamedDataContainer compressed;
+    comp.compress(compressed, &data);
+
+    // Inside a block, across block borders, the whole thing and the tail.
+    const uint64_t ranges[][2] = {{10, 20}, {990, 20}, {1500, 3000}, {0, 10500}, {10000, 500}, {10500, 0}};
+    for(auto range : ranges) {
+        StreamedDataContainer part;
+        comp.decompressRange(part, compressed.getBoundDC(), range[0], range[1]);
+        if(range[1] > 0) {
+            CHECK(sameData(*part.getBoundDC(), data.getData() + range[0], static_cast<size_t>(range[1])));
+        }
+    }
+
+    StreamedDataContainer part;
+    try {
+        comp.decompressRange(part, compressed.getBoundDC(), 10000, 501);
+        FAIL("Expected an out of range exception");
+    } catch(const CorruptDecompressionDataException&) {
+    }
+}
+
+TEST_INSUITE_WITHSETUP(dCompressor, Compressor, BlockLZOCorruptDataThrows)
+{
+    BlockLZOCompressor comp(1000);
+    RawDataContainer data = makeData(5000);
+    StreamedDataContainer compressed;
+    comp.compress(compressed, &data);
+
+    // Cut off the last block.
+    RawDataContainer truncated(*compressed.getBoundDC());
+    truncated.resize(truncated.getSize() - 10);
+    StreamedDataContainer out;
+    try {
+        comp.decompress(out, &truncated);
+        FAIL("Expected a corrupt data exception for truncated data");
+    } catch(const CorruptDecompressionDataException&) {
+    }
+
+    // Make the first block, which compresses well, one byte too short. The
+    // index entry of the first block comes right after the fixed header.
+    RawDataContainer broken(*compressed.getBoundDC());
+    uint8_t *pFirstEntry = broken.getData() + sizeof("FTSBLZ") + 1 + 8 + 4 + 4;
+    pFirstEntry[0] -= 1;
+    try {
+        comp.decompress(out, &broken);
+        FAIL("Expected a corrupt data exception for broken data");
+    } catch(const CorruptDecompressionDataException&) {
+    }
+
+    // A size so big that rounding it up to whole blocks overflows to no blocks.
+    RawDataContainer huge(*compressed.getBoundDC());
+    uint8_t *pSize = huge.getData() + sizeof("FTSBLZ") + 1;
+    const uint64_t uiHugeSize = UINT64_MAX;
+    const uint32_t nNoBlocks = 0;
+    std::memcpy(pSize, &uiHugeSize, sizeof(uiHugeSize));
+    std::memcpy(pSize + 8 + 4, &nNoBlocks, sizeof(nNoBlocks));
+    try {
+        comp.decompress(out, &huge);
+        FAIL("Expected a corrupt data exception for a huge size");
+    } catch(const CorruptDecompressionDataException&) {
+    }
+}
+
+TEST_INSUITE_WITHSETUP(dCompressor, Compressor, FactoryKnowsBothLZOFormats)
+{
+    CompressorFactory& factory = CompressorFactory::getSingleton();
+    // Block compression is opt-in, older versions can't read it.
+    CHECK_EQUAL("MiniLZO", factory.getDefault()->getName());
+    CHECK_EQUAL("BlockLZO", factory.create("BlockLZO")->getName());
+
+    RawDataContainer data = makeData(3000);
+    StreamedDataContainer blocks, whole;
+    BlockLZOCompressor().compress(blocks, &data);
+    MiniLZOCompressor().compress(whole, &data);
+
+    CHECK_EQUAL("BlockLZO", factory.determine(blocks.getBoundDC())->getName());
+    CHECK_EQUAL("MiniLZO", factory.determine(whole.getBoundDC())->getName());
+}
+
+TEST_INSUITE_WITHSETUP(dCompressor, Compressor, benchmark_lzo_32MiB)
+{
+    // This is a micro-benchmark rather than a real test.
+    RawDataContainer data = makeData(32 * 1024 * 1024);
+    MiniLZOCompressor mini;
+    BlockLZOCompressor block;
+
+    StreamedDataContainer miniComp, blockComp, miniDecomp, blockDecomp;
+    auto t0 = std::chrono::steady_clock::now();
+    mini.compress(miniComp, &data);
+    auto t1 = std::chrono::steady_clock::now();
+    block.compress(blockComp, &data);
+    auto t2 = std::chrono::steady_clock::now();
+    mini.decompress(miniDecomp, miniComp.getBoundDC());
+    auto t3 = std::chrono::steady_clock::now();
+    block.decompress(blockDecomp, blockComp.getBoundDC());
+    auto t4 = std::chrono::steady_clock::now();
+
+    auto ms = [](std::chrono::steady_clock::duration d) {return std::chrono::duration_cast<std::chrono::milliseconds>(d).count();};
+    std::cerr << std::endl << "      [LZO of 32MiB: MiniLZO " << ms(t1 - t0) << "ms/" << ms(t3 - t2) << "ms, "
+              << "BlockLZO " << ms(t2 - t1) << "ms/" << ms(t4 - t3) << "ms (compress/decompress)]" << std::endl;
+    CHECK(sameData(data, blockDecomp.getBoundDC()->getData(), data.getSize()));
+}
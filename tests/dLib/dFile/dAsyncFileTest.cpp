@@ -0,0 +1,123 @@
+#include "dLib/aTest/TestHarness.h"
+
+#include "dLib/dFile/dAsyncFile.h"
+#include "main/Clock.h"
+#include "logging/MinimalLogger.h"
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <experimental/filesystem>
+
+using namespace FTS;
+using namespace std;
+namespace fs = std::experimental::filesystem;
+
+SUITE(dAsyncFile);
+
+class AsyncFileSetup : public TestSetup {
+public:
+    void setup()
+    {
+        new MinimalLogger(1);
+        auto f = ofstream("dummy.file");
+        f << "0123456789";
+    }
+    void teardown()
+    {
+        delete AsyncFileLoader::getSingletonPtr();
+        fs::remove("dummy.file");
+        delete Logger::getSingletonPtr();
+    }
+};
+
+TEST_INSUITE_WITHSETUP(dAsyncFile, AsyncFile, OpensInBackgroundCallsBackInUpdate)
+{
+    new AsyncFileLoader(2);
+    std::thread::id mainThread = std::this_thread::get_id();
+
+    int nCalled = 0;
+    bool bOnMainThread = false;
+    AsyncFile::Ptr pReq = File::openAsync("dummy.file", File::Read, 0, [&](AsyncFile& f) {
+        ++nCalled;
+        bOnMainThread = std::this_thread::get_id() == mainThread;
+        CHECK(f.isReady());
+    });
+
+    pReq->wait();
+    CHECK(AsyncFile::Done == pReq->getState());
+
+    // The callback comes only with the updates.
+    CHECK_EQUAL(0, nCalled);
+    Clock c;
+    UpdateableManager::getSingleton().doUpdates(c);
+    CHECK_EQUAL(1, nCalled);
+    CHECK(bOnMainThread);
+
+    File::Ptr pFile = pReq->get();
+    CHECK(pFile != NULL);
+    CHECK_EQUAL(10, pFile->getSize());
+    CHECK(pReq->get() == NULL);
+}
+
+TEST_INSUITE_WITHSETUP(dAsyncFile, AsyncFile, FailureIsThrownByGet)
+{
+    new AsyncFileLoader(1);
+
+    AsyncFile::Ptr pReq = File::openAsync("invalid.file", File::Read);
+    try {
+        pReq->get();
+        FAIL("Expected a file not exist exception");
+    } catch(const FileNotExistException&) {
+    }
+    CHECK(AsyncFile::Failed == pReq->getState());
+    CHECK_EQUAL(1, AsyncFileLoader::getSingleton().deliverCompleted());
+}
+
+TEST_INSUITE_WITHSETUP(dAsyncFile, AsyncFile, PriorityCancelAndBoost)
+{
+    new AsyncFileLoader(1);
+
+    // Flood the only I/O thread, it can't keep up with that.
+    std::vector<int> order;
+    std::vector<AsyncFile::Ptr> lowPrio;
+    for(int i = 0 ; i < 200 ; ++i) {
+        lowPrio.push_back(File::openAsync("dummy.file", File::Read, 0, [&order, i](AsyncFile&) {order.push_back(i);}));
+    }
+    AsyncFile::Ptr pUrgent = File::openAsync("dummy.file", File::Read, 10, [&order](AsyncFile&) {order.push_back(1000);});
+
+    // Whatever is still waiting now was waiting when the urgent one came.
+    std::vector<int> overtaken;
+    for(int i = 0 ; i < 198 ; ++i) {
+        if(lowPrio[i]->getState() == AsyncFile::Queued)
+            overtaken.push_back(i);
+    }
+
+    bool bBoosted = lowPrio[198]->boost(20);
+    bool bUrgentWaited = pUrgent->getState() == AsyncFile::Queued;
+
+    // If the last one is still waiting, it won't be opened anymore.
+    bool bCancelled = lowPrio.back()->cancel();
+    CHECK_EQUAL(bCancelled, (lowPrio.back()->getState() == AsyncFile::Cancelled));
+
+    for(auto i = lowPrio.begin() ; i != lowPrio.end() ; ++i) {
+        (*i)->wait();
+    }
+    pUrgent->wait();
+    AsyncFileLoader::getSingleton().deliverCompleted();
+
+    // The urgent one overtook all that were still waiting, and the boosted
+    // one overtook the urgent one if it had to wait.
+    CHECK_EQUAL((bCancelled ? 200u : 201u), order.size());
+    std::size_t iUrgent = std::find(order.begin(), order.end(), 1000) - order.begin();
+    for(auto i = overtaken.begin() ; i != overtaken.end() ; ++i) {
+        CHECK(static_cast<std::size_t>(std::find(order.begin(), order.end(), *i) - order.begin()) > iUrgent);
+    }
+    if(bBoosted && bUrgentWaited) {
+        std::size_t iBoosted = std::find(order.begin(), order.end(), 198) - order.begin();
+        CHECK(iBoosted < iUrgent);
+    }
+    if(bCancelled) {
+        CHECK(lowPrio.back()->get() == NULL);
+    }
+}
@@ -2,6 +2,11 @@
 
 #include "dLib/dFile/dFile.h"
 #include "dLib/dArchive/dArchive.h"
+#include "logging/MinimalLogger.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
 
 using namespace FTS;
 
@@ -11,6 +16,7 @@ class ArchiveSetup : public TestSetup {
 public:
     void setup()
     {
+        new MinimalLogger(1); // Needed by the archive's debug messages.
         File::Ptr pFile1 = File::overwrite("dummy.file", File::Insert);
         pFile1->write("Hello, Moto!");
         pFile1->write(10.0);
@@ -24,6 +30,7 @@ public:
     void teardown()
     {
         SAFE_DELETE(m_pArch);
+        delete Logger::getSingletonPtr();
     }
 protected:
 	Archive* m_pArch;
@@ -51,3 +58,294 @@ TEST_INSUITE_WITHSETUP(dFileArchive, Archive, LoadSaveFromArchiveToLook)
     // And especially check if that change is still in!
 	CHECK_EQUAL("Bye, Moto!", pFile->readstr());
 }
+
+TEST_INSUITE_WITHSETUP(dFileArchive, Archive, IndexedArchiveLoadsLazily)
+{
+    CHECK_EQUAL(Archive::CurrentFormat, m_pArch->getFormatVersion());
+    m_pArch->save();
+
+    Archive::Ptr pLoaded(Archive::loadArchive("dummy.ftsarc"));
+    CHECK_EQUAL(Archive::FormatV2, pLoaded->getFormatVersion());
+    CHECK_EQUAL(2, pLoaded->getFileCount());
+
+    // Nothing but the index has been read yet.
+    FileChunk *pChk = dynamic_cast<FileChunk *>(pLoaded->getChunk("dummy.file2"));
+    CHECK(pChk != NULL);
+    CHECK(pChk->isLazy());
+
+    File& f = pLoaded->getFile("dummy.file2");
+    CHECK(!pChk->isLazy());
+    CHECK_EQUAL("Bye, Moto!", f.readstr());
+    CHECK_EQUAL(25L, f.readi64());
+    CHECK(pLoaded->getFileContent("dummy.file").getSize() > 0);
+}
+
+TEST_INSUITE_WITHSETUP(dFileArchive, Archive, LazyChunkMakesOneFileForAllThreads)
+{
+    m_pArch->save();
+    Archive::Ptr pLoaded(Archive::loadArchive("dummy.ftsarc"));
+    FileChunk *pChk = dynamic_cast<FileChunk *>(pLoaded->getChunk("dummy.file2"));
+    CHECK(pChk->isLazy());
+
+    // Whoever comes first makes the file, the others get the same one.
+    std::vector<File*> files(4, nullptr);
+    std::vector<std::thread> threads;
+    for(std::size_t i = 0 ; i < files.size() ; ++i) {
+        threads.push_back(std::thread([pChk, &files, i]() {files[i] = &pChk->getFile();}));
+    }
+    for(std::thread& t : threads) {
+        t.join();
+    }
+    for(File* pFile : files) {
+        CHECK_EQUAL(files[0], pFile);
+    }
+    CHECK_EQUAL("Bye, Moto!", files[0]->readstr());
+}
+
+TEST_INSUITE_WITHSETUP(dFileArchive, Archive, ConvertBetweenFormats)
+{
+    m_pArch->setFormatVersion(Archive::FormatV1);
+    m_pArch->save();
+
+    Archive::Ptr pLoaded(Archive::loadArchive("dummy.ftsarc"));
+    CHECK_EQUAL(Archive::FormatV1, pLoaded->getFormatVersion());
+    CHECK_EQUAL("Hello, Moto!", pLoaded->getFile("dummy.file").readstr());
+
+    // Write it back as an indexed archive.
+    pLoaded->setFormatVersion(Archive::FormatV2);
+    pLoaded->save();
+    pLoaded.reset(Archive::loadArchive("dummy.ftsarc"));
+    CHECK_EQUAL(Archive::FormatV2, pLoaded->getFormatVersion());
+    CHECK_EQUAL("Hello, Moto!", pLoaded->getFile("dummy.file").readstr());
+    CHECK_EQUAL("Bye, Moto!", pLoaded->getFile("dummy.file2").readstr());
+
+    // Both formats can be read from memory too.
+    File::Ptr pFile = File::open("dummy.ftsarc", File::Read);
+    CHECK(Archive::isValidArchive(*pFile));
+    pLoaded.reset(Archive::loadArchive(*pFile));
+    CHECK_EQUAL(2, pLoaded->getFileCount());
+    CHECK_EQUAL("Bye, Moto!", pLoaded->getFile("dummy.file2").readstr());
+}
+
+TEST_INSUITE_WITHSETUP(dFileArchive, Archive, IndexedArchiveDetectsCorruptChunk)
+{
+    m_pArch->save();
+
+    // Flip the last byte of the first chunk's payload (right before the index).
+    Archive::Ptr pLoaded(Archive::loadArchive("dummy.ftsarc"));
+    File::Ptr pRaw = File::open("dummy.ftsarc", File::Overwrite);
+    pRaw->setCursorPos(12);
+    uint64_t uiIndexPos = pRaw->readui64();
+    pRaw->setCursorPos(uiIndexPos - 1);
+    uint8_t uiLast = pRaw->readui8();
+    pRaw->setCursorPos(uiIndexPos - 1);
+    pRaw->getWriter()->overwrite(static_cast<uint8_t>(~uiLast));
+    pRaw->save();
+
+    pLoaded.reset(Archive::loadArchive("dummy.ftsarc"));
+    try {
+        pLoaded->getFile("dummy.file2");
+        FAIL("Expected a corrupt data exception");
+    } catch(const CorruptDataException&) {
+    }
+}
+
+TEST_INSUITE_WITHSETUP(dFileArchive, Archive, IndexedArchiveDetectsCorruptIndex)
+{
+    m_pArch->save();
+
+    // Make the first chunk's payload reach into the index, with a valid
+    // checksum of the index: the count, then hash, type, offset and size.
+    File::Ptr pRaw = File::open("dummy.ftsarc", File::Overwrite);
+    pRaw->setCursorPos(12);
+    uint64_t uiIndexPos = pRaw->readui64();
+    pRaw->setCursorPos(uiIndexPos + 8 + 4 + 1 + 8);
+    pRaw->getWriter()->overwrite(static_cast<uint64_t>(1) << 40);
+    const uint8_t *pData = pRaw->getDataContainer().getData();
+    ConstRawDataContainer index(pData + uiIndexPos, static_cast<size_t>(pRaw->getSize() - uiIndexPos));
+    uint32_t uiFletcher32 = index.fletcher32();
+    pRaw->setCursorPos(8);
+    pRaw->getWriter()->overwrite(uiFletcher32);
+    pRaw->save();
+
+    // That's found out right away, not once the chunk is needed.
+    try {
+        Archive::Ptr pLoaded(Archive::loadArchive("dummy.ftsarc"));
+        FAIL("Expected a corrupt data exception");
+    } catch(const CorruptDataException&) {
+    }
+}
+
+TEST_INSUITE_WITHSETUP(dFileArchive, Archive, IndexedArchiveDetectsWrappingChunk)
+{
+    m_pArch->save();
+
+    // Give the first chunk a size that wraps its end around to the start of
+    // the archive, again with a valid checksum of the index.
+    File::Ptr pRaw = File::open("dummy.ftsarc", File::Overwrite);
+    pRaw->setCursorPos(12);
+    uint64_t uiIndexPos = pRaw->readui64();
+    pRaw->setCursorPos(uiIndexPos + 8 + 4 + 1);
+    uint64_t uiOffset = pRaw->readui64();
+    pRaw->getWriter()->overwrite(static_cast<uint64_t>(0) - uiOffset);
+    const uint8_t *pData = pRaw->getDataContainer().getData();
+    ConstRawDataContainer index(pData + uiIndexPos, static_cast<size_t>(pRaw->getSize() - uiIndexPos));
+    uint32_t uiFletcher32 = index.fletcher32();
+    pRaw->setCursorPos(8);
+    pRaw->getWriter()->overwrite(uiFletcher32);
+    pRaw->save();
+
+    // Neither when indexing the file nor when reading it from memory.
+    try {
+        Archive::Ptr pLoaded(Archive::loadArchive("dummy.ftsarc"));
+        FAIL("Expected a corrupt data exception");
+    } catch(const CorruptDataException&) {
+    }
+    try {
+        pRaw->setCursorPos(0);
+        Archive::Ptr pLoaded(Archive::loadArchive(*pRaw));
+        FAIL("Expected a corrupt data exception");
+    } catch(const CorruptDataException&) {
+    }
+}
+
+TEST_INSUITE_WITHSETUP(dFileArchive, Archive, FilesShareChunkData)
+{
+    File::addArchiveToLook(m_pArch);
+
+    // Reading doesn't copy the chunk's data.
+    File::Ptr pFile = File::open("dummy.file2", File::Read);
+    CHECK(pFile->isShared());
+    CHECK_EQUAL("Bye, Moto!", pFile->readstr());
+    CHECK_EQUAL(25L, pFile->readi64());
+    CHECK(pFile->isShared());
+
+    m_pArch->save();
+    Archive::Ptr pLoaded(Archive::loadArchive("dummy.ftsarc"));
+    CHECK(dynamic_cast<FileChunk*>(pLoaded->getChunk("dummy.file2"))->getFile().isShared());
+
+    // Writing only modifies the file's own copy.
+    File::Ptr pModified = File::open("dummy.file2", File::Overwrite);
+    CHECK(pModified->isShared());
+    pModified->write("Hi, Moto!!");
+    CHECK(!pModified->isShared());
+    pModified->setCursorPos(0);
+    CHECK_EQUAL("Hi, Moto!!", pModified->readstr());
+
+    pFile->setCursorPos(0);
+    CHECK_EQUAL("Bye, Moto!", pFile->readstr());
+    CHECK_EQUAL("Bye, Moto!", File::open("dummy.file2", File::Read)->readstr());
+
+    // The data stays alive even when the chunk goes away.
+    pModified.reset();
+    SAFE_DELETE(m_pArch);
+    pFile->setCursorPos(0);
+    CHECK_EQUAL("Bye, Moto!", pFile->readstr());
+}
+
+TEST_INSUITE_WITHSETUP(dFileArchive, Archive, ArchivesOverlayByPriority)
+{
+    Archive::Ptr pMod(Archive::createEmptyArchive("dummy_mod.ftsarc"));
+    File::Ptr pModFile = File::fromRawData(ConstRawDataContainer("Mod", 4), "dummy.file2", File::Read, File::OverwriteFile);
+    pMod->give(new FileChunk(std::move(pModFile)));
+
+    // Among archives of the same priority, the last added one wins.
+    File::addArchiveToLook(m_pArch);
+    File::addArchiveToLook(pMod.get());
+    CHECK_EQUAL("Mod", File::open("dummy.file2", File::Read)->readstr());
+    CHECK_EQUAL("Hello, Moto!", File::open("./dummy.file", File::Read)->readstr());
+
+    // A higher priority wins no matter the order.
+    File::addArchiveToLook(m_pArch, 1);
+    CHECK_EQUAL("Bye, Moto!", File::open("dummy.file2", File::Read)->readstr());
+
+    // Once the winner is gone, the file of the next archive shows up again.
+    File::remArchiveToLook(m_pArch);
+    CHECK_EQUAL("Mod", File::open("dummy.file2", File::Read)->readstr());
+    CHECK(!File::available("dummy.file3", File::Read));
+    File::remArchiveToLook(pMod.get());
+}
+
+TEST_INSUITE_WITHSETUP(dFileArchive, Archive, IndexFollowsArchiveChanges)
+{
+    File::addArchiveToLook(m_pArch);
+
+    // Lots of files, so that the index has to grow and to move entries around
+    // when they are removed again.
+    for(int i = 0 ; i < 1000 ; ++i) {
+        String sName = "Data/file" + String::nr(i);
+        m_pArch->give(new FileChunk(File::fromRawData(ConstRawDataContainer(sName.c_str(), sName.byteCount() + 1), sName, File::Read, File::OverwriteFile)));
+    }
+    for(int i = 0 ; i < 1000 ; i += 2) {
+        delete m_pArch->take("Data/file" + String::nr(i));
+    }
+
+    for(int i = 0 ; i < 1000 ; ++i) {
+        String sName = "Data/file" + String::nr(i);
+        CHECK_EQUAL((i % 2 == 1), File::available(sName, File::Read));
+    }
+    CHECK_EQUAL("Data/file999", File::open("Data/file999", File::Read)->readstr());
+    CHECK(File::available("dummy.file", File::Read));
+
+    // Deleting the archive takes all its files out of the index.
+    SAFE_DELETE(m_pArch);
+    CHECK(!File::available("Data/file999", File::Read));
+}
+
+TEST_INSUITE_WITHSETUP(dFileArchive, Archive, DirectoryArchiveIsSameForAnyThreadCount)
+{
+    // Enough files of different sizes in some subdirectories for the threads
+    // to finish them in a different order than they were started.
+    for(int i = 0 ; i < 24 ; ++i) {
+        Path sName = Path("dummy.dir") + Path(String::nr(i % 3)) + Path("file" + String::nr(i));
+        FileUtils::mkdirIfNeeded(sName, true);
+        File::Ptr pFile = File::overwrite(sName, File::Insert);
+        for(int j = 0 ; j <= (i * 7919) % 5000 ; ++j) {
+            pFile->write(static_cast<uint32_t>(j * i));
+        }
+        pFile->save();
+    }
+
+    std::vector<ConstRawDataContainer> saved;
+    std::vector<File::Ptr> files;
+    const std::size_t threadCounts[] = {1, 4, 0};
+    for(std::size_t nThreads : threadCounts) {
+        Archive::setWorkerThreads(nThreads);
+        Archive::Ptr pDirArch(Archive::loadArchive("dummy.dir", "prefix/"));
+        CHECK_EQUAL(24, pDirArch->getFileCount());
+        CHECK(pDirArch->hasChunk("prefix/2/file23"));
+
+        files.push_back(File::overwrite("dummy.ftsarc", File::Insert));
+        pDirArch->save(*files.back());
+        saved.push_back(files.back()->getDataContainer());
+    }
+    Archive::setWorkerThreads(0);
+    FileUtils::rmdir("dummy.dir");
+
+    for(const ConstRawDataContainer& data : saved) {
+        CHECK_EQUAL(saved[0].getSize(), data.getSize());
+        CHECK(std::memcmp(saved[0].getData(), data.getData(), static_cast<size_t>(data.getSize())) == 0);
+    }
+}
+
+TEST_INSUITE_WITHSETUP(dFileArchive, Archive, ChunksAreFoundByName)
+{
+    const Name file2("dummy.file2");
+    CHECK(m_pArch->hasChunk(file2));
+    CHECK_EQUAL(m_pArch->getChunk("dummy.file2"), m_pArch->getChunk(file2));
+    CHECK(!m_pArch->hasChunk(Name("dummy.file3")));
+
+    // Also the ones read from disk and the ones taken out.
+    m_pArch->save();
+    Archive::Ptr pLoaded(Archive::loadArchive("dummy.ftsarc"));
+    CHECK(pLoaded->getChunk(file2) != NULL);
+    delete pLoaded->take("dummy.file2");
+    CHECK(pLoaded->getChunk(file2) == NULL);
+    CHECK(pLoaded->hasChunk(Name("dummy.file")));
+
+    // Loading an archive doesn't intern its chunk names, only looking them up does.
+    std::size_t nNames = Name::count();
+    Archive::Ptr pPrefixed(Archive::loadArchive("dummy.ftsarc", "ChunksAreFoundByName/"));
+    CHECK_EQUAL(nNames, Name::count());
+    CHECK(pPrefixed->hasChunk(Name("ChunksAreFoundByName/dummy.file2")));
+}
@@ -175,4 +175,66 @@ TEST_INSUITE_WITHSETUP(dFile, File, copy_file_no_overwrite)
     CHECK_EQUAL("abcdef", in_data);
 
     fs::remove_all(cwd);
-}
\ No newline at end of file
+}
+class MappedFileSetup : public TestSetup {
+public:
+    void setup()
+    {
+        new MinimalLogger(1);
+
+        // A size that is a multiple of the page size, the data must be
+        // zero-terminated all the same.
+        auto f = ofstream("dummy.bigfile", ios::binary);
+        for(std::size_t i = 0 ; i < 2*File::MapThreshold ; ++i) {
+            f.put(static_cast<char>('a' + i % 26));
+        }
+    }
+    void teardown()
+    {
+        fs::remove("dummy.bigfile");
+        delete Logger::getSingletonPtr();
+    }
+protected:
+};
+
+TEST_INSUITE_WITHSETUP(dFile, MappedFile, open_read_maps_big_files)
+{
+    File::Ptr pFile = File::open("dummy.bigfile", File::Read);
+    CHECK(pFile->isMapped());
+    CHECK_EQUAL(2*File::MapThreshold, pFile->getSize());
+
+    const uint8_t* pData = pFile->getDataContainer().getData();
+    CHECK_EQUAL('a', pData[0]);
+    CHECK_EQUAL('a' + (2*File::MapThreshold - 1) % 26, pData[2*File::MapThreshold - 1]);
+    CHECK_EQUAL(0, pData[2*File::MapThreshold]);
+
+    pFile->setCursorPos(26);
+    CHECK_EQUAL('a', pFile->readui8());
+    CHECK_EQUAL('b', pFile->readui8());
+    CHECK(pFile->isMapped());
+
+    // Small files and files opened for writing are still read as a whole.
+    CHECK(!File::open("dummy.bigfile", File::Insert)->isMapped());
+    auto f = ofstream("dummy.bigfile", ios::binary | ios::trunc);
+    f << "0123456789";
+    f.close();
+    CHECK(!File::open("dummy.bigfile", File::Read)->isMapped());
+}
+
+TEST_INSUITE_WITHSETUP(dFile, MappedFile, mapped_file_copies_on_write)
+{
+    File::Ptr pFile = File::open("dummy.bigfile", File::Read);
+    CHECK(pFile->isMapped());
+
+    // Writing through the stream copies the data out of the mapping.
+    pFile->getStream()->setCursorPos(0);
+    pFile->getStream()->overwrite(static_cast<uint8_t>('Z'));
+    CHECK(!pFile->isMapped());
+    CHECK_EQUAL(2*File::MapThreshold, pFile->getSize());
+    CHECK_EQUAL('Z', pFile->getDataContainer().getData()[0]);
+    CHECK_EQUAL('b', pFile->getDataContainer().getData()[1]);
+
+    // The file on the disk stays untouched.
+    File::Ptr pOther = File::open("dummy.bigfile", File::Read);
+    CHECK_EQUAL('a', pOther->getDataContainer().getData()[0]);
+}
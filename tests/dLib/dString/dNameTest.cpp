@@ -0,0 +1,95 @@
+#include "dLib/aTest/TestHarness.h"
+
+#include "dLib/dString/dName.h"
+
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace FTS;
+
+SUITE(dName)
+
+TEST_INSUITE(dName, SameStringSameName)
+{
+    Name a("uModelViewMatrix");
+    Name b(String("uModelViewMatrix"));
+    Name c("uViewMatrix");
+
+    CHECK(a == b);
+    CHECK(a != c);
+    CHECK_EQUAL(a.id(), b.id());
+    CHECK(a.id() != c.id());
+    CHECK_EQUAL(a.hash(), b.hash());
+    CHECK_EQUAL(cstring_hash()(String("uModelViewMatrix")), a.hash());
+
+    // It's the very same string, not a copy.
+    CHECK_EQUAL(&a.str(), &b.str());
+    CHECK_EQUAL("uModelViewMatrix", a.str());
+}
+
+TEST_INSUITE(dName, EmptyName)
+{
+    Name empty;
+    CHECK(empty.empty());
+    CHECK(empty == Name(""));
+    CHECK(empty == Name(String()));
+    CHECK(!Name("x").empty());
+    CHECK_EQUAL("", empty.str());
+
+    // It is the very first name, there before anything else got interned.
+    CHECK_EQUAL(0u, empty.id());
+    CHECK(empty < Name("dNameTest.EmptyName"));
+}
+
+TEST_INSUITE(dName, InternsOnlyOnce)
+{
+    Name("dNameTest.InternsOnlyOnce");
+    std::size_t nNames = Name::count();
+    for(int i = 0 ; i < 10 ; ++i) {
+        Name("dNameTest.InternsOnlyOnce");
+    }
+    CHECK_EQUAL(nNames, Name::count());
+
+    Name first("dNameTest.InternsOnlyOnce.first");
+    Name second("dNameTest.InternsOnlyOnce.second");
+    CHECK_EQUAL(nNames + 2, Name::count());
+    CHECK(first < second);
+}
+
+TEST_INSUITE(dName, AsKey)
+{
+    std::unordered_map<Name, int> m;
+    m[Name("one")] = 1;
+    m[Name("two")] = 2;
+    m[Name(String("o") + "ne")] += 10;
+
+    CHECK_EQUAL(2, m.size());
+    CHECK_EQUAL(11, m[Name("one")]);
+    CHECK(m.find(Name("three")) == m.end());
+}
+
+TEST_INSUITE(dName, ThreadsGetTheSameNames)
+{
+    static const std::size_t nThreads = 4;
+    static const std::size_t nNames = 200;
+
+    std::vector<std::vector<Name>> names(nThreads);
+    std::vector<std::thread> threads;
+    for(std::size_t t = 0 ; t < nThreads ; ++t) {
+        threads.push_back(std::thread([&names, t]() {
+            for(std::size_t i = 0 ; i < nNames ; ++i) {
+                names[t].push_back(Name("dNameTest.Thread." + String::nr(i)));
+            }
+        }));
+    }
+    for(auto i = threads.begin() ; i != threads.end() ; ++i) {
+        i->join();
+    }
+
+    for(std::size_t t = 1 ; t < nThreads ; ++t) {
+        for(std::size_t i = 0 ; i < nNames ; ++i) {
+            CHECK(names[0][i] == names[t][i]);
+        }
+    }
+}
@@ -1,5 +1,7 @@
 #include "dLib/aTest/TestHarness.h"
 
+#include <chrono>
+#include <cmath>
 #include <iostream>
 #include <limits>
 #include <iomanip>
@@ -937,3 +939,175 @@ TEST_INSUITE(dString, Empty)
 }
 
 
+
+TEST_INSUITE(dString, MetricsFollowChanges)
+{
+    FTS::String s("Hello");
+    CHECK_EQUAL(5, s.len());
+    s += ", World";
+    CHECK_EQUAL(12, s.len());
+    s += FTS::String(" ที่รัก");
+    CHECK_EQUAL(19, s.len());
+    CHECK_EQUAL(31, s.byteCount());
+    s = FTS::String("abc") + FTS::String("def");
+    CHECK_EQUAL(6, s.len());
+    CHECK_EQUAL('e', s.getCharAt(4));
+    s[4] = 'x';
+    CHECK_EQUAL("abcdxf", s.str());
+    s.removeChar(0);
+    CHECK_EQUAL(5, s.len());
+    s.addChar(5, '!');
+    CHECK_EQUAL("bcdxf!", s.str());
+    s.replaceStr(1, 2, "é");
+    CHECK_EQUAL("béxf!", s.str());
+    CHECK_EQUAL(5, s.len());
+    CHECK_EQUAL('x', s.getCharAt(2));
+
+    // A copy knows it as well, and the cut-outs have to be right either way.
+    FTS::String ascii("Beautiful World!");
+    CHECK_EQUAL(16, ascii.len());
+    FTS::String copy(ascii);
+    CHECK_EQUAL(16, copy.len());
+    CHECK_EQUAL("Beau", copy.left(4).str());
+    CHECK_EQUAL("World!", copy.right(6).str());
+    CHECK_EQUAL("ful", copy.mid(6, 7).str());
+    CHECK_EQUAL("", copy.mid(16, 0).str());
+    CHECK_EQUAL("World!", FTS::String(copy, 10).str());
+    CHECK_EQUAL("", FTS::String(copy, 20, 2).str());
+
+    // Like before, everything behind a 0 doesn't count.
+    FTS::String zero(std::string("ab\0cd", 5));
+    CHECK_EQUAL(2, zero.len());
+    CHECK_EQUAL("ab", zero.left(3).str());
+}
+
+TEST_INSUITE(dString, NrIsLikeAStream)
+{
+    const std::ios_base::fmtflags flags[] = {std::ios::dec, std::ios::hex, std::ios::oct,
+                                             std::ios::dec | std::ios::left, std::ios::hex | std::ios::right,
+                                             std::ios::dec | std::ios::showpos, std::ios::hex | std::ios::uppercase | std::ios::showbase};
+    const int64_t values[] = {0, 1, -1, 42, -1234567, std::numeric_limits<int32_t>::max(), std::numeric_limits<int64_t>::min()};
+    for(std::ios_base::fmtflags f : flags) {
+        for(int64_t v : values) {
+            for(std::streamsize w : {0, 1, 12}) {
+                std::stringstream i32, i64, u16;
+                i32.width(w); i32.fill('.'); i32.flags(f); i32 << (int)static_cast<int32_t>(v);
+                i64.width(w); i64.fill('.'); i64.flags(f); i64 << (long long)v;
+                u16.width(w); u16.fill('.'); u16.flags(f); u16 << (unsigned short)static_cast<uint16_t>(v);
+                CHECK_EQUAL(i32.str(), FTS::String::nr(static_cast<int32_t>(v), w, '.', f).str());
+                CHECK_EQUAL(i64.str(), FTS::String::nr(v, w, '.', f).str());
+                CHECK_EQUAL(u16.str(), FTS::String::nr(static_cast<uint16_t>(v), w, '.', f).str());
+            }
+        }
+    }
+
+    const double doubles[] = {0.0, -0.0, 0.5, -2.25, 1.0/3.0, 123456.789, 1e20, 1e300, -1e-10};
+    for(double d : doubles) {
+        for(std::streamsize p : {-1, 0, 2, 10}) {
+            for(std::ios_base::fmtflags f : {std::ios::fixed | std::ios::right, std::ios::fixed | std::ios::left, std::ios::scientific}) {
+                std::stringstream ds, fs;
+                if(p != -1) {
+                    ds.precision(p);
+                    fs.precision(p);
+                }
+                ds.width(15); ds.fill('_'); ds.flags(f); ds << d;
+                fs.width(15); fs.fill('_'); fs.flags(f); fs << static_cast<float>(d);
+                CHECK_EQUAL(ds.str(), FTS::String::nr(d, p, 15, '_', f).str());
+                // Too big for a float, it would be infinity.
+                if(std::abs(d) < 1e30) {
+                    CHECK_EQUAL(fs.str(), FTS::String::nr(static_cast<float>(d), p, 15, '_', f).str());
+                }
+            }
+        }
+    }
+
+    // The numbers are known to be one byte per character.
+    CHECK_EQUAL(4, (FTS::String::nr(12) + FTS::String::nr(34)).len());
+}
+
+namespace {
+    /// How String::nr used to do it.
+    FTS::String oldNr(int i)
+    {
+        std::stringstream out;
+        out.width(0);
+        out.fill(' ');
+        out.flags(std::ios::dec);
+        out << i;
+        return FTS::String(out.str());
+    }
+
+    /// How String::len and getCharAt used to do it, walking the string from
+    /// the start every time, over \a in_n characters or all of them.
+    const char* oldWalk(const FTS::String& s, std::size_t in_n, std::size_t& out_len)
+    {
+        const char* p = s.c_str();
+        for(out_len = 0 ; *p && out_len < in_n ; ++out_len) {
+            if(!(*p & 0x80)) p++;
+            else if((*p & 0xF0) == 0xC0 && (*(p+1) & 0xC0) == 0x80) p += 2;
+            else if((*p & 0xF0) == 0xE0 && (*(p+1) & 0xC0) == 0x80) p += 3;
+            else if((*p & 0xF0) == 0xF0 && (*(p+1) & 0xC0) == 0x80) p += 4;
+            else p++;
+        }
+        return p;
+    }
+
+    std::size_t oldLen(const FTS::String& s)
+    {
+        std::size_t len = 0;
+        oldWalk(s, std::numeric_limits<std::size_t>::max(), len);
+        return len;
+    }
+
+    unsigned char oldCharAt(const FTS::String& s, std::size_t i)
+    {
+        if(s.empty() || i >= oldLen(s))
+            return 0;
+        std::size_t len = 0;
+        return *oldWalk(s, i, len);
+    }
+}
+
+TEST_INSUITE(dString, benchmark_nr_and_len)
+{
+    // This is a micro-benchmark rather than a real test.
+    typedef std::chrono::steady_clock clock;
+    auto us = [](clock::duration d) {return std::chrono::duration_cast<std::chrono::microseconds>(d).count();};
+    const int nMessages = 100000;
+
+    // Logging: lines glued together out of text and numbers.
+    std::size_t nOld = 0, nNew = 0;
+    auto t0 = clock::now();
+    for(int i = 0 ; i < nMessages ; ++i) {
+        FTS::String s = "Loaded " + oldNr(i) + " of " + oldNr(nMessages) + " chunks in " + oldNr(i % 97) + "ms";
+        nOld += oldLen(s);
+    }
+    auto t1 = clock::now();
+    for(int i = 0 ; i < nMessages ; ++i) {
+        FTS::String s = "Loaded " + FTS::String::nr(i) + " of " + FTS::String::nr(nMessages) + " chunks in " + FTS::String::nr(i % 97) + "ms";
+        nNew += s.len();
+    }
+    auto t2 = clock::now();
+    CHECK_EQUAL(nOld, nNew);
+
+    // UI: a label is laid out character by character, asking its length every time.
+    FTS::String label("Welcome to Arkana-FTS, please choose a server from the list below or enter its address.");
+    nOld = nNew = 0;
+    auto t3 = clock::now();
+    for(int n = 0 ; n < 200 ; ++n) {
+        for(std::size_t i = 0 ; i < oldLen(label) ; ++i) {
+            nOld += oldCharAt(label, i);
+        }
+    }
+    auto t4 = clock::now();
+    for(int n = 0 ; n < 200 ; ++n) {
+        for(std::size_t i = 0 ; i < label.len() ; ++i) {
+            nNew += label.getCharAt(i);
+        }
+    }
+    auto t5 = clock::now();
+    CHECK_EQUAL(nOld, nNew);
+
+    std::cerr << std::endl << "      [String, old/new: " << nMessages << " log lines " << us(t1 - t0) << "us/" << us(t2 - t1) << "us, "
+              << "label layout " << us(t4 - t3) << "us/" << us(t5 - t4) << "us]" << std::endl;
+}
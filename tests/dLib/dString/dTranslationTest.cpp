@@ -3,7 +3,7 @@
 #include <ciso646>
 
 #include "dLib/dString/dString.h"
-#include "dLib/dConf/configuration.h"
+#include "dLib/dConf/ConfigurationStore.h"
 #include "dLib/dString/dTranslation.h"
 #include "logging/ftslogger.h"
 
@@ -88,3 +88,42 @@ TEST_INSUITE(dTranslation, message_unknown)
     CHECK_EQUAL("", trans.get("UnitTestUnknown"));
 }
 
+
+TEST_INSUITE(dTranslation, TablesAreShared)
+{
+    Translation trans1("ui");
+    Translation trans2("ui");
+    trans1.setNoLogging();
+
+    CHECK(trans1.find("Msg_Err") != nullptr);
+    CHECK(trans1.find("Msg_Err") == trans2.find("Msg_Err"));
+    CHECK(trans1.find("UnitTestUnknown") == nullptr);
+}
+
+TEST_INSUITE(dTranslation, BinaryCache)
+{
+    Path sCacheDir = Path::userdir("TranslationCacheTest");
+    Path sCacheFile = sCacheDir + Path(ConfigurationStore::getSingleton().getMainConf()->get<string>("Language")) + Path("messages.bin");
+    Translation::setCacheDir(sCacheDir);
+    Translation::unloadAll();
+
+    // The first one compiles the XML files and writes the cache.
+    String sFromXML = Translation("messages").get("EnterRlv");
+    CHECK(FileUtils::fileExists(sCacheFile));
+
+    // The next one reads it from the cache.
+    Translation::unloadAll();
+    CHECK_EQUAL(sFromXML, Translation("messages").get("EnterRlv"));
+    CHECK_EQUAL("This is for testing.", Translation("messages").get("UnitTest"));
+
+    // A broken cache is just ignored and written again.
+    File::Ptr pBroken = File::overwrite(sCacheFile, File::Insert);
+    pBroken->write("Not a cache");
+    pBroken->save();
+    Translation::unloadAll();
+    CHECK_EQUAL(sFromXML, Translation("messages").get("EnterRlv"));
+
+    Translation::setCacheDir(Path());
+    Translation::unloadAll();
+    FileUtils::rmdir(sCacheDir);
+}
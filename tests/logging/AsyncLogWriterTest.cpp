@@ -0,0 +1,161 @@
+#include "dLib/aTest/TestHarness.h"
+
+#include "logging/AsyncLogWriter.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <experimental/filesystem>
+
+using namespace FTS;
+using namespace std;
+namespace fs = std::experimental::filesystem;
+
+SUITE(AsyncLog);
+
+namespace {
+    const char* LogFileName = "asynclog.test";
+
+    vector<string> readLines()
+    {
+        vector<string> lines;
+        ifstream f(LogFileName);
+        for(string sLine ; getline(f, sLine) ; ) {
+            lines.push_back(sLine);
+        }
+        return lines;
+    }
+}
+
+class LogFileSetup : public TestSetup {
+public:
+    void setup()
+    {
+    }
+    void teardown()
+    {
+        fs::remove(LogFileName);
+    }
+};
+
+TEST_INSUITE_WITHSETUP(AsyncLog, LogFile, WritesStampedAndRawLines)
+{
+    AsyncLogWriter writer(fopen(LogFileName, "w"), 16, std::chrono::hours(1));
+    time_t now = time(nullptr);
+    writer.push("doing something");
+    writer.push("Done\n");
+    writer.push("FTS: Error: bad !\n", now);
+    writer.push("no newline", now);
+    writer.flush();
+
+    // Flushed, even though the interval is nowhere near.
+    vector<string> lines = readLines();
+    CHECK_EQUAL(3u, lines.size());
+    CHECK_EQUAL("doing somethingDone", lines[0]);
+    CHECK_EQUAL(AsyncLogWriter::timestamp(now) + "FTS: Error: bad !", lines[1]);
+    CHECK_EQUAL(AsyncLogWriter::timestamp(now) + "no newline", lines[2]);
+    CHECK_EQUAL(23u, AsyncLogWriter::timestamp(now).size());
+}
+
+TEST_INSUITE_WITHSETUP(AsyncLog, LogFile, ManyThreadsKeepTheirOrder)
+{
+    const int nThreads = 4;
+    const int nLines = 5000;
+    {
+        // A tiny ring, so that the producers have to wait for the writer a lot.
+        AsyncLogWriter writer(fopen(LogFileName, "w"), 8, std::chrono::milliseconds(0));
+        vector<thread> threads;
+        for(int t = 0 ; t < nThreads ; ++t) {
+            threads.push_back(thread([&writer, t, nLines]() {
+                for(int i = 0 ; i < nLines ; ++i) {
+                    writer.push(to_string(t) + " " + to_string(i) + "\n");
+                }
+            }));
+        }
+        for(auto& t : threads) {
+            t.join();
+        }
+    } // Destroying the writer writes everything.
+
+    vector<string> lines = readLines();
+    CHECK_EQUAL(static_cast<size_t>(nThreads * nLines), lines.size());
+
+    vector<int> next(nThreads, 0);
+    bool bInOrder = true;
+    for(const string& sLine : lines) {
+        int t = -1, i = -1;
+        istringstream(sLine) >> t >> i;
+        if(t < 0 || t >= nThreads || next[t] != i) {
+            bInOrder = false;
+            break;
+        }
+        next[t]++;
+    }
+    CHECK(bInOrder);
+}
+
+TEST_INSUITE_WITHSETUP(AsyncLog, LogFile, FlushesWithinTheInterval)
+{
+    AsyncLogWriter writer(fopen(LogFileName, "w"), 16, std::chrono::milliseconds(20));
+    writer.push("soon\n");
+
+    for(int i = 0 ; i < 200 && readLines().empty() ; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    CHECK_EQUAL(1u, readLines().size());
+}
+
+TEST_INSUITE_WITHSETUP(AsyncLog, LogFile, WritesOnCrash)
+{
+    AsyncLogWriter writer(fopen(LogFileName, "w"), 16, std::chrono::hours(1));
+    writer.push("written before\n");
+    writer.push("last words", time(nullptr));
+
+    // Whether the writer thread got to them yet or not, they're not in the
+    // file as the interval is nowhere near, but a crash gets them out.
+    CHECK_EQUAL(0u, readLines().size());
+    writer.writeOnCrash();
+
+    vector<string> lines = readLines();
+    CHECK_EQUAL(2u, lines.size());
+    CHECK_EQUAL("written before", lines[0]);
+    CHECK(lines[1].size() > 10 && lines[1].substr(lines[1].size() - 10) == "last words");
+}
+
+TEST_INSUITE_WITHSETUP(AsyncLog, LogFile, benchmark_log_100k_lines)
+{
+    // This is a micro-benchmark rather than a real test: how long the logging
+    // thread is busy, writing and flushing itself versus handing over.
+    const int nLines = 100000;
+    string sLine = "  Loading the model Data/Models/Some/Thing.fts3d for the 1234th time.\n";
+    time_t now = time(nullptr);
+
+    FILE* pSync = fopen(LogFileName, "w");
+    auto t0 = std::chrono::steady_clock::now();
+    for(int i = 0 ; i < nLines ; ++i) {
+        fputs(AsyncLogWriter::timestamp(now).c_str(), pSync);
+        fputs(sLine.c_str(), pSync);
+        fflush(pSync);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    fclose(pSync);
+
+    std::chrono::steady_clock::time_point t2, t3;
+    {
+        AsyncLogWriter writer(fopen(LogFileName, "w"));
+        t2 = std::chrono::steady_clock::now();
+        for(int i = 0 ; i < nLines ; ++i) {
+            writer.push(sLine, now);
+        }
+        t3 = std::chrono::steady_clock::now();
+    }
+
+    auto us = [](std::chrono::steady_clock::duration d) {return std::chrono::duration_cast<std::chrono::microseconds>(d).count();};
+    std::cerr << std::endl << "      [100k log lines on the logging thread: fprintf+fflush " << us(t1 - t0)
+              << "us, push " << us(t3 - t2) << "us]" << std::endl;
+    CHECK_EQUAL(static_cast<size_t>(nLines), readLines().size());
+}
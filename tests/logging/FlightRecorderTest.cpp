@@ -0,0 +1,138 @@
+#include "dLib/aTest/TestHarness.h"
+
+#include "logging/FlightRecorder.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <experimental/filesystem>
+
+using namespace FTS;
+using namespace std;
+namespace fs = std::experimental::filesystem;
+
+SUITE(Flight);
+
+namespace {
+    const char* DumpFileName = "flight.test";
+
+    /// \return The lines of the decoded dump, without the summary line.
+    vector<string> decodeDump()
+    {
+        ifstream dump(DumpFileName, ios::binary);
+        ostringstream text;
+        vector<string> lines;
+        if(!FlightRecorder::decode(dump, text))
+            return lines;
+
+        istringstream in(text.str());
+        string sLine;
+        getline(in, sLine);
+        while(getline(in, sLine)) {
+            lines.push_back(sLine);
+        }
+        return lines;
+    }
+
+    bool contains(const string& in_s, const string& in_sPart)
+    {
+        return in_s.find(in_sPart) != string::npos;
+    }
+}
+
+class DumpFileSetup : public TestSetup {
+public:
+    void setup()
+    {
+    }
+    void teardown()
+    {
+        fs::remove(DumpFileName);
+    }
+};
+
+TEST_INSUITE_WITHSETUP(Flight, DumpFile, DecodesWhatHasBeenRecorded)
+{
+    FlightRecorder::record(FlightEvent::Frame, 42, 16667);
+    FlightRecorder::recordText(FlightEvent::RunlevelEnter, "A runlevel with a way too long name");
+    std::thread([]() {FlightRecorder::record(FlightEvent::FileOpened, 7, 123, 1);}).join();
+    CHECK(FlightRecorder::dump(DumpFileName));
+
+    vector<string> lines = decodeDump();
+    CHECK(lines.size() >= 3u);
+    if(lines.size() < 3u)
+        return;
+
+    // The newest ones are at the end, in the order they were recorded.
+    const string& sFrame = lines[lines.size() - 3];
+    const string& sRlv = lines[lines.size() - 2];
+    const string& sFile = lines[lines.size() - 1];
+    CHECK(contains(sFrame, "General") && contains(sFrame, "Frame") && contains(sFrame, "frame=42 us=16667"));
+    CHECK(contains(sRlv, "Runlevel") && contains(sRlv, "'A runlevel with a way to'"));
+    CHECK(contains(sFile, "File") && contains(sFile, "request=7 us=123 failed=1"));
+
+    // That one came from another thread.
+    CHECK(sFrame.substr(sFrame.find('T'), 4) != sFile.substr(sFile.find('T'), 4));
+}
+
+TEST_INSUITE_WITHSETUP(Flight, DumpFile, KeepsTheNewestRecords)
+{
+    const int64_t nRecords = FlightRecorder::Capacity + 100;
+    for(int64_t i = 0 ; i < nRecords ; ++i) {
+        FlightRecorder::record(FlightEvent::ChunkLoaded, i, 0);
+    }
+    CHECK(FlightRecorder::dump(DumpFileName));
+
+    vector<string> lines = decodeDump();
+    CHECK_EQUAL(static_cast<size_t>(FlightRecorder::Capacity), lines.size());
+
+    bool bInOrder = true;
+    for(size_t i = 0 ; i < lines.size() ; ++i) {
+        int64_t iExpected = nRecords - static_cast<int64_t>(lines.size()) + static_cast<int64_t>(i);
+        bInOrder = bInOrder && contains(lines[i], "bytes=" + to_string(iExpected) + " ");
+    }
+    CHECK(bInOrder);
+}
+
+TEST_INSUITE_WITHSETUP(Flight, DumpFile, RejectsWhatIsNoDump)
+{
+    ofstream(DumpFileName) << "This is no flight recorder dump, but it's long enough to be one.";
+    ifstream dump(DumpFileName, ios::binary);
+    ostringstream text;
+    CHECK(!FlightRecorder::decode(dump, text));
+}
+
+TEST_INSUITE_WITHSETUP(Flight, DumpFile, RejectsABrokenRecordCount)
+{
+    FlightRecorder::record(FlightEvent::Frame, 1, 2);
+    CHECK(FlightRecorder::dump(DumpFileName));
+
+    // The count comes right after the magic, the version and the record size.
+    {
+        fstream dump(DumpFileName, ios::binary | ios::in | ios::out);
+        dump.seekp(8 + 4 + 4);
+        const uint64_t nRecords = UINT64_MAX / 2;
+        dump.write(reinterpret_cast<const char*>(&nRecords), sizeof(nRecords));
+    }
+    ifstream dump(DumpFileName, ios::binary);
+    ostringstream text;
+    CHECK(!FlightRecorder::decode(dump, text));
+}
+
+TEST_INSUITE(Flight, benchmark_record_1M)
+{
+    // This is a micro-benchmark rather than a real test: what recording costs.
+    const int n = 1000000;
+    auto t0 = std::chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; ++i) {
+        FlightRecorder::record(FlightEvent::Frame, i, 16667);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+    std::cerr << std::endl << "      [1M flight records: " << ns / 1000
+              << "us, " << ns / n << "ns per record]" << std::endl;
+}
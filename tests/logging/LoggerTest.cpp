@@ -0,0 +1,107 @@
+#include "dLib/aTest/TestHarness.h"
+
+#include "logging/MinimalLogger.h"
+#include <chrono>
+#include <iostream>
+
+using namespace FTS;
+
+SUITE(DebugLog);
+
+namespace {
+    int nFormatted = 0;
+
+    /// Something that is expensive to turn into text.
+    struct Expensive {
+        int i;
+    };
+
+    String logArg(const Expensive& in_e)
+    {
+        nFormatted++;
+        return "expensive " + String::nr(in_e.i);
+    }
+
+    /// Remembers the debug messages instead of printing them.
+    class RecordingLogger : public MinimalLogger {
+    public:
+        int nMessages = 0;
+        String sLast;
+
+        RecordingLogger(int in_iDbgLv) : MinimalLogger(in_iDbgLv) {}
+
+        int messageDbg(const String &in_pszMsg, int in_iDbgLv,
+                       const String &in_sArg1, const String &in_sArg2,
+                       const String &in_sArg3, const String &in_sArg4,
+                       const String &in_sArg5, const String &in_sArg6,
+                       const String &in_sArg7, const String &in_sArg8,
+                       const String &in_sArg9)
+        {
+            nMessages++;
+            sLast = this->formatMessageDbg(in_pszMsg, in_iDbgLv, in_sArg1, in_sArg2, in_sArg3,
+                                           in_sArg4, in_sArg5, in_sArg6, in_sArg7, in_sArg8, in_sArg9);
+            return ERR_OK;
+        }
+    };
+}
+
+class RecordingSetup : public TestSetup {
+public:
+    void setup()
+    {
+        nFormatted = 0;
+        new RecordingLogger(2);
+    }
+    void teardown()
+    {
+        delete Logger::getSingletonPtr();
+    }
+};
+
+TEST_INSUITE_WITHSETUP(DebugLog, Recording, FilteredDebugMessagesAreNotFormatted)
+{
+    RecordingLogger& log = dynamic_cast<RecordingLogger&>(Logger::getSingleton());
+
+    FTSMSGDBG("Reading {1} with size {2}", 3, Expensive{1}, 42);
+    CHECK_EQUAL(0, nFormatted);
+    CHECK_EQUAL(0, log.nMessages);
+
+    FTSMSGDBG("Reading {1} with size {2}", 2, Expensive{1}, 42);
+    CHECK_EQUAL(1, nFormatted);
+    CHECK_EQUAL(1, log.nMessages);
+    CHECK_EQUAL("Reading expensive 1 with size 42", log.sLast);
+
+    // Everything that used to be glued together by hand.
+    FTSMSGDBG("{1} {2} {3} {4} {5} {6} {7}", 1, String("a"), "b", std::string("c"), 'd', true, -1.5, static_cast<uint64_t>(7));
+    CHECK_EQUAL("a b c d True -1.500000 7", log.sLast);
+
+    // The old way still works, and is filtered too.
+    FTSMSGDBG(String("Old {1}"), 3, String("way"));
+    CHECK_EQUAL(2, log.nMessages);
+    FTSMSGDBG(String("Old {1}"), 1, String("way"));
+    CHECK_EQUAL("Old way", log.sLast);
+}
+
+TEST_INSUITE_WITHSETUP(DebugLog, Recording, benchmark_filtered_debug_messages)
+{
+    // This is a micro-benchmark rather than a real test: a million debug
+    // messages nobody is going to see.
+    const int n = 1000000;
+    String sName = "Data/Models/Some/Thing.fts3d";
+    uint64_t uiSize = 123456;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; ++i) {
+        FTSMSGDBG("Reading chunk '"+sName+"' with size "+String::nr(uiSize), 3);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; ++i) {
+        FTSMSGDBG("Reading chunk '{1}' with size {2}", 3, sName, uiSize);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    auto us = [](std::chrono::steady_clock::duration d) {return std::chrono::duration_cast<std::chrono::microseconds>(d).count();};
+    std::cerr << std::endl << "      [1M filtered debug messages: glued " << us(t1 - t0)
+              << "us, deferred " << us(t2 - t1) << "us]" << std::endl;
+    CHECK_EQUAL(0, dynamic_cast<RecordingLogger&>(Logger::getSingleton()).nMessages);
+}
@@ -0,0 +1,230 @@
+#include "dLib/aTest/TestHarness.h"
+
+#include "logging/PerfCounters.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <experimental/filesystem>
+
+using namespace FTS;
+using namespace std;
+namespace fs = std::experimental::filesystem;
+
+SUITE(Counters);
+
+namespace {
+    const char* CsvFileName = "perfcounters.test.csv";
+
+    /// \return Whether the counter was there during the last frame.
+    bool findCounter(const char* in_pszName, PerfCounterValue& out_value)
+    {
+        vector<PerfCounterValue> values = PerfCounters::getLastFrame();
+        auto i = std::find_if(values.begin(), values.end(), [in_pszName](const PerfCounterValue& v) {
+            return std::strcmp(v.pszName, in_pszName) == 0;
+        });
+        if(i == values.end())
+            return false;
+
+        out_value = *i;
+        return true;
+    }
+
+    vector<string> splitCsv(const string& in_sLine)
+    {
+        vector<string> cells;
+        istringstream in(in_sLine);
+        string sCell;
+        while(getline(in, sCell, ',')) {
+            cells.push_back(sCell);
+        }
+        return cells;
+    }
+
+    /// \return The cell of \a in_sColumn in \a in_line, empty if there is none.
+    string csvCell(const vector<string>& in_header, const vector<string>& in_line, const string& in_sColumn)
+    {
+        auto i = std::find(in_header.begin(), in_header.end(), in_sColumn);
+        std::size_t idx = static_cast<std::size_t>(i - in_header.begin());
+        return idx < in_line.size() ? in_line[idx] : string();
+    }
+}
+
+TEST_INSUITE(Counters, CountersCountPerFrame)
+{
+    PerfCounter c("Test.counter");
+    PerfCounters::frame();
+
+    c.add();
+    c.add(3);
+    PerfCounters::frame();
+
+    PerfCounterValue v;
+    CHECK(findCounter("Test.counter", v));
+    CHECK_EQUAL(PerfCounter::Counter, v.kind);
+    CHECK_EQUAL(4, v.iValue);
+    CHECK_EQUAL(4, v.iTotal);
+
+    // Nothing happened during the next frame.
+    PerfCounters::frame();
+    CHECK(findCounter("Test.counter", v));
+    CHECK_EQUAL(0, v.iValue);
+    CHECK_EQUAL(4, v.iTotal);
+}
+
+TEST_INSUITE(Counters, GaugesKeepTheirValue)
+{
+    PerfCounter g("Test.gauge", PerfCounter::Gauge);
+    g.add(5);
+    g.sub(2);
+    PerfCounters::frame();
+
+    PerfCounterValue v;
+    CHECK(findCounter("Test.gauge", v));
+    CHECK_EQUAL(3, v.iValue);
+
+    PerfCounters::frame();
+    CHECK(findCounter("Test.gauge", v));
+    CHECK_EQUAL(3, v.iValue);
+
+    g.set(7);
+    PerfCounters::frame();
+    CHECK(findCounter("Test.gauge", v));
+    CHECK_EQUAL(7, v.iValue);
+}
+
+TEST_INSUITE(Counters, HistogramsSummarizeTheFrame)
+{
+    PerfCounter h("Test.histogram", PerfCounter::Histogram);
+    h.sample(2);
+    h.sample(9);
+    h.sample(4);
+    PerfCounters::frame();
+
+    PerfCounterValue v;
+    CHECK(findCounter("Test.histogram", v));
+    CHECK_EQUAL(3, v.iValue);
+    CHECK_EQUAL(3, v.iTotal);
+    CHECK_EQUAL(2, v.iMin);
+    CHECK_EQUAL(9, v.iMax);
+    CHECK_EQUAL(5.0, v.dMean);
+
+    // Each frame starts from scratch.
+    h.sample(1);
+    PerfCounters::frame();
+    CHECK(findCounter("Test.histogram", v));
+    CHECK_EQUAL(1, v.iValue);
+    CHECK_EQUAL(4, v.iTotal);
+    CHECK_EQUAL(1, v.iMin);
+    CHECK_EQUAL(1, v.iMax);
+    CHECK_EQUAL(1.0, v.dMean);
+}
+
+TEST_INSUITE(Counters, PullsCountersFromElsewhere)
+{
+    int64_t iTotal = 10;
+    PerfCounter c("Test.pulled", [&iTotal]() {return iTotal;});
+    PerfCounters::frame();
+
+    iTotal = 15;
+    PerfCounters::frame();
+
+    PerfCounterValue v;
+    CHECK(findCounter("Test.pulled", v));
+    CHECK_EQUAL(5, v.iValue);
+    CHECK_EQUAL(15, v.iTotal);
+}
+
+TEST_INSUITE(Counters, DestroyedCountersAreGone)
+{
+    {
+        PerfCounter c("Test.gone");
+        PerfCounters::frame();
+
+        PerfCounterValue v;
+        CHECK(findCounter("Test.gone", v));
+    }
+    PerfCounters::frame();
+
+    PerfCounterValue v;
+    CHECK(!findCounter("Test.gone", v));
+}
+
+class CsvFileSetup : public TestSetup {
+public:
+    void setup()
+    {
+    }
+    void teardown()
+    {
+        PerfCounters::stopCsv();
+        fs::remove(CsvFileName);
+    }
+};
+
+TEST_INSUITE_WITHSETUP(Counters, CsvFile, WritesTheCsvFile)
+{
+    PerfCounter c("Test.csv");
+    PerfCounter h("Test.csvSize", PerfCounter::Histogram);
+    CHECK(PerfCounters::startCsv(CsvFileName, std::chrono::milliseconds(0)));
+
+    c.add(2);
+    h.sample(4);
+    h.sample(6);
+    PerfCounters::frame();
+    c.add(1);
+    PerfCounters::frame();
+    PerfCounters::stopCsv();
+
+    ifstream csv(CsvFileName);
+    string sHeader, sLine1, sLine2;
+    CHECK(static_cast<bool>(getline(csv, sHeader)));
+    CHECK(static_cast<bool>(getline(csv, sLine1)));
+    CHECK(static_cast<bool>(getline(csv, sLine2)));
+
+    vector<string> header = splitCsv(sHeader);
+    vector<string> line1 = splitCsv(sLine1);
+    vector<string> line2 = splitCsv(sLine2);
+    CHECK_EQUAL(header.size(), line1.size());
+    CHECK_EQUAL("seconds", header[0]);
+    CHECK_EQUAL("1", csvCell(header, line1, "frames"));
+    CHECK_EQUAL("2", csvCell(header, line1, "Test.csv"));
+    CHECK_EQUAL("2", csvCell(header, line1, "Test.csvSize.count"));
+    CHECK_EQUAL("5.000", csvCell(header, line1, "Test.csvSize.mean"));
+    CHECK_EQUAL("6", csvCell(header, line1, "Test.csvSize.max"));
+
+    CHECK_EQUAL("1", csvCell(header, line2, "Test.csv"));
+    CHECK_EQUAL("0", csvCell(header, line2, "Test.csvSize.count"));
+}
+
+TEST_INSUITE(Counters, CsvFileCanFail)
+{
+    CHECK(!PerfCounters::startCsv("this/directory/does/not/exist.csv", std::chrono::milliseconds(0)));
+}
+
+TEST_INSUITE(Counters, benchmark_count_10M)
+{
+    // This is a micro-benchmark rather than a real test: what counting an
+    // event costs in the hot paths.
+    const int n = 10000000;
+    PerfCounter c("Test.benchmark");
+    auto t0 = std::chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; ++i) {
+        c.add();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    PerfCounters::frame();
+
+    PerfCounterValue v;
+    CHECK(findCounter("Test.benchmark", v));
+    CHECK_EQUAL(static_cast<int64_t>(n), v.iValue);
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+    std::cerr << std::endl << "      [10M counted events: " << ns / 1000
+              << "us, " << static_cast<double>(ns) / n << "ns per event]" << std::endl;
+}
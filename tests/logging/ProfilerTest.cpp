@@ -0,0 +1,143 @@
+#include "dLib/aTest/TestHarness.h"
+
+#include "logging/Profiler.h"
+
+#if D_PROFILE
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace FTS;
+using namespace std;
+
+SUITE(Profile);
+
+namespace {
+    void spin(std::chrono::microseconds in_duration)
+    {
+        auto end = std::chrono::steady_clock::now() + in_duration;
+        while(std::chrono::steady_clock::now() < end) {
+        }
+    }
+
+    ProfileZoneStats findZone(const char* in_pszName)
+    {
+        vector<ProfileZoneStats> stats = Profiler::getLastFrame();
+        auto i = std::find_if(stats.begin(), stats.end(), [in_pszName](const ProfileZoneStats& z) {
+            return string(z.pszName) == in_pszName;
+        });
+        return i == stats.end() ? ProfileZoneStats{in_pszName, 0, 0, 0} : *i;
+    }
+
+    bool contains(const string& in_s, const string& in_sPart)
+    {
+        return in_s.find(in_sPart) != string::npos;
+    }
+}
+
+TEST_INSUITE(Profile, NestedZonesAreSummedUpPerFrame)
+{
+    FTS_PROFILE_FRAME();
+    uint64_t nFrames = Profiler::getFrameCount();
+    {
+        FTS_PROFILE_SCOPE("Test::outer");
+        spin(std::chrono::microseconds(200));
+        for(int i = 0 ; i < 2 ; ++i) {
+            FTS_PROFILE_SCOPE("Test::inner");
+            spin(std::chrono::microseconds(300));
+        }
+    }
+    FTS_PROFILE_FRAME();
+
+    CHECK_EQUAL(nFrames + 1, Profiler::getFrameCount());
+    ProfileZoneStats outer = findZone("Test::outer");
+    ProfileZoneStats inner = findZone("Test::inner");
+    CHECK_EQUAL(1u, outer.nCalls);
+    CHECK_EQUAL(2u, inner.nCalls);
+    CHECK(inner.uiTotalNs >= 600000u);
+    CHECK_EQUAL(inner.uiTotalNs, inner.uiSelfNs);
+    CHECK(outer.uiTotalNs >= 800000u);
+    CHECK_EQUAL(outer.uiTotalNs - inner.uiTotalNs, outer.uiSelfNs);
+    CHECK(Profiler::getLastFrameNs() >= outer.uiTotalNs);
+
+    // The next frame starts from scratch.
+    FTS_PROFILE_FRAME();
+    CHECK_EQUAL(0u, findZone("Test::outer").nCalls);
+}
+
+TEST_INSUITE(Profile, CapturesAChromeTrace)
+{
+    FTS_PROFILE_FRAME();
+    Profiler::startCapture();
+    CHECK(Profiler::isCapturing());
+    {
+        FTS_PROFILE_SCOPE("Test::\"quoted\"");
+        std::thread([]() {
+            FTS_PROFILE_THREAD("Test worker");
+            FTS_PROFILE_SCOPE("Test::worker");
+        }).join();
+    }
+    FTS_PROFILE_FRAME();
+    {
+        FTS_PROFILE_SCOPE("Test::second frame");
+    }
+    FTS_PROFILE_FRAME();
+
+    ostringstream trace;
+    CHECK_EQUAL(3u, Profiler::stopCapture(trace));
+    CHECK(!Profiler::isCapturing());
+
+    string s = trace.str();
+    CHECK_EQUAL(0u, s.find("{\"displayTimeUnit\":\"ns\""));
+    CHECK(contains(s, "\"name\":\"Test::\\\"quoted\\\"\",\"cat\":\"fts\",\"ph\":\"X\""));
+    CHECK(contains(s, "\"name\":\"Test::worker\""));
+    CHECK(contains(s, "\"name\":\"Test::second frame\""));
+    CHECK(contains(s, "\"args\":{\"name\":\"Test worker\"}"));
+    CHECK(contains(s, "\"droppedEvents\":0"));
+    CHECK_EQUAL("]}\n", s.substr(s.size() - 3));
+
+    // The worker's zone counts into the frame it ended in.
+    CHECK_EQUAL(0u, findZone("Test::worker").nCalls);
+}
+
+TEST_INSUITE(Profile, CaptureDropsWhatIsTooMuch)
+{
+    FTS_PROFILE_FRAME();
+    Profiler::startCapture(string(), 2);
+    for(int i = 0 ; i < 5 ; ++i) {
+        FTS_PROFILE_SCOPE("Test::many");
+    }
+    FTS_PROFILE_FRAME();
+
+    // They are all in the stats, but only two in the trace.
+    CHECK_EQUAL(5u, findZone("Test::many").nCalls);
+    ostringstream trace;
+    CHECK_EQUAL(2u, Profiler::stopCapture(trace));
+    CHECK(contains(trace.str(), "\"droppedEvents\":3"));
+}
+
+TEST_INSUITE(Profile, benchmark_profile_1M_zones)
+{
+    // This is a micro-benchmark rather than a real test: what a zone costs,
+    // including summing it up at the end of the frame.
+    const int n = 1000000;
+    FTS_PROFILE_FRAME();
+    auto t0 = std::chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; ++i) {
+        FTS_PROFILE_SCOPE("Test::benchmark");
+        if(i % 1000 == 999)
+            FTS_PROFILE_FRAME();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    FTS_PROFILE_FRAME();
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+    std::cerr << std::endl << "      [1M profiled zones: " << ns / 1000
+              << "us, " << ns / n << "ns per zone]" << std::endl;
+}
+
+#endif // D_PROFILE
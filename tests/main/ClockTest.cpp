@@ -3,6 +3,7 @@
 #include "dLib/aTest/TestHarness.h"
 
 #include <chrono>
+#include <cmath>
 #include <thread>
 
 #include "main/Clock.h"
@@ -114,3 +115,60 @@ TEST_INSUITE( ClockTests, currentTime )
     CHECK( ( expected - actual ) < 0.01 );
 }
 
+
+TEST_INSUITE( ClockTests, simulationStepsAreFixed )
+{
+    SimulationClock c( 50, 5 );
+    CHECK_DOUBLES_EQUAL( 0.02, c.getStep() );
+
+    for ( int i = 0; i < 10; ++i )
+    {
+        c.tick();
+        CHECK_DOUBLES_EQUAL( 0.02, c.getDeltaT() );
+    }
+    CHECK_DOUBLES_EQUAL( 0.2, c.getCurrentTime() );
+}
+
+TEST_INSUITE( ClockTests, simulationCatchesUp )
+{
+    SimulationClock c( 100, 5 );
+
+    // Not enough for a step yet, but it piles up.
+    CHECK_EQUAL( 0, c.accumulate( 0.004 ) );
+    CHECK( std::abs( c.getAlpha() - 0.4 ) < 1e-6 );
+    CHECK_EQUAL( 1, c.accumulate( 0.008 ) );
+    CHECK( std::abs( c.getAlpha() - 0.2 ) < 1e-6 );
+    c.tick();
+
+    CHECK_EQUAL( 3, c.accumulate( 0.03 ) );
+    CHECK( std::abs( c.getAlpha() - 0.2 ) < 1e-6 );
+    for ( int i = 0; i < 3; ++i )
+        c.tick();
+    CHECK( std::abs( c.getCurrentTime() - 0.04 ) < 1e-6 );
+
+    auto toNext = std::chrono::duration< double >( c.getTimeToNextStep() ).count();
+    CHECK( std::abs( toNext - 0.008 ) < 1e-6 );
+    CHECK_EQUAL( 0, c.getDroppedSteps() );
+}
+
+TEST_INSUITE( ClockTests, simulationDropsTooManySteps )
+{
+    SimulationClock c( 100, 5 );
+
+    // Half a second is way too much for one frame, the rest is dropped.
+    CHECK_EQUAL( 5, c.accumulate( 0.505 ) );
+    CHECK_EQUAL( 45, c.getDroppedSteps() );
+    CHECK( std::abs( c.getAlpha() - 0.5 ) < 1e-6 );
+    for ( int i = 0; i < 5; ++i )
+        c.tick();
+
+    // And there's no debt left for the next frame.
+    CHECK_EQUAL( 0, c.accumulate( 0.0 ) );
+    CHECK( std::abs( c.getCurrentTime() - 0.05 ) < 1e-6 );
+}
+
+TEST_INSUITE( ClockTests, realClockIsUpToDate )
+{
+    Clock c;
+    CHECK_DOUBLES_EQUAL( 1.0, c.getAlpha() );
+}
@@ -0,0 +1,309 @@
+#include "dLib/aTest/TestHarness.h"
+
+#include "main/JobSystem.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace FTS;
+
+SUITE(Jobs);
+
+TEST_INSUITE(Jobs, RunsAllJobs)
+{
+    JobSystem jobs(3);
+    JobCounter counter;
+    std::atomic<int> nDone(0);
+    for(int i = 0 ; i < 1000 ; ++i) {
+        jobs.run([&nDone]() {nDone++;}, &counter);
+    }
+    jobs.wait(counter);
+
+    CHECK(counter.isDone());
+    CHECK_EQUAL(1000, nDone.load());
+}
+
+TEST_INSUITE(Jobs, RunsWithoutWorkers)
+{
+    // The main thread does all of them while it waits.
+    JobSystem jobs(0);
+    JobCounter counter;
+    int nDone = 0;
+    for(int i = 0 ; i < 100 ; ++i) {
+        jobs.run([&nDone]() {nDone++;}, &counter);
+    }
+    CHECK_EQUAL(0, nDone);
+
+    jobs.wait(counter);
+    CHECK_EQUAL(100, nDone);
+}
+
+TEST_INSUITE(Jobs, ParallelForCoversEveryItemOnce)
+{
+    JobSystem jobs(3);
+    const std::size_t nItems = 10007;
+    std::vector<std::atomic<int>> hits(nItems);
+    for(auto& h : hits) {
+        h = 0;
+    }
+
+    jobs.parallelFor(nItems, 0, [&hits](std::size_t in_iBegin, std::size_t in_iEnd) {
+        for(std::size_t i = in_iBegin ; i < in_iEnd ; ++i) {
+            hits[i]++;
+        }
+    });
+
+    int nWrong = 0;
+    for(auto& h : hits) {
+        if(h.load() != 1)
+            nWrong++;
+    }
+    CHECK_EQUAL(0, nWrong);
+
+    // Not a single item is nothing to do.
+    bool bCalled = false;
+    jobs.parallelFor(0, 0, [&bCalled](std::size_t, std::size_t) {bCalled = true;});
+    CHECK(!bCalled);
+}
+
+TEST_INSUITE(Jobs, ParallelForComputesEveryItem)
+{
+    JobSystem jobs(3);
+    const std::size_t nItems = 1 << 16;
+    std::vector<std::uint64_t> out(nItems, 0);
+    jobs.parallelFor(nItems, 100, [&out](std::size_t in_iBegin, std::size_t in_iEnd) {
+        for(std::size_t i = in_iBegin ; i < in_iEnd ; ++i) {
+            out[i] = static_cast<std::uint64_t>(i) * i + 1;
+        }
+    });
+
+    std::size_t nWrong = 0;
+    for(std::size_t i = 0 ; i < nItems ; ++i) {
+        if(out[i] != static_cast<std::uint64_t>(i) * i + 1)
+            nWrong++;
+    }
+    CHECK_EQUAL(0, nWrong);
+    CHECK_EQUAL(1, out[0]);
+    CHECK_EQUAL(static_cast<std::uint64_t>(nItems - 1) * (nItems - 1) + 1, out[nItems - 1]);
+}
+
+TEST_INSUITE(Jobs, ParallelForRethrowsTheFirstRange)
+{
+    JobSystem jobs(3);
+    for(int iRun = 0 ; iRun < 20 ; ++iRun) {
+        std::string sError;
+        try {
+            jobs.parallelFor(64, 1, [](std::size_t in_iBegin, std::size_t) {
+                if(in_iBegin % 10 == 3)
+                    throw std::runtime_error(std::to_string(in_iBegin));
+            });
+        } catch(const std::runtime_error& e) {
+            sError = e.what();
+        }
+        CHECK_EQUAL("3", sError);
+    }
+}
+
+TEST_INSUITE(Jobs, DependentJobsRunAfter)
+{
+    JobSystem jobs(3);
+    JobCounter first, second;
+    std::atomic<int> nFirstDone(0);
+    std::atomic<int> nSeenTooEarly(0);
+
+    // Keep the first jobs busy, so that the second ones really have to wait.
+    for(int i = 0 ; i < 8 ; ++i) {
+        jobs.run([&nFirstDone]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            nFirstDone++;
+        }, &first);
+    }
+    for(int i = 0 ; i < 8 ; ++i) {
+        jobs.run([&nFirstDone, &nSeenTooEarly]() {
+            if(nFirstDone.load() != 8)
+                nSeenTooEarly++;
+        }, &second, &first);
+    }
+    jobs.wait(second);
+
+    CHECK(first.isDone());
+    CHECK_EQUAL(0, nSeenTooEarly.load());
+
+    // Once the counter is done, they start right away.
+    bool bRan = false;
+    jobs.run([&bRan]() {bRan = true;}, &second, &first);
+    jobs.wait(second);
+    CHECK(bRan);
+}
+
+TEST_INSUITE(Jobs, MainThreadJobsStayOnTheMainThread)
+{
+    JobSystem jobs(3);
+    JobCounter counter;
+    std::thread::id mainThread = std::this_thread::get_id();
+    std::atomic<int> nElsewhere(0);
+
+    // Also when they are started by a worker.
+    jobs.run([&]() {
+        for(int i = 0 ; i < 10 ; ++i) {
+            jobs.run([&]() {
+                if(std::this_thread::get_id() != mainThread)
+                    nElsewhere++;
+            }, &counter, nullptr, JobSystem::MainThread);
+        }
+    }, &counter);
+
+    jobs.wait(counter);
+    CHECK_EQUAL(0, nElsewhere.load());
+
+    // And once per frame, they are done without waiting.
+    bool bRan = false;
+    jobs.run([&bRan]() {bRan = true;}, nullptr, nullptr, JobSystem::MainThread);
+    CHECK_EQUAL(1, jobs.runMainThreadJobs());
+    CHECK(bRan);
+    CHECK_EQUAL(0, jobs.runMainThreadJobs());
+}
+
+TEST_INSUITE(Jobs, WaitRethrows)
+{
+    JobSystem jobs(2);
+    JobCounter counter;
+    std::atomic<int> nDone(0);
+    for(int i = 0 ; i < 20 ; ++i) {
+        jobs.run([i, &nDone]() {
+            nDone++;
+            if(i == 7)
+                throw std::runtime_error("job 7");
+        }, &counter);
+    }
+
+    bool bThrown = false;
+    try {
+        jobs.wait(counter);
+    } catch(const std::runtime_error& e) {
+        bThrown = std::string(e.what()) == "job 7";
+    }
+    CHECK(bThrown);
+    // All the others still have been done.
+    CHECK_EQUAL(20, nDone.load());
+
+    // The error has been reported, the counter is good to be used again.
+    jobs.run([]() {}, &counter);
+    jobs.wait(counter);
+}
+
+TEST_INSUITE(Jobs, WaitWakesUpForMainThreadJobs)
+{
+    // The main thread has nothing to do but wait while the worker runs, until
+    // the worker needs it for a main thread job.
+    JobSystem jobs(1);
+    JobCounter counter;
+    std::thread::id mainJobThread;
+    jobs.run([&jobs, &counter, &mainJobThread]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        jobs.run([&mainJobThread]() {mainJobThread = std::this_thread::get_id();}, &counter, nullptr, JobSystem::MainThread);
+    }, &counter);
+    jobs.wait(counter);
+    CHECK(mainJobThread == std::this_thread::get_id());
+}
+
+TEST_INSUITE(Jobs, NestedParallelFor)
+{
+    // Workers waiting for their inner loop help, instead of blocking.
+    JobSystem jobs(3);
+    std::atomic<int> nItems(0);
+    jobs.parallelFor(16, 1, [&](std::size_t in_iBegin, std::size_t in_iEnd) {
+        for(std::size_t i = in_iBegin ; i < in_iEnd ; ++i) {
+            jobs.parallelFor(100, 10, [&nItems](std::size_t in_iB, std::size_t in_iE) {
+                nItems += static_cast<int>(in_iE - in_iB);
+            });
+        }
+    });
+    CHECK_EQUAL(1600, nItems.load());
+}
+
+TEST_INSUITE(Jobs, JobsFromForeignThreads)
+{
+    JobSystem jobs(2);
+    JobCounter counter;
+    std::atomic<int> nDone(0);
+    std::thread other([&]() {
+        for(int i = 0 ; i < 100 ; ++i) {
+            jobs.run([&nDone]() {nDone++;}, &counter);
+        }
+    });
+    other.join();
+    jobs.wait(counter);
+    CHECK_EQUAL(100, nDone.load());
+}
+
+TEST_INSUITE(Jobs, ParallelForRangesWithoutJobSystem)
+{
+    CHECK(JobSystem::getSingletonPtr() == nullptr);
+
+    std::vector<std::pair<std::size_t, std::size_t>> ranges;
+    parallelForRanges(50, 4, [&ranges](std::size_t in_iBegin, std::size_t in_iEnd) {
+        ranges.push_back(std::make_pair(in_iBegin, in_iEnd));
+    });
+    CHECK_EQUAL(1, ranges.size());
+    CHECK_EQUAL(0, ranges[0].first);
+    CHECK_EQUAL(50, ranges[0].second);
+
+    JobSystem jobs(1);
+    std::atomic<std::size_t> nItems(0);
+    parallelForRanges(50, 4, [&nItems](std::size_t in_iBegin, std::size_t in_iEnd) {
+        nItems += in_iEnd - in_iBegin;
+    });
+    CHECK_EQUAL(50, nItems.load());
+
+    // At most that many ranges, and the job system decides without a limit.
+    CHECK_EQUAL(13, rangeGrain(50, 4));
+    CHECK_EQUAL(1, rangeGrain(3, 8));
+    CHECK_EQUAL(0, rangeGrain(50, 0));
+}
+
+TEST_INSUITE(Jobs, benchmark_scalability)
+{
+    // This is a micro-benchmark rather than a real test: how a loop of small
+    // independent items scales with the number of threads.
+    const std::size_t nItems = 1 << 21;
+    std::vector<float> out(nItems);
+
+    std::size_t nCores = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    std::vector<std::size_t> threadCounts = {1, 2, 4};
+    if(nCores > 4)
+        threadCounts.push_back(nCores);
+
+    double dSingle = 0.0;
+    std::cerr << std::endl << "      [" << nItems << " items on " << nCores << " cores:";
+    for(std::size_t nThreads : threadCounts) {
+        JobSystem jobs(nThreads - 1);
+
+        auto t0 = std::chrono::steady_clock::now();
+        for(int iRun = 0 ; iRun < 4 ; ++iRun) {
+            jobs.parallelFor(nItems, 0, [&out, iRun](std::size_t in_iBegin, std::size_t in_iEnd) {
+                for(std::size_t i = in_iBegin ; i < in_iEnd ; ++i) {
+                    float f = static_cast<float>(i + iRun);
+                    out[i] = std::sqrt(f) * std::sin(f) + std::cos(f * 0.5f);
+                }
+            });
+        }
+        auto t1 = std::chrono::steady_clock::now();
+
+        double dMs = std::chrono::duration<double, std::milli>(t1 - t0).count() / 4.0;
+        if(nThreads == 1)
+            dSingle = dMs;
+        std::cerr << " " << nThreads << "T " << dMs << "ms (x" << dSingle / dMs
+                  << ", " << jobs.getSteals() << " steals)";
+    }
+    std::cerr << "]" << std::endl;
+
+    CHECK(out[nItems - 1] == out[nItems - 1]);
+}
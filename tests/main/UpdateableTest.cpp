@@ -0,0 +1,298 @@
+#include "dLib/aTest/TestHarness.h"
+
+#include "main/Updateable.h"
+#include "main/JobSystem.h"
+#include "main/Clock.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace FTS;
+
+SUITE(Updates);
+
+namespace {
+    /// Does whatever it's told and unregisters itself when it dies.
+    class TestUpdateable : public Updateable {
+    public:
+        TestUpdateable(Phase in_phase, bool in_bThreadSafe = false, const char* in_pszName = nullptr)
+            : m_phase(in_phase)
+            , m_bThreadSafe(in_bThreadSafe)
+            , nUpdates(0)
+            , bKeep(true)
+        {
+            if(in_pszName)
+                h = UpdateableManager::getSingleton().add(Name(in_pszName), this);
+            else
+                h = UpdateableManager::getSingleton().add(this);
+        }
+
+        virtual ~TestUpdateable()
+        {
+            UpdateableManager::getSingleton().rem(h);
+        }
+
+        virtual bool update(const Clock&)
+        {
+            nUpdates++;
+            if(onUpdate)
+                onUpdate();
+            return bKeep;
+        }
+
+        virtual Phase getUpdatePhase() const {return m_phase;};
+        virtual bool isUpdateThreadSafe() const {return m_bThreadSafe;};
+
+    private:
+        Phase m_phase;
+        bool m_bThreadSafe;
+
+    public:
+        UpdateableManager::Handle h;
+        std::atomic<int> nUpdates;
+        bool bKeep;
+        std::function<void()> onUpdate;
+    };
+}
+
+TEST_INSUITE(Updates, PhasesComeInOrder)
+{
+    std::vector<int> order;
+    TestUpdateable render(Updateable::PreRender);
+    TestUpdateable input(Updateable::Input, false, "Test input");
+    TestUpdateable anim(Updateable::Animation);
+    TestUpdateable sim(Updateable::Simulation, false, "Test simulation");
+    TestUpdateable rlv(Updateable::Runlevels);
+    render.onUpdate = [&order]() {order.push_back(Updateable::PreRender);};
+    input.onUpdate = [&order]() {order.push_back(Updateable::Input);};
+    anim.onUpdate = [&order]() {order.push_back(Updateable::Animation);};
+    sim.onUpdate = [&order]() {order.push_back(Updateable::Simulation);};
+    rlv.onUpdate = [&order]() {order.push_back(Updateable::Runlevels);};
+
+    Clock c;
+    UpdateableManager::getSingleton().doUpdates(c);
+
+    CHECK_EQUAL(5, order.size());
+    CHECK_EQUAL(Updateable::Input, order[0]);
+    CHECK_EQUAL(Updateable::Runlevels, order[1]);
+    CHECK_EQUAL(Updateable::Simulation, order[2]);
+    CHECK_EQUAL(Updateable::Animation, order[3]);
+    CHECK_EQUAL(Updateable::PreRender, order[4]);
+
+    // What the main thread updates when the simulation runs apart.
+    order.clear();
+    UpdateableManager::getSingleton().doUpdates(c, Updateable::Input, Updateable::Runlevels);
+    CHECK_EQUAL(2, order.size());
+    CHECK_EQUAL(Updateable::Runlevels, order[1]);
+}
+
+TEST_INSUITE(Updates, FinishedOnesAreRemoved)
+{
+    TestUpdateable once(Updateable::Simulation);
+    TestUpdateable onceNamed(Updateable::Animation, true, "Test once");
+    once.bKeep = false;
+    onceNamed.bKeep = false;
+
+    Clock c;
+    UpdateableManager::getSingleton().doUpdates(c);
+    UpdateableManager::getSingleton().doUpdates(c);
+
+    CHECK_EQUAL(1, once.nUpdates.load());
+    CHECK_EQUAL(1, onceNamed.nUpdates.load());
+}
+
+TEST_INSUITE(Updates, ChangesWaitForTheEndOfThePhase)
+{
+    Clock c;
+    std::unique_ptr<TestUpdateable> pVictim, pNewcomer, pLateNewcomer;
+    bool bVictimUpdated = false;
+
+    // The killer comes first, it has been added first.
+    TestUpdateable killer(Updateable::Simulation, false, "Test killer");
+    pVictim.reset(new TestUpdateable(Updateable::Simulation));
+    pVictim->onUpdate = [&bVictimUpdated]() {bVictimUpdated = true;};
+    killer.onUpdate = [&]() {
+        if(pVictim) {
+            pVictim.reset();
+            pNewcomer.reset(new TestUpdateable(Updateable::Simulation));
+            pLateNewcomer.reset(new TestUpdateable(Updateable::PreRender));
+        }
+    };
+
+    UpdateableManager::getSingleton().doUpdates(c);
+
+    // Already deleted, it mustn't be updated anymore.
+    CHECK(!pVictim);
+    CHECK(!bVictimUpdated);
+    // Its phase was running, it starts next frame. The other one's phase
+    // only came after.
+    CHECK_EQUAL(0, pNewcomer->nUpdates.load());
+    CHECK_EQUAL(1, pLateNewcomer->nUpdates.load());
+
+    UpdateableManager::getSingleton().doUpdates(c);
+    CHECK_EQUAL(1, pNewcomer->nUpdates.load());
+    CHECK_EQUAL(2, pLateNewcomer->nUpdates.load());
+}
+
+TEST_INSUITE(Updates, ThreadSafeOnesRunInParallel)
+{
+    JobSystem jobs(3);
+    Clock c;
+
+    std::vector<std::unique_ptr<TestUpdateable>> items;
+    for(int i = 0 ; i < 200 ; ++i) {
+        items.push_back(std::unique_ptr<TestUpdateable>(new TestUpdateable(Updateable::Animation, true)));
+        items.back()->bKeep = i % 2 == 0;
+    }
+
+    // And one removes another one from a worker.
+    std::atomic<bool> bRemoved(false);
+    items[0]->onUpdate = [&]() {
+        if(!bRemoved.exchange(true))
+            UpdateableManager::getSingleton().rem(items[2].get());
+    };
+
+    UpdateableManager::getSingleton().doUpdates(c);
+    UpdateableManager::getSingleton().doUpdates(c);
+
+    int nWrong = 0;
+    for(int i = 0 ; i < 200 ; ++i) {
+        if(i == 2)
+            continue;
+        if(items[i]->nUpdates.load() != (i % 2 == 0 ? 2 : 1))
+            nWrong++;
+    }
+    CHECK_EQUAL(0, nWrong);
+    CHECK(items[2]->nUpdates.load() <= 1);
+}
+
+TEST_INSUITE(Updates, HandlesStayUnique)
+{
+    UpdateableManager& mgr = UpdateableManager::getSingleton();
+    std::size_t nBefore = mgr.count();
+
+    std::unique_ptr<TestUpdateable> pFirst(new TestUpdateable(Updateable::Simulation));
+    UpdateableManager::Handle hFirst = pFirst->h;
+    CHECK(hFirst != UpdateableManager::InvalidHandle);
+    CHECK_EQUAL(nBefore + 1, mgr.count());
+    pFirst.reset();
+    CHECK_EQUAL(nBefore, mgr.count());
+
+    // The slot is used again, but the old handle doesn't stand for the new one.
+    TestUpdateable second(Updateable::Simulation);
+    CHECK(second.h != hFirst);
+    mgr.rem(hFirst);
+    mgr.rem(hFirst);
+    CHECK_EQUAL(nBefore + 1, mgr.count());
+
+    Clock c;
+    mgr.doUpdates(c);
+    CHECK_EQUAL(1, second.nUpdates.load());
+}
+
+TEST_INSUITE(Updates, NamesAreOptional)
+{
+    UpdateableManager& mgr = UpdateableManager::getSingleton();
+    TestUpdateable anonymous(Updateable::Simulation);
+    CHECK(mgr.getName(anonymous.h).empty());
+
+    TestUpdateable debug(Updateable::Simulation);
+    mgr.rem(debug.h);
+    debug.h = mgr.add(&debug, Name("Test debug"));
+    CHECK_EQUAL(String("Test debug"), mgr.getName(debug.h).str());
+
+    // A named one replaces the one that had the name so far.
+    TestUpdateable first(Updateable::Simulation, false, "Test twice");
+    TestUpdateable second(Updateable::Simulation, false, "Test twice");
+    CHECK(mgr.getName(first.h).empty());
+    CHECK_EQUAL(String("Test twice"), mgr.getName(second.h).str());
+
+    Clock c;
+    mgr.doUpdates(c);
+    CHECK_EQUAL(0, first.nUpdates.load());
+    CHECK_EQUAL(1, second.nUpdates.load());
+
+    // And may be removed by name.
+    mgr.rem(Name("Test twice"));
+    mgr.doUpdates(c);
+    CHECK_EQUAL(1, second.nUpdates.load());
+    CHECK_EQUAL(2, debug.nUpdates.load());
+}
+
+TEST_INSUITE(Updates, benchmark_spawn_and_despawn)
+{
+    // This is a micro-benchmark rather than a real test: spawning and
+    // despawning many instances of the same model.
+    const int n = 20000;
+    std::vector<std::unique_ptr<TestUpdateable>> units;
+    units.reserve(n);
+
+    auto t0 = std::chrono::steady_clock::now();
+    for(int i = 0 ; i < n ; ++i) {
+        units.push_back(std::unique_ptr<TestUpdateable>(new TestUpdateable(Updateable::Animation, true)));
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    Clock c;
+    UpdateableManager::getSingleton().doUpdates(c);
+    auto t2 = std::chrono::steady_clock::now();
+    // Despawn every other one first, to mix the slots up.
+    for(int i = 0 ; i < n ; i += 2) {
+        units[i].reset();
+    }
+    units.clear();
+    auto t3 = std::chrono::steady_clock::now();
+
+    auto ns = [](std::chrono::steady_clock::duration d) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+    };
+    std::cerr << std::endl << "      [" << n << " units: " << ns(t1 - t0) / n << "ns per spawn, "
+              << ns(t2 - t1) / n << "ns per first update, " << ns(t3 - t2) / n << "ns per despawn]" << std::endl;
+}
+
+TEST_INSUITE(Updates, benchmark_animated_units)
+{
+    // This is a micro-benchmark rather than a real test: a few hundred
+    // animated units, updated one after the other and then in parallel.
+    const int nUnits = 400;
+    const int nFrames = 100;
+    Clock c;
+
+    std::vector<std::unique_ptr<TestUpdateable>> units;
+    std::vector<float> bones(nUnits * 64);
+    for(int iUnit = 0 ; iUnit < nUnits ; ++iUnit) {
+        units.push_back(std::unique_ptr<TestUpdateable>(new TestUpdateable(Updateable::Animation, true)));
+        float* pBones = &bones[iUnit * 64];
+        units.back()->onUpdate = [pBones]() {
+            for(int i = 0 ; i < 64 ; ++i) {
+                pBones[i] = std::sin(pBones[i] + 0.1f) * std::cos(static_cast<float>(i));
+            }
+        };
+    }
+
+    auto timeFrames = [&]() {
+        auto t0 = std::chrono::steady_clock::now();
+        for(int i = 0 ; i < nFrames ; ++i) {
+            UpdateableManager::getSingleton().doUpdates(c);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::micro>(t1 - t0).count() / nFrames;
+    };
+
+    double dSerial = timeFrames();
+    double dParallel = 0.0;
+    std::size_t nWorkers = 0;
+    {
+        JobSystem jobs;
+        nWorkers = jobs.getWorkerCount();
+        dParallel = timeFrames();
+    }
+
+    CHECK_EQUAL(2 * nFrames, units[0]->nUpdates.load());
+    std::cerr << std::endl << "      [" << nUnits << " units per frame: " << dSerial
+              << "us serial, " << dParallel << "us with " << nWorkers << " workers]" << std::endl;
+}
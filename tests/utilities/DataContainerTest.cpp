@@ -1,6 +1,9 @@
 #include "dLib/aTest/TestHarness.h"
 #include "utilities/DataContainer.h"
 #include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
 
 using namespace FTS;
 
@@ -165,4 +168,116 @@ TEST_INSUITE(DataContainerTests, for_each)
         ++td;
     }
 
-}
\ No newline at end of file
+}
+namespace {
+    /// The original scalar implementation, which the checksums in existing
+    /// archives have been calculated with.
+    uint32_t referenceFletcher32(const uint8_t *in_pData, size_t in_uiSize)
+    {
+        uint64_t uiToCompare = in_uiSize % 2;
+        uint64_t uiDataLen16Bit = in_uiSize/2;
+        const uint16_t *pData16Bit = reinterpret_cast<const uint16_t*>(in_pData);
+
+        uint32_t sum1 = 0xffff, sum2 = 0xffff;
+        while(uiDataLen16Bit > uiToCompare) {
+                uint64_t tlen = uiDataLen16Bit > 360 ? 360 : uiDataLen16Bit;
+                uiDataLen16Bit -= tlen;
+                do {
+                        sum1 += *pData16Bit++;
+                        sum2 += sum1;
+                } while (--tlen);
+                sum1 = (sum1 & 0xffff) + (sum1 >> 16);
+                sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+        }
+
+        if(uiToCompare > 0) {
+            sum1 += *(reinterpret_cast<const uint8_t*>(pData16Bit));
+            sum2 += sum1;
+            sum1 = (sum1 & 0xffff) + (sum1 >> 16);
+            sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+        }
+
+        sum1 = (sum1 & 0xffff) + (sum1 >> 16);
+        sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+        return sum2 << 16 | sum1;
+    }
+}
+
+TEST_INSUITE(DataContainerTests, fletcher32_matches_reference)
+{
+    // Lots of 0xff make the sums wrap around the most.
+    RawDataContainer container(64 * 1024 + 3);
+    uint32_t uiRand = 12345;
+    for(size_t i = 0 ; i < container.getSize() ; ++i) {
+        uiRand = uiRand * 1103515245 + 12345;
+        container.getData()[i] = (i % 3 == 0) ? 0xff : static_cast<uint8_t>(uiRand >> 16);
+    }
+
+    // All small sizes, sizes around the blocks of 360 words and big ones, at
+    // odd addresses too.
+    size_t sizes[] = {0, 1, 2, 3, 4, 5, 31, 32, 33, 719, 720, 721, 722, 723, 1441, 1443, 4096, 4097, 8191, 64 * 1024 + 1};
+    for(size_t uiSize : sizes) {
+        for(size_t uiOffset = 0 ; uiOffset < 2 ; ++uiOffset) {
+            const uint8_t *pData = container.getData() + uiOffset;
+            CHECK_EQUAL(referenceFletcher32(pData, uiSize), ConstRawDataContainer(pData, uiSize).fletcher32());
+        }
+    }
+
+    // All zero data gives sums of exactly 0xffff.
+    RawDataContainer zeros(1000);
+    memset(zeros.getData(), 0, zeros.getSize());
+    CHECK_EQUAL(referenceFletcher32(zeros.getData(), zeros.getSize()), zeros.fletcher32());
+    CHECK_EQUAL(0xffffffffu, RawDataContainer().fletcher32());
+}
+
+TEST_INSUITE(DataContainerTests, fletcher32_incremental)
+{
+    RawDataContainer container(10000);
+    for(size_t i = 0 ; i < container.getSize() ; ++i) {
+        container.getData()[i] = static_cast<uint8_t>(i * 7 + (i >> 8));
+    }
+
+    // Any split gives the same result, even into odd pieces.
+    size_t sizes[] = {1, 721 * 2 + 1, 5000, 9999, 10000};
+    for(size_t uiSize : sizes) {
+        uint32_t uiExpected = referenceFletcher32(container.getData(), uiSize);
+        size_t pieces[] = {1, 2, 3, 7, 64, 333, 1024};
+        for(size_t uiPiece : pieces) {
+            Fletcher32 f;
+            for(size_t uiDone = 0 ; uiDone < uiSize ; uiDone += uiPiece) {
+                f.update(container.getData() + uiDone, std::min(uiPiece, uiSize - uiDone));
+            }
+            CHECK_EQUAL(uiExpected, f.finalize());
+        }
+    }
+
+    // It can go on after looking at the checksum.
+    Fletcher32 f;
+    f.update(container.getData(), 100);
+    CHECK_EQUAL(referenceFletcher32(container.getData(), 100), f.finalize());
+    f.update(container.getData() + 100, 101);
+    CHECK_EQUAL(referenceFletcher32(container.getData(), 201), f.finalize());
+    f.reset();
+    CHECK_EQUAL(0xffffffffu, f.finalize());
+}
+
+TEST_INSUITE(DataContainerTests, benchmark_fletcher32_16MiB)
+{
+    // This is a micro-benchmark rather than a real test.
+    RawDataContainer container(16 * 1024 * 1024);
+    for(size_t i = 0 ; i < container.getSize() ; ++i) {
+        container.getData()[i] = static_cast<uint8_t>(i ^ (i >> 9));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint32_t uiReference = referenceFletcher32(container.getData(), container.getSize());
+    auto middle = std::chrono::steady_clock::now();
+    uint32_t uiNew = container.fletcher32();
+    auto end = std::chrono::steady_clock::now();
+
+    std::cerr << std::endl << "      [fletcher32 of 16MiB: scalar "
+              << std::chrono::duration_cast<std::chrono::microseconds>(middle - start).count() << "us, "
+              << Fletcher32::getImplementationName() << " "
+              << std::chrono::duration_cast<std::chrono::microseconds>(end - middle).count() << "us]" << std::endl;
+    CHECK_EQUAL(uiReference, uiNew);
+}
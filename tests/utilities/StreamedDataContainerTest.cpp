@@ -0,0 +1,126 @@
+#include "dLib/aTest/TestHarness.h"
+#include "utilities/DataContainer.h"
+#include "utilities/StreamedDataContainer.h"
+#include "dLib/dString/dString.h"
+#include <cstring>
+#include <chrono>
+#include <iostream>
+
+using namespace FTS;
+
+SUITE( StreamedDataContainerTests )
+
+TEST_INSUITE(StreamedDataContainerTests, insert_in_the_middle)
+{
+    StreamedDataContainer sdc;
+    sdc.insertNoEndian("abcdef", 6);
+    sdc.setCursorPos(2);
+    sdc.insertNoEndian("XYZ", 3);
+
+    CHECK_EQUAL(5, sdc.getCursorPos());
+    CHECK_EQUAL(9, sdc.getBoundDC()->getSize());
+    CHECK(memcmp("abXYZcdef", sdc.getBoundDC()->getData(), 9) == 0);
+    CHECK_EQUAL(0, sdc.getBoundDC()->getData()[9]);
+
+    // Inserting more than what is behind the cursor.
+    sdc.setCursorPos(8);
+    sdc.insertNoEndian("0123", 4);
+    CHECK_EQUAL(13, sdc.getBoundDC()->getSize());
+    CHECK(memcmp("abXYZcde0123f", sdc.getBoundDC()->getData(), 13) == 0);
+    CHECK_EQUAL(0, sdc.getBoundDC()->getData()[13]);
+}
+
+TEST_INSUITE(StreamedDataContainerTests, overwrite_past_the_end)
+{
+    StreamedDataContainer sdc;
+    sdc.insertNoEndian("abcdef", 6);
+    sdc.setCursorPos(4);
+    sdc.overwrite(reinterpret_cast<const void *>("WXYZ"), 1, 4);
+
+    CHECK_EQUAL(8, sdc.getBoundDC()->getSize());
+    CHECK(memcmp("abcdWXYZ", sdc.getBoundDC()->getData(), 8) == 0);
+    CHECK_EQUAL(0, sdc.getBoundDC()->getData()[8]);
+}
+
+TEST_INSUITE(StreamedDataContainerTests, many_values_round_trip)
+{
+    StreamedDataContainer sdc;
+    for(int32_t i = 0 ; i < 1000 ; ++i) {
+        sdc.insert(i);
+    }
+
+    // Prepend one in front of all the others.
+    sdc.setCursorPos(0);
+    sdc.insert(static_cast<int32_t>(-1));
+
+    sdc.setCursorPos(0);
+    CHECK_EQUAL(-1, sdc.read<int32_t>());
+    for(int32_t i = 0 ; i < 1000 ; ++i) {
+        CHECK_EQUAL(i, sdc.read<int32_t>());
+    }
+    CHECK(sdc.eod());
+}
+
+TEST_INSUITE(StreamedDataContainerTests, capacity_grows_geometrically)
+{
+    RawDataContainer container;
+    size_t nReallocs = 0;
+    size_t uiLastCapacity = container.getCapacity();
+    for(size_t i = 0 ; i < 100000 ; ++i) {
+        container.grow(4);
+        if(container.getCapacity() != uiLastCapacity) {
+            ++nReallocs;
+            uiLastCapacity = container.getCapacity();
+        }
+    }
+
+    CHECK_EQUAL(400000, container.getSize());
+    CHECK(container.getCapacity() >= container.getSize());
+    CHECK(nReallocs < 50);
+
+    // Shrinking keeps the memory around, but cuts the data.
+    container.resize(10);
+    CHECK_EQUAL(10, container.getSize());
+    CHECK_EQUAL(uiLastCapacity, container.getCapacity());
+    CHECK_EQUAL(0, container.getData()[10]);
+
+    container.reserve(1);
+    CHECK_EQUAL(uiLastCapacity, container.getCapacity());
+}
+
+TEST_INSUITE(StreamedDataContainerTests, benchmark_serialize_100k_fields)
+{
+    // This is a micro-benchmark rather than a real test: it serializes 100k
+    // fields the way savegames and archives are written.
+    auto start = std::chrono::steady_clock::now();
+
+    StreamedDataContainer sdc;
+    for(int32_t i = 0 ; i < 25000 ; ++i) {
+        sdc.insert(i);
+        sdc.insert(static_cast<double>(i) / 2.0);
+        sdc.insert(static_cast<uint8_t>(i % 256));
+        sdc.insert(String("field"));
+    }
+
+    auto append = std::chrono::steady_clock::now();
+
+    // And a header that gets written in front of everything, at the end.
+    sdc.setCursorPos(0);
+    for(int32_t i = 0 ; i < 100 ; ++i) {
+        sdc.insert(i);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    std::cerr << std::endl << "      [serializing 100k fields: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(append - start).count() << "us, "
+              << "100 prepends: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(end - append).count() << "us]" << std::endl;
+
+    CHECK_EQUAL(25000*(4+8+1+6) + 100*4, sdc.getBoundDC()->getSize());
+    sdc.setCursorPos(100*4 + 24999*(4+8+1+6));
+    CHECK_EQUAL(24999, sdc.read<int32_t>());
+    CHECK_DOUBLES_EQUAL(24999.0 / 2.0, sdc.read<double>());
+    CHECK_EQUAL(24999 % 256, sdc.read<uint8_t>());
+    CHECK_EQUAL("field", sdc.readstr());
+}
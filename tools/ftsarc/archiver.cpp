@@ -7,6 +7,10 @@
 #include <filesystem>
 
 #include "dLib/dCompressor/dCompressor.h"
+#include "main/JobSystem.h"
+
+#include <exception>
+#include <vector>
 
 using namespace FTSArc;
 using namespace FTS;
@@ -26,6 +30,9 @@ ArchiverBase::~ArchiverBase()
 
 bool ArchiverBase::addDirectoryRecursive(const FTS::Path& in_sDir)
 {
+    if(!fs::is_directory(in_sDir.c_str()))
+        return false;
+
     for(auto& p : fs::directory_iterator(in_sDir.c_str())) {
         if(fs::is_directory(p.path())) {
             // If it is a directory, recurse into it again.
@@ -90,44 +97,64 @@ int Archiver::execute()
         pArchive = Archive::createEmptyArchive(m_sOutName, m_pComp.get());
     }
 
-    FTSMSG("Archiving the following files: \n");
+    // Directories are replaced by the files they contain, which are appended
+    // to the list, so that only files remain.
+    std::vector<Path> files;
     for(FileList::iterator i = m_lFilesToHandle.begin() ; i != m_lFilesToHandle.end() ; ++i) {
-        // If the current entry is a directory and files were added because of
-        // recursing into the directory, we need to go to the next iterator.
-        if(this->addDirectoryRecursive(*i)) {
-            continue;
+        if(!this->addDirectoryRecursive(*i)) {
+            files.push_back(*i);
+        }
+    }
+
+    // Reading and compressing the files is what takes time, do it on all cores.
+    // Whatever fails is kept to be reported in order, together with the rest.
+    CompressorFactory::getSingleton();
+    std::vector<FileChunk*> chunks(files.size(), nullptr);
+    std::vector<std::exception_ptr> errors(files.size());
+    parallelForRanges(files.size(), rangeGrain(files.size(), Archive::getWorkerThreads()), [&](std::size_t in_iBegin, std::size_t in_iEnd) {
+        for(std::size_t i = in_iBegin ; i < in_iEnd ; ++i) {
+            try {
+                chunks[i] = new FileChunk(File::open(files[i], File::Read));
+            } catch(...) {
+                errors[i] = std::current_exception();
+            }
         }
+    });
 
-        FTSMSG(*i + "... ");
+    FTSMSG("Archiving the following files: \n");
+    for(std::size_t i = 0 ; i < files.size() ; ++i) {
+        FTSMSG(files[i] + "... ");
 
         try {
-            // It is a file, try to load it into memory.
-            File::Ptr pFile = File::open(*i, File::Read);
+            if(errors[i])
+                std::rethrow_exception(errors[i]);
 
             // If such a file is already present in the archive, ask if we should
             // overwrite it or ignore it.
-            if(pArchive->getChunk(pFile->getName()) != NULL) {
+            if(pArchive->getChunk(chunks[i]->getName()) != NULL) {
                 if(!m_bYesToAll) {
-                    FTSMSG(pFile->getName() + " is already present in the archive, overwrite it ? (y/n) ");
+                    FTSMSG(chunks[i]->getName() + " is already present in the archive, overwrite it ? (y/n) ");
                     std::string sAnswer;
                     std::cin >> sAnswer;
                     if(sAnswer[0] == 'y') {
                         // Remove the file from the archive.
-                        Chunk *pChk = pArchive->take(pFile->getName());
+                        Chunk *pChk = pArchive->take(chunks[i]->getName());
                         SAFE_DELETE(pChk);
                     } else {
                         FTSMSG("Skipping\n");
+                        SAFE_DELETE(chunks[i]);
                         continue;
                     }
                 } else {
                     // Remove the file from the archive.
-                    Chunk *pChk = pArchive->take(pFile->getName());
+                    Chunk *pChk = pArchive->take(chunks[i]->getName());
                     SAFE_DELETE(pChk);
                 }
             }
 
             // Not present in the archive yet, add it to the archive.
-            pArchive->give(new FileChunk(std::move(pFile)));
+            pArchive->give(chunks[i]);
+            chunks[i] = nullptr;
             FTSMSG("Done\n");
         } catch(const ArkanaException& e) {
             e.show();
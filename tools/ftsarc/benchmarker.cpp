@@ -0,0 +1,437 @@
+#include "benchmarker.h"
+#include "logging/logger.h"
+#include "dLib/dArchive/dArchive.h"
+#include "utilities/DataContainer.h"
+#include "utilities/StreamedDataContainer.h"
+
+#ifndef D_NOMINILZO
+#  include "dLib/dCompressor/blocklzo_compressor.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <experimental/filesystem>
+
+#if defined(_WIN32)
+#  include <windows.h>
+#  include <psapi.h>
+#endif
+
+using namespace FTSArc;
+using namespace FTS;
+namespace fs = std::experimental::filesystem;
+
+/// The block sizes and thread counts used if none are given.
+#define D_BENCH_BLOCK_SIZES {64*1024, 256*1024, 1024*1024}
+#define D_BENCH_RUNS 3
+
+namespace {
+
+/// Forgets the highest memory usage of the process so far, so that the next
+/// call to \a getPeakMemory only sees what comes after this call.
+/// \return The memory the process uses right now, -1 if unknown.
+std::int64_t resetPeakMemory()
+{
+#if defined(_WIN32)
+    // Windows can't forget the peak, the result may thus be too small.
+    PROCESS_MEMORY_COUNTERS pmc;
+    if(!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return -1;
+    return static_cast<std::int64_t>(pmc.WorkingSetSize);
+#elif defined(__linux__)
+    std::ofstream("/proc/self/clear_refs") << "5";
+
+    std::ifstream status("/proc/self/status");
+    for(std::string sLine ; std::getline(status, sLine) ; ) {
+        if(sLine.compare(0, 6, "VmRSS:") == 0)
+            return std::atoll(sLine.c_str() + 6) * 1024;
+    }
+    return -1;
+#else
+    return -1;
+#endif
+}
+
+/// \return The highest memory usage of the process since the last call to
+///         \a resetPeakMemory, -1 if unknown.
+std::int64_t getPeakMemory()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    if(!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return -1;
+    return static_cast<std::int64_t>(pmc.PeakWorkingSetSize);
+#elif defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    for(std::string sLine ; std::getline(status, sLine) ; ) {
+        if(sLine.compare(0, 6, "VmHWM:") == 0)
+            return std::atoll(sLine.c_str() + 6) * 1024;
+    }
+    return -1;
+#else
+    return -1;
+#endif
+}
+
+double seconds(std::chrono::steady_clock::duration in_d)
+{
+    return std::chrono::duration<double>(in_d).count();
+}
+
+/// \return The number of megabytes per second, 0 if no time was needed.
+double mbPerSec(std::uint64_t in_uiBytes, double in_dSeconds)
+{
+    return in_dSeconds > 0.0 ? static_cast<double>(in_uiBytes) / (1024.0 * 1024.0) / in_dSeconds : 0.0;
+}
+
+/// Fills up a string with spaces on the left or the right.
+String pad(const String& in_s, std::size_t in_uiWidth, bool in_bLeft = false)
+{
+    String sPad;
+    for(std::size_t i = in_s.len() ; i < in_uiWidth ; ++i) {
+        sPad += " ";
+    }
+    return in_bLeft ? sPad + in_s : in_s + sPad;
+}
+
+String jsonString(const String& in_s)
+{
+    String sRet = "\"";
+    for(std::size_t i = 0 ; i < in_s.byteCount() ; ++i) {
+        char c = in_s.c_str()[i];
+        if(c == '"' || c == '\\') {
+            sRet += "\\";
+        }
+        sRet += String::chr(c);
+    }
+    return sRet + "\"";
+}
+
+} // anonymous namespace
+
+Benchmarker::Benchmarker()
+    : m_blockSizes(D_BENCH_BLOCK_SIZES)
+    , m_nRuns(D_BENCH_RUNS)
+{
+    m_threadCounts.push_back(1);
+    std::uint32_t nCores = std::thread::hardware_concurrency();
+    if(nCores > 1)
+        m_threadCounts.push_back(nCores);
+}
+
+Benchmarker::~Benchmarker()
+{
+}
+
+/// \param in_sizes The block sizes to run the block compressors at.
+void Benchmarker::setBlockSizes(const std::vector<std::uint32_t>& in_sizes)
+{
+    m_blockSizes = in_sizes;
+}
+
+/// \param in_counts The thread counts to run the block compressors with.
+void Benchmarker::setThreadCounts(const std::vector<std::uint32_t>& in_counts)
+{
+    m_threadCounts = in_counts;
+}
+
+/// \param in_nRuns How often to repeat every measurement, the best one counts.
+void Benchmarker::setRuns(std::uint32_t in_nRuns)
+{
+    m_nRuns = std::max<std::uint32_t>(in_nRuns, 1);
+}
+
+/// \param in_sFile Where to write the results as JSON to, "-" for stdout.
+void Benchmarker::setJSONFile(const Path& in_sFile)
+{
+    m_sJSONFile = in_sFile;
+}
+
+/** Parses a comma separated list of numbers, like the block sizes given on the
+ *  command line. A number may end in k or m for kilo- or megabytes.
+ *
+ * \param in_sList The list to parse, for example "64k,256k,1m".
+ * \param out_list Receives the numbers.
+ *
+ * \return true if all of the list could be parsed into positive numbers.
+ */
+bool Benchmarker::parseList(const String& in_sList, std::vector<std::uint32_t>& out_list)
+{
+    out_list.clear();
+
+    const char *p = in_sList.c_str();
+    while(*p != '\0') {
+        char *pEnd = NULL;
+        unsigned long ul = std::strtoul(p, &pEnd, 10);
+        if(pEnd == p || ul == 0)
+            return false;
+
+        if(*pEnd == 'k' || *pEnd == 'K') {
+            ul *= 1024;
+            ++pEnd;
+        } else if(*pEnd == 'm' || *pEnd == 'M') {
+            ul *= 1024 * 1024;
+            ++pEnd;
+        }
+
+        if(*pEnd == ',') {
+            ++pEnd;
+        } else if(*pEnd != '\0') {
+            return false;
+        }
+
+        out_list.push_back(static_cast<std::uint32_t>(ul));
+        p = pEnd;
+    }
+
+    return !out_list.empty();
+}
+
+/** Loads the data to benchmark with: every file of a directory (recursively),
+ *  every file of an archive or a single file.
+ *
+ * \param in_sPath The directory, archive or file to load.
+ *
+ * \return true if something could be loaded.
+ */
+bool Benchmarker::loadData(const Path& in_sPath)
+{
+    try {
+        if(FileUtils::dirExists(in_sPath)) {
+            bool bRet = false;
+            for(auto& p : fs::recursive_directory_iterator(in_sPath.c_str())) {
+                if(!fs::is_directory(p.path())) {
+                    bRet = this->loadData(Path(p.path().string())) || bRet;
+                }
+            }
+            return bRet;
+        }
+
+        if(Archive::isValidArchive(in_sPath)) {
+            Archive::Ptr pArch(Archive::loadArchive(in_sPath));
+            for(Archive::ChunkMap::const_iterator i = pArch->begin() ; i != pArch->end() ; ++i) {
+                const FileChunk* pChunk = dynamic_cast<const FileChunk*>(i->second);
+                if(pChunk != NULL) {
+                    m_data.push_back(std::make_shared<RawDataContainer>(pChunk->getContents()));
+                }
+            }
+            return true;
+        }
+
+        File::Ptr pFile = File::open(in_sPath, File::Read);
+        m_data.push_back(std::make_shared<RawDataContainer>(pFile->getDataContainer()));
+        return true;
+    } catch(const ArkanaException& e) {
+        e.show();
+    } catch(const fs::filesystem_error& e) {
+        FTSMSG("{1}: {2}\n", FTS::MsgType::Error, in_sPath, e.what());
+    }
+
+    return false;
+}
+
+/** Compresses and decompresses all the data with one compressor, a few times,
+ *  and notes the best times.
+ *
+ * \param in_comp The compressor to use, already set up with the block size and
+ *                thread count.
+ * \param in_uiBlockSize The block size the compressor uses, 0 if none.
+ * \param in_nThreads How many threads the compressor uses.
+ */
+void Benchmarker::run(const Compressor& in_comp, std::uint32_t in_uiBlockSize, std::uint32_t in_nThreads)
+{
+    Result res;
+    res.sCompressor = in_comp.getName();
+    res.uiBlockSize = in_uiBlockSize;
+    res.nThreads = in_nThreads;
+    res.uiSize = 0;
+    res.uiCompressedSize = 0;
+    res.dCompressTime = res.dDecompressTime = 0.0;
+    res.iPeakMemory = -1;
+    res.bOk = true;
+
+    for(std::uint32_t iRun = 0 ; iRun < m_nRuns ; ++iRun) {
+        // The memory of the first run is what counts, later runs may re-use
+        // memory the allocator kept.
+        std::int64_t iMemBefore = iRun == 0 ? resetPeakMemory() : -1;
+
+        std::vector<StreamedDataContainer> compressed(m_data.size());
+        auto start = std::chrono::steady_clock::now();
+        for(std::size_t i = 0 ; i < m_data.size() ; ++i) {
+            in_comp.compress(compressed[i], m_data[i].get());
+        }
+        auto middle = std::chrono::steady_clock::now();
+
+        // Only time the decompression, the checking comes later.
+        std::vector<StreamedDataContainer> decompressed(m_data.size());
+        try {
+            for(std::size_t i = 0 ; i < m_data.size() ; ++i) {
+                in_comp.decompress(decompressed[i], compressed[i].getBoundDC());
+            }
+        } catch(const ArkanaException& e) {
+            e.show();
+            res.bOk = false;
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        if(iRun == 0) {
+            std::int64_t iPeak = getPeakMemory();
+            if(iMemBefore >= 0 && iPeak >= 0)
+                res.iPeakMemory = std::max<std::int64_t>(iPeak - iMemBefore, 0);
+        }
+
+        if(iRun == 0 || seconds(middle - start) < res.dCompressTime)
+            res.dCompressTime = seconds(middle - start);
+        if(iRun == 0 || seconds(end - middle) < res.dDecompressTime)
+            res.dDecompressTime = seconds(end - middle);
+
+        res.uiSize = res.uiCompressedSize = 0;
+        for(std::size_t i = 0 ; i < m_data.size() ; ++i) {
+            const DataContainer *pIn = m_data[i].get();
+            const DataContainer *pOut = decompressed[i].getBoundDC();
+            const std::size_t uiOutSize = pOut == NULL ? 0 : pOut->getSize();
+            if(uiOutSize != pIn->getSize() || (uiOutSize > 0 && std::memcmp(pOut->getData(), pIn->getData(), uiOutSize) != 0))
+                res.bOk = false;
+
+            res.uiSize += pIn->getSize();
+            res.uiCompressedSize += compressed[i].getBoundDC() == NULL ? 0 : compressed[i].getBoundDC()->getSize();
+        }
+    }
+
+    m_results.push_back(res);
+}
+
+int Benchmarker::execute()
+{
+    FTSMSG("Loading the data to benchmark with: ");
+    for(FileList::iterator i = m_lFilesToHandle.begin() ; i != m_lFilesToHandle.end() ; ++i) {
+        FTSMSG(*i + " ");
+        this->loadData(*i);
+    }
+    FTSMSG("\n");
+
+    if(m_data.empty()) {
+        FTSMSG("There is no data to benchmark with.", FTS::MsgType::Error);
+        return -1;
+    }
+
+    std::uint64_t uiTotal = 0;
+    for(std::size_t i = 0 ; i < m_data.size() ; ++i) {
+        uiTotal += m_data[i]->getSize();
+    }
+    FTSMSG("{1} files, {2} MB, best of {3} runs.\n", FTS::MsgType::Raw, String::nr(static_cast<std::uint64_t>(m_data.size())),
+           String::nr(static_cast<double>(uiTotal) / (1024.0 * 1024.0), 2), String::nr(m_nRuns));
+
+    std::list< std::pair<String, String> > lComps = CompressorFactory::getSingletonPtr()->list();
+    for(std::list< std::pair<String, String> >::iterator i = lComps.begin() ; i != lComps.end() ; ++i) {
+        Compressor::Ptr pComp = CompressorFactory::getSingletonPtr()->create(i->first);
+        FTSMSG("  " + pComp->getName() + " ...\n");
+
+#ifndef D_NOMINILZO
+        // The block compressors get every setting.
+        if(dynamic_cast<BlockLZOCompressor*>(pComp.get()) != NULL) {
+            for(std::uint32_t uiBlockSize : m_blockSizes) {
+                for(std::uint32_t nThreads : m_threadCounts) {
+                    this->run(BlockLZOCompressor(uiBlockSize, nThreads), uiBlockSize, nThreads);
+                }
+            }
+            continue;
+        }
+#endif
+
+        this->run(*pComp, 0, 1);
+    }
+
+    // When the JSON goes to stdout, the table must not end up in the middle
+    // of it, whatever logger is in use.
+    if(m_sJSONFile == "-") {
+        String sTable = this->formatTable();
+        fputs(sTable.c_str(), stderr);
+        fflush(stderr);
+    } else {
+        FTSMSG(this->formatTable());
+    }
+
+    if(!m_sJSONFile.empty()) {
+        try {
+            String sJSON = this->toJSON();
+            File::Ptr pFile = File::overwrite(m_sJSONFile, File::Insert);
+            pFile->writeNoEndian(sJSON.c_str(), sJSON.byteCount());
+            pFile->save();
+        } catch(const ArkanaException& e) {
+            e.show();
+            return -1;
+        }
+    }
+
+    for(std::vector<Result>::const_iterator i = m_results.begin() ; i != m_results.end() ; ++i) {
+        if(!i->bOk)
+            return -1;
+    }
+
+    return ERR_OK;
+}
+
+/// \return All results as a table to be read by humans.
+String Benchmarker::formatTable() const
+{
+    String sTable = "\n" + pad("Compressor", 14) + pad("Block", 9, true) + pad("Threads", 9, true)
+                  + pad("Ratio", 9, true) + pad("Comp MB/s", 12, true) + pad("Decomp MB/s", 13, true)
+                  + pad("Peak MB", 10, true) + "\n";
+
+    for(std::vector<Result>::const_iterator i = m_results.begin() ; i != m_results.end() ; ++i) {
+        String sBlock = "-";
+        if(i->uiBlockSize >= 1024 * 1024 && i->uiBlockSize % (1024 * 1024) == 0) {
+            sBlock = String::nr(i->uiBlockSize / (1024 * 1024)) + "M";
+        } else if(i->uiBlockSize >= 1024 && i->uiBlockSize % 1024 == 0) {
+            sBlock = String::nr(i->uiBlockSize / 1024) + "K";
+        } else if(i->uiBlockSize > 0) {
+            sBlock = String::nr(i->uiBlockSize);
+        }
+
+        double dRatio = i->uiSize > 0 ? static_cast<double>(i->uiCompressedSize) / static_cast<double>(i->uiSize) : 1.0;
+        String sPeak = i->iPeakMemory < 0 ? String("n/a") : String::nr(static_cast<double>(i->iPeakMemory) / (1024.0 * 1024.0), 1);
+
+        sTable += pad(i->sCompressor, 14) + pad(sBlock, 9, true) + pad(String::nr(i->nThreads), 9, true)
+                + pad(String::nr(dRatio, 3), 9, true)
+                + pad(String::nr(mbPerSec(i->uiSize, i->dCompressTime), 1), 12, true)
+                + pad(String::nr(mbPerSec(i->uiSize, i->dDecompressTime), 1), 13, true)
+                + pad(sPeak, 10, true) + (i->bOk ? "" : "  BROKEN!") + "\n";
+    }
+
+    return sTable;
+}
+
+/// \return All results as a JSON document.
+String Benchmarker::toJSON() const
+{
+    String sJSON = "{\n  \"inputs\": [";
+    for(FileList::const_iterator i = m_lFilesToHandle.begin() ; i != m_lFilesToHandle.end() ; ++i) {
+        sJSON += (i == m_lFilesToHandle.begin() ? "" : ", ") + jsonString(*i);
+    }
+    sJSON += "],\n  \"files\": " + String::nr(static_cast<std::uint64_t>(m_data.size()))
+           + ",\n  \"runs\": " + String::nr(m_nRuns) + ",\n  \"results\": [\n";
+
+    for(std::vector<Result>::const_iterator i = m_results.begin() ; i != m_results.end() ; ++i) {
+        double dRatio = i->uiSize > 0 ? static_cast<double>(i->uiCompressedSize) / static_cast<double>(i->uiSize) : 1.0;
+        sJSON += "    {\"compressor\": " + jsonString(i->sCompressor)
+               + ", \"block_size\": " + String::nr(i->uiBlockSize)
+               + ", \"threads\": " + String::nr(i->nThreads)
+               + ", \"bytes\": " + String::nr(i->uiSize)
+               + ", \"compressed_bytes\": " + String::nr(i->uiCompressedSize)
+               + ", \"ratio\": " + String::nr(dRatio, 4)
+               + ", \"compress_mb_s\": " + String::nr(mbPerSec(i->uiSize, i->dCompressTime), 2)
+               + ", \"decompress_mb_s\": " + String::nr(mbPerSec(i->uiSize, i->dDecompressTime), 2)
+               + ", \"peak_memory_bytes\": " + (i->iPeakMemory < 0 ? String("null") : String::nr(i->iPeakMemory))
+               + ", \"ok\": " + (i->bOk ? "true" : "false")
+               + "}" + (i + 1 == m_results.end() ? "\n" : ",\n");
+    }
+
+    return sJSON + "  ]\n}\n";
+}
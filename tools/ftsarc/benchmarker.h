@@ -0,0 +1,69 @@
+#ifndef D_FTSARC_BENCHMARKER_H
+#define D_FTSARC_BENCHMARKER_H
+
+#include "ftsarc.h"
+
+#include <vector>
+#include <memory>
+
+#include "dLib/dCompressor/dCompressor.h"
+
+namespace FTSArc {
+
+/// Measures how fast and how well every compressor of the factory handles
+/// some real data: all files of some directories and/or archives.\n
+/// Every file is compressed and decompressed on its own, the way files end
+/// up in the packs. Compressors that work in blocks are run at every given
+/// block size and thread count.
+class Benchmarker : public ExecutionMode {
+public:
+    /// The result of one compressor with one setting over all the data.
+    struct Result {
+        FTS::String sCompressor;
+        /// The block size, 0 if the compressor doesn't work in blocks.
+        std::uint32_t uiBlockSize;
+        std::uint32_t nThreads;
+        std::uint64_t uiSize;
+        std::uint64_t uiCompressedSize;
+        /// The best time of all runs, in seconds.
+        double dCompressTime;
+        double dDecompressTime;
+        /// How much memory the process needed in addition to the data, in
+        /// bytes. -1 if this can't be measured here.
+        std::int64_t iPeakMemory;
+        /// Whether everything decompressed into what has been compressed.
+        bool bOk;
+    };
+
+    Benchmarker();
+    virtual ~Benchmarker();
+
+    void setBlockSizes(const std::vector<std::uint32_t>& in_sizes);
+    void setThreadCounts(const std::vector<std::uint32_t>& in_counts);
+    void setRuns(std::uint32_t in_nRuns);
+    void setJSONFile(const FTS::Path& in_sFile);
+
+    int execute();
+
+    static bool parseList(const FTS::String& in_sList, std::vector<std::uint32_t>& out_list);
+
+private:
+    std::vector<std::uint32_t> m_blockSizes;
+    std::vector<std::uint32_t> m_threadCounts;
+    std::uint32_t m_nRuns;
+    /// Where to write the results as JSON to, empty if nowhere.
+    FTS::Path m_sJSONFile;
+
+    /// The data to (de)compress, every entry is one file.
+    std::vector< std::shared_ptr<FTS::RawDataContainer> > m_data;
+    std::vector<Result> m_results;
+
+    bool loadData(const FTS::Path& in_sPath);
+    void run(const FTS::Compressor& in_comp, std::uint32_t in_uiBlockSize, std::uint32_t in_nThreads);
+    FTS::String formatTable() const;
+    FTS::String toJSON() const;
+};
+
+}
+
+#endif // D_FTSARC_BENCHMARKER_H
@@ -0,0 +1,47 @@
+#include "converter.h"
+#include "logging/logger.h"
+#include "dLib/dArchive/dArchive.h"
+
+using namespace FTSArc;
+using namespace FTS;
+
+Converter::Converter(uint8_t in_uiFormatVersion)
+    : m_uiFormatVersion(in_uiFormatVersion)
+{
+}
+
+Converter::~Converter()
+{
+}
+
+int Converter::execute()
+{
+    FTSMSG("Converting the following archives to format version {1}: ", FTS::MsgType::Raw, String::nr(m_uiFormatVersion));
+    for(FileList::iterator i = m_lFilesToHandle.begin() ; i != m_lFilesToHandle.end() ; ++i) {
+        FTSMSG(*i + " ");
+    }
+    FTSMSG("\n");
+
+    int iRet = ERR_OK;
+    for(FileList::iterator iFile = m_lFilesToHandle.begin() ; iFile != m_lFilesToHandle.end() ; ++iFile) {
+        try {
+            FTSMSG("  " + *iFile + " ... ");
+            Archive::Ptr a(Archive::loadArchive(*iFile));
+            if(a->getFormatVersion() == m_uiFormatVersion) {
+                FTSMSG("already in that format\n");
+                continue;
+            }
+
+            // The whole-archive compression stays the same.
+            FTSMSG("from version {1} ", FTS::MsgType::Raw, String::nr(a->getFormatVersion()));
+            a->setFormatVersion(m_uiFormatVersion);
+            a->save();
+            FTSMSG("Done\n");
+        } catch(const ArkanaException& e) {
+            e.show();
+            iRet = -1;
+        }
+    }
+
+    return iRet;
+}
@@ -0,0 +1,21 @@
+#ifndef D_FTSARC_CONVERTER_H
+#define D_FTSARC_CONVERTER_H
+
+#include "ftsarc.h"
+
+namespace FTSArc {
+
+class Converter : public ExecutionMode {
+    /// The archive format version to convert the archives to.
+    uint8_t m_uiFormatVersion;
+
+public:
+    Converter(uint8_t in_uiFormatVersion);
+    virtual ~Converter();
+
+    int execute();
+};
+
+}
+
+#endif // D_FTSARC_CONVERTER_H
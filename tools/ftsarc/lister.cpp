@@ -25,6 +25,7 @@ int Lister::execute()
         try {
             FTSMSG("\nArchive " + *iFile + ":\n");
             Archive::Ptr a(Archive::loadArchive(*iFile));
+            FTSMSG("(format version {1})\n", FTS::MsgType::Raw, String::nr(a->getFormatVersion()));
             for(Archive::ChunkMap::const_iterator iChunk = a->begin() ; iChunk != a->end() ; ++iChunk) {
                 this->printChunk(iChunk->second);
             }
@@ -5,14 +5,17 @@
 
 #include "lister.h"
 #include "remover.h"
+#include "converter.h"
 #include "archiver.h"
 #include "dearchiver.h"
 #include "sfcompressor.h"
 #include "internaltester.h"
 #include "compressorlister.h"
+#include "benchmarker.h"
 
 #include "dLib/dCompressor/dCompressor.h"
 #include "dLib/dArchive/dArchive.h"
+#include "main/JobSystem.h"
 
 using namespace FTSArc;
 using namespace FTS;
@@ -20,7 +23,7 @@ using namespace FTS;
 void usage()
 {
     FTSMSG("-----\n");
-    FTSMSG("Usage for archiving: {1} [-s] [-o OUTFILE] [-c COMPR] [-R] [-y] FILE_1 [FILE_2 ... FILE_N]\n", FTS::MsgType::Raw, TOOLNAME);
+    FTSMSG("Usage for archiving: {1} [-s] [-o OUTFILE] [-c COMPR] [-j THREADS] [-R] [-y] FILE_1 [FILE_2 ... FILE_N]\n", FTS::MsgType::Raw, TOOLNAME);
     FTSMSG("  -o OUTFILE    name the created archive file OUTPUT. For example -o bla.ftsarc\n");
     FTSMSG("                will name the created archive bla.ftsarc\n");
     FTSMSG("                If this is not specified, the name will default to {1}\n", FTS::MsgType::Raw, Archiver::defaultOutName());
@@ -30,6 +33,9 @@ void usage()
     FTSMSG("                Omitting this option will not compress the archive.\n");
     FTSMSG("                To see all available compressors, use the -lc option.\n");
     FTSMSG("                Example: -c MiniLZO.\n");
+    FTSMSG("  -j THREADS    How many files to read and compress at the same time.\n");
+    FTSMSG("                Omitting this option uses one thread per core.\n");
+    FTSMSG("                The archive is the same for any number of threads.\n");
     FTSMSG("  -R            Recurse into subdirectories\n");
     FTSMSG("  -y            Answer yes to all questions automatically (e.g. overwrite files).\n");
     FTSMSG("  -s            If this option is set, it means that the archiver won't create\n");
@@ -69,9 +75,26 @@ void usage()
     FTSMSG("                For example -r bla.ftsarc removes the objects from the\n");
     FTSMSG("                archive named bla.ftsarc\n");
     FTSMSG("-----\n");
+    FTSMSG("Usage for converting archives: {1} -cv VERSION ARCHIVE_1 [ARCHIVE_2 .. ARCHIVE_N]\n", FTS::MsgType::Raw, TOOLNAME);
+    FTSMSG("  -cv VERSION   rewrites the archives in the given format version.\n");
+    FTSMSG("                1 is the original format that is read as a whole,\n");
+    FTSMSG("                2 has a table of contents and allows reading only\n");
+    FTSMSG("                the files that are needed. New archives use version {1}.\n", FTS::MsgType::Raw, String::nr(Archive::CurrentFormat));
+    FTSMSG("-----\n");
     FTSMSG("Usage for listing compressors: {1} -lc\n", FTS::MsgType::Raw, TOOLNAME);
     FTSMSG("  Litsts all the compressors you may currently use.\n");
     FTSMSG("-----\n");
+    FTSMSG("Usage for benchmarking compressors: {1} bench [-bs SIZES] [-t THREADS] [-n RUNS] [-json OUTFILE] PATH_1 [PATH_2 .. PATH_N]\n", FTS::MsgType::Raw, TOOLNAME);
+    FTSMSG("  Compresses and decompresses every file of the given directories,\n");
+    FTSMSG("  archives or files with every compressor and prints the speed,\n");
+    FTSMSG("  the compression ratio and the peak memory of each.\n");
+    FTSMSG("  -bs SIZES     Comma separated block sizes to run block compressors at.\n");
+    FTSMSG("                For example -bs 64k,256k,1m (that is the default).\n");
+    FTSMSG("  -t THREADS    Comma separated thread counts to run block compressors with.\n");
+    FTSMSG("                Defaults to 1 and the number of cores.\n");
+    FTSMSG("  -n RUNS       How often to repeat every measurement, the best one counts.\n");
+    FTSMSG("  -json OUTFILE Also write the results as JSON into OUTFILE, - for stdout.\n");
+    FTSMSG("-----\n");
     FTSMSG("Usage for an internal test: {1} -it\n", FTS::MsgType::Raw, TOOLNAME);
     FTSMSG("  Runs an internal test to check if the main functionality is OK.\n");
     FTSMSG("-----\n");
@@ -151,10 +174,49 @@ int main(int argc, char *argv[])
     int nArgsHandled = 1;
 
     // If some argument is given, detect that.
-    if(argv[1][0] == '-'){
+    if(String(argv[1]) == "bench") {
+        Benchmarker *b = new Benchmarker();
+        int argpos = 2;
+
+        // Parse the benchmark options.
+        while(argpos < argc && argv[argpos][0] == '-') {
+            String sOpt = argv[argpos];
+            if(argc < argpos + 2) {
+                FTSMSG("The {1} option needs a value after it.", FTS::MsgType::Error, sOpt);
+                delete b;
+                return 1;
+            }
+
+            std::vector<uint32_t> list;
+            if(sOpt == "-bs" && Benchmarker::parseList(argv[argpos+1], list)) {
+                b->setBlockSizes(list);
+            } else if(sOpt == "-t" && Benchmarker::parseList(argv[argpos+1], list)) {
+                b->setThreadCounts(list);
+            } else if(sOpt == "-n" && atoi(argv[argpos+1]) > 0) {
+                b->setRuns(static_cast<uint32_t>(atoi(argv[argpos+1])));
+            } else if(sOpt == "-json") {
+                b->setJSONFile(argv[argpos+1]);
+            } else {
+                FTSMSG("I don't understand the option {1} {2}", FTS::MsgType::Error, sOpt, argv[argpos+1]);
+                delete b;
+                return 1;
+            }
+            argpos += 2;
+        }
+
+        if(argc < argpos+1) {
+            FTSMSG("You didn't tell me what data to benchmark with.\n"
+                   "Do so by adding directories, archives or files after the options.", FTS::MsgType::Error);
+            delete b;
+            return 1;
+        }
+
+        exe = b;
+        nArgsHandled = argpos;
+    } else if(argv[1][0] == '-'){
         // We want to create an archive or add files to an archive with the
         // following name.
-        if((argv[1][1] == 'o' || argv[1][1] == 'c' || argv[1][1] == 's') && argv[1][2] == '\0') {
+        if((argv[1][1] == 'o' || argv[1][1] == 'c' || argv[1][1] == 'j' || argv[1][1] == 's') && argv[1][2] == '\0') {
             int argpos = 1;
             String sOutName;
             Compressor::Ptr pComp(new NoCompressor);
@@ -191,6 +253,16 @@ int main(int argc, char *argv[])
                     }
                     nArgsHandled += 2;
                     argpos += 2;
+                } else if(argv[argpos][1] == 'j') {
+                    if(argc < argpos + 2 || atoi(argv[argpos+1]) <= 0) {
+                        FTSMSG("You didn't tell me how many threads you want to use.\n"
+                               "Do so by adding a number after the -j option,\n"
+                               "separated by a space. For example: -j 4", FTS::MsgType::Error);
+                        return 1;
+                    }
+                    Archive::setWorkerThreads(static_cast<std::size_t>(atoi(argv[argpos+1])));
+                    nArgsHandled += 2;
+                    argpos += 2;
                 } else if(argv[argpos][1] == 'R') {
                     bRec = true;
                     nArgsHandled++;
@@ -277,6 +349,20 @@ int main(int argc, char *argv[])
             }
             exe = new Remover(argv[2]);
             nArgsHandled += 2;
+        } else if(argv[1][1] == 'c' && argv[1][2] == 'v' && argv[1][3] == '\0') {
+            if(argc <= 3) {
+                FTSMSG("You didn't tell me what format version and archives you want to convert.\n"
+                       "Do so by adding the version and the archive file names after the -cv option,"
+                       "separated by a space. For example: -cv 2 bla.ftsarc", FTS::MsgType::Error);
+                return 1;
+            }
+            int iVersion = atoi(argv[2]);
+            if(iVersion != Archive::FormatV1 && iVersion != Archive::FormatV2) {
+                FTSMSG("I don't know the archive format version {1}, use 1 or 2.", FTS::MsgType::Error, argv[2]);
+                return 1;
+            }
+            exe = new Converter(static_cast<uint8_t>(iVersion));
+            nArgsHandled += 2;
         } else if(argv[1][1] == 'l' && argv[1][2] == 'c' && argv[1][3] == '\0') {
             exe = new CompressorLister();
             nArgsHandled += 1;
@@ -305,6 +391,8 @@ int main(int argc, char *argv[])
         exe->addFileToHandle(argv[i]);
     }
 
+    // Archiving and the block compressor spread their work over its workers.
+    JobSystem jobs;
     int iRet = exe->execute();
     delete exe;
     return iRet;
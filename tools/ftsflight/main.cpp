@@ -0,0 +1,43 @@
+#define TOOLNAME "ftsflight"
+#define TOOLVERSIONSTR "0.1"
+
+#include "logging/FlightRecorder.h"
+
+#include <fstream>
+#include <iostream>
+
+using namespace FTS;
+
+void usage()
+{
+    std::cout << "Usage: " TOOLNAME " DUMP_1 [DUMP_2 ... DUMP_N]" << std::endl
+              << "Shows what the flight recorder of Arkana-FTS recorded before it wrote the" << std::endl
+              << "given dumps, like the CriticalError.flight written when the game crashes." << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc <= 1) {
+        std::cout << "Arkana-FTS " TOOLNAME " Version " TOOLVERSIONSTR << std::endl << std::endl;
+        usage();
+        return 0;
+    }
+
+    int iFailed = 0;
+    for(int i = 1 ; i < argc ; ++i) {
+        std::ifstream dump(argv[i], std::ios::binary);
+        if(argc > 2)
+            std::cout << argv[i] << ":" << std::endl;
+
+        if(!dump) {
+            std::cerr << TOOLNAME ": can't open " << argv[i] << std::endl;
+            iFailed++;
+        } else if(!FlightRecorder::decode(dump, std::cout)) {
+            std::cerr << TOOLNAME ": " << argv[i] << " is no flight recorder dump of version "
+                      << static_cast<unsigned>(FlightRecorder::Version) << std::endl;
+            iFailed++;
+        }
+    }
+
+    return iFailed;
+}
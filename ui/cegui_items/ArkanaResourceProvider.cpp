@@ -8,7 +8,7 @@
 
 #include "dLib/dFile/dFile.h"
 #include "utilities/utilities.h"
-#include "dLib/dConf/configuration.h"
+#include "dLib/dConf/ConfigurationStore.h"
 
 // Start of CEGUI namespace section
 namespace CEGUI
@@ -81,8 +81,8 @@ namespace CEGUI
 
         // For layouts, add the language to the name!
         if(in_sResourceGroup == "layouts") {
-            FTS::Configuration conf ("conf.xml", FTS::ArkanaDefaultSettings());
-            FTS::String sMyLang = conf.get<std::string>("Language");
+            FTS::Configuration::Ptr pConf = FTS::ConfigurationStore::getSingleton().getMainConf();
+            FTS::String sMyLang = pConf->get<std::string>("Language");
             FTS::Path sNameInMyLang = FTS::String(sNameWithGroupDir) + FTS::String(".") + sMyLang + FTS::String(".layout");
             FTS::Path sNameInEngl = FTS::String(sNameWithGroupDir) + FTS::String(".English.layout");
 
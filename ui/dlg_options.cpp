@@ -17,14 +17,13 @@
 #include "utilities/utilities.h"
 
 #include "dLib/dFile/dBrowse.h"
-#include "dLib/dConf/configuration.h"
+#include "dLib/dConf/ConfigurationStore.h"
 #include "dLib/dString/dTranslation.h"
 
 using namespace FTS;
 
 FTS::MenuOptions::MenuOptions(const std::list<String>& in_lDisables)
     : m_pRoot(NULL)
-    , m_pConf(nullptr)
     , m_pTrans(nullptr)
 {
     this->reload(true, in_lDisables);
@@ -32,16 +31,12 @@ FTS::MenuOptions::MenuOptions(const std::list<String>& in_lDisables)
 
 FTS::MenuOptions::~MenuOptions()
 {
-    delete m_pConf;
     delete m_pTrans;
 }
 
 void FTS::MenuOptions::reload(bool in_bDoLoad, const std::list<String>& in_lDisables)
 {
-    if(m_pConf != nullptr) {
-        delete m_pConf;
-    }
-    m_pConf = new Configuration("conf.xml", ArkanaDefaultSettings());
+    m_pConf = ConfigurationStore::getSingleton().getMainConf();
     if( m_pTrans != nullptr ) {
         delete m_pTrans;
     }
@@ -675,7 +670,7 @@ int FTS::MenuOptions::loadMisc()
 
 bool FTS::MenuOptions::cbOptions_btnVidAdvanced(const CEGUI::EventArgs & in_ea)
 {
-    m_pAdvVideoDlg = new AdvVideoDlg(m_pConf);
+    m_pAdvVideoDlg = new AdvVideoDlg(m_pConf.get());
 
     return true;
 }
@@ -779,9 +774,6 @@ int FTS::MenuOptions::saveVideo(bool &out_bReloadMenu)
         Renderer::getSingleton().changeResolution(res);
         m_bVideoChange = false;
         out_bReloadMenu = true;
-        // Reload the configuration, since it is changed by the Renderer.
-        delete m_pConf;
-        m_pConf = new Configuration("conf.xml", ArkanaDefaultSettings());
     }
 
     return ERR_OK;
@@ -11,6 +11,7 @@
 #include "main.h"
 
 #include <list>
+#include <memory>
 
 namespace CEGUI {
     class Window;
@@ -39,7 +40,8 @@ private:
     /* Or maybe prefer an advanced graphics one ? */
     AdvVideoDlg *m_pAdvVideoDlg;
 
-    Configuration * m_pConf;
+    /// The shared configuration of the game, see ConfigurationStore.
+    std::shared_ptr<Configuration> m_pConf;
     class Translation* m_pTrans;
 
     /* Functions that load the settings into the widgets. */
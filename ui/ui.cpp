@@ -8,8 +8,10 @@
 #include "ui/ui_commands.h"
 
 #include "logging/logger.h"
+#include "logging/PerfCounters.h"
 #include "main/Clock.h"
 #include "graphic/graphic.h"
+#include "graphic/cegui_null_renderer.h"
 #include "utilities/utilities.h"
 #include "utilities/fps_calculator.h"
 
@@ -349,11 +351,35 @@ FTS::GUI::GUIInfo FTS::GUI::next(const GUIInfo &in_info) const
 {
     switch(in_info) {
     case NoInfo: return FPS;
-    case FPS: return NoInfo;
+    case FPS: return Counters;
+    case Counters: return NoInfo;
     };
     return FPS;
 }
 
+namespace {
+    /// \return One line per performance counter, with its value of the last frame.
+    FTS::String formatCounters()
+    {
+        FTS::String sCounters;
+        for(const FTS::PerfCounterValue& v : FTS::PerfCounters::getLastFrame()) {
+            sCounters += FTS::String(v.pszName) + ": ";
+            switch(v.kind) {
+            case FTS::PerfCounter::Counter:
+            case FTS::PerfCounter::Gauge:
+                sCounters += FTS::String::nr(v.iValue);
+                break;
+            case FTS::PerfCounter::Histogram:
+                sCounters += FTS::String::nr(v.iValue) + " x " + FTS::String::nr(v.dMean, 1)
+                           + " (" + FTS::String::nr(v.iMin) + "-" + FTS::String::nr(v.iMax) + ")";
+                break;
+            }
+            sCounters += "\n";
+        }
+        return sCounters;
+    }
+}
+
 /// Updates the GUI Info field of CEGUI, if there is one.
 extern size_t g_nAllocs;
 extern size_t g_iTotalMem;
@@ -375,6 +401,7 @@ void FTS::GUI::updateGUIInfo()
     case NoInfo:
         break;
     case FPS:
+    case Counters:
         {
             sInfo = "FPS : "+String::nr(FPSCalculator::getSingleton().getFPS(),1);
             sCInfo = sInfo;
@@ -389,6 +416,28 @@ void FTS::GUI::updateGUIInfo()
         }
     } catch(CEGUI::Exception & ) {
     }
+
+    // The counters don't fit into the info field, they get their own one just
+    // below it, which goes away together with the info field.
+    try {
+        CEGUI::WindowManager& wm = CEGUI::WindowManager::getSingleton();
+        if(this->getGUIInfo() == Counters) {
+            CEGUI::Window *pCounters = NULL;
+            if(wm.isWindowPresent("CountersInfo")) {
+                pCounters = wm.getWindow("CountersInfo");
+            } else {
+                pCounters = wm.createWindow("ArkanaLook/Label", "CountersInfo");
+                pCounters->setPosition(CEGUI::UVector2(CEGUI::UDim(1.0f,-250.0f), CEGUI::UDim(0.0f,40.0f)));
+                pCounters->setSize(CEGUI::UVector2(CEGUI::UDim(0.0f,250.0f), CEGUI::UDim(0.0f,400.0f)));
+                pCounters->setAlwaysOnTop(true);
+                pWin->getParent()->addChildWindow(pCounters);
+            }
+            pCounters->setText(formatCounters());
+        } else if(wm.isWindowPresent("CountersInfo")) {
+            wm.destroyWindow("CountersInfo");
+        }
+    } catch(CEGUI::Exception & ) {
+    }
 }
 
 /// Selects a new active widget.
@@ -416,8 +465,10 @@ void FTS::GUI::setActiveWidget(CEGUI::Window *in_pWidget)
 void FTS::GUI::preChangeResolution(float /*in_fW*/, float /*in_fH*/)
 {
     if(CEGUI::System::getSingletonPtr()) {
-        CEGUI::OpenGLRenderer *gl = (CEGUI::OpenGLRenderer *) CEGUI::System::getSingleton().getRenderer();
-        gl->grabTextures();
+        // Without a display, there is nothing to grab.
+        CEGUI::OpenGLRenderer *gl = dynamic_cast<CEGUI::OpenGLRenderer *>(CEGUI::System::getSingleton().getRenderer());
+        if(gl)
+            gl->grabTextures();
     }
 }
 
@@ -428,10 +479,12 @@ void FTS::GUI::preChangeResolution(float /*in_fW*/, float /*in_fH*/)
 void FTS::GUI::postChangeResolution(float in_fW, float in_fH)
 {
     if(CEGUI::System::getSingletonPtr()) {
-        CEGUI::OpenGLRenderer *gl = (CEGUI::OpenGLRenderer *) CEGUI::System::getSingleton().getRenderer();
-        if(gl) {
+        CEGUI::Renderer *pRenderer = CEGUI::System::getSingleton().getRenderer();
+        if(CEGUI::OpenGLRenderer *gl = dynamic_cast<CEGUI::OpenGLRenderer *>(pRenderer)) {
             gl->restoreTextures();
             gl->setDisplaySize(CEGUI::Size(in_fW, in_fH));
+        } else if(CEGUI::NullRenderer *pNull = dynamic_cast<CEGUI::NullRenderer *>(pRenderer)) {
+            pNull->setDisplaySize(CEGUI::Size(in_fW, in_fH));
         }
     }
 }
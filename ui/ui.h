@@ -64,6 +64,7 @@ private:
     typedef enum {
         NoInfo = 0, ///< Shows nothing.
         FPS,        ///< Shows the current frames per seconds.
+        Counters,   ///< Shows the FPS and all performance counters of the last frame.
     } GUIInfo;
 
     /// The current info displayed on the top right of the GUI.
@@ -137,6 +138,7 @@ private:
 class CEGUIUpdater : public Updateable {
 public:
     bool update(const Clock&);
+    Phase getUpdatePhase() const {return PreRender;};
 };
 
 /// Little macro to write less.
@@ -29,7 +29,7 @@
 #include "mdlviewer/mdlviewer_main.h"
 #include "game/loadgame_rlv.h"
 #include "graphic/graphic.h"
-#include "dLib/dConf/configuration.h"
+#include "dLib/dConf/ConfigurationStore.h"
 #include "dLib/dString/dTranslation.h"
 #include "dLib/dFile/dBrowse.h"
 
@@ -67,10 +67,10 @@ FTS::MainMenuRlv::~MainMenuRlv()
 
 void FTS::MainMenuRlv::loadSettingsFromConf()
 {
-    Configuration conf ("conf.xml", ArkanaDefaultSettings());
+    Configuration::Ptr pConf = ConfigurationStore::getSingleton().getMainConf();
 
-    m_iScreenHeigth = conf.get<int>("VRes");
-    m_iScreenWidth  = conf.get<int>("HRes");
+    m_iScreenHeigth = pConf->get<int>("VRes");
+    m_iScreenWidth  = pConf->get<int>("HRes");
 }
 
 /** This method will be called during the loading
@@ -24,7 +24,7 @@
 #include "3d/ModelInstance.h"
 #include "3d/Resolution.h"
 
-#include "dLib/dConf/configuration.h"
+#include "dLib/dConf/ConfigurationStore.h"
 #include "dLib/dFile/dBrowse.h"
 
 using namespace FTS;
@@ -37,7 +37,6 @@ FTS::LoginMenuRlv::LoginMenuRlv()
 /// Default destructor.
 FTS::LoginMenuRlv::~LoginMenuRlv()
 {
-    delete m_pConf;
 }
 
 /** This method will be called during the loading of the runlevel.\n
@@ -50,10 +49,7 @@ FTS::LoginMenuRlv::~LoginMenuRlv()
  */
 bool FTS::LoginMenuRlv::load()
 {
-    if( m_pConf != nullptr ) {
-        delete m_pConf;
-    }
-    m_pConf = new Configuration("conf.xml", ArkanaDefaultSettings());
+    m_pConf = ConfigurationStore::getSingleton().getMainConf();
 
     // Find the correct menu background image.
     std::list<Resolution> lAvail;
@@ -162,8 +158,7 @@ bool FTS::LoginMenuRlv::unload()
         }
     } catch(CEGUI::Exception &) {
     }
-    delete m_pConf;
-    m_pConf = nullptr;
+    m_pConf.reset();
     return true;
 }
 
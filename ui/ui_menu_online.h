@@ -4,6 +4,8 @@
 #include "main.h"
 #include "main/runlevels.h"
 
+#include <memory>
+
 namespace FTS {
     class ModelInstance;
     class ModelManager;
@@ -24,7 +26,8 @@ private:
     /// An instance of the menu background model.
     ModelInstance* m_pMenuBGInst = nullptr;
 
-    Configuration* m_pConf = nullptr;
+    /// The shared configuration of the game, see ConfigurationStore.
+    std::shared_ptr<Configuration> m_pConf;
 
     bool cbLogin(const CEGUI::EventArgs & in_ea);
     bool cbCreate(const CEGUI::EventArgs & in_ea);
@@ -26,7 +26,7 @@
 #include "utilities/utilities.h"
 #include "main/runlevels.h"
 #include "sound/fts_Snd.h"
-#include "dLib/dConf/configuration.h"
+#include "dLib/dConf/ConfigurationStore.h"
 #include "dLib/dString/dTranslation.h"
 
 #define D_MAX_SENT_MESSAGES_STORED 100
@@ -138,9 +138,9 @@ bool FTS::OnlineMenuRlv::load()
 
     // Join the default channel. If this doesn't work, we can continue,
     // But will periodically retry this.
-    Configuration conf ("conf.xml", ArkanaDefaultSettings());
+    Configuration::Ptr pConf = ConfigurationStore::getSingleton().getMainConf();
 
-    String defaultChannel = conf.get<std::string>("DefaultChannel");
+    String defaultChannel = pConf->get<std::string>("DefaultChannel");
 
     this->join(defaultChannel);
 
@@ -961,10 +961,10 @@ int FTS::OnlineMenuRlv::join(const String & in_sChan)
  */
 int FTS::OnlineMenuRlv::enteringNewChannel(const String &in_sNewChanName)
 {
-    Configuration conf ("conf.xml", ArkanaDefaultSettings());
+    Configuration::Ptr pConf = ConfigurationStore::getSingleton().getMainConf();
 
     // In case the user wants to clear the chatbox, do this now.
-    if(conf.get<bool>("ClearChatbox")) {
+    if(pConf->get<bool>("ClearChatbox")) {
         try {
             FTSGetConvertWinMacro(CEGUI::Listbox, pChat, "menu_online_main/lbChat");
             pChat->resetList();
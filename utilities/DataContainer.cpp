@@ -9,46 +9,288 @@
 #include <malloc.h>
 #include <cstdint>
 #include <utility>
+#include <algorithm>
+#include "main/defines.h"
 #include "DataContainer.h"
 
+#if WINDOOF
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#endif
+
 using namespace FTS;
 
 /// \return The fletcher32 checksum of the data in the container.
 uint32_t FTS::DataContainer::fletcher32() const
 {
-    // Taken from wikipedia. Input only works on an array of uint16_t, thus
-    // if our data has one byte too much, cut it off.
+    return Fletcher32().update(*this).finalize();
+}
+
+// The checksum is built from 16 bit words in the system's byte order. We add
+// whole blocks of words using vector instructions where we can: every lane
+// sums up its own words and the sums of these sums, lane j taking the words
+// j, j+L, j+2L, ... After M rounds of L words, the lanes are put together:
+//   sum1 += sum(A)
+//   sum2 += n * sum1 + L * sum(B) - sum(j * A_j)    with n = M * L.
+// Lanes are 32 bit wide, B_j grows up to M*(M+1)/2 * 65535, so a block has
+// at most 256 rounds before the lanes need to be put together.
+#define D_FLETCHER_MAX_ROUNDS 256
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define D_FLETCHER_X86 1
+#  define D_FLETCHER_TARGET(x) __attribute__((target(x)))
+#  include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#  define D_FLETCHER_X86 1
+#  define D_FLETCHER_TARGET(x)
+#  include <intrin.h>
+#  include <immintrin.h>
+#else
+#  define D_FLETCHER_X86 0
+#endif
+
+namespace {
+    typedef void (*FletcherWordsFn)(const uint8_t *in_pWords, uint64_t in_nWords, uint32_t &io_uiSum1, uint32_t &io_uiSum2);
+
+    /// Adds words one by one, the reference for all the others.
+    void fletcherWordsScalar(const uint8_t *in_pWords, uint64_t in_nWords, uint32_t &io_uiSum1, uint32_t &io_uiSum2)
+    {
+        uint64_t sum1 = io_uiSum1, sum2 = io_uiSum2;
+        while(in_nWords > 0) {
+            // 64 bit sums don't overflow within that many words.
+            uint64_t n = std::min<uint64_t>(in_nWords, 4096);
+            in_nWords -= n;
+            for( ; n > 0 ; --n, in_pWords += 2) {
+                uint16_t w;
+                memcpy(&w, in_pWords, 2);
+                sum1 += w;
+                sum2 += sum1;
+            }
+            sum1 %= 65535;
+            sum2 %= 65535;
+        }
+        io_uiSum1 = static_cast<uint32_t>(sum1);
+        io_uiSum2 = static_cast<uint32_t>(sum2);
+    }
+
+#if D_FLETCHER_X86
+    /// Puts the lanes of a block of \a in_nRounds rounds together.
+    template<int L>
+    void fletcherCombine(const uint32_t (&A)[L], const uint32_t (&B)[L], uint64_t in_nRounds, uint32_t &io_uiSum1, uint32_t &io_uiSum2)
+    {
+        uint64_t sumA = 0, sumB = 0, sumJA = 0;
+        for(int j = 0 ; j < L ; ++j) {
+            sumA += A[j];
+            sumB += B[j];
+            sumJA += static_cast<uint64_t>(j) * A[j];
+        }
+
+        uint64_t n = in_nRounds * L;
+        uint64_t sum2 = io_uiSum2 + (n % 65535) * io_uiSum1 + L * sumB - sumJA;
+        io_uiSum2 = static_cast<uint32_t>(sum2 % 65535);
+        io_uiSum1 = static_cast<uint32_t>((io_uiSum1 + sumA) % 65535);
+    }
+
+    D_FLETCHER_TARGET("sse2")
+    void fletcherWordsSSE2(const uint8_t *in_pWords, uint64_t in_nWords, uint32_t &io_uiSum1, uint32_t &io_uiSum2)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        while(in_nWords >= 8) {
+            uint64_t nRounds = std::min<uint64_t>(in_nWords / 8, D_FLETCHER_MAX_ROUNDS);
+            __m128i a0 = zero, a1 = zero, b0 = zero, b1 = zero;
+            for(uint64_t m = 0 ; m < nRounds ; ++m, in_pWords += 16) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in_pWords));
+                a0 = _mm_add_epi32(a0, _mm_unpacklo_epi16(v, zero));
+                a1 = _mm_add_epi32(a1, _mm_unpackhi_epi16(v, zero));
+                b0 = _mm_add_epi32(b0, a0);
+                b1 = _mm_add_epi32(b1, a1);
+            }
+
+            uint32_t A[8], B[8];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(A), a0);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(A + 4), a1);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(B), b0);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(B + 4), b1);
+            fletcherCombine<8>(A, B, nRounds, io_uiSum1, io_uiSum2);
+            in_nWords -= nRounds * 8;
+        }
+
+        fletcherWordsScalar(in_pWords, in_nWords, io_uiSum1, io_uiSum2);
+    }
+
+    D_FLETCHER_TARGET("avx2")
+    void fletcherWordsAVX2(const uint8_t *in_pWords, uint64_t in_nWords, uint32_t &io_uiSum1, uint32_t &io_uiSum2)
+    {
+        while(in_nWords >= 16) {
+            uint64_t nRounds = std::min<uint64_t>(in_nWords / 16, D_FLETCHER_MAX_ROUNDS);
+            __m256i a0 = _mm256_setzero_si256(), a1 = a0, b0 = a0, b1 = a0;
+            for(uint64_t m = 0 ; m < nRounds ; ++m, in_pWords += 32) {
+                __m256i lo = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in_pWords)));
+                __m256i hi = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in_pWords + 16)));
+                a0 = _mm256_add_epi32(a0, lo);
+                a1 = _mm256_add_epi32(a1, hi);
+                b0 = _mm256_add_epi32(b0, a0);
+                b1 = _mm256_add_epi32(b1, a1);
+            }
+
+            uint32_t A[16], B[16];
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(A), a0);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(A + 8), a1);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(B), b0);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(B + 8), b1);
+            fletcherCombine<16>(A, B, nRounds, io_uiSum1, io_uiSum2);
+            in_nWords -= nRounds * 16;
+        }
+
+        fletcherWordsScalar(in_pWords, in_nWords, io_uiSum1, io_uiSum2);
+    }
+
+    bool cpuHasAVX2()
+    {
+#  if defined(__GNUC__)
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#  else
+        int info[4];
+        __cpuid(info, 0);
+        if(info[0] < 7)
+            return false;
+
+        // The OS must save the AVX registers too.
+        __cpuid(info, 1);
+        bool bOSXSave = (info[2] & (1 << 27)) != 0;
+        bool bAVX = (info[2] & (1 << 28)) != 0;
+        if(!bOSXSave || !bAVX || (_xgetbv(0) & 6) != 6)
+            return false;
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#  endif
+    }
+
+    bool cpuHasSSE2()
+    {
+#  if defined(__GNUC__)
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse2");
+#  else
+        int info[4];
+        __cpuid(info, 1);
+        return (info[3] & (1 << 26)) != 0;
+#  endif
+    }
+#endif // D_FLETCHER_X86
+
+    struct FletcherImpl {
+        FletcherWordsFn fn;
+        const char *pszName;
+    };
+
+    /// Picks the fastest implementation the CPU can run, once.
+    const FletcherImpl& fletcherImpl()
+    {
+        static const FletcherImpl impl = []() {
+#if D_FLETCHER_X86
+            if(cpuHasAVX2())
+                return FletcherImpl{&fletcherWordsAVX2, "AVX2"};
+            if(cpuHasSSE2())
+                return FletcherImpl{&fletcherWordsSSE2, "SSE2"};
+#endif
+            return FletcherImpl{&fletcherWordsScalar, "scalar"};
+        }();
+        return impl;
+    }
+}
+
+FTS::Fletcher32::Fletcher32()
+{
+    this->reset();
+}
+
+void FTS::Fletcher32::reset()
+{
+    // The sums start at 0xffff, which is 0 modulo 65535.
+    m_uiSum1 = m_uiSum2 = 0;
+    m_nWords = 0;
+    m_heldWord[0] = m_heldWord[1] = 0;
+    m_uiPendingByte = 0;
+    m_bPendingByte = false;
+}
+
+const char *FTS::Fletcher32::getImplementationName()
+{
+    return fletcherImpl().pszName;
+}
 
-    // 0 if the length is pair (exactly enough bytes), 1 if we are missing 1 byte.
-    uint64_t uiToCompare = this->getSize() % 2;
+void FTS::Fletcher32::addHeldWord()
+{
+    if(m_nWords > 0)
+        fletcherWordsScalar(m_heldWord, 1, m_uiSum1, m_uiSum2);
+}
 
-    uint64_t uiDataLen16Bit = this->getSize()/2;
-    const uint16_t *pData16Bit = reinterpret_cast<const uint16_t*>(this->getData());
+FTS::Fletcher32& FTS::Fletcher32::update(const void *in_pData, size_t in_uiSize)
+{
+    const uint8_t *pData = reinterpret_cast<const uint8_t *>(in_pData);
+
+    // Complete the word that has been started by the last piece.
+    if(m_bPendingByte && in_uiSize > 0) {
+        this->addHeldWord();
+        m_heldWord[0] = m_uiPendingByte;
+        m_heldWord[1] = *pData++;
+        --in_uiSize;
+        ++m_nWords;
+        m_bPendingByte = false;
+    }
 
-    uint32_t sum1 = 0xffff, sum2 = 0xffff;
+    // All but the last of the complete words can be added right away.
+    uint64_t nWords = in_uiSize / 2;
+    if(nWords > 0) {
+        this->addHeldWord();
+        fletcherImpl().fn(pData, nWords - 1, m_uiSum1, m_uiSum2);
+        memcpy(m_heldWord, pData + 2 * (nWords - 1), 2);
+        m_nWords += nWords;
+    }
 
-    while(uiDataLen16Bit > uiToCompare) {
-            uint64_t tlen = uiDataLen16Bit > 360 ? 360 : uiDataLen16Bit;
-            uiDataLen16Bit -= tlen;
-            do {
-                    sum1 += *pData16Bit++;
-                    sum2 += sum1;
-            } while (--tlen);
-            sum1 = (sum1 & 0xffff) + (sum1 >> 16);
-            sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+    if(in_uiSize % 2 == 1) {
+        m_uiPendingByte = pData[in_uiSize - 1];
+        m_bPendingByte = true;
     }
 
-    // If we are missing one byte, add a zero.
-    if(uiToCompare > 0) {
-        sum1 += *(reinterpret_cast<const uint8_t*>(pData16Bit));
-        sum2 += sum1;
-        sum1 = (sum1 & 0xffff) + (sum1 >> 16);
-        sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+    return *this;
+}
+
+uint32_t FTS::Fletcher32::finalize() const
+{
+    uint32_t sum1 = m_uiSum1, sum2 = m_uiSum2;
+
+    // The original algorithm (taken from wikipedia) goes through the words in
+    // blocks of 360. For an odd number of bytes, it stops as soon as at most
+    // one word is left, which then is not added as a whole, but only its
+    // first byte, and the real last byte is not added at all. This happens if
+    // exactly one word is left after the last block. We do the same, for the
+    // checksums to stay the ones written into existing archives.
+    if(m_bPendingByte && m_nWords % 360 == 1) {
+        sum1 = (sum1 + m_heldWord[0]) % 65535;
+        sum2 = (sum2 + sum1) % 65535;
+    } else {
+        if(m_nWords > 0)
+            fletcherWordsScalar(m_heldWord, 1, sum1, sum2);
+
+        if(m_bPendingByte) {
+            sum1 = (sum1 + m_uiPendingByte) % 65535;
+            sum2 = (sum2 + sum1) % 65535;
+        }
     }
 
-    // Second reduction step to reduce sums to 16 bits.
-    sum1 = (sum1 & 0xffff) + (sum1 >> 16);
-    sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+    // The original sums never become 0 but 0xffff instead.
+    if(sum1 == 0)
+        sum1 = 0xffff;
+    if(sum2 == 0)
+        sum2 = 0xffff;
     return sum2 << 16 | sum1;
 }
 
@@ -58,6 +300,7 @@ FTS::RawDataContainer::RawDataContainer()
 
 FTS::RawDataContainer::RawDataContainer(size_t in_uiSize)
     : m_uiSize(in_uiSize)
+    , m_uiCapacity(in_uiSize)
 {
     if(in_uiSize == 0) {
         return;
@@ -68,7 +311,7 @@ FTS::RawDataContainer::RawDataContainer(size_t in_uiSize)
 
 FTS::RawDataContainer::RawDataContainer(const DataContainer &o)
 {
-    m_uiSize = o.getSize();
+    m_uiSize = m_uiCapacity = o.getSize();
     m_pData = reinterpret_cast<uint8_t *>(malloc(o.getSize()+1));
     memcpy(m_pData, o.getData(), o.getSize());
     m_pData[m_uiSize] = 0;
@@ -76,7 +319,7 @@ FTS::RawDataContainer::RawDataContainer(const DataContainer &o)
 
 FTS::RawDataContainer::RawDataContainer(const RawDataContainer &o)
 {
-    m_uiSize = o.getSize();
+    m_uiSize = m_uiCapacity = o.getSize();
     m_pData = reinterpret_cast<uint8_t *>(malloc(o.getSize() + 1));
     memcpy(m_pData, o.getData(), o.getSize());
     m_pData[m_uiSize] = 0;
@@ -86,6 +329,7 @@ FTS::RawDataContainer::~RawDataContainer()
 {
     free(m_pData);
     m_uiSize = 0;
+    m_uiCapacity = 0;
 }
 
 RawDataContainer& RawDataContainer::operator=(const RawDataContainer& o)
@@ -93,7 +337,8 @@ RawDataContainer& RawDataContainer::operator=(const RawDataContainer& o)
     if(this == &o) {
         return *this;
     }
-    m_uiSize = o.getSize();
+    free(m_pData);
+    m_uiSize = m_uiCapacity = o.getSize();
     m_pData = reinterpret_cast<uint8_t *>(malloc(o.getSize() + 1));
     memcpy(m_pData, o.getData(), o.getSize());
     m_pData[m_uiSize] = 0;
@@ -126,14 +371,36 @@ void FTS::RawDataContainer::grow(size_t in_uiAdditional)
 
 void FTS::RawDataContainer::resize(size_t in_uiNewSize)
 {
-    auto newBlock = reinterpret_cast<uint8_t *>(realloc(m_pData, in_uiNewSize+1));
+    if(in_uiNewSize > m_uiCapacity || m_pData == nullptr) {
+        // Grow geometrically, so that many small appends only cost an
+        // amortized constant time each.
+        this->reserve(std::max(in_uiNewSize, m_uiCapacity + m_uiCapacity / 2));
+        if(in_uiNewSize > m_uiCapacity || m_pData == nullptr) {
+            // Out of memory.
+            this->destroy();
+            return;
+        }
+    }
+
+    if(in_uiNewSize > m_uiSize)
+        memset(m_pData + m_uiSize, 0, in_uiNewSize - m_uiSize);
+    m_uiSize = in_uiNewSize;
+    m_pData[m_uiSize] = 0;
+}
+
+void FTS::RawDataContainer::reserve(size_t in_uiCapacity)
+{
+    if(in_uiCapacity <= m_uiCapacity && m_pData != nullptr) {
+        return;
+    }
+
+    // Not this->getData(), copy-on-write containers detach before this.
+    auto newBlock = reinterpret_cast<uint8_t *>(realloc(m_pData, in_uiCapacity+1));
     if(newBlock != nullptr) {
+        if(m_pData == nullptr)
+            newBlock[0] = 0;
         m_pData = newBlock;
-        if(in_uiNewSize > m_uiSize)
-            memset(m_pData + m_uiSize, 0, in_uiNewSize - m_uiSize);
-        m_uiSize = in_uiNewSize;
-    } else {
-        this->destroy();
+        m_uiCapacity = in_uiCapacity;
     }
 }
 
@@ -142,6 +409,7 @@ void FTS::RawDataContainer::destroy()
     free(m_pData);
     m_pData = nullptr;
     m_uiSize = 0;
+    m_uiCapacity = 0;
 }
 
 RawDataContainer *FTS::RawDataContainer::copy() const
@@ -158,6 +426,217 @@ void FTS::RawDataContainer::append(const ConstRawDataContainer& in_other)
     memcpy(this->getData() + oldSize, in_other.getData(), in_other.getSize());
 }
 
+/// Copies the borrowed data into memory that belongs to this container and
+/// lets go of the borrowed data, so the data may be modified.
+void FTS::CopyOnWriteDataContainer::detach()
+{
+    if(!m_bBorrowed) {
+        return;
+    }
+
+    size_t uiSize = m_uiSize;
+    uint8_t *pData = reinterpret_cast<uint8_t *>(malloc(uiSize + 1));
+    memcpy(pData, m_pData, uiSize);
+    pData[uiSize] = 0;
+
+    this->release();
+    m_pData = pData;
+    m_uiSize = m_uiCapacity = uiSize;
+}
+
+uint8_t *FTS::CopyOnWriteDataContainer::getData()
+{
+    this->detach();
+    return m_pData;
+}
+
+const uint8_t *FTS::CopyOnWriteDataContainer::getData() const
+{
+    return m_pData;
+}
+
+void FTS::CopyOnWriteDataContainer::resize(size_t in_uiNewSize)
+{
+    this->detach();
+    RawDataContainer::resize(in_uiNewSize);
+}
+
+void FTS::CopyOnWriteDataContainer::reserve(size_t in_uiCapacity)
+{
+    this->detach();
+    RawDataContainer::reserve(in_uiCapacity);
+}
+
+void FTS::CopyOnWriteDataContainer::destroy()
+{
+    if(m_bBorrowed) {
+        this->release();
+    } else {
+        RawDataContainer::destroy();
+    }
+}
+
+/** Maps a whole file into memory, read-only. The pages of the file are only
+ *  read from the disk when they are accessed for the first time.
+ *
+ * \param in_pszFileName The name of the file to map.
+ * \param in_uiMinSize Files smaller than this are not mapped, as reading them
+ *                    is cheaper than setting up the mapping.
+ *
+ * \return A new data container you need to delete or NULL if the file could
+ *         not be mapped (for example it doesn't exist or is too small). In that
+ *         case, just read the file the usual way.
+ */
+MappedDataContainer *FTS::MappedDataContainer::map(const char *in_pszFileName, size_t in_uiMinSize)
+{
+#if WINDOOF
+    HANDLE hFile = CreateFileA(in_pszFileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(hFile == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+
+    LARGE_INTEGER size;
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+
+    // The zero byte after the data is only there for free if the file doesn't
+    // fill its last page entirely.
+    if(!GetFileSizeEx(hFile, &size) || size.QuadPart <= 0
+    || static_cast<uint64_t>(size.QuadPart) < in_uiMinSize
+    || static_cast<uint64_t>(size.QuadPart) > SIZE_MAX - 1
+    || size.QuadPart % si.dwPageSize == 0) {
+        CloseHandle(hFile);
+        return nullptr;
+    }
+
+    HANDLE hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(hFile);
+    if(hMapping == NULL) {
+        return nullptr;
+    }
+
+    void *pMapping = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    if(pMapping == NULL) {
+        CloseHandle(hMapping);
+        return nullptr;
+    }
+
+    size_t uiSize = static_cast<size_t>(size.QuadPart);
+    MappedDataContainer *pRet = new MappedDataContainer;
+    pRet->m_hMapping = hMapping;
+    pRet->m_uiMappingSize = uiSize;
+#else
+    int fd = open(in_pszFileName, O_RDONLY);
+    if(fd < 0) {
+        return nullptr;
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0
+    || static_cast<uint64_t>(st.st_size) < in_uiMinSize
+    || static_cast<uint64_t>(st.st_size) > SIZE_MAX - 1) {
+        close(fd);
+        return nullptr;
+    }
+
+    // Reserve room for the data and the terminating zero in anonymous (thus
+    // zeroed) memory, then place the file's mapping over the beginning of it.
+    // This way, even a file that fills its last page has its zero byte.
+    size_t uiSize = static_cast<size_t>(st.st_size);
+    void *pMapping = mmap(nullptr, uiSize + 1, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(pMapping == MAP_FAILED) {
+        close(fd);
+        return nullptr;
+    }
+
+    if(mmap(pMapping, uiSize, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(pMapping, uiSize + 1);
+        close(fd);
+        return nullptr;
+    }
+
+    // The mapping stays valid after closing the file.
+    close(fd);
+
+    MappedDataContainer *pRet = new MappedDataContainer;
+    pRet->m_uiMappingSize = uiSize + 1;
+#endif
+
+    pRet->m_pMapping = pMapping;
+    pRet->m_pData = reinterpret_cast<uint8_t *>(pMapping);
+    pRet->m_uiSize = uiSize;
+    pRet->m_bBorrowed = true;
+    return pRet;
+}
+
+FTS::MappedDataContainer::~MappedDataContainer()
+{
+    // The base class frees m_pData, which is fine once it's our own copy.
+    this->release();
+}
+
+void FTS::MappedDataContainer::release()
+{
+    if(m_pMapping == nullptr) {
+        return;
+    }
+
+#if WINDOOF
+    UnmapViewOfFile(m_pMapping);
+    CloseHandle(reinterpret_cast<HANDLE>(m_hMapping));
+    m_hMapping = nullptr;
+#else
+    munmap(m_pMapping, m_uiMappingSize);
+#endif
+
+    m_pMapping = nullptr;
+    m_uiMappingSize = 0;
+    m_pData = nullptr;
+    m_uiSize = 0;
+    m_bBorrowed = false;
+}
+
+/// \param in_pShared The data container whose data to share. It must not be
+///                   modified anymore, by nobody.
+FTS::SharedDataContainer::SharedDataContainer(const std::shared_ptr<const RawDataContainer>& in_pShared)
+    : m_pShared(in_pShared)
+{
+    if(m_pShared) {
+        // Never written to, see getData.
+        m_pData = const_cast<uint8_t *>(m_pShared->getData());
+        m_uiSize = m_pShared->getSize();
+        m_bBorrowed = true;
+    }
+}
+
+FTS::SharedDataContainer::~SharedDataContainer()
+{
+    // The base class frees m_pData, which is fine once it's our own copy.
+    this->release();
+}
+
+void FTS::SharedDataContainer::release()
+{
+    if(!m_bBorrowed) {
+        return;
+    }
+
+    m_pShared.reset();
+    m_pData = nullptr;
+    m_uiSize = 0;
+    m_bBorrowed = false;
+}
+
+/// \return A copy of this data container that shares the same data, as long
+///         as the data is still shared. A copy of the whole data else.
+RawDataContainer *FTS::SharedDataContainer::copy() const
+{
+    if(m_bBorrowed) {
+        return new SharedDataContainer(m_pShared);
+    }
+    return RawDataContainer::copy();
+}
+
 FTS::ConstRawDataContainer::ConstRawDataContainer() : m_pData(nullptr), m_uiSize(0)
 {
 }
@@ -8,6 +8,8 @@
 #ifndef D_DATA_CONTAINER_H
 #define D_DATA_CONTAINER_H
 
+#include <memory>
+
 namespace FTS {
     class ConstRawDataContainer;
 
@@ -53,6 +55,9 @@ protected:
     uint8_t *m_pData = nullptr;
     /// The size of the data managed by this container.
     size_t m_uiSize = 0;
+    /// How many bytes fit into \a m_pData without reallocating it, not
+    /// counting the terminating zero byte.
+    size_t m_uiCapacity = 0;
 
 public:
     /// Constructs a data container with no data :)
@@ -85,7 +90,17 @@ public:
     /// \param in_uiNewSize The new size that the data should have. If this is
     ///                     less then the current size, data at the end will be
     ///                     cut off. If it is more, all data is kept.
+    /// \note If more memory is needed, the capacity grows by at least half of
+    ///       the current capacity. Shrinking never gives memory back.
     virtual void resize(size_t in_uiNewSize);
+
+    /// Makes sure the data can grow up to a certain size without the need to
+    /// reallocate it. This never changes the size of the data.
+    /// \param in_uiCapacity The size the data should be able to grow to.
+    virtual void reserve(size_t in_uiCapacity);
+
+    /// \return How big the data may become without the need to reallocate it.
+    inline size_t getCapacity() const {return m_uiCapacity;};
     
     /// Grows the data that I hold (similar to realloc)
     /// \param in_uiAdditional How much more space should be reserved at the end
@@ -105,6 +120,85 @@ public:
     virtual void append(const ConstRawDataContainer& in_other);
 };
 
+/// This is the base for data containers that start out with data they don't
+/// own but only look at, read-only.\n
+/// As soon as the data is about to be modified (non-const \a getData, \a resize,
+/// ...), it is copied into memory owned by the container, so from there on it
+/// behaves exactly like a \a RawDataContainer.\n
+/// Like for a \a RawDataContainer, the data must be followed by a zero byte.
+class CopyOnWriteDataContainer : public RawDataContainer {
+protected:
+    CopyOnWriteDataContainer() {};
+
+    /// Lets go of the borrowed data, without copying it. Afterwards, the
+    /// container must hold no data at all.
+    virtual void release() = 0;
+    void detach();
+
+    /// Whether \a m_pData points to borrowed data or to data I own.
+    bool m_bBorrowed = false;
+
+public:
+    /// \return Whether the data still is borrowed, that is not copied yet.
+    inline bool isBorrowed() const {return m_bBorrowed;};
+
+    /// \return A modifiable pointer to the data. This copies the data first if
+    ///         it is borrowed.
+    uint8_t *getData() override;
+    /// \return A read-only pointer to the data, be it borrowed or not.
+    const uint8_t *getData() const override;
+
+    void resize(size_t in_uiNewSize) override;
+    void reserve(size_t in_uiCapacity) override;
+    void destroy() override;
+};
+
+/// This data container maps a file on the disk into memory, read-only. Only the
+/// pages that are really accessed are read from the disk, by the OS. The data
+/// is copied into memory as soon as it is about to be modified.
+/// \note The file should not be truncated while it is mapped.
+class MappedDataContainer : public CopyOnWriteDataContainer {
+    /// The start of the mapping, NULL once the data got copied into memory.
+    void *m_pMapping = nullptr;
+    /// The length of the whole mapping, including the terminating zero.
+    size_t m_uiMappingSize = 0;
+    /// The file mapping object, needed to close the mapping on windows.
+    void *m_hMapping = nullptr;
+
+    MappedDataContainer() {};
+
+protected:
+    void release() override;
+
+public:
+    static MappedDataContainer *map(const char *in_pszFileName, size_t in_uiMinSize = 1);
+
+    /// Unmaps the file or deallocates the data, whatever is the case.
+    virtual ~MappedDataContainer();
+
+    /// \return Whether the data still lies in the mapped file.
+    inline bool isMapped() const {return this->isBorrowed();};
+};
+
+/// This data container shares the data of another data container, which is
+/// kept alive as long as it is shared. The data is copied as soon as it is
+/// about to be modified, the shared data container itself is never modified.
+class SharedDataContainer : public CopyOnWriteDataContainer {
+    /// The data container whose data is shared, empty once it got copied.
+    std::shared_ptr<const RawDataContainer> m_pShared;
+
+protected:
+    void release() override;
+
+public:
+    SharedDataContainer(const std::shared_ptr<const RawDataContainer>& in_pShared);
+
+    /// Stops sharing the data or deallocates the copy, whatever is the case.
+    virtual ~SharedDataContainer();
+
+    RawDataContainer *copy() const override;
+};
+
 /// This class represents a data container that is only good for reading the
 /// data, neither modifying it, nor creating it.\n
 /// Also, it does not destroy the data when it is being destroyed itself.
@@ -142,6 +236,49 @@ public:
     virtual DataContainer *copy() const;
 };
 
+/// Computes the fletcher32 checksum of \a DataContainer::fletcher32 piece by
+/// piece, so that data can be checksummed while it is read or written instead
+/// of in a second pass. Feeding the data in any number of pieces of any size
+/// gives exactly the same checksum as checksumming it all at once.\n
+/// The bulk of the work is done using SSE2 or AVX2 if the CPU has it.
+class Fletcher32 {
+public:
+    Fletcher32();
+
+    /// Adds data to the checksum.
+    /// \param in_pData The data to add, directly following the data added before.
+    /// \param in_uiSize The size (in bytes) of \a in_pData.
+    /// \return A reference to myself.
+    Fletcher32& update(const void *in_pData, size_t in_uiSize);
+    /// Adds the whole data of a data container to the checksum.
+    /// \return A reference to myself.
+    inline Fletcher32& update(const DataContainer& in_data) {return this->update(in_data.getData(), in_data.getSize());};
+
+    /// \return The checksum of all the data added so far. More data may still
+    ///         be added afterwards.
+    uint32_t finalize() const;
+
+    /// Forgets all the data added so far.
+    void reset();
+
+    /// \return The name of the implementation in use, like "AVX2".
+    static const char *getImplementationName();
+
+private:
+    /// Both sums, always reduced modulo 65535.
+    uint32_t m_uiSum1, m_uiSum2;
+    /// The number of complete 16 bit words seen so far.
+    uint64_t m_nWords;
+    /// The last complete word is only added once the next one comes, as the
+    /// last word is treated specially in some cases, see \a finalize.
+    uint8_t m_heldWord[2];
+    /// A single byte that still waits for its partner to make a word.
+    uint8_t m_uiPendingByte;
+    bool m_bPendingByte;
+
+    void addHeldWord();
+};
+
 /// Converts a data buffer from little endian into the system's endian.
 /// \param out_pBuff The data whose endianness to swap.
 /// \param in_uiSize The size of the data.
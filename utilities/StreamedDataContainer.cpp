@@ -274,6 +274,11 @@ int FTS::WriteableStream::overwrite(const uint8_t *in_ptr, size_t in_size)
  */
 size_t FTS::WriteableStream::insert(const void *in_ptr, size_t in_size, size_t in_nmemb)
 {
+    // Nothing to swap, so write all chunks at once.
+    if(systemHasGoodEndian()) {
+        return this->insert(in_ptr, in_size * in_nmemb) == ERR_OK ? in_nmemb : 0;
+    }
+
     uint8_t *pSwapBuff = new uint8_t[in_size];
     const uint8_t *pInPosition = reinterpret_cast<const uint8_t *>(in_ptr);
     const uint8_t *pWriteBuff = pInPosition;
@@ -373,6 +378,11 @@ int FTS::WriteableStream::insert(const String &in)
  */
 size_t FTS::WriteableStream::overwrite(const void *in_ptr, size_t in_size, size_t in_nmemb)
 {
+    // Nothing to swap, so write all chunks at once.
+    if(systemHasGoodEndian()) {
+        return this->overwrite(reinterpret_cast<const uint8_t *>(in_ptr), in_size * in_nmemb) == ERR_OK ? in_nmemb : 0;
+    }
+
     uint8_t *pSwapBuff = new uint8_t[in_size];
     const uint8_t *pInPosition = reinterpret_cast<const uint8_t *>(in_ptr);
     const uint8_t *pWriteBuff = pInPosition;
@@ -547,7 +557,9 @@ RawDataContainer *FTS::StreamedDataContainer::unbindDC()
 /// \return True if the data is invalid (for example non existent).
 bool FTS::StreamedDataContainer::invalid() const
 {
-    return m_pDC == NULL || m_pDC->getData() == NULL;
+    // Go through the const accessor, reading must not trigger a copy of
+    // mapped data.
+    return m_pDC == NULL || this->getBoundDC()->getData() == NULL;
 }
 
 /// \return True if the end of data has been reached, false else.
@@ -573,7 +585,7 @@ const void *FTS::StreamedDataContainer::getDataAtCursorPos() const
     if(this->eod())
         return NULL;
 
-    return &m_pDC->getData()[this->getCursorPos()];
+    return &this->getBoundDC()->getData()[this->getCursorPos()];
 }
 
 /// \return How much bytes there are still left from the cursor's position until
@@ -617,10 +629,11 @@ int FTS::StreamedDataContainer::moveAndResizeData(uint64_t in_uiFrom, uint64_t i
 
     // No data yet ? create it with the right size. No need to move anything.
     if(this->invalid()) {
-        if(in_uiSize == 0) {
-            m_pDC = new RawDataContainer(in_uiFrom + in_iOffset);
+        uint64_t uiNewSize = in_uiSize == 0 ? in_uiFrom + in_iOffset : in_uiSize;
+        if(m_pDC == NULL) {
+            m_pDC = new RawDataContainer(static_cast<size_t>(uiNewSize));
         } else {
-            m_pDC = new RawDataContainer(in_uiSize);
+            m_pDC->resize(static_cast<size_t>(uiNewSize));
         }
         return ERR_OK;
     }
@@ -637,10 +650,21 @@ int FTS::StreamedDataContainer::moveAndResizeData(uint64_t in_uiFrom, uint64_t i
         m_pDC->resize(uiLastByteToWrite);
     }
 
-    // Move the data, beginning with the last byte.
-    for(uint64_t i = in_uiSize ; i > 0 ; i--) {
-        m_pDC->getData()[in_uiFrom+in_iOffset+i-1] = m_pDC->getData()[in_uiFrom+i-1];
-        m_pDC->getData()[in_uiFrom+i-1] = 0;
+    // Appending at the end, nothing to move.
+    if(in_uiSize == 0 || in_iOffset == 0)
+        return ERR_OK;
+
+    // Move the whole block at once, the regions may overlap.
+    uint8_t *pData = m_pDC->getData();
+    memmove(pData + in_uiFrom + in_iOffset, pData + in_uiFrom, static_cast<size_t>(in_uiSize));
+
+    // Zero the part of the old place that isn't covered by the new one.
+    if(in_iOffset > 0) {
+        uint64_t uiToZero = std::min(in_uiSize, static_cast<uint64_t>(in_iOffset));
+        memset(pData + in_uiFrom, 0, static_cast<size_t>(uiToZero));
+    } else {
+        uint64_t uiToZero = std::min(in_uiSize, static_cast<uint64_t>(-in_iOffset));
+        memset(pData + in_uiFrom + in_uiSize - uiToZero, 0, static_cast<size_t>(uiToZero));
     }
 
     return ERR_OK;
@@ -697,40 +721,7 @@ uint8_t *FTS::StreamedDataContainer::getBufferInFrontOfCursor()
 /// \return The fletcher32 checksum of the data beginning at the cursor.
 uint32_t FTS::StreamedDataContainer::fletcher32FromCursor() const
 {
-    // Taken from wikipedia. Input only works on an array of uint16_t, thus
-    // if our data has one byte too much, cut it off.
-
-    // 0 if the length is pair (exactly enough bytes), 1 if we are missing 1 byte.
-    uint64_t uiToCompare = this->getSizeTillEnd() % 2;
-
-    uint64_t uiDataLen16Bit = this->getSizeTillEnd()/2;
-    const uint16_t *pData16Bit = reinterpret_cast<const uint16_t*>(this->getDataAtCursorPos());
-
-    uint32_t sum1 = 0xffff, sum2 = 0xffff;
-
-    while(uiDataLen16Bit > uiToCompare) {
-            uint64_t tlen = uiDataLen16Bit > 360 ? 360 : uiDataLen16Bit;
-            uiDataLen16Bit -= tlen;
-            do {
-                    sum1 += *pData16Bit++;
-                    sum2 += sum1;
-            } while (--tlen);
-            sum1 = (sum1 & 0xffff) + (sum1 >> 16);
-            sum2 = (sum2 & 0xffff) + (sum2 >> 16);
-    }
-
-    // If we are missing one byte, add a zero.
-    if(uiToCompare > 0) {
-        sum1 += *(reinterpret_cast<const uint8_t*>(pData16Bit));
-        sum2 += sum1;
-        sum1 = (sum1 & 0xffff) + (sum1 >> 16);
-        sum2 = (sum2 & 0xffff) + (sum2 >> 16);
-    }
-
-    // Second reduction step to reduce sums to 16 bits.
-    sum1 = (sum1 & 0xffff) + (sum1 >> 16);
-    sum2 = (sum2 & 0xffff) + (sum2 >> 16);
-    return sum2 << 16 | sum1;
+    return Fletcher32().update(this->getDataAtCursorPos(), static_cast<size_t>(this->getSizeTillEnd())).finalize();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -7,7 +7,7 @@
 
 #include "utilities/console.h"
 #include "ui/ui.h"
-#include "dLib/dConf/configuration.h"
+#include "dLib/dConf/ConfigurationStore.h"
 
 using namespace FTS;
 
@@ -199,10 +199,10 @@ int FTS::Console::Foreground( const bool bFore )
     if(!GUI::getSingletonPtr())
         return ERR_OK;
 
-    Configuration conf ("conf.xml", ArkanaDefaultSettings());
+    Configuration::Ptr pConf = ConfigurationStore::getSingleton().getMainConf();
     
     /* Don't do this in fullscreen mode ! */
-    if(conf.get<bool>("Fullscreen"))
+    if(pConf->get<bool>("Fullscreen"))
         return ERR_OK;
 
     if(bFore) {
@@ -15,6 +15,7 @@ public:
     virtual ~FPSCalculator();
 
     bool update(const Clock&);
+    Phase getUpdatePhase() const {return PreRender;};
     inline double getFPS() const {return m_dLastFPS;};
 
 private: